@@ -187,6 +187,19 @@ LdpConstraintBasedRouting::CreateLspTunnel (Ptr<const ExplicitRouteTLV> ertlv, O
   return lspid;
 }
 
+uint16_t
+LdpConstraintBasedRouting::CreateLspTunnel (const std::vector<Ipv4Address> &route, OperationSuccessCallback scb,
+  OperationFailCallback fcb)
+{
+  Ptr<ExplicitRouteTLV> ertlv = Create<ExplicitRouteTLV> ();
+  for (std::vector<Ipv4Address>::const_iterator i = route.begin (); i != route.end (); ++i)
+    {
+      ertlv->AddRouteHop (Create<Ipv4ExplicitRouteHopTLV> (*i, 32));
+    }
+
+  return CreateLspTunnel (ertlv, scb, fcb);
+}
+
 void
 LdpConstraintBasedRouting::DeleteLspTunnel (uint16_t lspid)
 {
@@ -21,9 +21,12 @@
 #ifndef LDP_CONSTRAINT_BASED_ROUTING_H
 #define LDP_CONSTRAINT_BASED_ROUTING_H
 
+#include <vector>
+
 #include "ns3/object.h"
 #include "ns3/ptr.h"
 #include "ns3/callback.h"
+#include "ns3/ipv4-address.h"
 #include "ns3/forwarding-equivalence-class.h"
 
 #include "common-cr-tlv.h"
@@ -50,6 +53,14 @@ public:
   typedef Callback<void, uint16_t> OperationFailCallback;
 
   uint16_t CreateLspTunnel (Ptr<const ExplicitRouteTLV> ertlv, OperationSuccessCallback scb, OperationFailCallback fcb);
+  /**
+   * \param route addresses of incoming interfaces of every LSR after this one (strict ER-hops),
+   *        e.g. computed by MplsCspfHelper::GetExplicitRoute
+   * \param scb success callback
+   * \param fcb fail callback
+   * \returns lsp id
+   */
+  uint16_t CreateLspTunnel (const std::vector<Ipv4Address> &route, OperationSuccessCallback scb, OperationFailCallback fcb);
   void DeleteLspTunnel (uint16_t lspid);
 //  void ModifyLspTunnel (uint16_t lspid, OperationSuccessCallback scb, OperationFailCallback fcb);
 
@@ -0,0 +1,751 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010 Andrey Churin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Andrey Churin <aachurin@gmail.com>
+ */
+
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ns3/enum.h"
+#include "ns3/simulator.h"
+#include "ns3/ipv4.h"
+#include "ns3/ipv4-list-routing.h"
+#include "ns3/ipv4-static-routing.h"
+#include "ns3/ipv4-global-routing.h"
+#include "ns3/mpls-interface.h"
+#include "ns3/mpls-fec.h"
+#include "ns3/mpls-nhlfe.h"
+#include "ns3/mpls-operations.h"
+#include "ns3/mpls-nhlfe-selection-policy.h"
+
+#include "protocol-data-unit.h"
+#include "common-tlv.h"
+#include "ldp-downstream-unsolicited.h"
+
+NS_LOG_COMPONENT_DEFINE ("LdpDownstreamUnsolicited");
+
+namespace ns3 {
+namespace ldp {
+
+NS_OBJECT_ENSURE_REGISTERED (LdpDownstreamUnsolicited);
+
+const uint16_t LdpDownstreamUnsolicited::LABEL_MAPPING_MESSAGE = 0x0400;
+const uint16_t LdpDownstreamUnsolicited::LABEL_REQUEST_MESSAGE = 0x0401;
+const uint16_t LdpDownstreamUnsolicited::LABEL_WITHDRAW_MESSAGE = 0x0402;
+const uint16_t LdpDownstreamUnsolicited::LABEL_RELEASE_MESSAGE = 0x0403;
+
+TypeId
+LdpDownstreamUnsolicited::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::ldp::LdpDownstreamUnsolicited")
+    .SetParent<LdpExtension> ()
+    .AddConstructor <LdpDownstreamUnsolicited> ()
+    .AddAttribute ("RetentionMode",
+                   "Label retention mode.",
+                   EnumValue (LIBERAL),
+                   MakeEnumAccessor (&LdpDownstreamUnsolicited::SetRetentionMode),
+                   MakeEnumChecker (LIBERAL, "Liberal",
+                                    CONSERVATIVE, "Conservative"))
+    ;
+  return tid;
+}
+
+LdpDownstreamUnsolicited::LdpDownstreamUnsolicited ()
+  : m_ldp (0),
+    m_node (0),
+    m_mpls (0),
+    m_retentionMode (LIBERAL)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+}
+
+LdpDownstreamUnsolicited::~LdpDownstreamUnsolicited ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+}
+
+void
+LdpDownstreamUnsolicited::DoDispose (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  for (FecMap::iterator i = m_fecs.begin (); i != m_fecs.end (); ++i)
+    {
+      Uninstall (i->second);
+    }
+  m_fecs.clear ();
+  m_lib.clear ();
+  m_peers.clear ();
+
+  if (m_ldp != 0)
+    {
+      m_ldp->RemoveExtension (this);
+      m_ldp = 0;
+    }
+
+  m_node = 0;
+  m_mpls = 0;
+
+  LdpExtension::DoDispose ();
+}
+
+void
+LdpDownstreamUnsolicited::NotifyNewAggregate ()
+{
+  if (m_node == 0)
+    {
+      m_node = GetObject<MplsNode> ();
+    }
+
+  if (m_mpls == 0)
+    {
+      m_mpls = GetObject<Mpls> ();
+    }
+
+  if (m_ldp == 0)
+    {
+      Ptr<LdpProtocol> ldp = GetObject<LdpProtocol> ();
+      if (ldp != 0)
+        {
+          this->SetLdp (ldp);
+        }
+    }
+
+  LdpExtension::NotifyNewAggregate ();
+}
+
+void
+LdpDownstreamUnsolicited::SetLdp (Ptr<LdpProtocol> ldp)
+{
+  NS_LOG_FUNCTION (this << ldp);
+
+  m_ldp = ldp;
+  ldp->InsertExtension (this);
+
+  // routing tables are usually populated just before the simulation starts
+  Simulator::ScheduleNow (&LdpDownstreamUnsolicited::Update, this);
+}
+
+void
+LdpDownstreamUnsolicited::SetRetentionMode (RetentionMode mode)
+{
+  m_retentionMode = mode;
+}
+
+LdpDownstreamUnsolicited::RetentionMode
+LdpDownstreamUnsolicited::GetRetentionMode (void) const
+{
+  return m_retentionMode;
+}
+
+uint32_t
+LdpDownstreamUnsolicited::GetNFecs (void) const
+{
+  return m_fecs.size ();
+}
+
+uint32_t
+LdpDownstreamUnsolicited::GetNRemoteBindings (void) const
+{
+  uint32_t n = 0;
+  for (LabelInformationBase::const_iterator i = m_lib.begin (); i != m_lib.end (); ++i)
+    {
+      n += i->second.size ();
+    }
+  return n;
+}
+
+uint32_t
+LdpDownstreamUnsolicited::GetBindingMemory (void) const
+{
+  // std::map and std::list nodes carry three and two pointers of overhead respectively
+  const uint32_t mapNode = 3 * sizeof (void*) + sizeof (int);
+  const uint32_t listNode = 2 * sizeof (void*);
+
+  uint32_t bytes = 0;
+
+  for (FecMap::const_iterator i = m_fecs.begin (); i != m_fecs.end (); ++i)
+    {
+      bytes += mapNode + sizeof (Prefix) + sizeof (FecBinding);
+
+      const FecBinding &binding = i->second;
+      if (binding.ilm != 0)
+        {
+          bytes += listNode + sizeof (IncomingLabelMap) + binding.ilm->GetNNhlfe () * sizeof (Nhlfe);
+        }
+      if (binding.ftn != 0)
+        {
+          bytes += listNode + sizeof (FecToNhlfe) + sizeof (Ipv4Destination) +
+            binding.ftn->GetNNhlfe () * sizeof (Nhlfe);
+        }
+    }
+
+  for (LabelInformationBase::const_iterator i = m_lib.begin (); i != m_lib.end (); ++i)
+    {
+      bytes += mapNode + sizeof (Prefix) + sizeof (RemoteBindingList) +
+        i->second.size () * (listNode + sizeof (RemoteBinding));
+    }
+
+  return bytes;
+}
+
+Time
+LdpDownstreamUnsolicited::GetConvergenceTime (void) const
+{
+  return m_convergenceTime;
+}
+
+void
+LdpDownstreamUnsolicited::Update (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  NS_ASSERT_MSG (m_node != 0 && m_mpls != 0, "LdpDownstreamUnsolicited::Update (): "
+                                             "ldp should be aggregated to the mpls node");
+
+  m_updateTime = Simulator::Now ();
+  m_convergenceTime = Seconds (0);
+
+  RouteMap routes;
+  CollectConnectedRoutes (routes);
+  CollectRoutes (m_mpls->GetIpv4 ()->GetRoutingProtocol (), routes);
+
+  // withdraw labels of prefixes which are not routed anymore
+  for (FecMap::iterator i = m_fecs.begin (); i != m_fecs.end (); )
+    {
+      if (routes.find (i->first) == routes.end ())
+        {
+          Uninstall (i->second);
+          ReleaseLocalLabel (i->first, i->second);
+          m_fecs.erase (i++);
+        }
+      else
+        {
+          ++i;
+        }
+    }
+
+  for (RouteMap::const_iterator i = routes.begin (); i != routes.end (); ++i)
+    {
+      const Prefix &prefix = i->first;
+      const Route &route = i->second;
+
+      FecMap::iterator j = m_fecs.find (prefix);
+      if (j != m_fecs.end ())
+        {
+          FecBinding &binding = j->second;
+          if (binding.route.egress == route.egress &&
+              binding.route.nextHop == route.nextHop &&
+              binding.route.outIfIndex == route.outIfIndex)
+            {
+              continue;
+            }
+
+          if (binding.route.egress != route.egress)
+            {
+              Uninstall (binding);
+              ReleaseLocalLabel (prefix, binding);
+              m_fecs.erase (j);
+            }
+          else
+            {
+              NS_LOG_DEBUG ("Next-hop for " << prefix.address << "/" << (uint32_t)prefix.length <<
+                            " changed to " << route.nextHop);
+              binding.route = route;
+              Install (prefix, binding);
+              RequestLabel (prefix, binding);
+              continue;
+            }
+        }
+
+      FecBinding binding;
+      binding.route = route;
+      binding.localLabel = route.egress ? Label (Label::IMPLICIT_NULL) : m_node->GetLabelSpace (0)->Allocate ();
+
+      NS_LOG_DEBUG ("Bind " << prefix.address << "/" << (uint32_t)prefix.length << " to label " << binding.localLabel);
+
+      for (PeerList::const_iterator k = m_peers.begin (); k != m_peers.end (); ++k)
+        {
+          (*k)->Send (CreateLabelMappingMessage (prefix, binding.localLabel));
+        }
+
+      FecBinding &inserted = m_fecs.insert (std::make_pair (prefix, binding)).first->second;
+      Install (prefix, inserted);
+      RequestLabel (prefix, inserted);
+    }
+}
+
+void
+LdpDownstreamUnsolicited::RequestLabel (const Prefix &prefix, const FecBinding &binding)
+{
+  // in conservative mode the mapping of a new next-hop has been released before, ask for it again
+  if (m_retentionMode != CONSERVATIVE || binding.route.egress || binding.ilm != 0)
+    {
+      return;
+    }
+
+  for (PeerList::const_iterator i = m_peers.begin (); i != m_peers.end (); ++i)
+    {
+      if (Ipv4Address::ConvertFrom ((*i)->GetAddress ()) == binding.route.nextHop)
+        {
+          (*i)->Send (CreateLabelRequestMessage (prefix));
+          return;
+        }
+    }
+}
+
+void
+LdpDownstreamUnsolicited::CollectRoutes (Ptr<Ipv4RoutingProtocol> routing, RouteMap &routes) const
+{
+  Ptr<Ipv4ListRouting> list = DynamicCast<Ipv4ListRouting> (routing);
+  if (list != 0)
+    {
+      // protocols are sorted by priority, so the preferred route is collected first
+      for (uint32_t i = 0; i < list->GetNRoutingProtocols (); ++i)
+        {
+          int16_t priority;
+          CollectRoutes (list->GetRoutingProtocol (i, priority), routes);
+        }
+      return;
+    }
+
+  Ptr<Ipv4StaticRouting> staticRouting = DynamicCast<Ipv4StaticRouting> (routing);
+  if (staticRouting != 0)
+    {
+      for (uint32_t i = 0; i < staticRouting->GetNRoutes (); ++i)
+        {
+          CollectRoute (staticRouting->GetRoute (i), routes);
+        }
+      return;
+    }
+
+  Ptr<Ipv4GlobalRouting> globalRouting = DynamicCast<Ipv4GlobalRouting> (routing);
+  if (globalRouting != 0)
+    {
+      for (uint32_t i = 0; i < globalRouting->GetNRoutes (); ++i)
+        {
+          CollectRoute (*globalRouting->GetRoute (i), routes);
+        }
+      return;
+    }
+
+  NS_LOG_WARN ("Unsupported routing protocol " << routing->GetInstanceTypeId ().GetName ());
+}
+
+void
+LdpDownstreamUnsolicited::CollectRoute (const Ipv4RoutingTableEntry &entry, RouteMap &routes) const
+{
+  // the loopback network is local to every node and is never label switched
+  if (entry.IsDefault () || entry.GetDest ().CombineMask (Ipv4Mask ("255.0.0.0")) == Ipv4Address ("127.0.0.0"))
+    {
+      return;
+    }
+
+  Prefix prefix (entry.GetDest (), entry.IsHost () ? 32 : entry.GetDestNetworkMask ().GetPrefixLength ());
+  if (routes.find (prefix) != routes.end ())
+    {
+      return;
+    }
+
+  Route route;
+  route.egress = !entry.IsGateway ();
+  route.nextHop = entry.GetGateway ();
+  route.outIfIndex = -1;
+
+  if (!route.egress)
+    {
+      Ptr<Interface> iface = m_mpls->GetInterfaceForDevice (m_mpls->GetIpv4 ()->GetNetDevice (entry.GetInterface ()));
+      if (iface == 0)
+        {
+          NS_LOG_DEBUG ("Skip " << prefix.address << "/" << (uint32_t)prefix.length << ", not an mpls interface");
+          return;
+        }
+      route.outIfIndex = iface->GetIfIndex ();
+    }
+
+  routes.insert (std::make_pair (prefix, route));
+}
+
+void
+LdpDownstreamUnsolicited::CollectConnectedRoutes (RouteMap &routes) const
+{
+  Ptr<Ipv4> ipv4 = m_mpls->GetIpv4 ();
+
+  Route route;
+  route.egress = true;
+  route.outIfIndex = -1;
+
+  for (uint32_t i = 0; i < ipv4->GetNInterfaces (); ++i)
+    {
+      for (uint32_t j = 0; j < ipv4->GetNAddresses (i); ++j)
+        {
+          Ipv4InterfaceAddress address = ipv4->GetAddress (i, j);
+          if (address.GetLocal () == Ipv4Address::GetLoopback ())
+            {
+              continue;
+            }
+          routes.insert (std::make_pair (Prefix (address.GetLocal (), 32), route));
+          routes.insert (std::make_pair (Prefix (address.GetLocal ().CombineMask (address.GetMask ()),
+                                                 address.GetMask ().GetPrefixLength ()), route));
+        }
+    }
+}
+
+bool
+LdpDownstreamUnsolicited::IsNextHop (Ptr<const LdpPeer> peer, const Prefix &prefix) const
+{
+  FecMap::const_iterator i = m_fecs.find (prefix);
+  if (i == m_fecs.end () || i->second.route.egress)
+    {
+      return false;
+    }
+
+  return Ipv4Address::ConvertFrom (peer->GetAddress ()) == i->second.route.nextHop;
+}
+
+void
+LdpDownstreamUnsolicited::Install (const Prefix &prefix, FecBinding &binding)
+{
+  NS_LOG_FUNCTION (this << prefix.address << (uint32_t)prefix.length);
+
+  Uninstall (binding);
+
+  if (binding.route.egress)
+    {
+      return;
+    }
+
+  LabelInformationBase::const_iterator i = m_lib.find (prefix);
+  if (i == m_lib.end ())
+    {
+      return;
+    }
+
+  for (RemoteBindingList::const_iterator j = i->second.begin (); j != i->second.end (); ++j)
+    {
+      if (Ipv4Address::ConvertFrom ((*j).peer->GetAddress ()) != binding.route.nextHop)
+        {
+          continue;
+        }
+
+      Nhlfe nhlfe (Swap ((*j).label), binding.route.outIfIndex, binding.route.nextHop);
+
+      binding.ilm = Create<IncomingLabelMap> (binding.localLabel, nhlfe, CreateObject<NhlfeSelectionPolicy> ());
+      m_node->GetIlmTable ()->push_back (binding.ilm);
+
+      if ((*j).label != Label::IMPLICIT_NULL)
+        {
+          Ipv4Mask mask (prefix.length ? 0xffffffff << (32 - prefix.length) : 0);
+          binding.ftn = Create<FecToNhlfe> (Fec::Build (Ipv4Destination (prefix.address, mask)), nhlfe,
+                                            CreateObject<NhlfeSelectionPolicy> ());
+          m_node->GetFtnTable ()->push_back (binding.ftn);
+        }
+
+      m_convergenceTime = Simulator::Now () - m_updateTime;
+      return;
+    }
+}
+
+void
+LdpDownstreamUnsolicited::Uninstall (FecBinding &binding)
+{
+  if (binding.ilm != 0)
+    {
+      m_node->GetIlmTable ()->remove (binding.ilm);
+      binding.ilm = 0;
+      m_convergenceTime = Simulator::Now () - m_updateTime;
+    }
+
+  if (binding.ftn != 0)
+    {
+      m_node->GetFtnTable ()->remove (binding.ftn);
+      binding.ftn = 0;
+      m_convergenceTime = Simulator::Now () - m_updateTime;
+    }
+}
+
+void
+LdpDownstreamUnsolicited::ReleaseLocalLabel (const Prefix &prefix, FecBinding &binding)
+{
+  NS_LOG_FUNCTION (this << prefix.address << (uint32_t)prefix.length);
+
+  for (PeerList::const_iterator i = m_peers.begin (); i != m_peers.end (); ++i)
+    {
+      (*i)->Send (CreateLabelWithdrawMessage (prefix, binding.localLabel));
+    }
+
+  if (!binding.route.egress)
+    {
+      m_node->GetLabelSpace (0)->Deallocate (binding.localLabel);
+    }
+}
+
+void
+LdpDownstreamUnsolicited::NotifyPeerUp (Ptr<LdpPeer> peer)
+{
+  NS_LOG_FUNCTION (this << peer);
+
+  m_peers.push_back (peer);
+
+  for (FecMap::const_iterator i = m_fecs.begin (); i != m_fecs.end (); ++i)
+    {
+      peer->Send (CreateLabelMappingMessage (i->first, i->second.localLabel));
+    }
+}
+
+void
+LdpDownstreamUnsolicited::NotifyPeerDown (Ptr<const LdpPeer> peer)
+{
+  NS_LOG_FUNCTION (this << peer);
+
+  for (PeerList::iterator i = m_peers.begin (); i != m_peers.end (); ++i)
+    {
+      if (*i == peer)
+        {
+          m_peers.erase (i);
+          break;
+        }
+    }
+
+  for (LabelInformationBase::iterator i = m_lib.begin (); i != m_lib.end (); )
+    {
+      RemoteBindingList &bindings = i->second;
+      for (RemoteBindingList::iterator j = bindings.begin (); j != bindings.end (); )
+        {
+          if ((*j).peer == peer)
+            {
+              j = bindings.erase (j);
+            }
+          else
+            {
+              ++j;
+            }
+        }
+
+      FecMap::iterator k = m_fecs.find (i->first);
+      if (k != m_fecs.end () && IsNextHop (peer, i->first))
+        {
+          Install (i->first, k->second);
+        }
+
+      if (bindings.empty ())
+        {
+          m_lib.erase (i++);
+        }
+      else
+        {
+          ++i;
+        }
+    }
+}
+
+bool
+LdpDownstreamUnsolicited::ReceiveMessage (Ptr<LdpPeer> peer, Ptr<const Message> message, uint32_t &errno)
+{
+  uint16_t type = message->GetMessageType ();
+  if (type != LABEL_MAPPING_MESSAGE && type != LABEL_REQUEST_MESSAGE &&
+      type != LABEL_WITHDRAW_MESSAGE && type != LABEL_RELEASE_MESSAGE)
+    {
+      return false;
+    }
+
+  // prefix FECs only, other FEC types belong to other extensions
+  Ptr<const FecTLV> fec = DynamicCast<const FecTLV> (*message->Begin ());
+  if (fec == 0 || fec->GetNElements () == 0)
+    {
+      return false;
+    }
+
+  Ptr<const PrefixFecElement> element = DynamicCast<const PrefixFecElement> (fec->GetElement (0));
+  if (element == 0 || !Ipv4Address::IsMatchingType (element->GetAddress ()))
+    {
+      return false;
+    }
+
+  Prefix prefix (Ipv4Address::ConvertFrom (element->GetAddress ()), element->GetPrefix ());
+
+  switch (type)
+  {
+    case LABEL_MAPPING_MESSAGE:
+      return HandleLabelMappingMessage (peer, prefix, message);
+    case LABEL_REQUEST_MESSAGE:
+      return HandleLabelRequestMessage (peer, prefix);
+    case LABEL_WITHDRAW_MESSAGE:
+      return HandleLabelWithdrawMessage (peer, prefix, message);
+    case LABEL_RELEASE_MESSAGE:
+      return HandleLabelReleaseMessage (peer, prefix);
+  }
+
+  return false;
+}
+
+bool
+LdpDownstreamUnsolicited::HandleLabelMappingMessage (Ptr<LdpPeer> peer, const Prefix &prefix,
+  Ptr<const Message> message)
+{
+  NS_LOG_FUNCTION (this << peer << message);
+
+  Message::Iterator i = message->Begin ();
+  ++i;
+  Ptr<const GenericLabelTLV> label = DynamicCast<const GenericLabelTLV> (*i);
+  if (label == 0)
+    {
+      NS_LOG_DEBUG ("Drop label mapping message. Generic Label TLV expected.");
+      return false;
+    }
+
+  NS_LOG_DEBUG ("Receive label mapping " << prefix.address << "/" << (uint32_t)prefix.length <<
+                " label " << label->GetLabel () << " from " << Ipv4Address::ConvertFrom (peer->GetAddress ()));
+
+  bool nextHop = IsNextHop (peer, prefix);
+
+  if (m_retentionMode == CONSERVATIVE && !nextHop)
+    {
+      peer->Send (CreateLabelReleaseMessage (prefix, label->GetLabel ()));
+      return true;
+    }
+
+  RemoteBindingList &bindings = m_lib[prefix];
+  RemoteBindingList::iterator j = bindings.begin ();
+  for (; j != bindings.end (); ++j)
+    {
+      if ((*j).peer == peer)
+        {
+          (*j).label = label->GetLabel ();
+          break;
+        }
+    }
+
+  if (j == bindings.end ())
+    {
+      bindings.push_back (RemoteBinding (peer, label->GetLabel ()));
+    }
+
+  if (nextHop)
+    {
+      Install (prefix, m_fecs.find (prefix)->second);
+    }
+
+  return true;
+}
+
+bool
+LdpDownstreamUnsolicited::HandleLabelRequestMessage (Ptr<LdpPeer> peer, const Prefix &prefix)
+{
+  NS_LOG_FUNCTION (this << peer);
+
+  FecMap::const_iterator i = m_fecs.find (prefix);
+  if (i == m_fecs.end ())
+    {
+      NS_LOG_DEBUG ("Drop label request message. No route to " << prefix.address);
+      return false;
+    }
+
+  peer->Send (CreateLabelMappingMessage (prefix, i->second.localLabel));
+  return true;
+}
+
+bool
+LdpDownstreamUnsolicited::HandleLabelWithdrawMessage (Ptr<LdpPeer> peer, const Prefix &prefix,
+  Ptr<const Message> message)
+{
+  NS_LOG_FUNCTION (this << peer << message);
+
+  Message::Iterator i = message->Begin ();
+  ++i;
+  Ptr<const GenericLabelTLV> label = DynamicCast<const GenericLabelTLV> (*i);
+  if (label == 0)
+    {
+      NS_LOG_DEBUG ("Drop label withdraw message. Generic Label TLV expected.");
+      return false;
+    }
+
+  LabelInformationBase::iterator j = m_lib.find (prefix);
+  if (j != m_lib.end ())
+    {
+      for (RemoteBindingList::iterator k = j->second.begin (); k != j->second.end (); ++k)
+        {
+          if ((*k).peer == peer && (*k).label == label->GetLabel ())
+            {
+              j->second.erase (k);
+              break;
+            }
+        }
+
+      if (j->second.empty ())
+        {
+          m_lib.erase (j);
+        }
+
+      if (IsNextHop (peer, prefix))
+        {
+          Install (prefix, m_fecs.find (prefix)->second);
+        }
+    }
+
+  peer->Send (CreateLabelReleaseMessage (prefix, label->GetLabel ()));
+  return true;
+}
+
+bool
+LdpDownstreamUnsolicited::HandleLabelReleaseMessage (Ptr<LdpPeer> peer, const Prefix &prefix)
+{
+  NS_LOG_FUNCTION (this << peer);
+
+  // the local label stays bound to the prefix as long as the prefix is routed
+  NS_LOG_DEBUG ("Peer " << Ipv4Address::ConvertFrom (peer->GetAddress ()) << " released label for " <<
+                prefix.address << "/" << (uint32_t)prefix.length);
+  return true;
+}
+
+Ptr<Message>
+LdpDownstreamUnsolicited::CreateLabelMappingMessage (const Prefix &prefix, uint32_t label) const
+{
+  Ptr<Message> message = Create<Message> (LABEL_MAPPING_MESSAGE);
+  message->AddValue (PrefixFecElement::CreateFecTLV (prefix.address, prefix.length));
+  message->AddValue (Create<GenericLabelTLV> (label));
+  return message;
+}
+
+Ptr<Message>
+LdpDownstreamUnsolicited::CreateLabelRequestMessage (const Prefix &prefix) const
+{
+  Ptr<Message> message = Create<Message> (LABEL_REQUEST_MESSAGE);
+  message->AddValue (PrefixFecElement::CreateFecTLV (prefix.address, prefix.length));
+  return message;
+}
+
+Ptr<Message>
+LdpDownstreamUnsolicited::CreateLabelWithdrawMessage (const Prefix &prefix, uint32_t label) const
+{
+  Ptr<Message> message = Create<Message> (LABEL_WITHDRAW_MESSAGE);
+  message->AddValue (PrefixFecElement::CreateFecTLV (prefix.address, prefix.length));
+  message->AddValue (Create<GenericLabelTLV> (label));
+  return message;
+}
+
+Ptr<Message>
+LdpDownstreamUnsolicited::CreateLabelReleaseMessage (const Prefix &prefix, uint32_t label) const
+{
+  Ptr<Message> message = Create<Message> (LABEL_RELEASE_MESSAGE);
+  message->AddValue (PrefixFecElement::CreateFecTLV (prefix.address, prefix.length));
+  message->AddValue (Create<GenericLabelTLV> (label));
+  return message;
+}
+
+} // namespace ldp
+} // namespace ns3
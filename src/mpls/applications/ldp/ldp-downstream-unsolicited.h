@@ -0,0 +1,202 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010 Andrey Churin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Andrey Churin <aachurin@gmail.com>
+ */
+
+#ifndef LDP_DOWNSTREAM_UNSOLICITED_H
+#define LDP_DOWNSTREAM_UNSOLICITED_H
+
+#include <map>
+#include <list>
+
+#include "ns3/object.h"
+#include "ns3/ptr.h"
+#include "ns3/nstime.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv4-routing-protocol.h"
+#include "ns3/ipv4-routing-table-entry.h"
+#include "ns3/mpls.h"
+#include "ns3/mpls-node.h"
+
+#include "fec-tlv.h"
+#include "ldp-peer.h"
+#include "ldp-protocol.h"
+
+namespace ns3 {
+namespace ldp {
+
+/**
+ * \ingroup ldp
+ *
+ * Downstream unsolicited label distribution (RFC 5036, section 2.6).
+ *
+ * A local label is bound to every IPv4 prefix found in the node's routing table and
+ * advertised to all operational peers. Prefixes the node is egress for are advertised
+ * with the implicit null label. Label mappings received from the next-hop peer of a prefix
+ * are installed as FTN (ingress) and ILM (transit) entries into MplsNode tables.
+ *
+ * Labels are allocated from the platform-wide label space of the node.
+ */
+class LdpDownstreamUnsolicited : public LdpExtension
+{
+public:
+  static const uint16_t LABEL_MAPPING_MESSAGE;
+  static const uint16_t LABEL_REQUEST_MESSAGE;
+  static const uint16_t LABEL_WITHDRAW_MESSAGE;
+  static const uint16_t LABEL_RELEASE_MESSAGE;
+
+  /**
+   * Label retention mode
+   */
+  enum RetentionMode
+  {
+    LIBERAL = 0,   // keep mappings from every peer
+    CONSERVATIVE   // keep mappings from the next-hop peer only
+  };
+
+  static TypeId GetTypeId (void);
+
+  LdpDownstreamUnsolicited ();
+  virtual ~LdpDownstreamUnsolicited ();
+
+  /**
+   * \param mode label retention mode
+   */
+  void SetRetentionMode (RetentionMode mode);
+  /**
+   * \returns label retention mode
+   */
+  RetentionMode GetRetentionMode (void) const;
+  /**
+   * Rescan the ipv4 routing table: bind labels to new prefixes, withdraw labels of
+   * prefixes which disappeared and reinstall LSPs whose next-hop has changed.
+   * Should be called whenever routing tables are recomputed.
+   */
+  void Update (void);
+  /**
+   * \returns number of prefixes bound to a local label
+   */
+  uint32_t GetNFecs (void) const;
+  /**
+   * \returns number of label mappings retained from peers
+   */
+  uint32_t GetNRemoteBindings (void) const;
+  /**
+   * \returns approximate number of bytes used by local and remote label bindings
+   *          and by the forwarding entries installed for them
+   */
+  uint32_t GetBindingMemory (void) const;
+  /**
+   * \returns time elapsed from the last Update () till the last forwarding entry change
+   */
+  Time GetConvergenceTime (void) const;
+
+  virtual bool ReceiveMessage (Ptr<LdpPeer> peer, Ptr<const Message> message, uint32_t &errno);
+  virtual void NotifyPeerUp (Ptr<LdpPeer> peer);
+  virtual void NotifyPeerDown (Ptr<const LdpPeer> peer);
+
+protected:
+  virtual void NotifyNewAggregate (void);
+  virtual void DoDispose (void);
+
+private:
+  struct Prefix
+  {
+    Ipv4Address address;
+    uint8_t length;
+
+    inline Prefix (const Ipv4Address &address, uint8_t length)
+      : address (address), length (length)
+    {
+    }
+
+    inline bool operator< (const Prefix &other) const
+    {
+      return address < other.address || (address == other.address && length < other.length);
+    }
+  };
+
+  struct Route
+  {
+    Ipv4Address nextHop;
+    int32_t outIfIndex;
+    bool egress;
+  };
+
+  struct FecBinding
+  {
+    uint32_t localLabel;
+    Route route;
+    Ptr<IncomingLabelMap> ilm;
+    Ptr<FecToNhlfe> ftn;
+  };
+
+  struct RemoteBinding
+  {
+    Ptr<LdpPeer> peer;
+    uint32_t label;
+
+    inline RemoteBinding (Ptr<LdpPeer> peer, uint32_t label)
+      : peer (peer), label (label)
+    {
+    }
+  };
+
+  typedef std::map<Prefix, Route> RouteMap;
+  typedef std::map<Prefix, FecBinding> FecMap;
+  typedef std::list<RemoteBinding> RemoteBindingList;
+  typedef std::map<Prefix, RemoteBindingList> LabelInformationBase;
+  typedef std::list<Ptr<LdpPeer> > PeerList;
+
+  void SetLdp (Ptr<LdpProtocol> ldp);
+
+  void CollectRoutes (Ptr<Ipv4RoutingProtocol> routing, RouteMap &routes) const;
+  void CollectRoute (const Ipv4RoutingTableEntry &entry, RouteMap &routes) const;
+  void CollectConnectedRoutes (RouteMap &routes) const;
+
+  void Install (const Prefix &prefix, FecBinding &binding);
+  void Uninstall (FecBinding &binding);
+  void ReleaseLocalLabel (const Prefix &prefix, FecBinding &binding);
+  void RequestLabel (const Prefix &prefix, const FecBinding &binding);
+  bool IsNextHop (Ptr<const LdpPeer> peer, const Prefix &prefix) const;
+
+  bool HandleLabelMappingMessage (Ptr<LdpPeer> peer, const Prefix &prefix, Ptr<const Message> message);
+  bool HandleLabelRequestMessage (Ptr<LdpPeer> peer, const Prefix &prefix);
+  bool HandleLabelWithdrawMessage (Ptr<LdpPeer> peer, const Prefix &prefix, Ptr<const Message> message);
+  bool HandleLabelReleaseMessage (Ptr<LdpPeer> peer, const Prefix &prefix);
+
+  Ptr<Message> CreateLabelMappingMessage (const Prefix &prefix, uint32_t label) const;
+  Ptr<Message> CreateLabelRequestMessage (const Prefix &prefix) const;
+  Ptr<Message> CreateLabelWithdrawMessage (const Prefix &prefix, uint32_t label) const;
+  Ptr<Message> CreateLabelReleaseMessage (const Prefix &prefix, uint32_t label) const;
+
+  Ptr<LdpProtocol> m_ldp;
+  Ptr<MplsNode> m_node;
+  Ptr<Mpls> m_mpls;
+  RetentionMode m_retentionMode;
+  FecMap m_fecs;
+  LabelInformationBase m_lib;
+  PeerList m_peers;
+  Time m_updateTime;
+  Time m_convergenceTime;
+};
+
+} // namespace ldp
+} // namespace ns3
+
+#endif /* LDP_DOWNSTREAM_UNSOLICITED_H */
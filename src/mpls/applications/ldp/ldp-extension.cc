@@ -43,5 +43,15 @@ LdpExtension::~LdpExtension()
 {
 }
 
+void
+LdpExtension::NotifyPeerUp (Ptr<LdpPeer> peer)
+{
+}
+
+void
+LdpExtension::NotifyPeerDown (Ptr<const LdpPeer> peer)
+{
+}
+
 } // namespace ldp
 } // namespace ns3
@@ -41,6 +41,14 @@ public:
   virtual ~LdpExtension();
 
   virtual bool ReceiveMessage (Ptr<LdpPeer> peer, Ptr<const Message> message, uint32_t &errno) = 0;
+  /**
+   * \param peer ldp session which has just reached the operational state
+   */
+  virtual void NotifyPeerUp (Ptr<LdpPeer> peer);
+  /**
+   * \param peer ldp session which has been closed
+   */
+  virtual void NotifyPeerDown (Ptr<const LdpPeer> peer);
 
 };
 
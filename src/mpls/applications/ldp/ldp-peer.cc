@@ -375,6 +375,12 @@ LdpPeer::SetCloseCallback (CloseCallback cb)
   m_closeCallback = cb;
 }
 
+void
+LdpPeer::SetOperationalCallback (OperationalCallback cb)
+{
+  m_operationalCallback = cb;
+}
+
 /*void
 LdpPeer::SetErrorCallback (ErrorCallback cb)
 {
@@ -625,10 +631,23 @@ LdpPeer::HandleOpenRecStateMessages (Ptr<const Message> message)
     }
 
   m_sendKeepAliveTimeoutEvent = Simulator::Schedule (Seconds(m_sendKeepAliveTime), &LdpPeer::SendKeepAliveMessage, this);
-  m_state = OPERATIONAL_STATE;
+  EnterOperationalState ();
   return 0;
 }
 
+void
+LdpPeer::EnterOperationalState (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  m_state = OPERATIONAL_STATE;
+
+  if (!m_operationalCallback.IsNull ())
+    {
+      m_operationalCallback (this);
+    }
+}
+
 uint32_t
 LdpPeer::HandleOpenSentStateMessages (Ptr<const Message> message)
 {
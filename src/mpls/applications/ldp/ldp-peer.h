@@ -146,6 +146,7 @@ public:
 
   typedef Callback<void, Ptr<LdpPeer>, Ptr<const Message> > MessageCallback;
   typedef Callback<void, Ptr<const LdpPeer> > CloseCallback;
+  typedef Callback<void, Ptr<LdpPeer> > OperationalCallback;
 
   /**
    * \param cb message callback
@@ -155,6 +156,10 @@ public:
    * \param cb peer close callback
    */
   void SetCloseCallback (CloseCallback cb);
+  /**
+   * \param cb callback invoked when the session enters the operational state
+   */
+  void SetOperationalCallback (OperationalCallback cb);
 
 private:
   typedef std::list<std::pair<uint32_t, Ptr<MplsLibEntry> > > LabelList;
@@ -196,6 +201,7 @@ private:
    * \brief close peer and
    */
   void ClosePeer (void);
+  void EnterOperationalState (void);
 
   uint32_t HandleInitializedStateMessages (Ptr<const Message> message);
   uint32_t HandleInitializationMessage (Ptr<const Message> message);
@@ -229,6 +235,7 @@ private:
 
   MessageCallback m_messageCallback;
   CloseCallback m_closeCallback;
+  OperationalCallback m_operationalCallback;
   //ErrorCallback   m_errorCallback;
 
   //friend class LdpProtocol;
@@ -456,6 +456,22 @@ LdpProtocol::HandlePeerClose (Ptr<const LdpPeer> peer)
           break;
         }
     }
+
+  for (ExtensionList::const_iterator i = m_extensions.begin (); i != m_extensions.end (); ++i)
+    {
+      (*i)->NotifyPeerDown (peer);
+    }
+}
+
+void
+LdpProtocol::HandlePeerOperational (Ptr<LdpPeer> peer)
+{
+  NS_LOG_FUNCTION (this << peer);
+
+  for (ExtensionList::const_iterator i = m_extensions.begin (); i != m_extensions.end (); ++i)
+    {
+      (*i)->NotifyPeerUp (peer);
+    }
 }
 
 Ptr<Message>
@@ -604,6 +620,7 @@ LdpProtocol::HandleHelloMessage (uint32_t ifIndex, const Ipv4Address &address, u
   peer->SetIfIndex (ifIndex);
   peer->SetCloseCallback (MakeCallback (&LdpProtocol::HandlePeerClose, this));
   peer->SetMessageCallback (MakeCallback (&LdpProtocol::HandlePeerMessage, this));
+  peer->SetOperationalCallback (MakeCallback (&LdpProtocol::HandlePeerOperational, this));
 
   if (routerId > localRouterId)
     {
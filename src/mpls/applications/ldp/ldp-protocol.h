@@ -140,6 +140,7 @@ private:
   void HandlePeerMessage (Ptr<LdpPeer> peer, Ptr<const Message> message);
   //void HandlePeerError (Ptr<const LdpPeer> session, enum PduDecodingErrno errno);
   void HandlePeerClose (Ptr<const LdpPeer> peer);
+  void HandlePeerOperational (Ptr<LdpPeer> peer);
 
   Ptr<Message> CreateHelloMessage (void) const;
   void HandleHelloRead (Ptr<Socket> socket);
@@ -0,0 +1,262 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010 Andrey Churin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Andrey Churin <aachurin@gmail.com>
+ */
+
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+#include "ns3/ipv4.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-static-routing.h"
+#include "ns3/ipv4-static-routing-helper.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/mpls-node.h"
+#include "ns3/mpls-network-configurator.h"
+
+#include "ns3/ldp-protocol.h"
+#include "ns3/ldp-downstream-unsolicited.h"
+
+namespace ns3 {
+namespace ldp {
+
+class LdpDownstreamUnsolicitedTestCase : public TestCase
+{
+public:
+  /**
+   * @brief Constructor.
+   */
+  LdpDownstreamUnsolicitedTestCase ();
+  /**
+   * @brief Destructor.
+   */
+  virtual ~LdpDownstreamUnsolicitedTestCase ();
+  /**
+   * @brief Run unit tests for this class.
+   */
+  virtual void DoRun (void);
+
+};
+
+LdpDownstreamUnsolicitedTestCase::LdpDownstreamUnsolicitedTestCase () :
+  TestCase ("Verify label binding of the downstream unsolicited distribution")
+{
+}
+
+LdpDownstreamUnsolicitedTestCase::~LdpDownstreamUnsolicitedTestCase ()
+{
+}
+
+void
+LdpDownstreamUnsolicitedTestCase::DoRun (void)
+{
+  MplsNetworkConfigurator network;
+  NodeContainer nodes = network.CreateAndInstall (2);
+
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  NetDeviceContainer devices;
+  for (uint32_t i = 0; i < nodes.GetN (); ++i)
+    {
+      Ptr<SimpleNetDevice> dev = CreateObject<SimpleNetDevice> ();
+      dev->SetAddress (Mac48Address::Allocate ());
+      dev->SetChannel (channel);
+      nodes.Get (i)->AddDevice (dev);
+      devices.Add (dev);
+    }
+
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.0");
+  address.Assign (devices);
+
+  network.DiscoverNetwork ();
+
+  Ptr<MplsNode> node = DynamicCast<MplsNode> (nodes.Get (0));
+  Ptr<Ipv4StaticRouting> routing = Ipv4StaticRoutingHelper ().GetStaticRouting (node->GetObject<Ipv4> ());
+  routing->AddNetworkRouteTo (Ipv4Address ("10.2.0.0"), Ipv4Mask ("255.255.0.0"), Ipv4Address ("10.1.1.2"), 1);
+
+  Ptr<LdpDownstreamUnsolicited> ldp = CreateObject<LdpDownstreamUnsolicited> ();
+  node->AggregateObject (ldp);
+  ldp->Update ();
+
+  // 10.1.1.1/32 and 10.1.1.0/24 are connected, 10.2.0.0/16 is routed via the neighbour, 127.0.0.0/8 is skipped
+  NS_TEST_ASSERT_MSG_EQ (ldp->GetNFecs (), 3, "Every routed prefix but loopback should be bound to a label");
+  NS_TEST_ASSERT_MSG_EQ (ldp->GetNRemoteBindings (), 0, "No mapping has been received yet");
+  NS_TEST_ASSERT_MSG_EQ (node->GetIlmTable ()->size (), 0, "Nothing is installed without a downstream mapping");
+  NS_TEST_ASSERT_MSG_EQ (node->GetFtnTable ()->size (), 0, "Nothing is installed without a downstream mapping");
+
+  for (uint32_t i = 0; i < routing->GetNRoutes (); ++i)
+    {
+      if (routing->GetRoute (i).GetDest () == Ipv4Address ("10.2.0.0"))
+        {
+          routing->RemoveRoute (i);
+          break;
+        }
+    }
+
+  ldp->Update ();
+
+  NS_TEST_ASSERT_MSG_EQ (ldp->GetNFecs (), 2, "Label of the removed prefix should be withdrawn");
+
+  Simulator::Destroy ();
+}
+
+class LdpLabelExchangeTestCase : public TestCase
+{
+public:
+  /**
+   * @brief Constructor.
+   */
+  LdpLabelExchangeTestCase ();
+  /**
+   * @brief Destructor.
+   */
+  virtual ~LdpLabelExchangeTestCase ();
+  /**
+   * @brief Run unit tests for this class.
+   */
+  virtual void DoRun (void);
+
+private:
+  /**
+   * @brief Build a chain of three LSRs, the last one is the egress of 10.2.1.0/24.
+   * @param mode label retention mode of every LSR
+   * @returns chain nodes
+   */
+  NodeContainer CreateChain (LdpDownstreamUnsolicited::RetentionMode mode);
+  /**
+   * @param nodes nodes of a channel
+   * @param network network address of a channel
+   * @returns devices attached to the channel
+   */
+  NetDeviceContainer Connect (const NodeContainer &nodes, const char *network);
+};
+
+LdpLabelExchangeTestCase::LdpLabelExchangeTestCase () :
+  TestCase ("Verify label mappings exchanged between LSRs and label retention modes")
+{
+}
+
+LdpLabelExchangeTestCase::~LdpLabelExchangeTestCase ()
+{
+}
+
+NetDeviceContainer
+LdpLabelExchangeTestCase::Connect (const NodeContainer &nodes, const char *network)
+{
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  NetDeviceContainer devices;
+  for (uint32_t i = 0; i < nodes.GetN (); ++i)
+    {
+      Ptr<SimpleNetDevice> dev = CreateObject<SimpleNetDevice> ();
+      dev->SetAddress (Mac48Address::Allocate ());
+      dev->SetChannel (channel);
+      nodes.Get (i)->AddDevice (dev);
+      devices.Add (dev);
+    }
+
+  Ipv4AddressHelper address;
+  address.SetBase (network, "255.255.255.0");
+  address.Assign (devices);
+
+  return devices;
+}
+
+NodeContainer
+LdpLabelExchangeTestCase::CreateChain (LdpDownstreamUnsolicited::RetentionMode mode)
+{
+  MplsNetworkConfigurator network;
+  NodeContainer nodes = network.CreateAndInstall (3);
+
+  // node 0 -- 10.1.1.0/24 -- node 1 -- 10.1.2.0/24 -- node 2 -- 10.2.1.0/24
+  Connect (NodeContainer (nodes.Get (0), nodes.Get (1)), "10.1.1.0");
+  Connect (NodeContainer (nodes.Get (1), nodes.Get (2)), "10.1.2.0");
+  Connect (NodeContainer (nodes.Get (2)), "10.2.1.0");
+
+  network.DiscoverNetwork ();
+
+  Ipv4StaticRoutingHelper helper;
+  helper.GetStaticRouting (nodes.Get (0)->GetObject<Ipv4> ())->AddNetworkRouteTo (
+    Ipv4Address ("10.2.1.0"), Ipv4Mask ("255.255.255.0"), Ipv4Address ("10.1.1.2"), 1);
+  helper.GetStaticRouting (nodes.Get (1)->GetObject<Ipv4> ())->AddNetworkRouteTo (
+    Ipv4Address ("10.2.1.0"), Ipv4Mask ("255.255.255.0"), Ipv4Address ("10.1.2.2"), 2);
+
+  for (uint32_t i = 0; i < nodes.GetN (); ++i)
+    {
+      Ptr<LdpDownstreamUnsolicited> ldp = CreateObject<LdpDownstreamUnsolicited> ();
+      ldp->SetRetentionMode (mode);
+      nodes.Get (i)->AggregateObject (CreateObject<LdpProtocol> ());
+      nodes.Get (i)->AggregateObject (ldp);
+    }
+
+  return nodes;
+}
+
+void
+LdpLabelExchangeTestCase::DoRun (void)
+{
+  NodeContainer nodes = CreateChain (LdpDownstreamUnsolicited::LIBERAL);
+
+  Simulator::Stop (Seconds (10));
+  Simulator::Run ();
+
+  Ptr<MplsNode> ingress = DynamicCast<MplsNode> (nodes.Get (0));
+  Ptr<MplsNode> transit = DynamicCast<MplsNode> (nodes.Get (1));
+
+  // 10.2.1.0/24 is the only prefix the ingress and the transit LSR do not terminate
+  NS_TEST_ASSERT_MSG_EQ (ingress->GetIlmTable ()->size (), 1, "Ingress should swap to the label of the transit LSR");
+  NS_TEST_ASSERT_MSG_EQ (ingress->GetFtnTable ()->size (), 1, "Ingress should push the label of the transit LSR");
+  NS_TEST_ASSERT_MSG_EQ (transit->GetIlmTable ()->size (), 1, "Transit LSR should pop towards the egress");
+  NS_TEST_ASSERT_MSG_EQ (transit->GetFtnTable ()->size (), 0, "Egress advertises implicit null, nothing to push");
+
+  uint32_t liberal = transit->GetObject<LdpDownstreamUnsolicited> ()->GetNRemoteBindings ();
+
+  Simulator::Destroy ();
+
+  nodes = CreateChain (LdpDownstreamUnsolicited::CONSERVATIVE);
+
+  Simulator::Stop (Seconds (10));
+  Simulator::Run ();
+
+  ingress = DynamicCast<MplsNode> (nodes.Get (0));
+  transit = DynamicCast<MplsNode> (nodes.Get (1));
+
+  NS_TEST_ASSERT_MSG_EQ (ingress->GetFtnTable ()->size (), 1, "Conservative retention should keep next-hop mappings");
+  NS_TEST_ASSERT_MSG_EQ (transit->GetIlmTable ()->size (), 1, "Conservative retention should keep next-hop mappings");
+
+  // only the mapping of 10.2.1.0/24 received from the egress is retained
+  uint32_t conservative = transit->GetObject<LdpDownstreamUnsolicited> ()->GetNRemoteBindings ();
+  NS_TEST_ASSERT_MSG_EQ (conservative, 1, "Conservative retention should release mappings of other peers");
+  NS_TEST_ASSERT_MSG_GT (liberal, conservative, "Liberal retention should keep mappings of every peer");
+
+  Simulator::Destroy ();
+}
+
+static class LdpTestSuite : public TestSuite
+{
+public:
+  LdpTestSuite () :
+    TestSuite ("ldp", UNIT)
+  {
+    AddTestCase (new LdpDownstreamUnsolicitedTestCase ());
+    AddTestCase (new LdpLabelExchangeTestCase ());
+  }
+} g_ldpTestSuite;
+
+} // namespace ldp
+} // namespace ns3
@@ -0,0 +1,197 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010 Andrey Churin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Andrey Churin <aachurin@gmail.com>
+ */
+
+// Fast reroute with a facility backup (RFC 4090).
+//
+//                          r3
+//                   10.1.5 /  \ 10.1.6
+//                         /    \
+//   h0 ---- r0 ----------- r1 ----------- r2 ---- h1
+//   192.168.1   10.1.1          10.1.3      192.168.4
+//
+// The LSP h0 -> h1 follows r0 -> r1 -> r2. Link r0-r1 is protected at r0 by a bypass tunnel
+// r0 -> r3 -> r1 (label 300, popped by r3). The link fails every few seconds: from the failure
+// on every packet sent to it is lost, after the failure is detected (--detect) r0 disables its
+// interface and switches to the bypass. The link is repaired a second later. Switchover time and
+// packet loss are reported per failure event.
+//
+// Usage: frr-example [--failures=N] [--detect=ms]
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/mpls-module.h"
+
+#include <iostream>
+#include <vector>
+
+using namespace ns3;
+using namespace mpls;
+
+static Ptr<RateErrorModel> g_linkFailure;
+static std::vector<Time> g_failTimes;
+static std::vector<uint32_t> g_lost;
+
+static void
+LinkDrop (Ptr<const Packet> packet)
+{
+  if (!g_lost.empty ())
+    {
+      ++g_lost.back ();
+    }
+}
+
+static void
+FailLink (void)
+{
+  g_linkFailure->Enable ();
+  g_failTimes.push_back (Simulator::Now ());
+  g_lost.push_back (0);
+}
+
+static void
+RepairLink (Ptr<Interface> interface)
+{
+  g_linkFailure->Disable ();
+  interface->SetUp ();
+}
+
+static Ptr<Interface>
+GetMplsInterface (Ptr<NetDevice> device)
+{
+  return device->GetNode ()->GetObject<Mpls> ()->GetInterfaceForDevice (device);
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t failures = 3;
+  uint32_t detect = 10;
+
+  CommandLine cmd;
+  cmd.AddValue ("failures", "Number of link failures", failures);
+  cmd.AddValue ("detect", "Failure detection time (ms)", detect);
+  cmd.Parse (argc, argv);
+
+  NodeContainer hosts;
+  NodeContainer routers;
+
+  PointToPointHelper pointToPoint;
+  Ipv4AddressHelper address;
+  NetDeviceContainer devices;
+  InternetStackHelper internet;
+  MplsNetworkConfigurator network;
+
+  hosts.Create (2);
+  internet.Install (hosts);
+  routers = network.CreateAndInstall (4);
+
+  pointToPoint.SetDeviceAttribute ("DataRate", StringValue ("100Mbps"));
+  pointToPoint.SetChannelAttribute ("Delay", StringValue ("1ms"));
+
+  devices = pointToPoint.Install (hosts.Get (0), routers.Get (0));
+  address.SetBase ("192.168.1.0", "255.255.255.0");
+  address.Assign (devices);
+
+  devices = pointToPoint.Install (routers.Get (2), hosts.Get (1));
+  address.SetBase ("192.168.4.0", "255.255.255.0");
+  address.Assign (devices);
+
+  NetDeviceContainer protectedLink = pointToPoint.Install (routers.Get (0), routers.Get (1));
+  address.SetBase ("10.1.1.0", "255.255.255.0");
+  address.Assign (protectedLink);
+
+  devices = pointToPoint.Install (routers.Get (1), routers.Get (2));
+  address.SetBase ("10.1.3.0", "255.255.255.0");
+  address.Assign (devices);
+
+  NetDeviceContainer bypassLink = pointToPoint.Install (routers.Get (0), routers.Get (3));
+  address.SetBase ("10.1.5.0", "255.255.255.0");
+  address.Assign (bypassLink);
+
+  devices = pointToPoint.Install (routers.Get (3), routers.Get (1));
+  address.SetBase ("10.1.6.0", "255.255.255.0");
+  address.Assign (devices);
+
+  // the failure is seen by r1 as corrupted frames
+  g_linkFailure = CreateObject<RateErrorModel> ();
+  g_linkFailure->SetAttribute ("ErrorRate", DoubleValue (1.0));
+  g_linkFailure->Disable ();
+  protectedLink.Get (1)->SetAttribute ("ReceiveErrorModel", PointerValue (g_linkFailure));
+  protectedLink.Get (1)->TraceConnectWithoutContext ("PhyRxDrop", MakeCallback (&LinkDrop));
+
+  MplsSwitch sw0 (routers.Get (0));
+  MplsSwitch sw1 (routers.Get (1));
+  MplsSwitch sw2 (routers.Get (2));
+  MplsSwitch sw3 (routers.Get (3));
+
+  sw0.AddFtn (Ipv4Destination ("192.168.4.2"), Nhlfe (Swap (100), Ipv4Address ("10.1.1.2")));
+  sw1.AddIlm (100, Nhlfe (Swap (200), Ipv4Address ("10.1.3.2")));
+  sw2.AddIlm (200, Nhlfe (Pop ()));
+  sw3.AddIlm (300, Nhlfe (Pop (), Ipv4Address ("10.1.6.2")));
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  network.DiscoverNetwork ();
+
+  Ptr<Interface> protectedIf = GetMplsInterface (protectedLink.Get (0));
+  Ptr<Interface> bypassIf = GetMplsInterface (bypassLink.Get (0));
+  const Ptr<FastReroute> &frr = sw0.GetNode ()->GetFastReroute ();
+  frr->AddBypass (protectedIf->GetIfIndex (), Ipv4Address ("10.1.1.2"),
+                  Nhlfe (Swap (300), bypassIf->GetIfIndex (), Ipv4Address ("10.1.5.2")));
+
+  uint16_t port = 9;
+  UdpServerHelper server (port);
+  ApplicationContainer apps = server.Install (hosts.Get (1));
+  apps.Start (Seconds (0.5));
+  apps.Stop (Seconds (2.0 * failures + 3.0));
+
+  UdpClientHelper client (Ipv4Address ("192.168.4.2"), port);
+  client.SetAttribute ("MaxPackets", UintegerValue (0xffffffff));
+  client.SetAttribute ("Interval", TimeValue (MilliSeconds (1)));
+  client.SetAttribute ("PacketSize", UintegerValue (512));
+  apps = client.Install (hosts.Get (0));
+  apps.Start (Seconds (1.0));
+  apps.Stop (Seconds (2.0 * failures + 2.0));
+
+  for (uint32_t i = 0; i < failures; ++i)
+    {
+      Time failure = Seconds (2.0 * i + 1.5);
+      Simulator::Schedule (failure, &FailLink);
+      Simulator::Schedule (failure + MilliSeconds (detect), &Interface::SetDown, protectedIf);
+      Simulator::Schedule (failure + Seconds (1.0), &RepairLink, protectedIf);
+    }
+
+  Simulator::Run ();
+
+  for (uint32_t i = 0; i < frr->GetNEvents (); ++i)
+    {
+      const FastReroute::Event &event = frr->GetEvent (i);
+      std::cout << "failure " << i << ": at " << g_failTimes[i].GetSeconds () << " s, switchover after "
+                << (event.time - g_failTimes[i]).GetMilliSeconds () << " ms, "
+                << event.adjacencies << " adjacencies, " << g_lost[i] << " packets lost" << std::endl;
+    }
+  std::cout << "received " << server.GetServer ()->GetReceived () << " packets" << std::endl;
+
+  Simulator::Destroy ();
+  return 0;
+}
@@ -0,0 +1,116 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010 Andrey Churin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Andrey Churin <aachurin@gmail.com>
+ */
+
+// Compares memory used by a large ILM table with NHLFEs kept by every entry, with NHLFEs
+// interned in the node NHLFE pool and with the flat label forwarding table. Every ILM pops the
+// label and sends the packet to one of the neighbors (penultimate hop popping), so the entries
+// share a few distinct NHLFEs.
+//
+// Usage: lfib-memory [--entries=N] [--neighbors=N]
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/mpls-module.h"
+
+#include <iostream>
+#include <vector>
+
+using namespace ns3;
+using namespace mpls;
+
+static uint64_t
+GetIlmTableMemoryUsage (const Ptr<MplsNode> &node)
+{
+  MplsNode::IlmTable *table = node->GetIlmTable ();
+  // list node: two links and the pointer to the entry
+  uint64_t size = table->size () * (2 * sizeof (void*) + sizeof (Ptr<IncomingLabelMap>));
+
+  for (MplsNode::IlmTable::const_iterator i = table->begin (); i != table->end (); ++i)
+    {
+      size += (*i)->GetMemoryUsage ();
+    }
+
+  return size + node->GetNhlfePool ()->GetMemoryUsage () + node->GetFlatLfib ()->GetMemoryUsage ();
+}
+
+static void
+Report (const std::string &title, const Ptr<MplsNode> &node, uint32_t entries)
+{
+  uint64_t size = GetIlmTableMemoryUsage (node);
+  std::cout << title << ": " << size << " bytes, " << double (size) / entries << " bytes per entry, "
+            << node->GetNhlfePool ()->GetN () << " pooled NHLFEs" << std::endl;
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t entries = 1000000;
+  uint32_t neighbors = 16;
+
+  CommandLine cmd;
+  cmd.AddValue ("entries", "Number of ILMs", entries);
+  cmd.AddValue ("neighbors", "Number of distinct next-hops", neighbors);
+  cmd.Parse (argc, argv);
+
+  MplsInstaller installer;
+  NodeContainer nodes = installer.CreateAndInstall (3);
+
+  std::vector<Nhlfe> nhlfes;
+  for (uint32_t i = 0; i < neighbors; ++i)
+    {
+      nhlfes.push_back (Nhlfe (Pop (), Ipv4Address (0x0a000001 + i)));
+    }
+
+  // every entry keeps its own NHLFEs
+  MplsSwitch plain (nodes.Get (0));
+  for (uint32_t i = 0; i < entries; ++i)
+    {
+      plain.AddIlm (16 + i, nhlfes[i % neighbors]);
+    }
+  Report ("NHLFEs kept by the entries", plain.GetNode (), entries);
+
+  // entries keep NHLFE ids
+  MplsSwitch pooled (nodes.Get (1));
+  MplsSwitch::NhlfeGroupVector groups;
+  for (uint32_t i = 0; i < neighbors; ++i)
+    {
+      groups.push_back (MplsSwitch::NhlfeGroup (1, nhlfes[i]));
+    }
+
+  std::vector<MplsIlmHelper::IlmEntry> ilms;
+  ilms.reserve (entries);
+  for (uint32_t i = 0; i < entries; ++i)
+    {
+      ilms.push_back (MplsIlmHelper::IlmEntry (-1, 16 + i, i % neighbors));
+    }
+  pooled.AddIlms (ilms.begin (), ilms.end (), groups);
+  Report ("NHLFEs interned in the pool", pooled.GetNode (), entries);
+
+  // label indexed arrays
+  MplsSwitch flat (nodes.Get (2));
+  MplsSwitch::PolicyVector policies (1, flat.GetSelectionPolicy ().Create ());
+  flat.GetNode ()->GetFlatLfib ()->Reserve (16 + entries - 1);
+  flat.AddFlatIlms (ilms.begin (), ilms.end (), groups, policies);
+  Report ("Flat label forwarding table", flat.GetNode (), entries);
+
+  Simulator::Destroy ();
+  return 0;
+}
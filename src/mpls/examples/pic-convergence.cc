@@ -0,0 +1,119 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010 Andrey Churin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Andrey Churin <aachurin@gmail.com>
+ */
+
+// Measures convergence time after a next-hop failure on a node with many LSPs. Every ILM pops the
+// label and load-balances over two of the neighbors (penultimate hop popping). When a neighbor
+// fails, ILMs keeping own NHLFEs are edited one by one, while ILMs referencing shared NHLFE groups
+// are repaired by updating the few groups that contain the failed next-hop.
+//
+// Usage: pic-convergence [--entries=N] [--neighbors=N]
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/mpls-module.h"
+#include "ns3/system-wall-clock-ms.h"
+
+#include <iostream>
+#include <vector>
+
+using namespace ns3;
+using namespace mpls;
+
+static void
+Report (const std::string &title, uint32_t updated, int64_t elapsed)
+{
+  std::cout << title << ": " << updated << " updated, " << elapsed << " ms" << std::endl;
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t entries = 100000;
+  uint32_t neighbors = 8;
+
+  CommandLine cmd;
+  cmd.AddValue ("entries", "Number of ILMs", entries);
+  cmd.AddValue ("neighbors", "Number of distinct next-hops", neighbors);
+  cmd.Parse (argc, argv);
+
+  MplsInstaller installer;
+  NodeContainer nodes = installer.CreateAndInstall (2);
+
+  std::vector<Nhlfe> nhlfes;
+  for (uint32_t i = 0; i < neighbors; ++i)
+    {
+      nhlfes.push_back (Nhlfe (Pop (), Ipv4Address (0x0a000001 + i)));
+    }
+  Address failed = Ipv4Address (0x0a000001);
+
+  // every entry keeps its own NHLFEs
+  MplsSwitch plain (nodes.Get (0));
+  for (uint32_t i = 0; i < entries; ++i)
+    {
+      plain.AddIlm (16 + i, nhlfes[i % neighbors], nhlfes[(i + 1) % neighbors]);
+    }
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  uint32_t updated = 0;
+  MplsNode::IlmTable *table = plain.GetNode ()->GetIlmTable ();
+  for (MplsNode::IlmTable::iterator i = table->begin (); i != table->end (); ++i)
+    {
+      for (uint32_t j = (*i)->GetNNhlfe (); j-- > 0; )
+        {
+          if ((*i)->GetNhlfe (j).GetNextHop () == failed)
+            {
+              (*i)->RemoveNhlfe (j);
+              ++updated;
+            }
+        }
+    }
+  Report ("NHLFEs kept by the entries", updated, clock.End ());
+
+  // entries reference shared groups
+  MplsSwitch shared (nodes.Get (1));
+  std::vector<Ptr<NextHopGroup> > groups;
+  for (uint32_t i = 0; i < neighbors; ++i)
+    {
+      Ptr<NextHopGroup> group = Create<NextHopGroup> ();
+      group->AddNhlfe (nhlfes[i]);
+      group->AddNhlfe (nhlfes[(i + 1) % neighbors]);
+      groups.push_back (group);
+    }
+  for (uint32_t i = 0; i < entries; ++i)
+    {
+      shared.AddIlm (16 + i, groups[i % neighbors]);
+    }
+
+  clock.Start ();
+  updated = 0;
+  for (std::vector<Ptr<NextHopGroup> >::iterator i = groups.begin (); i != groups.end (); ++i)
+    {
+      if ((*i)->RemoveNextHop (-1, failed) != 0)
+        {
+          ++updated;
+        }
+    }
+  Report ("Shared NHLFE groups", updated, clock.End ());
+
+  Simulator::Destroy ();
+  return 0;
+}
@@ -0,0 +1,277 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010 Andrey Churin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Andrey Churin <aachurin@gmail.com>
+ */
+
+// Measures label stack overhead of strict segment routing paths with and without binding SIDs on
+// a grid of routers. Every demand follows the shortest path computed by CSPF, encoded as a list
+// of adjacency segments. Without binding SIDs the ingress pushes the whole list. With binding SIDs
+// the path is split into chunks of --chunk hops, every chunk after the first one is a binding
+// segment installed on its first node, which pushes the chunk and the binding segment of the next
+// chunk. Packets are walked through the installed ILMs hop by hop, every hop serializes and
+// parses the label stack. Reported are the label bytes carried per hop, the stack depth and the
+// time spent on the label stack headers of one packet along all the paths.
+//
+// Usage: sr-binding-sid [--rows=N] [--cols=N] [--demands=N] [--chunk=N] [--rounds=N]
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/mpls-module.h"
+#include "ns3/system-wall-clock-ms.h"
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+using namespace ns3;
+using namespace mpls;
+
+typedef MplsSegmentRoutingHelper::Segment Segment;
+typedef MplsSegmentRoutingHelper::SegmentList SegmentList;
+
+// applies the compiled operation of the NHLFE to the stack (top at the back) as MplsProtocol does,
+// returns true if the pushed labels are resolved by the same node (binding SID)
+static bool
+Apply (const Nhlfe &nhlfe, std::vector<uint32_t> &stack)
+{
+  stack.resize (stack.size () - std::min<uint32_t> (nhlfe.GetNPop (), stack.size ()));
+  for (uint32_t i = 0; i < nhlfe.GetNShims (); ++i)
+    {
+      stack.push_back (shim::GetLabel (nhlfe.GetShims ()[i]));
+    }
+
+  return nhlfe.GetOpCode () == OP_PUSH && nhlfe.GetInterface () < 0 && nhlfe.GetNextHop ().IsInvalid ();
+}
+
+// forwards the labeled packet of the demand through the ILMs, appends the stack carried over
+// every hop, returns false if the packet is dropped
+static bool
+Walk (Ptr<const MplsTopology> topology, uint32_t node, Nhlfe nhlfe, std::vector<std::vector<uint32_t> > &hops)
+{
+  std::vector<uint32_t> stack;
+
+  for (uint32_t ttl = 255; ttl > 0; --ttl)
+    {
+      while (Apply (nhlfe, stack))
+        {
+          Ptr<IncomingLabelMap> ilm = topology->GetNode (node)->LookupIlm (Label (stack.back ()), -1);
+          if (ilm == 0)
+            {
+              return false;
+            }
+          nhlfe = ilm->GetNhlfe (0);
+        }
+
+      if (stack.empty ())
+        {
+          // popped by the penultimate hop
+          return true;
+        }
+
+      uint32_t l = topology->GetOutBegin (node);
+      while (l < topology->GetOutEnd (node) && int32_t (topology->GetLink (l).localIf) != nhlfe.GetInterface ())
+        {
+          ++l;
+        }
+      if (l == topology->GetOutEnd (node))
+        {
+          return false;
+        }
+
+      hops.push_back (stack);
+      node = topology->GetLink (l).to;
+
+      Ptr<IncomingLabelMap> ilm = topology->GetNode (node)->LookupIlm (Label (stack.back ()), -1);
+      if (ilm == 0)
+        {
+          return false;
+        }
+      nhlfe = ilm->GetNhlfe (0);
+    }
+
+  return false;
+}
+
+static void
+Report (const std::string &title, Ptr<const MplsTopology> topology, const std::vector<uint32_t> &ingresses,
+        const std::vector<Nhlfe> &nhlfes, uint32_t rounds)
+{
+  std::vector<std::vector<uint32_t> > hops;
+  uint32_t dropped = 0;
+  for (uint32_t i = 0; i < nhlfes.size (); ++i)
+    {
+      if (!Walk (topology, ingresses[i], nhlfes[i], hops))
+        {
+          ++dropped;
+        }
+    }
+
+  uint64_t bytes = 0;
+  uint32_t maxDepth = 0;
+  std::vector<LabelStack> stacks (hops.size ());
+  for (uint32_t i = 0; i < hops.size (); ++i)
+    {
+      for (uint32_t j = 0; j < hops[i].size (); ++j)
+        {
+          stacks[i].Push (shim::Get (hops[i][j]));
+        }
+      bytes += stacks[i].GetSerializedSize ();
+      maxDepth = std::max (maxDepth, uint32_t (hops[i].size ()));
+    }
+
+  // every hop adds the label stack header to the packet and the next hop parses it
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (uint32_t r = 0; r < rounds; ++r)
+    {
+      for (std::vector<LabelStack>::const_iterator i = stacks.begin (); i != stacks.end (); ++i)
+        {
+          Ptr<Packet> packet = Create<Packet> (64);
+          packet->AddHeader (*i);
+          LabelStack stack;
+          packet->RemoveHeader (stack);
+        }
+    }
+  int64_t elapsed = clock.End ();
+
+  std::cout << title << ": " << hops.size () << " hops, " << dropped << " dropped" << std::endl;
+  std::cout << "  label bytes per hop: average " << double (bytes) / hops.size () << ", max " << maxDepth * 4
+            << ", total per packet along all paths " << bytes << std::endl;
+  std::cout << "  label stack headers: " << elapsed << " ms for " << rounds << " rounds" << std::endl;
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t rows = 16;
+  uint32_t cols = 16;
+  uint32_t demands = 1000;
+  uint32_t chunk = 4;
+  uint32_t rounds = 100;
+
+  CommandLine cmd;
+  cmd.AddValue ("rows", "Number of grid rows", rows);
+  cmd.AddValue ("cols", "Number of grid columns", cols);
+  cmd.AddValue ("demands", "Number of demands of the traffic matrix", demands);
+  cmd.AddValue ("chunk", "Number of hops covered by one binding segment", chunk);
+  cmd.AddValue ("rounds", "Number of packets sent along every path for the timing", rounds);
+  cmd.Parse (argc, argv);
+
+  chunk = std::max (chunk, 1u);
+
+  MplsNetworkConfigurator network;
+  NodeContainer routers = network.CreateAndInstall (rows * cols);
+
+  PointToPointHelper pointToPoint;
+  Ipv4AddressHelper address ("10.0.0.0", "255.255.255.252");
+
+  for (uint32_t i = 0; i < rows; ++i)
+    {
+      for (uint32_t j = 0; j < cols; ++j)
+        {
+          if (j + 1 < cols)
+            {
+              address.Assign (pointToPoint.Install (routers.Get (i * cols + j), routers.Get (i * cols + j + 1)));
+              address.NewNetwork ();
+            }
+          if (i + 1 < rows)
+            {
+              address.Assign (pointToPoint.Install (routers.Get (i * cols + j), routers.Get ((i + 1) * cols + j)));
+              address.NewNetwork ();
+            }
+        }
+    }
+
+  network.DiscoverNetwork ();
+  Ptr<const MplsTopology> topology = network.GetTopology ();
+
+  // traffic matrix: pseudo-random pairs of distinct routers, paths computed by CSPF
+  MplsCspfHelper cspf;
+  cspf.BuildGraph (network);
+
+  std::vector<uint32_t> ingresses;
+  std::vector<MplsCspfHelper::Path> paths;
+  uint32_t seed = 1;
+  while (paths.size () < demands)
+    {
+      seed = seed * 1103515245 + 12345;
+      uint32_t from = (seed >> 8) % routers.GetN ();
+      seed = seed * 1103515245 + 12345;
+      uint32_t to = (seed >> 8) % routers.GetN ();
+
+      MplsCspfHelper::Path path;
+      if (from != to && cspf.ComputePath (routers.Get (from), routers.Get (to), MplsCspfHelper::Constraints (), path))
+        {
+          ingresses.push_back (topology->GetNodeIndex (routers.Get (from)));
+          paths.push_back (path);
+        }
+    }
+
+  MplsSegmentRoutingHelper sr;
+  sr.Install (network);
+
+  // the whole path pushed at the ingress
+  std::vector<Nhlfe> nhlfes;
+  for (uint32_t i = 0; i < paths.size (); ++i)
+    {
+      SegmentList segments;
+      for (MplsCspfHelper::Path::const_iterator j = paths[i].begin (); j != paths[i].end (); ++j)
+        {
+          segments.push_back (Segment (topology->GetLocalInterface (*j)));
+        }
+      nhlfes.push_back (sr.GetNhlfe (topology->GetNode (ingresses[i]), segments));
+    }
+
+  uint32_t nIlm = sr.GetNIlm ();
+  Report ("adjacency segments", topology, ingresses, nhlfes, rounds);
+
+  // chunks after the first one are binding segments, installed from the tail of the path
+  nhlfes.clear ();
+  for (uint32_t i = 0; i < paths.size (); ++i)
+    {
+      const MplsCspfHelper::Path &path = paths[i];
+      SegmentList next;
+      for (uint32_t start = (path.size () - 1) / chunk * chunk; ; start -= chunk)
+        {
+          SegmentList segments;
+          for (uint32_t j = start; j < std::min (start + chunk, uint32_t (path.size ())); ++j)
+            {
+              segments.push_back (Segment (topology->GetLocalInterface (path[j])));
+            }
+          segments.insert (segments.end (), next.begin (), next.end ());
+
+          Ptr<Node> node = topology->GetNode (topology->GetLink (path[start]).from);
+          if (start == 0)
+            {
+              nhlfes.push_back (sr.GetNhlfe (node, segments));
+              break;
+            }
+
+          next.assign (1, Segment (node, sr.AddBindingSid (node, segments)));
+        }
+    }
+
+  Report ("binding segments", topology, ingresses, nhlfes, rounds);
+  std::cout << "  binding segment ILM entries: " << sr.GetNIlm () - nIlm << std::endl;
+
+  Simulator::Destroy ();
+
+  return 0;
+}
@@ -0,0 +1,171 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010 Andrey Churin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Andrey Churin <aachurin@gmail.com>
+ */
+
+// Compares label forwarding state of segment routing with per-LSP signaling for one traffic
+// matrix on a grid of routers. Every demand follows the shortest path computed by CSPF. With
+// segment routing the path is pushed at the ingress as a strict list of adjacency segments (a deep
+// label stack), transit routers only keep node and adjacency segments. With per-LSP signaling
+// (MplsTunnelHelper) every transit router of every LSP keeps one ILM entry.
+//
+// Usage: sr-memory [--rows=N] [--cols=N] [--demands=N]
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/mpls-module.h"
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+using namespace ns3;
+using namespace mpls;
+
+static uint64_t
+GetIlmMemoryUsage (const NodeContainer &nodes, uint32_t &entries)
+{
+  uint64_t size = 0;
+  entries = 0;
+  for (NodeContainer::Iterator i = nodes.Begin (); i != nodes.End (); ++i)
+    {
+      MplsNode::IlmTable *table = DynamicCast<MplsNode> (*i)->GetIlmTable ();
+      // list node: two links and the pointer to the entry
+      size += table->size () * (2 * sizeof (void*) + sizeof (Ptr<IncomingLabelMap>));
+      for (MplsNode::IlmTable::const_iterator j = table->begin (); j != table->end (); ++j)
+        {
+          size += (*j)->GetMemoryUsage ();
+        }
+      entries += table->size ();
+    }
+  return size;
+}
+
+static void
+Report (const std::string &title, const NodeContainer &nodes)
+{
+  uint32_t entries;
+  uint64_t size = GetIlmMemoryUsage (nodes, entries);
+  std::cout << title << ": " << entries << " ILM entries, " << size << " bytes" << std::endl;
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t rows = 10;
+  uint32_t cols = 10;
+  uint32_t demands = 2000;
+
+  CommandLine cmd;
+  cmd.AddValue ("rows", "Number of grid rows", rows);
+  cmd.AddValue ("cols", "Number of grid columns", cols);
+  cmd.AddValue ("demands", "Number of demands of the traffic matrix", demands);
+  cmd.Parse (argc, argv);
+
+  MplsNetworkConfigurator network;
+  NodeContainer routers = network.CreateAndInstall (rows * cols);
+
+  PointToPointHelper pointToPoint;
+  Ipv4AddressHelper address ("10.0.0.0", "255.255.255.252");
+
+  for (uint32_t i = 0; i < rows; ++i)
+    {
+      for (uint32_t j = 0; j < cols; ++j)
+        {
+          if (j + 1 < cols)
+            {
+              address.Assign (pointToPoint.Install (routers.Get (i * cols + j), routers.Get (i * cols + j + 1)));
+              address.NewNetwork ();
+            }
+          if (i + 1 < rows)
+            {
+              address.Assign (pointToPoint.Install (routers.Get (i * cols + j), routers.Get ((i + 1) * cols + j)));
+              address.NewNetwork ();
+            }
+        }
+    }
+
+  network.DiscoverNetwork ();
+  Ptr<const MplsTopology> topology = network.GetTopology ();
+
+  // traffic matrix: pseudo-random pairs of distinct routers, paths computed by CSPF
+  MplsCspfHelper cspf;
+  cspf.BuildGraph (network);
+
+  std::vector<Ptr<Node> > ingresses;
+  std::vector<MplsCspfHelper::Path> paths;
+  uint32_t seed = 1;
+  while (paths.size () < demands)
+    {
+      seed = seed * 1103515245 + 12345;
+      uint32_t from = (seed >> 8) % routers.GetN ();
+      seed = seed * 1103515245 + 12345;
+      uint32_t to = (seed >> 8) % routers.GetN ();
+
+      MplsCspfHelper::Path path;
+      if (from != to && cspf.ComputePath (routers.Get (from), routers.Get (to), MplsCspfHelper::Constraints (), path))
+        {
+          ingresses.push_back (routers.Get (from));
+          paths.push_back (path);
+        }
+    }
+
+  // segment routing
+  MplsSegmentRoutingHelper sr;
+  sr.Install (network);
+
+  uint32_t maxDepth = 0;
+  uint64_t depth = 0;
+  for (uint32_t i = 0; i < paths.size (); ++i)
+    {
+      MplsSegmentRoutingHelper::SegmentList segments;
+      for (MplsCspfHelper::Path::const_iterator j = paths[i].begin (); j != paths[i].end (); ++j)
+        {
+          segments.push_back (MplsSegmentRoutingHelper::Segment (topology->GetLocalInterface (*j)));
+        }
+
+      Ipv4Address egress = topology->GetLink (paths[i].back ()).nextHop;
+      Ptr<FecToNhlfe> ftn = sr.AddFtn (ingresses[i], Ipv4Destination (egress), segments);
+
+      uint32_t nLabels = ftn->GetNhlfe (0).GetNLabels ();
+      maxDepth = std::max (maxDepth, nLabels);
+      depth += nLabels;
+    }
+
+  Report ("segment routing", routers);
+  std::cout << "  label stack depth: average " << double (depth) / paths.size () << ", max " << maxDepth
+            << std::endl;
+
+  sr.Uninstall ();
+
+  // per-LSP signaling
+  std::vector<Lsp> lsps;
+  for (uint32_t i = 0; i < paths.size (); ++i)
+    {
+      lsps.push_back (cspf.GetLsp (paths[i]));
+    }
+  network.CreateTunnels (lsps);
+
+  Report ("per-LSP signaling", routers);
+
+  Simulator::Destroy ();
+
+  return 0;
+}
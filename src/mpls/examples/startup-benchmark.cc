@@ -0,0 +1,84 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010 Andrey Churin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Andrey Churin <aachurin@gmail.com>
+ */
+
+// Measures how fast MplsInstaller::CreateAndInstall creates mpls routers.
+//
+// Usage: startup-benchmark [--nodes=N]
+// Without --nodes 1000, 10000 and 50000 routers are created.
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/mpls-module.h"
+#include "ns3/system-wall-clock-ms.h"
+
+#include <iostream>
+#include <vector>
+
+using namespace ns3;
+
+static void
+RunBenchmark (uint32_t count)
+{
+  MplsInstaller installer;
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  NodeContainer routers = installer.CreateAndInstall (count);
+  int64_t elapsed = clock.End ();
+
+  std::cout << count << " nodes: " << elapsed << " ms";
+  if (elapsed > 0)
+    {
+      std::cout << ", " << (uint64_t (count) * 1000 / elapsed) << " nodes/s";
+    }
+  std::cout << std::endl;
+
+  Simulator::Destroy ();
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t nodes = 0;
+
+  CommandLine cmd;
+  cmd.AddValue ("nodes", "Number of routers to create (0 - run 1k, 10k and 50k)", nodes);
+  cmd.Parse (argc, argv);
+
+  std::vector<uint32_t> counts;
+  if (nodes != 0)
+    {
+      counts.push_back (nodes);
+    }
+  else
+    {
+      counts.push_back (1000);
+      counts.push_back (10000);
+      counts.push_back (50000);
+    }
+
+  for (std::vector<uint32_t>::const_iterator i = counts.begin (); i != counts.end (); ++i)
+    {
+      RunBenchmark (*i);
+    }
+
+  return 0;
+}
@@ -0,0 +1,117 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010 Andrey Churin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Andrey Churin <aachurin@gmail.com>
+ */
+
+// Computes TI-LFA repair paths for every adjacency of a grid of routers and reports coverage,
+// the deepest repair label stack and computation time, with link and with node protection.
+// LSPs between all routers are installed by MplsGlobalLabelHelper, link metrics vary from 1 to 4,
+// so both single and multi segment repairs occur.
+//
+// Usage: ti-lfa-coverage [--rows=N] [--cols=N]
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/mpls-module.h"
+
+#include <iostream>
+
+using namespace ns3;
+
+static void
+Connect (Ptr<Node> a, Ptr<Node> b, uint32_t metric, PointToPointHelper &pointToPoint, Ipv4AddressHelper &address)
+{
+  NetDeviceContainer devices = pointToPoint.Install (a, b);
+  address.Assign (devices);
+  address.NewNetwork ();
+
+  for (uint32_t i = 0; i < devices.GetN (); ++i)
+    {
+      Ptr<NetDevice> device = devices.Get (i);
+      Ptr<Ipv4> ipv4 = device->GetNode ()->GetObject<Ipv4> ();
+      ipv4->SetMetric (ipv4->GetInterfaceForDevice (device), metric);
+    }
+}
+
+static void
+Report (const std::string &title, MplsTiLfaHelper &tilfa)
+{
+  uint32_t total = tilfa.GetNProtected () + tilfa.GetNUnprotected ();
+  std::cout << title << ": " << tilfa.GetNProtected () << " of " << total << " destinations protected";
+  if (total != 0)
+    {
+      std::cout << " (" << (uint64_t (tilfa.GetNProtected ()) * 100 / total) << "%)";
+    }
+  std::cout << ", max stack depth " << tilfa.GetMaxStackDepth () << ", " << tilfa.GetComputeTime () << " ms"
+            << std::endl;
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t rows = 32;
+  uint32_t cols = 32;
+
+  CommandLine cmd;
+  cmd.AddValue ("rows", "Number of grid rows", rows);
+  cmd.AddValue ("cols", "Number of grid columns", cols);
+  cmd.Parse (argc, argv);
+
+  MplsNetworkConfigurator network;
+  NodeContainer routers = network.CreateAndInstall (rows * cols);
+
+  PointToPointHelper pointToPoint;
+  Ipv4AddressHelper address ("10.0.0.0", "255.255.255.252");
+
+  for (uint32_t i = 0; i < rows; ++i)
+    {
+      for (uint32_t j = 0; j < cols; ++j)
+        {
+          Ptr<Node> node = routers.Get (i * cols + j);
+          if (j + 1 < cols)
+            {
+              Connect (node, routers.Get (i * cols + j + 1), 1 + (i * 7 + j * 13) % 4, pointToPoint, address);
+            }
+          if (i + 1 < rows)
+            {
+              Connect (node, routers.Get ((i + 1) * cols + j), 1 + (i * 11 + j * 5) % 4, pointToPoint, address);
+            }
+        }
+    }
+
+  network.DiscoverNetwork ();
+
+  MplsGlobalLabelHelper labels;
+  labels.PopulateLabelTables (network);
+  std::cout << rows * cols << " routers, " << labels.GetNIlm () << " ILM entries installed in "
+            << labels.GetRecomputeTime () << " ms" << std::endl;
+
+  MplsTiLfaHelper tilfa;
+  tilfa.InstallBackups (network, labels);
+  Report ("link protection", tilfa);
+
+  tilfa.SetProtection (MplsTiLfaHelper::NODE_PROTECTION);
+  tilfa.InstallBackups (network, labels);
+  Report ("node protection", tilfa);
+
+  Simulator::Destroy ();
+
+  return 0;
+}
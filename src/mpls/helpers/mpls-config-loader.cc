@@ -0,0 +1,606 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010-2011 Andrey Churin, Stefano Avallone
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Andrey Churin <aachurin@gmail.com>
+ *         Stefano Avallone <stavallo@gmail.com>
+ */
+
+#include <vector>
+#include <sstream>
+#include <fstream>
+#include <cstdlib>
+
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ns3/names.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv6-address.h"
+#include "ns3/mpls.h"
+#include "ns3/mpls-fec.h"
+#include "ns3/mpls-operations.h"
+
+#include "mpls-config-loader.h"
+
+NS_LOG_COMPONENT_DEFINE ("MplsConfigLoader");
+
+#define LOADER_ERROR(line, msg) \
+  NS_FATAL_ERROR ("MplsConfigLoader: line " << line << ": " << msg)
+
+namespace ns3 {
+
+using namespace mpls;
+
+namespace {
+
+bool
+ParseUint (const std::string &token, uint32_t &value)
+{
+  if (token.empty () || token[0] < '0' || token[0] > '9')
+    {
+      return false;
+    }
+
+  char *end = 0;
+  unsigned long v = std::strtoul (token.c_str (), &end, 10);
+  if (*end != 0 || v > 0xffffffffUL)
+    {
+      return false;
+    }
+
+  value = v;
+  return true;
+}
+
+int32_t
+ParseInterface (const std::string &token, uint32_t nInterfaces, uint32_t line)
+{
+  if (token == "-")
+    {
+      return -1;
+    }
+
+  uint32_t value;
+  if (!ParseUint (token, value) || value >= nInterfaces)
+    {
+      LOADER_ERROR (line, "invalid interface index " << token);
+    }
+
+  return value;
+}
+
+void
+ParseLabels (const std::string &token, std::vector<uint32_t> &labels, uint32_t line)
+{
+  labels.clear ();
+  if (token == "-")
+    {
+      return;
+    }
+
+  std::string::size_type begin = 0;
+  while (begin <= token.size ())
+    {
+      std::string::size_type end = token.find (',', begin);
+      if (end == std::string::npos)
+        {
+          end = token.size ();
+        }
+
+      uint32_t label;
+      if (!ParseUint (token.substr (begin, end - begin), label) || label > 0xfffff)
+        {
+          LOADER_ERROR (line, "invalid label list " << token);
+        }
+      labels.push_back (label);
+      begin = end + 1;
+    }
+}
+
+void
+ParsePortRange (const std::string &value, uint16_t &minPort, uint16_t &maxPort, uint32_t line)
+{
+  std::string::size_type dash = value.find ('-');
+  uint32_t a;
+  uint32_t b;
+
+  if (dash == std::string::npos)
+    {
+      if (!ParseUint (value, a) || a > 0xffff)
+        {
+          LOADER_ERROR (line, "invalid port " << value);
+        }
+      b = a;
+    }
+  else if (!ParseUint (value.substr (0, dash), a) || !ParseUint (value.substr (dash + 1), b) ||
+           a > b || b > 0xffff)
+    {
+      LOADER_ERROR (line, "invalid port range " << value);
+    }
+
+  minPort = a;
+  maxPort = b;
+}
+
+bool
+IsIpv4Address (const std::string &token)
+{
+  uint32_t nBytes = 0;
+  std::string::size_type begin = 0;
+
+  while (begin <= token.size ())
+    {
+      std::string::size_type end = token.find ('.', begin);
+      if (end == std::string::npos)
+        {
+          end = token.size ();
+        }
+
+      uint32_t value;
+      if (end - begin > 3 || !ParseUint (token.substr (begin, end - begin), value) || value > 255)
+        {
+          return false;
+        }
+      ++nBytes;
+      begin = end + 1;
+    }
+
+  return nBytes == 4;
+}
+
+// number of colon separated groups of 1 to 4 hex digits, or -1 if the text is malformed
+int32_t
+CountIpv6Groups (const std::string &text)
+{
+  if (text.empty ())
+    {
+      return 0;
+    }
+
+  int32_t nGroups = 0;
+  std::string::size_type begin = 0;
+  while (begin <= text.size ())
+    {
+      std::string::size_type end = text.find (':', begin);
+      if (end == std::string::npos)
+        {
+          end = text.size ();
+        }
+
+      if (end == begin || end - begin > 4 || text.find_first_not_of ("0123456789abcdefABCDEF", begin) < end)
+        {
+          return -1;
+        }
+      ++nGroups;
+      begin = end + 1;
+    }
+
+  return nGroups;
+}
+
+bool
+IsIpv6Address (const std::string &token)
+{
+  std::string::size_type gap = token.find ("::");
+  if (gap == std::string::npos)
+    {
+      return CountIpv6Groups (token) == 8;
+    }
+  if (token.find ("::", gap + 1) != std::string::npos)
+    {
+      return false;
+    }
+
+  int32_t head = CountIpv6Groups (token.substr (0, gap));
+  int32_t tail = CountIpv6Groups (token.substr (gap + 2));
+  return head >= 0 && tail >= 0 && head + tail < 8;
+}
+
+template <class Single, class Range>
+Fec*
+BuildPortFec (const std::string &value, uint32_t line)
+{
+  uint16_t minPort;
+  uint16_t maxPort;
+  ParsePortRange (value, minPort, maxPort, line);
+
+  if (minPort == maxPort)
+    {
+      return Fec::Build (Single (minPort));
+    }
+  return Fec::Build (Range (minPort, maxPort));
+}
+
+template <class T>
+Fec*
+BuildIpv4Fec (const std::string &value, uint32_t line)
+{
+  std::string::size_type slash = value.find ('/');
+  uint32_t length = 32;
+
+  if (!IsIpv4Address (value.substr (0, slash)) ||
+      (slash != std::string::npos && (!ParseUint (value.substr (slash + 1), length) || length > 32)))
+    {
+      LOADER_ERROR (line, "invalid ipv4 prefix " << value);
+    }
+
+  std::ostringstream mask;
+  mask << "/" << length;
+  return Fec::Build (T (Ipv4Address (value.substr (0, slash).c_str ()), Ipv4Mask (mask.str ().c_str ())));
+}
+
+template <class T>
+Fec*
+BuildIpv6Fec (const std::string &value, uint32_t line)
+{
+  std::string::size_type slash = value.find ('/');
+  uint32_t length = 128;
+
+  if (!IsIpv6Address (value.substr (0, slash)) ||
+      (slash != std::string::npos && (!ParseUint (value.substr (slash + 1), length) || length > 128)))
+    {
+      LOADER_ERROR (line, "invalid ipv6 prefix " << value);
+    }
+
+  return Fec::Build (T (Ipv6Address (value.substr (0, slash).c_str ()), Ipv6Prefix (uint8_t (length))));
+}
+
+Fec*
+ParseTerm (const std::string &term, uint32_t line)
+{
+  if (!term.empty () && term[0] == '!')
+    {
+      return Fec::BuildNot (ParseTerm (term.substr (1), line));
+    }
+
+  std::string::size_type eq = term.find ('=');
+  if (eq == std::string::npos)
+    {
+      LOADER_ERROR (line, "invalid fec term " << term);
+    }
+
+  std::string key = term.substr (0, eq);
+  std::string value = term.substr (eq + 1);
+
+  if (key == "src")
+    {
+      return BuildIpv4Fec<Ipv4Source> (value, line);
+    }
+  if (key == "dst")
+    {
+      return BuildIpv4Fec<Ipv4Destination> (value, line);
+    }
+  if (key == "src6")
+    {
+      return BuildIpv6Fec<Ipv6Source> (value, line);
+    }
+  if (key == "dst6")
+    {
+      return BuildIpv6Fec<Ipv6Destination> (value, line);
+    }
+  if (key == "udp-src")
+    {
+      return BuildPortFec<UdpSourcePort, UdpSourcePortRange> (value, line);
+    }
+  if (key == "udp-dst")
+    {
+      return BuildPortFec<UdpDestinationPort, UdpDestinationPortRange> (value, line);
+    }
+  if (key == "tcp-src")
+    {
+      return BuildPortFec<TcpSourcePort, TcpSourcePortRange> (value, line);
+    }
+  if (key == "tcp-dst")
+    {
+      return BuildPortFec<TcpDestinationPort, TcpDestinationPortRange> (value, line);
+    }
+
+  LOADER_ERROR (line, "unknown fec key " << key);
+  return 0;
+}
+
+Fec*
+ParseFec (const std::string &token, uint32_t line)
+{
+  Fec *fec = 0;
+  std::string::size_type begin = 0;
+
+  while (begin <= token.size ())
+    {
+      std::string::size_type end = token.find ('&', begin);
+      if (end == std::string::npos)
+        {
+          end = token.size ();
+        }
+
+      Fec *term = ParseTerm (token.substr (begin, end - begin), line);
+      fec = fec == 0 ? term : Fec::BuildAnd (fec, term);
+      begin = end + 1;
+    }
+
+  return fec;
+}
+
+Nhlfe
+MakeNhlfe (const Operation &op, int32_t interface, const Address &nextHop)
+{
+  if (interface >= 0 && !nextHop.IsInvalid ())
+    {
+      return Nhlfe (op, interface, nextHop);
+    }
+  if (interface >= 0)
+    {
+      return Nhlfe (op, interface);
+    }
+  if (!nextHop.IsInvalid ())
+    {
+      return Nhlfe (op, nextHop);
+    }
+  return Nhlfe (op);
+}
+
+Nhlfe
+ParseNhlfe (const std::string &op, const std::string &labelList, const std::string &outIf,
+            const std::string &nextHop, uint32_t nInterfaces, uint32_t line)
+{
+  std::vector<uint32_t> labels;
+  ParseLabels (labelList, labels, line);
+  int32_t interface = ParseInterface (outIf, nInterfaces, line);
+
+  Address address;
+  if (nextHop != "-")
+    {
+      if (!IsIpv4Address (nextHop))
+        {
+          LOADER_ERROR (line, "invalid next hop " << nextHop);
+        }
+      address = Ipv4Address (nextHop.c_str ());
+    }
+
+  if (op == "pop")
+    {
+      if (!labels.empty ())
+        {
+          LOADER_ERROR (line, "pop takes no labels");
+        }
+      return MakeNhlfe (Pop (), interface, address);
+    }
+
+  if (op == "swap")
+    {
+      if (labels.empty ())
+        {
+          LOADER_ERROR (line, "swap takes at least one label");
+        }
+      return MakeNhlfe (Swap (&labels[0], labels.size ()), interface, address);
+    }
+
+  if (op == "push")
+    {
+      if (labels.empty ())
+        {
+          LOADER_ERROR (line, "push takes at least one label");
+        }
+      return MakeNhlfe (Push (&labels[0], labels.size ()), interface, address);
+    }
+
+  LOADER_ERROR (line, "unknown operation " << op);
+  return Nhlfe (Pop ());
+}
+
+} // anonymous namespace
+
+MplsConfigLoader::MplsConfigLoader ()
+{
+}
+
+MplsConfigLoader::~MplsConfigLoader ()
+{
+}
+
+void
+MplsConfigLoader::SetPolicy (const std::string &name, const NhlfeSelectionPolicyHelper &policy)
+{
+  m_policies[name] = policy;
+}
+
+uint32_t
+MplsConfigLoader::Load (const NodeContainer &nodes, const std::string &filename)
+{
+  std::ifstream is (filename.c_str ());
+  if (!is)
+    {
+      NS_FATAL_ERROR ("MplsConfigLoader: can not open " << filename);
+    }
+
+  return Load (nodes, is);
+}
+
+uint32_t
+MplsConfigLoader::Load (const NodeContainer &nodes, std::istream &is)
+{
+  // nodes are referenced by id or name
+  std::vector<Ptr<MplsNode> > nodeById;
+  std::map<std::string, Ptr<MplsNode> > nodeByName;
+
+  for (NodeContainer::Iterator i = nodes.Begin (); i != nodes.End (); ++i)
+    {
+      Ptr<MplsNode> node = DynamicCast<MplsNode> (*i);
+      if (node == 0 || node->GetObject<Mpls> () == 0)
+        {
+          continue;
+        }
+
+      if (node->GetId () >= nodeById.size ())
+        {
+          nodeById.resize (node->GetId () + 1);
+        }
+      nodeById[node->GetId ()] = node;
+
+      std::string name = Names::FindName (node);
+      if (!name.empty ())
+        {
+          nodeByName[name] = node;
+        }
+    }
+
+  Ptr<MplsNode> lastNode;
+  Ptr<IncomingLabelMap> lastIlm;
+  Ptr<FecToNhlfe> lastFtn;
+  std::string lastFec;
+
+  uint32_t nEntries = 0;
+  uint32_t line = 0;
+  std::string text;
+
+  while (std::getline (is, text))
+    {
+      ++line;
+
+      std::string::size_type comment = text.find ('#');
+      if (comment != std::string::npos)
+        {
+          text.erase (comment);
+        }
+
+      std::istringstream fields (text);
+      std::vector<std::string> tokens;
+      std::string token;
+      while (fields >> token)
+        {
+          tokens.push_back (token);
+        }
+
+      if (tokens.empty ())
+        {
+          continue;
+        }
+
+      bool isIlm = tokens[0] == "ilm";
+      if (!isIlm && tokens[0] != "ftn")
+        {
+          LOADER_ERROR (line, "unknown entry type " << tokens[0]);
+        }
+
+      uint32_t nFields = isIlm ? 8 : 7;
+      if (tokens.size () < nFields || tokens.size () > nFields + 1)
+        {
+          LOADER_ERROR (line, "wrong number of fields");
+        }
+
+      Ptr<MplsNode> node;
+      uint32_t id;
+      if (ParseUint (tokens[1], id))
+        {
+          node = id < nodeById.size () ? nodeById[id] : 0;
+        }
+      else
+        {
+          std::map<std::string, Ptr<MplsNode> >::const_iterator i = nodeByName.find (tokens[1]);
+          node = i != nodeByName.end () ? i->second : 0;
+        }
+      if (node == 0)
+        {
+          LOADER_ERROR (line, "unknown mpls node " << tokens[1]);
+        }
+
+      const NhlfeSelectionPolicyHelper *policy = &m_defaultPolicy;
+      bool replication = tokens.size () > nFields && tokens[nFields] == "replicate";
+      if (tokens.size () > nFields && !replication)
+        {
+          PolicyMap::const_iterator i = m_policies.find (tokens[nFields]);
+          if (i == m_policies.end ())
+            {
+              LOADER_ERROR (line, "unknown policy " << tokens[nFields]);
+            }
+          policy = &i->second;
+        }
+
+      Ptr<Mpls> mpls = node->GetObject<Mpls> ();
+      uint32_t nInterfaces = mpls->GetNInterfaces ();
+      uint32_t first = isIlm ? 4 : 3;
+      Nhlfe nhlfe = ParseNhlfe (tokens[first], tokens[first + 1], tokens[first + 2], tokens[first + 3],
+                                nInterfaces, line);
+
+      if (isIlm)
+        {
+          int32_t interface = ParseInterface (tokens[2], nInterfaces, line);
+          uint32_t label;
+          if (!ParseUint (tokens[3], label) || label < 16 || label > 0xfffff)
+            {
+              LOADER_ERROR (line, "invalid incoming label " << tokens[3]);
+            }
+
+          if (lastIlm != 0 && lastNode == node && lastIlm->GetInterface () == interface &&
+              lastIlm->GetLabel () == label)
+            {
+              lastIlm->AddNhlfe (nhlfe);
+              continue;
+            }
+
+          // the ILM index of the node is kept up to date by AddIlm, so the lookup is cheap
+          Ptr<IncomingLabelMap> ilm = node->LookupIlm (label, interface);
+          if (ilm != 0 && ilm->GetInterface () == interface)
+            {
+              LOADER_ERROR (line, "duplicate ilm " << tokens[2] << " " << label);
+            }
+
+          // labels from the dynamic range are taken out of the label space
+          LabelSpace *space = 0;
+          if (node->GetLabelSpaceType () == MplsNode::PLATFORM)
+            {
+              space = node->GetLabelSpace (0);
+            }
+          else if (interface >= 0)
+            {
+              space = mpls->GetInterface (interface)->GetLabelSpace ();
+            }
+
+          if (space != 0 && label >= space->GetMinValue () && label <= space->GetMaxValue () &&
+              !space->Reserve (label))
+            {
+              LOADER_ERROR (line, "label " << label << " is already allocated");
+            }
+
+          lastIlm = Create<IncomingLabelMap> (interface, label, nhlfe, policy->Create ());
+          lastIlm->SetReplication (replication);
+          lastFtn = 0;
+          node->AddIlm (lastIlm);
+        }
+      else
+        {
+          if (lastFtn != 0 && lastNode == node && lastFec == tokens[2])
+            {
+              lastFtn->AddNhlfe (nhlfe);
+              continue;
+            }
+
+          lastFtn = Create<FecToNhlfe> (ParseFec (tokens[2], line), nhlfe, policy->Create ());
+          lastFtn->SetReplication (replication);
+          lastFec = tokens[2];
+          lastIlm = 0;
+          node->GetFtnTable ()->push_back (lastFtn);
+        }
+
+      lastNode = node;
+      ++nEntries;
+    }
+
+  NS_LOG_DEBUG ("Loaded " << nEntries << " entries from " << line << " lines");
+  return nEntries;
+}
+
+} // namespace ns3
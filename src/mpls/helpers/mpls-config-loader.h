@@ -0,0 +1,96 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010-2011 Andrey Churin, Stefano Avallone
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Andrey Churin <aachurin@gmail.com>
+ *         Stefano Avallone <stavallo@gmail.com>
+ */
+
+#ifndef MPLS_CONFIG_LOADER_H
+#define MPLS_CONFIG_LOADER_H
+
+#include <map>
+#include <string>
+#include <istream>
+
+#include "ns3/ptr.h"
+#include "ns3/node-container.h"
+#include "ns3/mpls-node.h"
+
+#include "mpls-nhlfe-selection-policy-helper.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup mpls
+ * \brief Loads static ILM and FTN tables from a line oriented text configuration.
+ *
+ * Every line describes one NHLFE, fields are separated by blanks, '#' starts a comment:
+ *
+ * \verbatim
+   ilm <node> <in-if> <label> <op> <labels> <out-if> <next-hop> [<policy>]
+   ftn <node> <fec> <op> <labels> <out-if> <next-hop> [<policy>]
+   \endverbatim
+ *
+ * - node: node id or name
+ * - in-if, out-if: mpls interface index or '-'
+ * - op: 'pop', 'swap' or 'push', labels: comma separated labels of swap and push or '-'. A push
+ *   with out-if and next-hop '-' is a binding SID, resolved by the ILM of the node
+ * - next-hop: ipv4 address or '-'
+ * - policy: name of a policy added by SetPolicy, the default policy is used if omitted. 'replicate'
+ *   makes the entry a point-to-multipoint branch point, the packet is copied to all its NHLFEs
+ * - fec: terms joined by '&', a term is key=value optionally preceded by '!', keys are
+ *   src, dst (ipv4 prefix), src6, dst6 (ipv6 prefix), udp-src, udp-dst, tcp-src, tcp-dst (port or
+ *   port range min-max)
+ *
+ * Consecutive lines with the same ILM key (node, in-if, label) or the same FTN (node, fec) add
+ * NHLFEs to one entry, the policy of the first line is used. The input is read line by line.
+ * Incoming labels within the range of the node label space are reserved in it, so labels
+ * allocated later by signaling do not collide with static ones. An ILM whose key is already
+ * installed on the node, by this or an earlier load, is an error. Nothing but the current entry is
+ * kept besides the tables of the nodes. Malformed lines abort the simulation.
+ */
+class MplsConfigLoader
+{
+public:
+  MplsConfigLoader ();
+  virtual ~MplsConfigLoader ();
+
+  /**
+   * @brief Register selection policy referenced by name
+   */
+  void SetPolicy (const std::string &name, const NhlfeSelectionPolicyHelper &policy);
+  /**
+   * @brief Load configuration of the nodes from the stream
+   * @return number of created ILM and FTN entries
+   */
+  uint32_t Load (const NodeContainer &nodes, std::istream &is);
+  /**
+   * @brief Load configuration of the nodes from the file
+   * @return number of created ILM and FTN entries
+   */
+  uint32_t Load (const NodeContainer &nodes, const std::string &filename);
+
+private:
+  typedef std::map<std::string, NhlfeSelectionPolicyHelper> PolicyMap;
+
+  PolicyMap m_policies;
+  NhlfeSelectionPolicyHelper m_defaultPolicy;
+};
+
+} // namespace ns3
+
+#endif /* MPLS_CONFIG_LOADER_H */
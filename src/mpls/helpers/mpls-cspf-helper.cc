@@ -0,0 +1,711 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010-2011 Andrey Churin, Stefano Avallone
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Andrey Churin <aachurin@gmail.com>
+ *         Stefano Avallone <stavallo@gmail.com>
+ */
+
+#include <algorithm>
+#include <deque>
+#include <functional>
+
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ns3/callback.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-thread.h"
+#include "ns3/system-mutex.h"
+#endif
+
+#include "mpls-cspf-helper.h"
+
+NS_LOG_COMPONENT_DEFINE ("MplsCspfHelper");
+
+namespace ns3 {
+
+using namespace mpls;
+
+MplsCspfHelper::Constraints::Constraints ()
+  : bandwidth (0),
+    includeAny (0),
+    includeAll (0),
+    excludeAny (0),
+    hopLimit (0)
+{
+}
+
+bool
+MplsCspfHelper::Constraints::operator== (const Constraints &other) const
+{
+  return bandwidth == other.bandwidth && includeAny == other.includeAny && includeAll == other.includeAll
+    && excludeAny == other.excludeAny && hopLimit == other.hopLimit;
+}
+
+MplsCspfHelper::Request::Request ()
+  : ingress (0),
+    egress (0),
+    constraints ()
+{
+}
+
+MplsCspfHelper::Request::Request (Ptr<Node> ingress, Ptr<Node> egress, const Constraints &constraints)
+  : ingress (ingress),
+    egress (egress),
+    constraints (constraints)
+{
+}
+
+/**
+ * \brief Worker thread of a batch placement. Every worker has its own queue of ingress groups and
+ * its own scratch buffers, the TE topology is shared read-only. A worker whose queue is empty steals
+ * groups from the back of other queues.
+ */
+class MplsCspfHelper::BatchWorker
+{
+public:
+  BatchWorker (const MplsCspfHelper *cspf, const std::vector<Request> *requests, const std::vector<uint32_t> *order,
+               const std::vector<std::pair<uint32_t, uint32_t> > *ends, std::vector<Path> *paths)
+    : m_cspf (cspf), m_requests (requests), m_order (order), m_ends (ends), m_paths (paths), m_workers (0)
+  {
+    m_scratch.dist.resize (cspf->m_nodes.size ());
+    m_scratch.parent.resize (cspf->m_nodes.size ());
+  }
+
+  void SetWorkers (std::vector<BatchWorker*> *workers)
+  {
+    m_workers = workers;
+  }
+
+  void Push (const Task &task)
+  {
+    m_tasks.push_back (task);
+  }
+
+  void Run (void)
+  {
+    Task task;
+    while (Pop (task) || Steal (task))
+      {
+        m_cspf->ComputeTask (task, *m_requests, *m_order, *m_ends, m_scratch, *m_paths);
+      }
+  }
+
+private:
+  bool Pop (Task &task)
+  {
+#ifdef HAVE_PTHREAD_H
+    CriticalSection cs (m_mutex);
+#endif
+    if (m_tasks.empty ())
+      {
+        return false;
+      }
+    task = m_tasks.front ();
+    m_tasks.pop_front ();
+    return true;
+  }
+
+  bool StealFrom (Task &task)
+  {
+#ifdef HAVE_PTHREAD_H
+    CriticalSection cs (m_mutex);
+#endif
+    if (m_tasks.empty ())
+      {
+        return false;
+      }
+    task = m_tasks.back ();
+    m_tasks.pop_back ();
+    return true;
+  }
+
+  bool Steal (Task &task)
+  {
+    for (std::vector<BatchWorker*>::iterator i = m_workers->begin (); i != m_workers->end (); ++i)
+      {
+        if (*i != this && (*i)->StealFrom (task))
+          {
+            return true;
+          }
+      }
+    return false;
+  }
+
+  const MplsCspfHelper *m_cspf;
+  const std::vector<Request> *m_requests;
+  const std::vector<uint32_t> *m_order;
+  const std::vector<std::pair<uint32_t, uint32_t> > *m_ends;
+  std::vector<Path> *m_paths;
+  std::vector<BatchWorker*> *m_workers;
+  std::deque<Task> m_tasks;
+  Scratch m_scratch;
+#ifdef HAVE_PTHREAD_H
+  SystemMutex m_mutex;
+#endif
+};
+
+MplsCspfHelper::MplsCspfHelper ()
+  : m_computeTime (0)
+{
+}
+
+MplsCspfHelper::~MplsCspfHelper ()
+{
+}
+
+void
+MplsCspfHelper::BuildGraph (const MplsNetworkDiscoverer &network)
+{
+  NS_LOG_FUNCTION (this);
+
+  m_nodes.clear ();
+  m_nodeIndex.clear ();
+  m_links.clear ();
+
+  Ptr<const MplsTopology> topology = network.GetTopology ();
+  NS_ASSERT_MSG (topology != 0, "MplsCspfHelper::BuildGraph (): Call DiscoverNetwork first");
+
+  // topology links are already sorted by source node, so nodes and links keep topology indexes
+  for (uint32_t i = 0; i < topology->GetNNodes (); ++i)
+    {
+      Ptr<MplsNode> node = topology->GetNode (i);
+      if (node->GetId () >= m_nodeIndex.size ())
+        {
+          m_nodeIndex.resize (node->GetId () + 1, -1);
+        }
+      m_nodeIndex[node->GetId ()] = m_nodes.size ();
+      m_nodes.push_back (node);
+    }
+
+  m_links.reserve (topology->GetNLinks ());
+  for (uint32_t i = 0; i < topology->GetNLinks (); ++i)
+    {
+      const MplsTopology::Link &topologyLink = topology->GetLink (i);
+
+      Link link;
+      link.from = topologyLink.from;
+      link.to = topologyLink.to;
+      link.metric = topologyLink.metric;
+      link.colors = 0;
+      link.reservable = topologyLink.rate != 0 ? topologyLink.rate : uint64_t (-1);
+      link.reserved = 0;
+      link.nextHop = topologyLink.nextHop;
+      link.interface = topology->GetLocalInterface (i);
+
+      m_links.push_back (link);
+    }
+
+  uint32_t nNodes = m_nodes.size ();
+  m_outBegin.resize (nNodes + 1);
+  for (uint32_t i = 0; i < nNodes; ++i)
+    {
+      m_outBegin[i] = topology->GetOutBegin (i);
+    }
+  m_outBegin[nNodes] = m_links.size ();
+
+  m_scratch.dist.resize (nNodes);
+  m_scratch.parent.resize (nNodes);
+
+  NS_LOG_DEBUG ("TE topology: " << nNodes << " nodes, " << m_links.size () << " links");
+}
+
+void
+MplsCspfHelper::SetReservableBandwidth (Ptr<Interface> interface, uint64_t bandwidth)
+{
+  int32_t l = GetLinkIndex (interface);
+  NS_ASSERT_MSG (l >= 0, "MplsCspfHelper::SetReservableBandwidth (): Unknown interface");
+  m_links[l].reservable = bandwidth;
+}
+
+void
+MplsCspfHelper::SetAdminColors (Ptr<Interface> interface, uint32_t colors)
+{
+  int32_t l = GetLinkIndex (interface);
+  NS_ASSERT_MSG (l >= 0, "MplsCspfHelper::SetAdminColors (): Unknown interface");
+  m_links[l].colors = colors;
+}
+
+void
+MplsCspfHelper::SetTeMetric (Ptr<Interface> interface, uint32_t metric)
+{
+  int32_t l = GetLinkIndex (interface);
+  NS_ASSERT_MSG (l >= 0, "MplsCspfHelper::SetTeMetric (): Unknown interface");
+  NS_ASSERT_MSG (metric > 0, "MplsCspfHelper::SetTeMetric (): Metric should be positive");
+  m_links[l].metric = metric;
+}
+
+uint64_t
+MplsCspfHelper::GetAvailableBandwidth (Ptr<Interface> interface) const
+{
+  int32_t l = GetLinkIndex (interface);
+  NS_ASSERT_MSG (l >= 0, "MplsCspfHelper::GetAvailableBandwidth (): Unknown interface");
+  return GetUnreservedBandwidth (m_links[l]);
+}
+
+bool
+MplsCspfHelper::ComputePath (Ptr<Node> ingress, Ptr<Node> egress, const Constraints &constraints, Path &path)
+{
+  NS_LOG_FUNCTION (this << ingress << egress);
+
+  int32_t from = GetNodeIndex (ingress);
+  int32_t to = GetNodeIndex (egress);
+  NS_ASSERT_MSG (from >= 0 && to >= 0, "MplsCspfHelper::ComputePath (): Unknown node, call BuildGraph first");
+  NS_ASSERT_MSG (from != to, "MplsCspfHelper::ComputePath (): Ingress and egress should differ");
+
+  path.clear ();
+
+  // dijkstra can not enforce the hop limit exactly: a node settled by a path with more hops
+  // hides longer paths with fewer hops
+  if (constraints.hopLimit != 0)
+    {
+      return ComputeHopLimitedPath (from, to, constraints, path);
+    }
+
+  return ComputeShortestPath (from, to, constraints, m_scratch, path);
+}
+
+bool
+MplsCspfHelper::PlaceTunnel (Ptr<Node> ingress, Ptr<Node> egress, const Constraints &constraints, Path &path)
+{
+  if (!ComputePath (ingress, egress, constraints, path))
+    {
+      return false;
+    }
+
+  Reserve (path, constraints.bandwidth);
+  return true;
+}
+
+uint32_t
+MplsCspfHelper::PlaceTunnels (const std::vector<Request> &requests, std::vector<Path> &paths, uint32_t nThreads)
+{
+  NS_LOG_FUNCTION (this << requests.size () << nThreads);
+  NS_ASSERT_MSG (nThreads > 0, "MplsCspfHelper::PlaceTunnels (): At least one thread is required");
+
+  SystemWallClockMs clock;
+  clock.Start ();
+
+  uint32_t nRequests = requests.size ();
+  paths.assign (nRequests, Path ());
+
+  // node indexes are resolved here, worker threads never touch reference counted objects
+  std::vector<std::pair<uint32_t, uint32_t> > ends (nRequests);
+  std::vector<std::pair<uint32_t, uint32_t> > sorted (nRequests);
+  for (uint32_t i = 0; i < nRequests; ++i)
+    {
+      int32_t from = GetNodeIndex (requests[i].ingress);
+      int32_t to = GetNodeIndex (requests[i].egress);
+      NS_ASSERT_MSG (from >= 0 && to >= 0, "MplsCspfHelper::PlaceTunnels (): Unknown node, call BuildGraph first");
+      NS_ASSERT_MSG (from != to, "MplsCspfHelper::PlaceTunnels (): Ingress and egress should differ");
+      ends[i] = std::make_pair (from, to);
+      sorted[i] = std::make_pair (from, i);
+    }
+
+  // group requests by ingress, keeping request order inside a group
+  std::sort (sorted.begin (), sorted.end ());
+  std::vector<uint32_t> order (nRequests);
+  std::vector<Task> tasks;
+  for (uint32_t i = 0; i < nRequests; ++i)
+    {
+      order[i] = sorted[i].second;
+      if (i == 0 || sorted[i].first != sorted[i - 1].first)
+        {
+          Task task;
+          task.begin = i;
+          task.end = i;
+          tasks.push_back (task);
+        }
+      tasks.back ().end = i + 1;
+    }
+
+#ifndef HAVE_PTHREAD_H
+  nThreads = 1;
+#endif
+  nThreads = std::max<uint32_t> (1, std::min<uint32_t> (nThreads, tasks.size ()));
+
+  std::vector<BatchWorker*> workers;
+  for (uint32_t i = 0; i < nThreads; ++i)
+    {
+      workers.push_back (new BatchWorker (this, &requests, &order, &ends, &paths));
+    }
+  for (uint32_t i = 0; i < tasks.size (); ++i)
+    {
+      workers[i % nThreads]->Push (tasks[i]);
+    }
+  for (uint32_t i = 0; i < nThreads; ++i)
+    {
+      workers[i]->SetWorkers (&workers);
+    }
+
+#ifdef HAVE_PTHREAD_H
+  std::vector<Ptr<SystemThread> > threads;
+  for (uint32_t i = 1; i < nThreads; ++i)
+    {
+      threads.push_back (Create<SystemThread> (MakeCallback (&BatchWorker::Run, workers[i])));
+      threads.back ()->Start ();
+    }
+#endif
+
+  workers[0]->Run ();
+
+#ifdef HAVE_PTHREAD_H
+  for (std::vector<Ptr<SystemThread> >::iterator i = threads.begin (); i != threads.end (); ++i)
+    {
+      (*i)->Join ();
+    }
+#endif
+
+  for (std::vector<BatchWorker*>::iterator i = workers.begin (); i != workers.end (); ++i)
+    {
+      delete *i;
+    }
+
+  // commit phase: reservations only shrink the set of feasible links, so a path which is still
+  // feasible is the one PlaceTunnel would compute now
+  uint32_t nPlaced = 0;
+  uint32_t nRecomputed = 0;
+  for (uint32_t i = 0; i < nRequests; ++i)
+    {
+      const Constraints &constraints = requests[i].constraints;
+      Path &path = paths[i];
+
+      bool feasible = !path.empty ();
+      for (Path::const_iterator l = path.begin (); l != path.end () && feasible; ++l)
+        {
+          feasible = IsFeasible (m_links[*l], constraints);
+        }
+
+      if (!feasible && !path.empty ())
+        {
+          path.clear ();
+          ++nRecomputed;
+          if (constraints.hopLimit != 0)
+            {
+              ComputeHopLimitedPath (ends[i].first, ends[i].second, constraints, path);
+            }
+          else
+            {
+              ComputeShortestPath (ends[i].first, ends[i].second, constraints, m_scratch, path);
+            }
+        }
+
+      if (!path.empty ())
+        {
+          Reserve (path, constraints.bandwidth);
+          ++nPlaced;
+        }
+    }
+
+  m_computeTime = clock.End ();
+
+  NS_LOG_DEBUG ("Placed " << nPlaced << " of " << nRequests << " tunnels (" << nRecomputed << " recomputed) using "
+                << nThreads << " threads in " << m_computeTime << "ms");
+  return nPlaced;
+}
+
+int64_t
+MplsCspfHelper::GetComputeTime (void) const
+{
+  return m_computeTime;
+}
+
+void
+MplsCspfHelper::ComputeTask (const Task &task, const std::vector<Request> &requests, const std::vector<uint32_t> &order,
+                             const std::vector<std::pair<uint32_t, uint32_t> > &ends, Scratch &scratch,
+                             std::vector<Path> &paths) const
+{
+  // SPF tree of the last constraints, requests of the group with equal constraints reuse it
+  const Constraints *treeConstraints = 0;
+
+  for (uint32_t i = task.begin; i < task.end; ++i)
+    {
+      uint32_t r = order[i];
+      const Constraints &constraints = requests[r].constraints;
+
+      if (constraints.hopLimit != 0)
+        {
+          ComputeHopLimitedPath (ends[r].first, ends[r].second, constraints, paths[r]);
+          continue;
+        }
+
+      if (treeConstraints == 0 || !(*treeConstraints == constraints))
+        {
+          ComputeTree (ends[r].first, -1, constraints, scratch);
+          treeConstraints = &constraints;
+        }
+
+      GetTreePath (ends[r].first, ends[r].second, scratch, paths[r]);
+    }
+}
+
+void
+MplsCspfHelper::Reserve (const Path &path, uint64_t bandwidth)
+{
+  for (Path::const_iterator i = path.begin (); i != path.end (); ++i)
+    {
+      Link &link = m_links[*i];
+      NS_ASSERT_MSG (GetUnreservedBandwidth (link) >= bandwidth,
+                     "MplsCspfHelper::Reserve (): Not enough bandwidth on link " << *i);
+      link.reserved += bandwidth;
+    }
+}
+
+void
+MplsCspfHelper::Release (const Path &path, uint64_t bandwidth)
+{
+  for (Path::const_iterator i = path.begin (); i != path.end (); ++i)
+    {
+      Link &link = m_links[*i];
+      NS_ASSERT_MSG (link.reserved >= bandwidth, "MplsCspfHelper::Release (): Bandwidth was not reserved");
+      link.reserved -= bandwidth;
+    }
+}
+
+uint32_t
+MplsCspfHelper::GetPathMetric (const Path &path) const
+{
+  uint32_t metric = 0;
+  for (Path::const_iterator i = path.begin (); i != path.end (); ++i)
+    {
+      metric += m_links[*i].metric;
+    }
+  return metric;
+}
+
+Lsp
+MplsCspfHelper::GetLsp (const Path &path) const
+{
+  NS_ASSERT_MSG (!path.empty (), "MplsCspfHelper::GetLsp (): Empty path");
+
+  Lsp lsp;
+  lsp.Add (LspNode (m_nodes[m_links[path.front ()].from]));
+  for (Path::const_iterator i = path.begin (); i != path.end (); ++i)
+    {
+      lsp.Add (LspNode (m_links[*i].nextHop));
+    }
+  return lsp;
+}
+
+std::vector<Ipv4Address>
+MplsCspfHelper::GetExplicitRoute (const Path &path) const
+{
+  std::vector<Ipv4Address> route;
+  route.reserve (path.size ());
+  for (Path::const_iterator i = path.begin (); i != path.end (); ++i)
+    {
+      route.push_back (m_links[*i].nextHop);
+    }
+  return route;
+}
+
+int32_t
+MplsCspfHelper::GetNodeIndex (Ptr<Node> node) const
+{
+  if (node == 0 || node->GetId () >= m_nodeIndex.size ())
+    {
+      return -1;
+    }
+  return m_nodeIndex[node->GetId ()];
+}
+
+int32_t
+MplsCspfHelper::GetLinkIndex (Ptr<Interface> interface) const
+{
+  // links are sorted by source node, so only the links of the interface's node are scanned
+  int32_t v = interface != 0 ? GetNodeIndex (interface->GetDevice ()->GetNode ()) : -1;
+  if (v < 0)
+    {
+      return -1;
+    }
+
+  for (uint32_t i = m_outBegin[v]; i < m_outBegin[v + 1]; ++i)
+    {
+      if (m_links[i].interface == interface)
+        {
+          return i;
+        }
+    }
+  return -1;
+}
+
+uint64_t
+MplsCspfHelper::GetUnreservedBandwidth (const Link &link)
+{
+  // reservable bandwidth may have been lowered below the reserved one
+  return link.reserved < link.reservable ? link.reservable - link.reserved : 0;
+}
+
+bool
+MplsCspfHelper::IsFeasible (const Link &link, const Constraints &constraints) const
+{
+  return GetUnreservedBandwidth (link) >= constraints.bandwidth
+    && (link.colors & constraints.excludeAny) == 0
+    && (link.colors & constraints.includeAll) == constraints.includeAll
+    && (constraints.includeAny == 0 || (link.colors & constraints.includeAny) != 0)
+    && link.interface->IsUp ();
+}
+
+void
+MplsCspfHelper::ComputeTree (uint32_t ingress, int32_t egress, const Constraints &constraints,
+                             Scratch &scratch) const
+{
+  // candidates are ordered by (metric, hops), both packed into one key: metric in the upper half
+  // and hop count in the lower half
+  typedef std::pair<uint64_t, uint32_t> Candidate;
+
+  std::vector<uint64_t> &dist = scratch.dist;
+  std::vector<int32_t> &parent = scratch.parent;
+  std::vector<Candidate> &heap = scratch.heap;
+  std::greater<Candidate> compare;
+
+  std::fill (dist.begin (), dist.end (), uint64_t (-1));
+  std::fill (parent.begin (), parent.end (), -1);
+  heap.clear ();
+
+  dist[ingress] = 0;
+  heap.push_back (Candidate (0, ingress));
+
+  while (!heap.empty ())
+    {
+      std::pop_heap (heap.begin (), heap.end (), compare);
+      Candidate c = heap.back ();
+      heap.pop_back ();
+
+      if (c.first > dist[c.second])
+        {
+          continue;
+        }
+
+      if (int32_t (c.second) == egress)
+        {
+          break;
+        }
+
+      for (int32_t l = m_outBegin[c.second]; l < int32_t (m_outBegin[c.second + 1]); ++l)
+        {
+          const Link &link = m_links[l];
+
+          if (!IsFeasible (link, constraints))
+            {
+              continue;
+            }
+
+          uint64_t d = c.first + (uint64_t (link.metric) << 32) + 1;
+
+          if (d < dist[link.to])
+            {
+              dist[link.to] = d;
+              parent[link.to] = l;
+              heap.push_back (Candidate (d, link.to));
+              std::push_heap (heap.begin (), heap.end (), compare);
+            }
+          else if (d == dist[link.to] && l < parent[link.to])
+            {
+              parent[link.to] = l;
+            }
+        }
+    }
+}
+
+bool
+MplsCspfHelper::GetTreePath (uint32_t ingress, uint32_t egress, const Scratch &scratch, Path &path) const
+{
+  if (scratch.parent[egress] < 0)
+    {
+      return false;
+    }
+
+  for (uint32_t v = egress; v != ingress; v = m_links[scratch.parent[v]].from)
+    {
+      path.push_back (scratch.parent[v]);
+    }
+  std::reverse (path.begin (), path.end ());
+  return true;
+}
+
+bool
+MplsCspfHelper::ComputeShortestPath (uint32_t ingress, uint32_t egress, const Constraints &constraints,
+                                     Scratch &scratch, Path &path) const
+{
+  ComputeTree (ingress, egress, constraints, scratch);
+  return GetTreePath (ingress, egress, scratch, path);
+}
+
+bool
+MplsCspfHelper::ComputeHopLimitedPath (uint32_t ingress, uint32_t egress, const Constraints &constraints,
+                                       Path &path) const
+{
+  // bellman-ford bounded by the hop limit: row h keeps minimal metric of paths with at most h hops,
+  // parent -2 means that the value was inherited from row h - 1
+  uint32_t nNodes = m_nodes.size ();
+  uint32_t nRows = constraints.hopLimit + 1;
+
+  std::vector<uint64_t> dist (nRows * nNodes, uint64_t (-1));
+  std::vector<int32_t> parent (nRows * nNodes, -1);
+  dist[ingress] = 0;
+
+  for (uint32_t h = 1; h < nRows; ++h)
+    {
+      uint64_t *prevDist = &dist[(h - 1) * nNodes];
+      uint64_t *curDist = &dist[h * nNodes];
+      int32_t *curParent = &parent[h * nNodes];
+
+      for (uint32_t v = 0; v < nNodes; ++v)
+        {
+          curDist[v] = prevDist[v];
+          curParent[v] = -2;
+        }
+
+      for (uint32_t l = 0; l < m_links.size (); ++l)
+        {
+          const Link &link = m_links[l];
+          if (prevDist[link.from] == uint64_t (-1) || !IsFeasible (link, constraints))
+            {
+              continue;
+            }
+
+          uint64_t d = prevDist[link.from] + link.metric;
+          if (d < curDist[link.to])
+            {
+              curDist[link.to] = d;
+              curParent[link.to] = l;
+            }
+        }
+    }
+
+  if (dist[(nRows - 1) * nNodes + egress] == uint64_t (-1))
+    {
+      return false;
+    }
+
+  uint32_t v = egress;
+  for (uint32_t h = nRows - 1; v != ingress; --h)
+    {
+      int32_t l = parent[h * nNodes + v];
+      if (l >= 0)
+        {
+          path.push_back (l);
+          v = m_links[l].from;
+        }
+    }
+  std::reverse (path.begin (), path.end ());
+  return true;
+}
+
+} // namespace ns3
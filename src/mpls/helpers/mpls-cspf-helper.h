@@ -0,0 +1,222 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010-2011 Andrey Churin, Stefano Avallone
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Andrey Churin <aachurin@gmail.com>
+ *         Stefano Avallone <stavallo@gmail.com>
+ */
+
+#ifndef MPLS_CSPF_HELPER_H
+#define MPLS_CSPF_HELPER_H
+
+#include <vector>
+
+#include "ns3/ptr.h"
+#include "ns3/node.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/mpls-node.h"
+#include "ns3/mpls-interface.h"
+
+#include "mpls-network-discoverer.h"
+#include "mpls-tunnel-helper.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup mpls
+ * \brief Constrained shortest path first computation for explicitly routed LSPs.
+ *
+ * The TE topology is built from MplsTopology of the discovered network. Every link has a TE metric
+ * (ipv4 interface metric by default), a reservable bandwidth (device data rate by default),
+ * a bandwidth reserved by placed tunnels and a bit mask of administrative colors. Links which do not satisfy the constraints
+ * are pruned during path computation. Among the paths of minimal metric the one with the fewest hops
+ * is chosen, remaining ties are broken by the lowest link index, so results are reproducible.
+ *
+ * Computed paths can be converted to Lsp (MplsTunnelHelper::CreateTunnel) or to a list of strict
+ * hops (explicit route of CR-LDP tunnels).
+ */
+class MplsCspfHelper
+{
+public:
+  /**
+   * @brief Path as a sequence of link indexes from the ingress to the egress
+   */
+  typedef std::vector<uint32_t> Path;
+
+  /**
+   * @brief Tunnel placement constraints
+   */
+  struct Constraints
+  {
+    uint64_t bandwidth;   // bandwidth to reserve (bps)
+    uint32_t includeAny;  // link should have at least one of these colors (0 - any link)
+    uint32_t includeAll;  // link should have all these colors
+    uint32_t excludeAny;  // link should have none of these colors
+    uint32_t hopLimit;    // maximum number of hops (0 - no limit)
+
+    Constraints ();
+    bool operator== (const Constraints &other) const;
+  };
+
+  /**
+   * @brief Tunnel placement request
+   */
+  struct Request
+  {
+    Ptr<Node> ingress;
+    Ptr<Node> egress;
+    Constraints constraints;
+
+    Request ();
+    Request (Ptr<Node> ingress, Ptr<Node> egress, const Constraints &constraints);
+  };
+
+  MplsCspfHelper ();
+  virtual ~MplsCspfHelper ();
+
+  /**
+   * @brief Build TE topology, all reservations are cleared
+   * @param network discoverer, DiscoverNetwork should be called first
+   */
+  void BuildGraph (const MplsNetworkDiscoverer &network);
+  /**
+   * @brief Set reservable bandwidth of the link attached to the interface
+   */
+  void SetReservableBandwidth (Ptr<mpls::Interface> interface, uint64_t bandwidth);
+  /**
+   * @brief Set administrative colors of the link attached to the interface
+   */
+  void SetAdminColors (Ptr<mpls::Interface> interface, uint32_t colors);
+  /**
+   * @brief Set TE metric of the link attached to the interface
+   */
+  void SetTeMetric (Ptr<mpls::Interface> interface, uint32_t metric);
+  /**
+   * @brief Compute the shortest path satisfying constraints
+   * @param ingress ingress node
+   * @param egress egress node
+   * @param constraints placement constraints
+   * @param path computed path
+   * @return false if there is no feasible path
+   */
+  bool ComputePath (Ptr<Node> ingress, Ptr<Node> egress, const Constraints &constraints, Path &path);
+  /**
+   * @brief Compute path and reserve bandwidth along it
+   * @return false if there is no feasible path
+   */
+  bool PlaceTunnel (Ptr<Node> ingress, Ptr<Node> egress, const Constraints &constraints, Path &path);
+  /**
+   * @brief Place a batch of tunnels, the result is the same as of PlaceTunnel called for every
+   * request in order, whatever the number of threads is.
+   *
+   * Paths are computed in parallel against reservations made before the call: requests are grouped by
+   * ingress, groups are distributed between worker threads which steal groups from each other when
+   * their own queue is empty. Requests of one group with equal constraints share one SPF tree.
+   * Reservations are then committed serially in request order, a path which is no longer feasible
+   * is recomputed.
+   *
+   * @param requests tunnel placement requests
+   * @param paths computed paths, empty for requests which can not be satisfied
+   * @param nThreads number of worker threads
+   * @return number of placed tunnels
+   */
+  uint32_t PlaceTunnels (const std::vector<Request> &requests, std::vector<Path> &paths, uint32_t nThreads = 1);
+  /**
+   * @brief Returns wall-clock time (in milliseconds) spent by the last PlaceTunnels
+   */
+  int64_t GetComputeTime (void) const;
+  /**
+   * @brief Reserve bandwidth along the path
+   */
+  void Reserve (const Path &path, uint64_t bandwidth);
+  /**
+   * @brief Release bandwidth reserved along the path
+   */
+  void Release (const Path &path, uint64_t bandwidth);
+  /**
+   * @brief Returns bandwidth still available for reservation on the link attached to the interface
+   */
+  uint64_t GetAvailableBandwidth (Ptr<mpls::Interface> interface) const;
+  /**
+   * @brief Returns sum of TE metrics of path links
+   */
+  uint32_t GetPathMetric (const Path &path) const;
+  /**
+   * @brief Convert path to LSP, hops are specified by addresses of incoming interfaces
+   */
+  Lsp GetLsp (const Path &path) const;
+  /**
+   * @brief Returns addresses of incoming interfaces of every node after the ingress (strict hops)
+   */
+  std::vector<Ipv4Address> GetExplicitRoute (const Path &path) const;
+
+private:
+  struct Link
+  {
+    uint32_t from;
+    uint32_t to;
+    uint32_t metric;
+    uint32_t colors;
+    uint64_t reservable;
+    uint64_t reserved;
+    Ipv4Address nextHop;
+    Ptr<mpls::Interface> interface;
+  };
+
+  // per thread dijkstra buffers
+  struct Scratch
+  {
+    std::vector<uint64_t> dist;
+    std::vector<int32_t> parent;
+    std::vector<std::pair<uint64_t, uint32_t> > heap;
+  };
+
+  // ingress group of a batch: requests order[begin, end)
+  struct Task
+  {
+    uint32_t begin;
+    uint32_t end;
+  };
+
+  class BatchWorker;
+  friend class BatchWorker;
+
+  int32_t GetNodeIndex (Ptr<Node> node) const;
+  int32_t GetLinkIndex (Ptr<mpls::Interface> interface) const;
+  static uint64_t GetUnreservedBandwidth (const Link &link);
+  bool IsFeasible (const Link &link, const Constraints &constraints) const;
+  void ComputeTree (uint32_t ingress, int32_t egress, const Constraints &constraints, Scratch &scratch) const;
+  bool GetTreePath (uint32_t ingress, uint32_t egress, const Scratch &scratch, Path &path) const;
+  bool ComputeShortestPath (uint32_t ingress, uint32_t egress, const Constraints &constraints, Scratch &scratch,
+                            Path &path) const;
+  bool ComputeHopLimitedPath (uint32_t ingress, uint32_t egress, const Constraints &constraints, Path &path) const;
+  void ComputeTask (const Task &task, const std::vector<Request> &requests, const std::vector<uint32_t> &order,
+                    const std::vector<std::pair<uint32_t, uint32_t> > &ends, Scratch &scratch,
+                    std::vector<Path> &paths) const;
+
+  std::vector<Ptr<MplsNode> > m_nodes;
+  std::vector<int32_t> m_nodeIndex;
+  std::vector<Link> m_links;
+  // outgoing links of node v are [m_outBegin[v], m_outBegin[v + 1])
+  std::vector<uint32_t> m_outBegin;
+
+  Scratch m_scratch;
+  int64_t m_computeTime;
+};
+
+} // namespace ns3
+
+#endif /* MPLS_CSPF_HELPER_H */
@@ -23,11 +23,13 @@
 #define MPLS_FTN_HELPER_H
 
 #include "ns3/ptr.h"
+#include "ns3/assert.h"
 #include "ns3/mpls.h"
 #include "ns3/mpls-label.h"
 #include "ns3/mpls-fec-to-nhlfe.h"
 #include "ns3/mpls-fec.h"
 #include "ns3/mpls-nhlfe.h"
+#include "ns3/mpls-next-hop-group.h"
 
 #include "mpls-node-helper-base.h"
 
@@ -41,6 +43,18 @@ using namespace mpls;
 class MplsFtnHelper : public MplsNodeHelperBase
 {
 public:
+  /**
+   * @brief FTN description used by bulk insertion
+   */
+  struct FtnEntry
+  {
+    FtnEntry (Fec *fec, uint32_t group, uint32_t policy = 0);
+
+    Fec *fec;           //!< FEC (built by Fec::Build, owned by the created FTN)
+    uint32_t group;     //!< index of the NHLFE group
+    uint32_t policy;    //!< index of the selection policy
+  };
+
   virtual ~MplsFtnHelper();
   /**
    * @brief Remove FTN
@@ -157,8 +171,108 @@ public:
                     const Nhlfe &nhlfe7, const Nhlfe &nhlfe8, const Nhlfe &nhlfe9, 
                     const Nhlfe &nhlfe10, const Nhlfe &nhlfe11, const Nhlfe &nhlfe12,
                     const NhlfeSelectionPolicyHelper& policy);
+
+  /**
+   * @brief Add FTN referencing a shared NHLFE group, a change of the group applies to every FTN
+   * built on it
+   * @param fec FEC
+   * @param group NHLFE group
+   * @return FTN
+   */
+  template<class T>
+  Ptr<FecToNhlfe> AddFtn (const T &fec, const Ptr<NextHopGroup> &group);
+  template<class T>
+  Ptr<FecToNhlfe> AddFtn (const T &fec, const Ptr<NextHopGroup> &group, const NhlfeSelectionPolicyHelper& policy);
+
+  /**
+   * @brief Add FTNs described by the range of FtnEntry
+   *
+   * NHLFEs of the groups are interned in the node NHLFE pool, every FTN takes the FEC of its entry
+   * and keeps ids of the referenced group and the referenced policy object.
+   *
+   * @param begin, end range of FtnEntry
+   * @param groups NHLFE groups referenced by the entries
+   * @param policies selection policies referenced by the entries
+   * @return number of added FTNs
+   */
+  template <class Iterator>
+  uint32_t AddFtns (Iterator begin, Iterator end, const NhlfeGroupVector &groups,
+                    const PolicyVector &policies);
+  /**
+   * @brief Add FTNs described by the range of FtnEntry with the default selection policy (policy
+   * index of the entries is ignored)
+   */
+  template <class Iterator>
+  uint32_t AddFtns (Iterator begin, Iterator end, const NhlfeGroupVector &groups);
 };
 
+inline
+MplsFtnHelper::FtnEntry::FtnEntry (Fec *fec, uint32_t group, uint32_t policy)
+  : fec (fec),
+    group (group),
+    policy (policy)
+{
+}
+
+template <class Iterator>
+uint32_t
+MplsFtnHelper::AddFtns (Iterator begin, Iterator end, const NhlfeGroupVector &groups,
+                        const PolicyVector &policies)
+{
+  MplsNode::FtnTable *table = GetNode ()->GetFtnTable ();
+  const Ptr<NhlfePool> &pool = GetNode ()->GetNhlfePool ();
+  std::vector<NhlfeIdVector> ids;
+  InternNhlfeGroups (pool, groups, ids);
+  uint32_t count = 0;
+
+  for (Iterator i = begin; i != end; ++i, ++count)
+    {
+      const FtnEntry &entry = *i;
+      NS_ASSERT_MSG (entry.group < groups.size (), "MplsFtnHelper::AddFtns (): invalid NHLFE group");
+      NS_ASSERT_MSG (entry.policy < policies.size (), "MplsFtnHelper::AddFtns (): invalid policy");
+      table->push_back (Create<FecToNhlfe> (entry.fec, pool, ids[entry.group], policies[entry.policy]));
+    }
+
+  return count;
+}
+
+template <class Iterator>
+uint32_t
+MplsFtnHelper::AddFtns (Iterator begin, Iterator end, const NhlfeGroupVector &groups)
+{
+  MplsNode::FtnTable *table = GetNode ()->GetFtnTable ();
+  const Ptr<NhlfePool> &pool = GetNode ()->GetNhlfePool ();
+  std::vector<NhlfeIdVector> ids;
+  InternNhlfeGroups (pool, groups, ids);
+  const Ptr<NhlfeSelectionPolicy> policy = GetSelectionPolicy ().Create ();
+  uint32_t count = 0;
+
+  for (Iterator i = begin; i != end; ++i, ++count)
+    {
+      const FtnEntry &entry = *i;
+      NS_ASSERT_MSG (entry.group < groups.size (), "MplsFtnHelper::AddFtns (): invalid NHLFE group");
+      table->push_back (Create<FecToNhlfe> (entry.fec, pool, ids[entry.group], policy));
+    }
+
+  return count;
+}
+
+template<class T>
+Ptr<FecToNhlfe>
+MplsFtnHelper::AddFtn (const T &fec, const Ptr<NextHopGroup> &group)
+{
+  return AddFtn (fec, group, GetSelectionPolicy ());
+}
+
+template<class T>
+Ptr<FecToNhlfe>
+MplsFtnHelper::AddFtn (const T &fec, const Ptr<NextHopGroup> &group, const NhlfeSelectionPolicyHelper& policy)
+{
+  Ptr<FecToNhlfe> ftn = Create<FecToNhlfe> (Fec::Build (fec), group, policy.Create ());
+  GetNode ()->GetFtnTable ()->push_back (ftn);
+  return ftn;
+}
+
 template<class T>
 Ptr<FecToNhlfe> 
 MplsFtnHelper::AddFtn (const T &fec, const Nhlfe &nhlfe)
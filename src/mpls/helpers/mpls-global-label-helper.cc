@@ -0,0 +1,645 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010-2011 Andrey Churin, Stefano Avallone
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Andrey Churin <aachurin@gmail.com>
+ *         Stefano Avallone <stavallo@gmail.com>
+ */
+
+#include <algorithm>
+#include <queue>
+#include <set>
+#include <functional>
+
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/ipv4.h"
+#include "ns3/mpls-fec.h"
+#include "ns3/mpls-nhlfe.h"
+#include "ns3/mpls-operations.h"
+
+#include "mpls-global-label-helper.h"
+
+NS_LOG_COMPONENT_DEFINE ("MplsGlobalLabelHelper");
+
+namespace ns3 {
+
+using namespace mpls;
+
+MplsGlobalLabelHelper::MplsGlobalLabelHelper ()
+  : m_policy (),
+    m_nChangedEntries (0),
+    m_recomputeTime (0)
+{
+}
+
+MplsGlobalLabelHelper::~MplsGlobalLabelHelper ()
+{
+}
+
+void
+MplsGlobalLabelHelper::SetSelectionPolicy (const NhlfeSelectionPolicyHelper &policy)
+{
+  m_policy = policy;
+}
+
+uint32_t
+MplsGlobalLabelHelper::GetNIlm (void) const
+{
+  return m_lsps.size ();
+}
+
+uint32_t
+MplsGlobalLabelHelper::GetNFtn (void) const
+{
+  uint32_t n = 0;
+  for (std::vector<Ptr<FecToNhlfe> >::const_iterator i = m_ftns.begin (); i != m_ftns.end (); ++i)
+    {
+      n += (*i != 0);
+    }
+  return n;
+}
+
+bool
+MplsGlobalLabelHelper::GetLabel (Ptr<Node> node, Ptr<Node> egress, Label &label) const
+{
+  uint32_t nodeId = node->GetId ();
+  uint32_t egressId = egress->GetId ();
+  if (nodeId >= m_index.size () || egressId >= m_index.size () || m_index[nodeId] < 0 || m_index[egressId] < 0)
+    {
+      return false;
+    }
+
+  uint32_t i = m_index[nodeId];
+  uint32_t e = m_index[egressId];
+  if (m_lsps.find (std::make_pair (e, i)) == m_lsps.end ())
+    {
+      return false;
+    }
+
+  label = Label (m_labelBase[i] + e);
+  return true;
+}
+
+uint32_t
+MplsGlobalLabelHelper::GetNChangedEntries (void) const
+{
+  return m_nChangedEntries;
+}
+
+int64_t
+MplsGlobalLabelHelper::GetRecomputeTime (void) const
+{
+  return m_recomputeTime;
+}
+
+void
+MplsGlobalLabelHelper::PopulateLabelTables (const MplsNetworkDiscoverer &network)
+{
+  NS_LOG_FUNCTION (this);
+
+  SystemWallClockMs clock;
+  clock.Start ();
+
+  ClearLabelTables ();
+  BuildGraph (network);
+
+  uint32_t nNodes = m_switches.size ();
+  uint32_t nPrefixes = m_prefixes.size ();
+
+  m_labelBase.resize (nNodes);
+  for (uint32_t i = 0; i < nNodes; ++i)
+    {
+      m_labelBase[i] = m_switches[i].GetNode ()->GetLabelSpace (0)->Allocate (nNodes);
+    }
+
+  m_ftns.assign (nNodes * nPrefixes, 0);
+
+  std::vector<uint32_t> dist (nNodes);
+  std::vector<int32_t> parent (nNodes);
+
+  m_nChangedEntries = 0;
+  for (uint32_t egress = 0; egress < nNodes; ++egress)
+    {
+      ComputeTree (egress, dist, parent);
+
+      for (uint32_t node = 0; node < nNodes; ++node)
+        {
+          m_nChangedEntries += Install (node, egress, parent[node]);
+        }
+    }
+
+  m_recomputeTime = clock.End ();
+
+  NS_LOG_DEBUG ("Installed " << GetNIlm () << " ILM and " << GetNFtn () << " FTN entries on " <<
+                nNodes << " nodes in " << m_recomputeTime << "ms");
+}
+
+void
+MplsGlobalLabelHelper::NotifyLinkDown (Ptr<Interface> interface)
+{
+  NS_LOG_FUNCTION (this << interface);
+
+  std::vector<uint32_t> failed;
+  for (uint32_t i = 0; i < m_links.size (); ++i)
+    {
+      if (m_linkUp[i] && (m_links[i].interface == interface || m_links[i].remote == interface))
+        {
+          failed.push_back (i);
+        }
+    }
+
+  Update (failed);
+}
+
+void
+MplsGlobalLabelHelper::NotifyNodeDown (Ptr<Node> node)
+{
+  NS_LOG_FUNCTION (this << node);
+
+  std::vector<uint32_t> failed;
+  for (uint32_t i = 0; i < m_links.size (); ++i)
+    {
+      if (m_linkUp[i] && (m_switches[m_links[i].from].GetNode () == node ||
+                          m_switches[m_links[i].to].GetNode () == node))
+        {
+          failed.push_back (i);
+        }
+    }
+
+  Update (failed);
+}
+
+void
+MplsGlobalLabelHelper::Update (const std::vector<uint32_t> &failed)
+{
+  SystemWallClockMs clock;
+  clock.Start ();
+
+  for (std::vector<uint32_t>::const_iterator i = failed.begin (); i != failed.end (); ++i)
+    {
+      m_linkUp[*i] = false;
+    }
+
+  uint32_t nNodes = m_switches.size ();
+  std::vector<uint32_t> dist (nNodes);
+  std::vector<int32_t> parent (nNodes);
+
+  m_nChangedEntries = 0;
+  for (uint32_t egress = 0; egress < nNodes && !failed.empty (); ++egress)
+    {
+      m_nChangedEntries += RepairTree (egress, failed, dist, parent);
+    }
+
+  m_recomputeTime = clock.End ();
+
+  NS_LOG_DEBUG (failed.size () << " links down, " << m_nChangedEntries << " entries changed in " <<
+                m_recomputeTime << "ms");
+}
+
+void
+MplsGlobalLabelHelper::ClearLabelTables (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  uint32_t nNodes = m_labelBase.size ();
+  uint32_t nPrefixes = m_prefixes.size ();
+
+  for (uint32_t i = 0; i < nNodes; ++i)
+    {
+      Ptr<MplsNode> node = m_switches[i].GetNode ();
+      uint32_t base = m_labelBase[i];
+
+      // every label of the block belongs to us, so the table is filtered in a single pass
+      MplsNode::IlmTable *ilmTable = node->GetIlmTable ();
+      for (MplsNode::IlmTable::iterator j = ilmTable->begin (); j != ilmTable->end (); )
+        {
+          uint32_t label = (*j)->GetLabel ();
+          if (label >= base && label < base + nNodes)
+            {
+              j = ilmTable->erase (j);
+            }
+          else
+            {
+              ++j;
+            }
+        }
+
+      std::set<FecToNhlfe*> ftns;
+      for (uint32_t j = i * nPrefixes; j < (i + 1) * nPrefixes; ++j)
+        {
+          if (m_ftns[j] != 0)
+            {
+              ftns.insert (PeekPointer (m_ftns[j]));
+            }
+        }
+
+      MplsNode::FtnTable *ftnTable = node->GetFtnTable ();
+      for (MplsNode::FtnTable::iterator j = ftnTable->begin (); !ftns.empty () && j != ftnTable->end (); )
+        {
+          if (ftns.erase (PeekPointer (*j)))
+            {
+              j = ftnTable->erase (j);
+            }
+          else
+            {
+              ++j;
+            }
+        }
+
+      node->GetLabelSpace (0)->Deallocate (base, nNodes);
+    }
+
+  m_switches.clear ();
+  m_index.clear ();
+  m_links.clear ();
+  m_linkUp.clear ();
+  m_inBegin.clear ();
+  m_inLinks.clear ();
+  m_outBegin.clear ();
+  m_outLinks.clear ();
+  m_prefixes.clear ();
+  m_prefixBegin.clear ();
+  m_labelBase.clear ();
+  m_lsps.clear ();
+  m_ftns.clear ();
+}
+
+void
+MplsGlobalLabelHelper::BuildGraph (const MplsNetworkDiscoverer &network)
+{
+  const NodeContainer &nodes = network.GetNetworkNodes ();
+
+  uint32_t maxId = 0;
+  for (NodeContainer::Iterator i = nodes.Begin (); i != nodes.End (); ++i)
+    {
+      maxId = std::max (maxId, (*i)->GetId ());
+    }
+
+  m_index.assign (maxId + 1, -1);
+
+  m_prefixBegin.push_back (0);
+  for (NodeContainer::Iterator i = nodes.Begin (); i != nodes.End (); ++i)
+    {
+      m_index[(*i)->GetId ()] = m_switches.size ();
+      m_switches.push_back (MplsSwitch (*i));
+      m_switches.back ().SetSelectionPolicy (m_policy);
+
+      Ptr<Ipv4> ipv4 = m_switches.back ().GetMpls ()->GetIpv4 ();
+      for (uint32_t j = 0; j < ipv4->GetNInterfaces (); ++j)
+        {
+          for (uint32_t k = 0; k < ipv4->GetNAddresses (j); ++k)
+            {
+              Ipv4Address address = ipv4->GetAddress (j, k).GetLocal ();
+              if (address != Ipv4Address::GetLoopback ())
+                {
+                  m_prefixes.push_back (address);
+                }
+            }
+        }
+      m_prefixBegin.push_back (m_prefixes.size ());
+    }
+
+  Ptr<const MplsTopology> topology = network.GetTopology ();
+  NS_ASSERT_MSG (topology != 0, "MplsGlobalLabelHelper::PopulateLabelTables (): Call DiscoverNetwork first");
+
+  for (uint32_t i = 0; i < topology->GetNLinks (); ++i)
+    {
+      const MplsTopology::Link &topologyLink = topology->GetLink (i);
+      Ptr<Interface> local = topology->GetLocalInterface (i);
+      if (!local->IsUp ())
+        {
+          continue;
+        }
+
+      Ptr<MplsNode> from = topology->GetNode (topologyLink.from);
+      Ptr<MplsNode> to = topology->GetNode (topologyLink.to);
+      if (from->GetId () > maxId || to->GetId () > maxId || m_index[from->GetId ()] < 0 || m_index[to->GetId ()] < 0)
+        {
+          continue;
+        }
+
+      Link link;
+      link.from = m_index[from->GetId ()];
+      link.to = m_index[to->GetId ()];
+      link.outIfIndex = topologyLink.localIf;
+      link.nextHop = topologyLink.nextHop;
+      link.interface = local;
+      link.remote = topology->GetRemoteInterface (i);
+      link.metric = topologyLink.metric;
+
+      m_links.push_back (link);
+    }
+
+  m_linkUp.assign (m_links.size (), true);
+
+  // incoming links of every node (SPF runs towards the egress) and outgoing links (tree repair)
+  uint32_t nNodes = m_switches.size ();
+  m_inBegin.assign (nNodes + 1, 0);
+  m_outBegin.assign (nNodes + 1, 0);
+  for (std::vector<Link>::const_iterator i = m_links.begin (); i != m_links.end (); ++i)
+    {
+      ++m_inBegin[(*i).to + 1];
+      ++m_outBegin[(*i).from + 1];
+    }
+  for (uint32_t i = 0; i < nNodes; ++i)
+    {
+      m_inBegin[i + 1] += m_inBegin[i];
+      m_outBegin[i + 1] += m_outBegin[i];
+    }
+
+  std::vector<uint32_t> inPos (m_inBegin.begin (), m_inBegin.end () - 1);
+  std::vector<uint32_t> outPos (m_outBegin.begin (), m_outBegin.end () - 1);
+  m_inLinks.resize (m_links.size ());
+  m_outLinks.resize (m_links.size ());
+  for (uint32_t i = 0; i < m_links.size (); ++i)
+    {
+      m_inLinks[inPos[m_links[i].to]++] = i;
+      m_outLinks[outPos[m_links[i].from]++] = i;
+    }
+}
+
+void
+MplsGlobalLabelHelper::ComputeTree (uint32_t egress, std::vector<uint32_t> &dist, std::vector<int32_t> &parent)
+{
+  typedef std::pair<uint32_t, uint32_t> Candidate;
+
+  std::fill (dist.begin (), dist.end (), uint32_t (-1));
+  std::fill (parent.begin (), parent.end (), -1);
+
+  std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate> > queue;
+  dist[egress] = 0;
+  queue.push (Candidate (0, egress));
+
+  while (!queue.empty ())
+    {
+      Candidate c = queue.top ();
+      queue.pop ();
+
+      if (c.first > dist[c.second])
+        {
+          continue;
+        }
+
+      for (uint32_t i = m_inBegin[c.second]; i < m_inBegin[c.second + 1]; ++i)
+        {
+          int32_t l = m_inLinks[i];
+          if (!m_linkUp[l])
+            {
+              continue;
+            }
+
+          const Link &link = m_links[l];
+          uint32_t d = c.first + link.metric;
+
+          // equal cost paths are broken by the lowest link index, so trees are reproducible
+          if (d < dist[link.from])
+            {
+              dist[link.from] = d;
+              parent[link.from] = l;
+              queue.push (Candidate (d, link.from));
+            }
+          else if (d == dist[link.from] && l < parent[link.from])
+            {
+              parent[link.from] = l;
+            }
+        }
+    }
+}
+
+uint32_t
+MplsGlobalLabelHelper::RepairTree (uint32_t egress, const std::vector<uint32_t> &failed,
+  std::vector<uint32_t> &dist, std::vector<int32_t> &parent)
+{
+  typedef std::pair<uint32_t, uint32_t> Candidate;
+
+  enum { UNKNOWN = 0, SETTLED, AFFECTED };
+
+  uint32_t nNodes = m_switches.size ();
+
+  bool used = false;
+  for (std::vector<uint32_t>::const_iterator i = failed.begin (); i != failed.end () && !used; ++i)
+    {
+      LspMap::const_iterator j = m_lsps.find (std::make_pair (egress, m_links[*i].from));
+      used = j != m_lsps.end () && j->second.parent == int32_t (*i);
+    }
+
+  if (!used)
+    {
+      return 0;
+    }
+
+  // the tree is kept only as the parent links of the installed LSPs of the egress
+  std::fill (parent.begin (), parent.end (), -1);
+  LspMap::const_iterator end = m_lsps.lower_bound (std::make_pair (egress + 1, 0u));
+  for (LspMap::const_iterator i = m_lsps.lower_bound (std::make_pair (egress, 0u)); i != end; ++i)
+    {
+      parent[i->first.second] = i->second.parent;
+    }
+
+  // split the tree into the part which still holds and the subtrees hanging on failed links,
+  // distances of the intact part are restored by walking up to the egress
+  std::vector<uint8_t> state (nNodes, UNKNOWN);
+  std::vector<uint32_t> affected;
+  std::vector<uint32_t> path;
+
+  for (uint32_t u = 0; u < nNodes; ++u)
+    {
+      uint32_t x = u;
+      while (state[x] == UNKNOWN)
+        {
+          if (parent[x] < 0)
+            {
+              state[x] = SETTLED;
+              dist[x] = x == egress ? 0 : uint32_t (-1);
+              break;
+            }
+          path.push_back (x);
+          x = m_links[parent[x]].to;
+        }
+
+      while (!path.empty ())
+        {
+          uint32_t y = path.back ();
+          path.pop_back ();
+
+          const Link &link = m_links[parent[y]];
+          if (!m_linkUp[parent[y]] || state[link.to] == AFFECTED)
+            {
+              state[y] = AFFECTED;
+              affected.push_back (y);
+            }
+          else
+            {
+              state[y] = SETTLED;
+              dist[y] = dist[link.to] + link.metric;
+            }
+        }
+    }
+
+  std::vector<int32_t> oldParent (affected.size ());
+  for (uint32_t i = 0; i < affected.size (); ++i)
+    {
+      oldParent[i] = parent[affected[i]];
+      parent[affected[i]] = -1;
+      dist[affected[i]] = uint32_t (-1);
+    }
+
+  // seed affected nodes from their intact neighbors, then run Dijkstra inside the affected part
+  std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate> > queue;
+
+  for (std::vector<uint32_t>::const_iterator i = affected.begin (); i != affected.end (); ++i)
+    {
+      uint32_t u = *i;
+      for (uint32_t j = m_outBegin[u]; j < m_outBegin[u + 1]; ++j)
+        {
+          int32_t l = m_outLinks[j];
+          const Link &link = m_links[l];
+          if (!m_linkUp[l] || state[link.to] != SETTLED || dist[link.to] == uint32_t (-1))
+            {
+              continue;
+            }
+
+          uint32_t d = dist[link.to] + link.metric;
+          if (d < dist[u] || (d == dist[u] && l < parent[u]))
+            {
+              dist[u] = d;
+              parent[u] = l;
+            }
+        }
+
+      if (parent[u] >= 0)
+        {
+          queue.push (Candidate (dist[u], u));
+        }
+    }
+
+  while (!queue.empty ())
+    {
+      Candidate c = queue.top ();
+      queue.pop ();
+
+      if (c.first > dist[c.second])
+        {
+          continue;
+        }
+
+      for (uint32_t i = m_inBegin[c.second]; i < m_inBegin[c.second + 1]; ++i)
+        {
+          int32_t l = m_inLinks[i];
+          const Link &link = m_links[l];
+          if (!m_linkUp[l] || state[link.from] != AFFECTED)
+            {
+              continue;
+            }
+
+          uint32_t d = c.first + link.metric;
+          if (d < dist[link.from])
+            {
+              dist[link.from] = d;
+              parent[link.from] = l;
+              queue.push (Candidate (d, link.from));
+            }
+          else if (d == dist[link.from] && l < parent[link.from])
+            {
+              parent[link.from] = l;
+            }
+        }
+    }
+
+  // only nodes whose next-hop has changed get new entries
+  uint32_t changes = 0;
+  for (uint32_t i = 0; i < affected.size (); ++i)
+    {
+      uint32_t u = affected[i];
+      if (parent[u] == oldParent[i])
+        {
+          continue;
+        }
+
+      uint32_t removed = Uninstall (u, egress);
+      uint32_t added = Install (u, egress, parent[u]);
+      changes += std::max (removed, added);
+    }
+
+  return changes;
+}
+
+uint32_t
+MplsGlobalLabelHelper::Uninstall (uint32_t node, uint32_t egress)
+{
+  uint32_t nPrefixes = m_prefixes.size ();
+  uint32_t removed = 0;
+
+  MplsSwitch &sw = m_switches[node];
+
+  LspMap::iterator lsp = m_lsps.find (std::make_pair (egress, node));
+  if (lsp != m_lsps.end ())
+    {
+      sw.RemoveIlm (lsp->second.ilm);
+      m_lsps.erase (lsp);
+      ++removed;
+    }
+
+  for (uint32_t i = m_prefixBegin[egress]; i < m_prefixBegin[egress + 1]; ++i)
+    {
+      Ptr<FecToNhlfe> &ftn = m_ftns[node * nPrefixes + i];
+      if (ftn != 0)
+        {
+          sw.RemoveFtn (ftn);
+          ftn = 0;
+          ++removed;
+        }
+    }
+
+  return removed;
+}
+
+uint32_t
+MplsGlobalLabelHelper::Install (uint32_t node, uint32_t egress, int32_t parent)
+{
+  uint32_t nPrefixes = m_prefixes.size ();
+
+  if (parent < 0)
+    {
+      return 0;
+    }
+
+  const Link &link = m_links[parent];
+  Label outLabel = link.to == egress ? Label (Label::IMPLICIT_NULL) : Label (m_labelBase[link.to] + egress);
+  Nhlfe nhlfe (Swap (outLabel), link.outIfIndex, link.nextHop);
+
+  MplsSwitch &sw = m_switches[node];
+  Lsp &lsp = m_lsps[std::make_pair (egress, node)];
+  lsp.parent = parent;
+  lsp.ilm = sw.AddIlm (Label (m_labelBase[node] + egress), nhlfe);
+
+  // next-hop is the egress itself, plain ip forwarding does the job
+  if (link.to == egress)
+    {
+      return 1;
+    }
+
+  for (uint32_t i = m_prefixBegin[egress]; i < m_prefixBegin[egress + 1]; ++i)
+    {
+      m_ftns[node * nPrefixes + i] = sw.AddFtn (Ipv4Destination (m_prefixes[i]), nhlfe);
+    }
+
+  return 1 + m_prefixBegin[egress + 1] - m_prefixBegin[egress];
+}
+
+} // namespace ns3
@@ -0,0 +1,169 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010-2011 Andrey Churin, Stefano Avallone
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Andrey Churin <aachurin@gmail.com>
+ *         Stefano Avallone <stavallo@gmail.com>
+ */
+
+#ifndef MPLS_GLOBAL_LABEL_HELPER_H
+#define MPLS_GLOBAL_LABEL_HELPER_H
+
+#include <map>
+#include <vector>
+
+#include "ns3/ptr.h"
+#include "ns3/node.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/mpls-interface.h"
+#include "ns3/mpls-incoming-label-map.h"
+#include "ns3/mpls-fec-to-nhlfe.h"
+
+#include "mpls-network-discoverer.h"
+#include "mpls-nhlfe-selection-policy-helper.h"
+#include "mpls-switch.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup mpls
+ * \brief Computes shortest path LSPs between all nodes of a discovered mpls network and installs
+ * them directly into ILM/FTN tables, without running a label distribution protocol.
+ *
+ * Every node is the egress for the /32 FECs of its own ipv4 addresses. One SPF tree is computed
+ * per egress (towards the egress, using ipv4 interface metrics) and shared by all ingress nodes.
+ * Every node binds one label per egress out of a single label block allocated from its label space.
+ * The penultimate hop pops the label (implicit null).
+ *
+ * SPF trees are kept after installation. When a link or a node fails, only the subtrees which
+ * were routed over the failed links are recomputed and just the ILM/FTN entries of the nodes whose
+ * next-hop has changed are replaced. NotifyLinkDown/NotifyNodeDown can be scheduled at the failure
+ * time, e.g. Simulator::Schedule (t, &MplsGlobalLabelHelper::NotifyLinkDown, &helper, iface).
+ *
+ * Only the installed LSPs are kept, keyed by (egress, node), with the parent link of the node in
+ * the SPF tree of the egress. The tree of an egress is rebuilt from them when a failure affects it.
+ * Memory grows with the number of installed LSPs rather than with nNodes * nNodes, FTNs take
+ * nNodes * nPrefixes pointers.
+ */
+class MplsGlobalLabelHelper
+{
+public:
+  MplsGlobalLabelHelper ();
+  virtual ~MplsGlobalLabelHelper ();
+
+  /**
+   * @brief Set selection policy used for installed ILM/FTN entries
+   */
+  void SetSelectionPolicy (const NhlfeSelectionPolicyHelper &policy);
+  /**
+   * @brief Compute and install LSPs between all nodes of the network
+   * @param network discoverer, DiscoverNetwork should be called first
+   */
+  void PopulateLabelTables (const MplsNetworkDiscoverer &network);
+  /**
+   * @brief Remove installed entries and release allocated labels
+   */
+  void ClearLabelTables (void);
+  /**
+   * @brief Incrementally update installed LSPs after failure of the link attached to the interface
+   * @param interface failed interface (links in both directions are considered down)
+   */
+  void NotifyLinkDown (Ptr<mpls::Interface> interface);
+  /**
+   * @brief Incrementally update installed LSPs after failure of the node
+   * @param node failed node
+   */
+  void NotifyNodeDown (Ptr<Node> node);
+  /**
+   * @brief Returns number of ILM/FTN entries replaced, added or removed by the last update
+   */
+  uint32_t GetNChangedEntries (void) const;
+  /**
+   * @brief Returns wall-clock time (in milliseconds) spent for the last update
+   */
+  int64_t GetRecomputeTime (void) const;
+  /**
+   * @brief Returns number of installed ILM entries
+   */
+  uint32_t GetNIlm (void) const;
+  /**
+   * @brief Returns number of installed FTN entries
+   */
+  uint32_t GetNFtn (void) const;
+  /**
+   * @brief Returns label bound by the node to the LSP towards the egress
+   * @param node node
+   * @param egress egress node
+   * @param label incoming label of the installed ILM (output)
+   * @return false if the node has no ILM for the egress (the egress itself or unreachable)
+   */
+  bool GetLabel (Ptr<Node> node, Ptr<Node> egress, mpls::Label &label) const;
+
+private:
+  struct Link
+  {
+    uint32_t from;
+    uint32_t to;
+    uint32_t metric;
+    int32_t outIfIndex;
+    Ipv4Address nextHop;
+    Ptr<mpls::Interface> interface;
+    Ptr<mpls::Interface> remote;
+  };
+
+  struct Lsp
+  {
+    int32_t parent;
+    Ptr<mpls::IncomingLabelMap> ilm;
+  };
+
+  // installed LSPs by (egress, node), so the LSPs of an egress are adjacent
+  typedef std::map<std::pair<uint32_t, uint32_t>, Lsp> LspMap;
+
+  void BuildGraph (const MplsNetworkDiscoverer &network);
+  void ComputeTree (uint32_t egress, std::vector<uint32_t> &dist, std::vector<int32_t> &parent);
+  uint32_t RepairTree (uint32_t egress, const std::vector<uint32_t> &failed, std::vector<uint32_t> &dist,
+                       std::vector<int32_t> &parent);
+  void Update (const std::vector<uint32_t> &failed);
+  uint32_t Install (uint32_t node, uint32_t egress, int32_t parent);
+  uint32_t Uninstall (uint32_t node, uint32_t egress);
+
+  NhlfeSelectionPolicyHelper m_policy;
+
+  std::vector<MplsSwitch> m_switches;
+  // switch index by node id, -1 for unknown nodes
+  std::vector<int32_t> m_index;
+  std::vector<Link> m_links;
+  std::vector<bool> m_linkUp;
+  std::vector<uint32_t> m_inBegin;
+  std::vector<uint32_t> m_inLinks;
+  std::vector<uint32_t> m_outBegin;
+  std::vector<uint32_t> m_outLinks;
+  std::vector<Ipv4Address> m_prefixes;
+  std::vector<uint32_t> m_prefixBegin;
+  std::vector<uint32_t> m_labelBase;
+
+  LspMap m_lsps;
+  // installed FTN entries (node * nPrefixes + prefix)
+  std::vector<Ptr<mpls::FecToNhlfe> > m_ftns;
+
+  uint32_t m_nChangedEntries;
+  int64_t m_recomputeTime;
+};
+
+} // namespace ns3
+
+#endif /* MPLS_GLOBAL_LABEL_HELPER_H */
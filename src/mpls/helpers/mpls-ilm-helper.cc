@@ -232,6 +232,33 @@ MplsIlmHelper::AddIlm (uint32_t interface, mpls::Label label, const mpls::Nhlfe
   return ilm;
 }
 
+Ptr<IncomingLabelMap>
+MplsIlmHelper::AddIlm (uint32_t interface, mpls::Label label, const Ptr<NextHopGroup> &group,
+  const NhlfeSelectionPolicyHelper &policy)
+{
+  Ptr<mpls::IncomingLabelMap> ilm = Create<mpls::IncomingLabelMap> (interface, label, group, policy.Create ());
+  GetNode ()->GetIlmTable ()->push_back (ilm);
+  return ilm;
+}
+
+Ptr<IncomingLabelMap>
+MplsIlmHelper::AddIlm (uint32_t interface, mpls::Label label, const Ptr<NextHopGroup> &group)
+{
+  return AddIlm (interface, label, group, GetSelectionPolicy ());
+}
+
+Ptr<IncomingLabelMap>
+MplsIlmHelper::AddIlm (mpls::Label label, const Ptr<NextHopGroup> &group, const NhlfeSelectionPolicyHelper &policy)
+{
+  return AddIlm (-1, label, group, policy);
+}
+
+Ptr<IncomingLabelMap>
+MplsIlmHelper::AddIlm (mpls::Label label, const Ptr<NextHopGroup> &group)
+{
+  return AddIlm (-1, label, group, GetSelectionPolicy ());
+}
+
 Ptr<IncomingLabelMap>
 MplsIlmHelper::AddIlm (uint32_t interface, mpls::Label label, const mpls::Nhlfe &nhlfe)
 {
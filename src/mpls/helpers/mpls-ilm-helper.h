@@ -23,11 +23,13 @@
 #define MPLS_ILM_HELPER_H
 
 #include "ns3/ptr.h"
+#include "ns3/assert.h"
 #include "ns3/mpls.h"
 
 #include "ns3/mpls-label.h"
 #include "ns3/mpls-incoming-label-map.h"
 #include "ns3/mpls-nhlfe.h"
+#include "ns3/mpls-next-hop-group.h"
 
 #include "mpls-node-helper-base.h"
 
@@ -41,6 +43,19 @@ using namespace mpls;
 class MplsIlmHelper : public MplsNodeHelperBase
 {
 public:
+  /**
+   * @brief ILM description used by bulk insertion
+   */
+  struct IlmEntry
+  {
+    IlmEntry (int32_t interface, Label label, uint32_t group, uint32_t policy = 0);
+
+    int32_t interface;  //!< incoming mpls interface or -1
+    Label label;        //!< incoming label
+    uint32_t group;     //!< index of the NHLFE group
+    uint32_t policy;    //!< index of the selection policy
+  };
+
   /**
    * @brief Destroy the object
    */
@@ -243,8 +258,147 @@ public:
                     const Nhlfe &nhlfe9, const Nhlfe &nhlfe10, const Nhlfe &nhlfe11,
                     const Nhlfe &nhlfe12,
                     const NhlfeSelectionPolicyHelper& policy);
+
+  /**
+   * @brief Add ILM referencing a shared NHLFE group, a change of the group applies to every ILM
+   * built on it
+   * @param interface Incoming mpls interface
+   * @param label Incoming label
+   * @param group NHLFE group
+   * @return ILM
+   */
+  Ptr<IncomingLabelMap> AddIlm (uint32_t interface, Label label, const Ptr<NextHopGroup> &group);
+  Ptr<IncomingLabelMap> AddIlm (uint32_t interface, Label label, const Ptr<NextHopGroup> &group,
+                    const NhlfeSelectionPolicyHelper &policy);
+  Ptr<IncomingLabelMap> AddIlm (Label label, const Ptr<NextHopGroup> &group);
+  Ptr<IncomingLabelMap> AddIlm (Label label, const Ptr<NextHopGroup> &group,
+                    const NhlfeSelectionPolicyHelper &policy);
+
+  /**
+   * @brief Add ILMs described by the range of IlmEntry
+   *
+   * NHLFEs of the groups are interned in the node NHLFE pool, every ILM keeps ids of the referenced
+   * group and the referenced policy object. The ILM lookup index is rebuilt once, after the whole
+   * range has been added.
+   *
+   * @param begin, end range of IlmEntry
+   * @param groups NHLFE groups referenced by the entries
+   * @param policies selection policies referenced by the entries
+   * @return number of added ILMs
+   */
+  template <class Iterator>
+  uint32_t AddIlms (Iterator begin, Iterator end, const NhlfeGroupVector &groups,
+                    const PolicyVector &policies);
+  /**
+   * @brief Add ILMs described by the range of IlmEntry with the default selection policy (policy
+   * index of the entries is ignored)
+   */
+  template <class Iterator>
+  uint32_t AddIlms (Iterator begin, Iterator end, const NhlfeGroupVector &groups);
+  /**
+   * @brief Add ILMs described by the range of IlmEntry to the flat label forwarding table of the node
+   * (one entry per label). Use FlatLfib::GetIlm to get an IncomingLabelMap of an entry
+   * @return number of added entries
+   */
+  template <class Iterator>
+  uint32_t AddFlatIlms (Iterator begin, Iterator end, const NhlfeGroupVector &groups,
+                        const PolicyVector &policies);
 };
 
+inline
+MplsIlmHelper::IlmEntry::IlmEntry (int32_t interface, Label label, uint32_t group, uint32_t policy)
+  : interface (interface),
+    label (label),
+    group (group),
+    policy (policy)
+{
+}
+
+template <class Iterator>
+uint32_t
+MplsIlmHelper::AddIlms (Iterator begin, Iterator end, const NhlfeGroupVector &groups,
+                        const PolicyVector &policies)
+{
+  const Ptr<MplsNode> &node = GetNode ();
+  MplsNode::IlmTable *table = node->GetIlmTable ();
+  const Ptr<NhlfePool> &pool = node->GetNhlfePool ();
+  std::vector<NhlfeIdVector> ids;
+  InternNhlfeGroups (pool, groups, ids);
+  uint32_t count = 0;
+
+  for (Iterator i = begin; i != end; ++i, ++count)
+    {
+      const IlmEntry &entry = *i;
+      NS_ASSERT_MSG (entry.group < groups.size (), "MplsIlmHelper::AddIlms (): invalid NHLFE group");
+      NS_ASSERT_MSG (entry.policy < policies.size (), "MplsIlmHelper::AddIlms (): invalid policy");
+      table->push_back (Create<IncomingLabelMap> (entry.interface, entry.label, pool, ids[entry.group],
+                                                  policies[entry.policy]));
+    }
+
+  node->RebuildIlmIndex ();
+  return count;
+}
+
+template <class Iterator>
+uint32_t
+MplsIlmHelper::AddIlms (Iterator begin, Iterator end, const NhlfeGroupVector &groups)
+{
+  const Ptr<MplsNode> &node = GetNode ();
+  MplsNode::IlmTable *table = node->GetIlmTable ();
+  const Ptr<NhlfePool> &pool = node->GetNhlfePool ();
+  std::vector<NhlfeIdVector> ids;
+  InternNhlfeGroups (pool, groups, ids);
+  const Ptr<NhlfeSelectionPolicy> policy = GetSelectionPolicy ().Create ();
+  uint32_t count = 0;
+
+  for (Iterator i = begin; i != end; ++i, ++count)
+    {
+      const IlmEntry &entry = *i;
+      NS_ASSERT_MSG (entry.group < groups.size (), "MplsIlmHelper::AddIlms (): invalid NHLFE group");
+      table->push_back (Create<IncomingLabelMap> (entry.interface, entry.label, pool, ids[entry.group], policy));
+    }
+
+  node->RebuildIlmIndex ();
+  return count;
+}
+
+template <class Iterator>
+uint32_t
+MplsIlmHelper::AddFlatIlms (Iterator begin, Iterator end, const NhlfeGroupVector &groups,
+                            const PolicyVector &policies)
+{
+  const Ptr<MplsNode> &node = GetNode ();
+  const Ptr<FlatLfib> &lfib = node->GetFlatLfib ();
+
+  std::vector<NhlfeIdVector> ids;
+  InternNhlfeGroups (node->GetNhlfePool (), groups, ids);
+
+  std::vector<uint32_t> groupIds;
+  groupIds.reserve (ids.size ());
+  for (std::vector<NhlfeIdVector>::const_iterator i = ids.begin (); i != ids.end (); ++i)
+    {
+      groupIds.push_back (lfib->AddGroup (*i));
+    }
+
+  std::vector<uint32_t> policyIds;
+  policyIds.reserve (policies.size ());
+  for (PolicyVector::const_iterator i = policies.begin (); i != policies.end (); ++i)
+    {
+      policyIds.push_back (lfib->AddPolicy (*i));
+    }
+
+  uint32_t count = 0;
+  for (Iterator i = begin; i != end; ++i, ++count)
+    {
+      const IlmEntry &entry = *i;
+      NS_ASSERT_MSG (entry.group < groups.size (), "MplsIlmHelper::AddFlatIlms (): invalid NHLFE group");
+      NS_ASSERT_MSG (entry.policy < policies.size (), "MplsIlmHelper::AddFlatIlms (): invalid policy");
+      lfib->Add (entry.interface, entry.label, groupIds[entry.group], policyIds[entry.policy]);
+    }
+
+  return count;
+}
+
 } // namespace ns3
 
 #endif /* MPLS_ILM_HELPER_H */
@@ -49,6 +49,7 @@ using namespace mpls;
 MplsInstaller::MplsInstaller ()
   : m_routing (0)
 {
+  Initialize ();
   SetTcp ("ns3::TcpL4Protocol");
   Ipv4StaticRoutingHelper staticRouting;
   Ipv4GlobalRoutingHelper globalRouting;
@@ -67,6 +68,11 @@ MplsInstaller::MplsInstaller (const MplsInstaller &o)
 {
   m_networkNodes = o.m_networkNodes;
   m_routing = o.m_routing->Copy ();
+  m_mplsFactory = o.m_mplsFactory;
+  m_ipv4Factory = o.m_ipv4Factory;
+  m_arpFactory = o.m_arpFactory;
+  m_icmpFactory = o.m_icmpFactory;
+  m_udpFactory = o.m_udpFactory;
   m_tcpFactory = o.m_tcpFactory;
 }
 
@@ -78,7 +84,14 @@ MplsInstaller::operator= (const MplsInstaller &o)
       return *this;
     }
   m_networkNodes = o.m_networkNodes;
+  delete m_routing;
   m_routing = o.m_routing->Copy ();
+  m_mplsFactory = o.m_mplsFactory;
+  m_ipv4Factory = o.m_ipv4Factory;
+  m_arpFactory = o.m_arpFactory;
+  m_icmpFactory = o.m_icmpFactory;
+  m_udpFactory = o.m_udpFactory;
+  m_tcpFactory = o.m_tcpFactory;
   return *this;
 }
 
@@ -102,12 +115,14 @@ MplsInstaller::SetTcp (const std::string tid)
 }
 
 void
-MplsInstaller::CreateAndAggregateObjectFromTypeId (Ptr<MplsNode> node, const std::string typeId)
+MplsInstaller::Initialize (void)
 {
-  ObjectFactory factory;
-  factory.SetTypeId (typeId);
-  Ptr<Object> protocol = factory.Create <Object> ();
-  node->AggregateObject (protocol);
+  // type ids are looked up by name once, not for every installed node
+  m_mplsFactory.SetTypeId ("ns3::mpls::MplsProtocol");
+  m_ipv4Factory.SetTypeId ("ns3::mpls::Ipv4Protocol");
+  m_arpFactory.SetTypeId ("ns3::ArpL3Protocol");
+  m_icmpFactory.SetTypeId ("ns3::Icmpv4L4Protocol");
+  m_udpFactory.SetTypeId ("ns3::UdpL4Protocol");
 }
 
 NodeContainer
@@ -136,15 +151,18 @@ MplsInstaller::InstallInternal (Ptr<MplsNode> node)
       return;
     }
 
-  CreateAndAggregateObjectFromTypeId (node, "ns3::mpls::MplsProtocol");
-  CreateAndAggregateObjectFromTypeId (node, "ns3::mpls::Ipv4Protocol");
-  CreateAndAggregateObjectFromTypeId (node, "ns3::ArpL3Protocol");
-  CreateAndAggregateObjectFromTypeId (node, "ns3::Icmpv4L4Protocol");
-  CreateAndAggregateObjectFromTypeId (node, "ns3::UdpL4Protocol");
-
-  node->AggregateObject (m_tcpFactory.Create<Object> ());
-  Ptr<PacketSocketFactory> factory = CreateObject<PacketSocketFactory> ();
-  node->AggregateObject (factory);
+  // protocols are aggregated with each other before they are aggregated onto the node. Each
+  // AggregateObject call notifies every object of the aggregate, but protocols complete their setup
+  // only when they see the node, so notifications issued before that do little work.
+  // Mpls goes first, mpls::Ipv4Protocol looks for it when aggregated
+  Ptr<Object> protocols = m_mplsFactory.Create<Object> ();
+  protocols->AggregateObject (m_ipv4Factory.Create<Object> ());
+  protocols->AggregateObject (m_arpFactory.Create<Object> ());
+  protocols->AggregateObject (m_icmpFactory.Create<Object> ());
+  protocols->AggregateObject (m_udpFactory.Create<Object> ());
+  protocols->AggregateObject (m_tcpFactory.Create<Object> ());
+  protocols->AggregateObject (CreateObject<PacketSocketFactory> ());
+  node->AggregateObject (protocols);
 
   Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
   Ptr<Ipv4RoutingProtocol> ipv4Routing = m_routing->Create (node);
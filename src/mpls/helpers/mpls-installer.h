@@ -70,6 +70,16 @@ public:
    */
   void SetTcp(std::string tid);
 
+  /**
+   * @brief Create nodes and aggregate MPLS, IPv4, TCP, UDP and ARP onto them.
+   *
+   * Protocol factories are resolved once per installer. Protocols of a node are aggregated with
+   * each other first and then onto the node in one step. Every aggregation still notifies the
+   * whole aggregate, but protocols do their node-dependent setup only once the node is there.
+   *
+   * @param count number of nodes
+   * @return created nodes
+   */
   NodeContainer CreateAndInstall (uint32_t count);
 
   /**
@@ -92,8 +102,11 @@ private:
   void Initialize (void);
   void InstallInternal (Ptr<MplsNode> node);
 
-  static void CreateAndAggregateObjectFromTypeId (Ptr<MplsNode> node, const std::string typeId);
-  
+  ObjectFactory m_mplsFactory;
+  ObjectFactory m_ipv4Factory;
+  ObjectFactory m_arpFactory;
+  ObjectFactory m_icmpFactory;
+  ObjectFactory m_udpFactory;
   ObjectFactory m_tcpFactory;
   const Ipv4RoutingHelper *m_routing;
   
@@ -0,0 +1,287 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010-2011 Andrey Churin, Stefano Avallone
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Andrey Churin <aachurin@gmail.com>
+ *         Stefano Avallone <stavallo@gmail.com>
+ */
+
+#ifndef MPLS_IPV4_ADDRESS_MAP_H
+#define MPLS_IPV4_ADDRESS_MAP_H
+
+#include <vector>
+#include <utility>
+
+#include "ns3/ipv4-address.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup mpls
+ * \brief Map from ipv4 addresses to values based on an open addressing hash table.
+ *
+ * Entries are kept in a dense vector in insertion order, so iteration does not chase pointers.
+ * The table itself holds entry positions only and is probed linearly, it is kept at most half full.
+ * An erased entry is replaced by the last one and the probe chain is shifted back, so the map does
+ * not keep tombstones (erasing changes the iteration order).
+ */
+template <class T>
+class Ipv4AddressMap
+{
+public:
+  typedef std::pair<Ipv4Address, T> Entry;
+  typedef typename std::vector<Entry>::iterator Iterator;
+  typedef typename std::vector<Entry>::const_iterator ConstIterator;
+
+  Ipv4AddressMap ();
+
+  /**
+   * @brief Returns value mapped to the address, a default value is inserted if there is none
+   */
+  T& operator[] (const Ipv4Address &address);
+  /**
+   * @brief Returns value mapped to the address or 0
+   */
+  T* Find (const Ipv4Address &address);
+  const T* Find (const Ipv4Address &address) const;
+  /**
+   * @brief Remove value mapped to the address
+   * @return false if there is none
+   */
+  bool Erase (const Ipv4Address &address);
+  /**
+   * @brief Prepare map for the specified number of entries
+   */
+  void Reserve (uint32_t n);
+  /**
+   * @brief Remove all entries
+   */
+  void Clear (void);
+  /**
+   * @brief Returns number of entries
+   */
+  uint32_t GetSize (void) const;
+
+  Iterator Begin (void);
+  Iterator End (void);
+  ConstIterator Begin (void) const;
+  ConstIterator End (void) const;
+
+private:
+  uint32_t GetHome (const Ipv4Address &address) const;
+  uint32_t Probe (const Ipv4Address &address) const;
+  void Rehash (uint32_t bits);
+
+  std::vector<Entry> m_entries;
+  // position of the entry plus one, zero marks an empty slot
+  std::vector<uint32_t> m_slots;
+  uint32_t m_bits;
+};
+
+template <class T>
+Ipv4AddressMap<T>::Ipv4AddressMap ()
+  : m_bits (0)
+{
+}
+
+template <class T>
+T&
+Ipv4AddressMap<T>::operator[] (const Ipv4Address &address)
+{
+  if ((m_entries.size () + 1) * 2 > m_slots.size ())
+    {
+      Rehash (m_bits < 4 ? 4 : m_bits + 1);
+    }
+
+  uint32_t slot = Probe (address);
+  if (m_slots[slot] == 0)
+    {
+      m_entries.push_back (Entry (address, T ()));
+      m_slots[slot] = m_entries.size ();
+    }
+
+  return m_entries[m_slots[slot] - 1].second;
+}
+
+template <class T>
+T*
+Ipv4AddressMap<T>::Find (const Ipv4Address &address)
+{
+  if (m_slots.empty ())
+    {
+      return 0;
+    }
+
+  uint32_t slot = Probe (address);
+  return m_slots[slot] != 0 ? &m_entries[m_slots[slot] - 1].second : 0;
+}
+
+template <class T>
+const T*
+Ipv4AddressMap<T>::Find (const Ipv4Address &address) const
+{
+  if (m_slots.empty ())
+    {
+      return 0;
+    }
+
+  uint32_t slot = Probe (address);
+  return m_slots[slot] != 0 ? &m_entries[m_slots[slot] - 1].second : 0;
+}
+
+template <class T>
+bool
+Ipv4AddressMap<T>::Erase (const Ipv4Address &address)
+{
+  if (m_slots.empty ())
+    {
+      return false;
+    }
+
+  uint32_t slot = Probe (address);
+  if (m_slots[slot] == 0)
+    {
+      return false;
+    }
+
+  // the last entry fills the hole, so entries stay dense
+  uint32_t pos = m_slots[slot] - 1;
+  uint32_t last = m_entries.size () - 1;
+  if (pos != last)
+    {
+      m_slots[Probe (m_entries[last].first)] = pos + 1;
+      m_entries[pos] = m_entries[last];
+    }
+  m_entries.pop_back ();
+
+  // entries probed past the freed slot are shifted back unless their home slot follows the hole
+  uint32_t mask = m_slots.size () - 1;
+  uint32_t hole = slot;
+  m_slots[hole] = 0;
+  for (uint32_t i = (hole + 1) & mask; m_slots[i] != 0; i = (i + 1) & mask)
+    {
+      uint32_t home = GetHome (m_entries[m_slots[i] - 1].first);
+      if (((i - home) & mask) >= ((i - hole) & mask))
+        {
+          m_slots[hole] = m_slots[i];
+          m_slots[i] = 0;
+          hole = i;
+        }
+    }
+
+  return true;
+}
+
+template <class T>
+void
+Ipv4AddressMap<T>::Reserve (uint32_t n)
+{
+  uint32_t bits = 4;
+  while ((uint32_t (1) << bits) < n * 2)
+    {
+      ++bits;
+    }
+
+  m_entries.reserve (n);
+  if (bits > m_bits)
+    {
+      Rehash (bits);
+    }
+}
+
+template <class T>
+void
+Ipv4AddressMap<T>::Clear (void)
+{
+  m_entries.clear ();
+  m_slots.clear ();
+  m_bits = 0;
+}
+
+template <class T>
+uint32_t
+Ipv4AddressMap<T>::GetSize (void) const
+{
+  return m_entries.size ();
+}
+
+template <class T>
+typename Ipv4AddressMap<T>::Iterator
+Ipv4AddressMap<T>::Begin (void)
+{
+  return m_entries.begin ();
+}
+
+template <class T>
+typename Ipv4AddressMap<T>::Iterator
+Ipv4AddressMap<T>::End (void)
+{
+  return m_entries.end ();
+}
+
+template <class T>
+typename Ipv4AddressMap<T>::ConstIterator
+Ipv4AddressMap<T>::Begin (void) const
+{
+  return m_entries.begin ();
+}
+
+template <class T>
+typename Ipv4AddressMap<T>::ConstIterator
+Ipv4AddressMap<T>::End (void) const
+{
+  return m_entries.end ();
+}
+
+template <class T>
+uint32_t
+Ipv4AddressMap<T>::GetHome (const Ipv4Address &address) const
+{
+  // fibonacci hashing, addresses of one subnet differ in the low bits only
+  return (address.Get () * 0x9e3779b1u) >> (32 - m_bits);
+}
+
+template <class T>
+uint32_t
+Ipv4AddressMap<T>::Probe (const Ipv4Address &address) const
+{
+  uint32_t mask = m_slots.size () - 1;
+  uint32_t slot = GetHome (address);
+
+  while (m_slots[slot] != 0 && m_entries[m_slots[slot] - 1].first != address)
+    {
+      slot = (slot + 1) & mask;
+    }
+
+  return slot;
+}
+
+template <class T>
+void
+Ipv4AddressMap<T>::Rehash (uint32_t bits)
+{
+  m_bits = bits;
+  m_slots.assign (uint32_t (1) << bits, 0);
+
+  for (uint32_t i = 0; i < m_entries.size (); ++i)
+    {
+      m_slots[Probe (m_entries[i].first)] = i + 1;
+    }
+}
+
+} // namespace ns3
+
+#endif /* MPLS_IPV4_ADDRESS_MAP_H */
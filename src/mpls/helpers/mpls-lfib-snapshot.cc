@@ -0,0 +1,926 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010-2011 Andrey Churin, Stefano Avallone
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Andrey Churin <aachurin@gmail.com>
+ *         Stefano Avallone <stavallo@gmail.com>
+ */
+
+#include <map>
+#include <vector>
+#include <sstream>
+#include <fstream>
+#include <cstring>
+
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ns3/string.h"
+#include "ns3/object-factory.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/mpls.h"
+#include "ns3/mpls-interface.h"
+#include "ns3/mpls-nhlfe-selection-policy.h"
+
+#include "mpls-lfib-snapshot.h"
+
+NS_LOG_COMPONENT_DEFINE ("MplsLfibSnapshot");
+
+namespace ns3 {
+
+using namespace mpls;
+
+namespace {
+
+const char MAGIC[8] = { 'M', 'P', 'L', 'S', 'L', 'F', 'I', 'B' };
+
+// all numbers are written in network byte order
+class Writer
+{
+public:
+  Writer (std::ostream &os) : m_os (os) {}
+
+  void WriteU8 (uint8_t value)
+  {
+    m_os.put (value);
+  }
+
+  void WriteU32 (uint32_t value)
+  {
+    char buf[4] = { char (value >> 24), char (value >> 16), char (value >> 8), char (value) };
+    m_os.write (buf, 4);
+  }
+
+  void WriteU64 (uint64_t value)
+  {
+    WriteU32 (value >> 32);
+    WriteU32 (value);
+  }
+
+  void WriteString (const std::string &value)
+  {
+    WriteU32 (value.size ());
+    m_os.write (value.data (), value.size ());
+  }
+
+  void WriteBytes (const uint8_t *buf, uint32_t size)
+  {
+    m_os.write ((const char*)buf, size);
+  }
+
+private:
+  std::ostream &m_os;
+};
+
+class Reader
+{
+public:
+  Reader (std::istream &is) : m_is (is) {}
+
+  uint8_t ReadU8 (void)
+  {
+    return uint8_t (m_is.get ());
+  }
+
+  uint32_t ReadU32 (void)
+  {
+    unsigned char buf[4] = { 0, 0, 0, 0 };
+    m_is.read ((char*)buf, 4);
+    return (uint32_t (buf[0]) << 24) | (uint32_t (buf[1]) << 16) | (uint32_t (buf[2]) << 8) | buf[3];
+  }
+
+  uint64_t ReadU64 (void)
+  {
+    uint64_t high = ReadU32 ();
+    return (high << 32) | ReadU32 ();
+  }
+
+  bool ReadString (std::string &value)
+  {
+    uint32_t size = ReadU32 ();
+    // strings are type ids, attribute names and values
+    if (!m_is || size > 0x10000)
+      {
+        return false;
+      }
+    value.resize (size);
+    if (size > 0)
+      {
+        m_is.read (&value[0], size);
+      }
+    return IsOk ();
+  }
+
+  void ReadBytes (uint8_t *buf, uint32_t size)
+  {
+    m_is.read ((char*)buf, size);
+  }
+
+  bool IsOk (void) const
+  {
+    return !m_is.fail ();
+  }
+
+  std::istream& GetStream (void)
+  {
+    return m_is;
+  }
+
+private:
+  std::istream &m_is;
+};
+
+uint64_t
+DoubleToBits (double value)
+{
+  uint64_t bits;
+  std::memcpy (&bits, &value, sizeof (bits));
+  return bits;
+}
+
+double
+BitsToDouble (uint64_t bits)
+{
+  double value;
+  std::memcpy (&value, &bits, sizeof (value));
+  return value;
+}
+
+/*
+ * Policy parameters: type id, attributes which can be set at construction and weights
+ */
+std::string
+SerializePolicy (const Ptr<NhlfeSelectionPolicy> &policy)
+{
+  std::ostringstream os;
+  Writer w (os);
+
+  TypeId tid = policy->GetInstanceTypeId ();
+  w.WriteString (tid.GetName ());
+
+  std::vector<std::pair<std::string, std::string> > attributes;
+  for (TypeId t = tid; ; t = t.GetParent ())
+    {
+      for (uint32_t i = 0; i < t.GetAttributeN (); ++i)
+        {
+          struct TypeId::AttributeInformation info = t.GetAttribute (i);
+          if ((info.flags & TypeId::ATTR_GET) && (info.flags & TypeId::ATTR_CONSTRUCT))
+            {
+              StringValue value;
+              policy->GetAttribute (info.name, value);
+              attributes.push_back (std::make_pair (info.name, value.Get ()));
+            }
+        }
+
+      if (t == NhlfeSelectionPolicy::GetTypeId () || t == t.GetParent ())
+        {
+          break;
+        }
+    }
+
+  w.WriteU32 (attributes.size ());
+  for (std::vector<std::pair<std::string, std::string> >::const_iterator i = attributes.begin ();
+       i != attributes.end (); ++i)
+    {
+      w.WriteString ((*i).first);
+      w.WriteString ((*i).second);
+    }
+
+  Ptr<WeightedPolicy> weighted = DynamicCast<WeightedPolicy> (policy);
+  if (weighted != 0)
+    {
+      const std::vector<double> &weights = weighted->GetWeights ();
+      w.WriteU32 (weights.size ());
+      for (std::vector<double>::const_iterator i = weights.begin (); i != weights.end (); ++i)
+        {
+          w.WriteU64 (DoubleToBits (*i));
+        }
+    }
+  else
+    {
+      w.WriteU32 (0);
+    }
+
+  return os.str ();
+}
+
+class PolicyFactory
+{
+public:
+  bool Deserialize (Reader &r)
+  {
+    std::string name;
+    if (!r.ReadString (name))
+      {
+        return false;
+      }
+
+    TypeId tid;
+    TypeId base = NhlfeSelectionPolicy::GetTypeId ();
+    if (!TypeId::LookupByNameFailSafe (name, &tid) || (tid != base && !tid.IsChildOf (base)))
+      {
+        NS_LOG_WARN ("Unknown selection policy " << name);
+        return false;
+      }
+    m_factory.SetTypeId (tid);
+
+    uint32_t nAttributes = r.ReadU32 ();
+    for (uint32_t i = 0; i < nAttributes && r.IsOk (); ++i)
+      {
+        std::string attribute;
+        std::string value;
+        struct TypeId::AttributeInformation info;
+        if (!r.ReadString (attribute) || !r.ReadString (value) || !tid.LookupAttributeByName (attribute, &info))
+          {
+            return false;
+          }
+        m_factory.Set (attribute, StringValue (value));
+      }
+
+    uint32_t nWeights = r.ReadU32 ();
+    if (nWeights > 0 && tid != WeightedPolicy::GetTypeId () && !tid.IsChildOf (WeightedPolicy::GetTypeId ()))
+      {
+        NS_LOG_WARN ("Weights of not weighted selection policy " << name);
+        return false;
+      }
+    for (uint32_t i = 0; i < nWeights && r.IsOk (); ++i)
+      {
+        m_weights.push_back (BitsToDouble (r.ReadU64 ()));
+      }
+
+    return r.IsOk ();
+  }
+
+  // policies hold no per-entry state, so one instance serves all entries referencing it
+  Ptr<NhlfeSelectionPolicy> Create (void) const
+  {
+    if (m_policy == 0)
+      {
+        m_policy = m_factory.Create<NhlfeSelectionPolicy> ();
+        if (!m_weights.empty ())
+          {
+            Ptr<WeightedPolicy> weighted = DynamicCast<WeightedPolicy> (m_policy);
+            NS_ASSERT (weighted != 0);
+            weighted->SetWeights (m_weights);
+          }
+      }
+    return m_policy;
+  }
+
+private:
+  ObjectFactory m_factory;
+  std::vector<double> m_weights;
+  mutable Ptr<NhlfeSelectionPolicy> m_policy;
+};
+
+struct LabelSpaceState
+{
+  uint32_t min;
+  uint32_t max;
+  uint32_t srgbBase;
+  uint32_t srgbSize;
+  LabelSpace::RangeVector ranges;
+};
+
+struct NodeState
+{
+  Ptr<MplsNode> node;
+  MplsNode::LabelSpaceType type;
+  std::vector<LabelSpaceState> spaces;
+  MplsNode::IlmTable ilms;
+  MplsNode::FtnTable ftns;
+};
+
+class SnapshotWriter
+{
+public:
+  SnapshotWriter (std::ostream &os) : m_w (os) {}
+
+  void WriteLabelSpace (const LabelSpace &space)
+  {
+    LabelSpace::RangeVector ranges;
+    space.GetAllocatedRanges (ranges);
+
+    m_w.WriteU32 (space.GetMinValue ());
+    m_w.WriteU32 (space.GetMaxValue ());
+    m_w.WriteU32 (space.GetSrgbBase ());
+    m_w.WriteU32 (space.GetSrgbSize ());
+    m_w.WriteU32 (ranges.size ());
+    for (LabelSpace::RangeVector::const_iterator i = ranges.begin (); i != ranges.end (); ++i)
+      {
+        m_w.WriteU32 ((*i).first);
+        m_w.WriteU32 ((*i).second);
+      }
+  }
+
+  // policy parameters are written where they are referenced for the first time
+  void WritePolicy (const Ptr<NhlfeSelectionPolicy> &policy)
+  {
+    std::string params = SerializePolicy (policy);
+    std::map<std::string, uint32_t>::iterator i = m_policies.find (params);
+    if (i != m_policies.end ())
+      {
+        m_w.WriteU32 (i->second);
+        return;
+      }
+
+    uint32_t id = m_policies.size ();
+    m_policies.insert (std::make_pair (params, id));
+    m_w.WriteU32 (id);
+    m_w.WriteBytes ((const uint8_t*)params.data (), params.size ());
+  }
+
+  void WriteNhlfe (const Nhlfe &nhlfe)
+  {
+    m_w.WriteU8 (nhlfe.GetOpCode ());
+    m_w.WriteU32 (nhlfe.GetInterface ());
+
+    if (nhlfe.GetOpCode () != OP_POP)
+      {
+        // segment lists and binding SIDs may push label stacks of any depth
+        m_w.WriteU32 (nhlfe.GetNLabels ());
+        for (uint32_t i = 0; i < nhlfe.GetNLabels (); ++i)
+          {
+            m_w.WriteU32 (nhlfe.GetLabel (i));
+          }
+      }
+
+    const Address &nextHop = nhlfe.GetNextHop ();
+    if (nextHop.IsInvalid ())
+      {
+        m_w.WriteU8 (0);
+      }
+    else
+      {
+        uint8_t buf[Address::MAX_SIZE + 2];
+        uint32_t size = nextHop.CopyAllTo (buf, sizeof (buf));
+        m_w.WriteU8 (size);
+        m_w.WriteBytes (buf, size);
+      }
+  }
+
+  void WriteForwardingInformation (ForwardingInformation &info)
+  {
+    m_w.WriteU32 (info.GetIndex ());
+    WritePolicy (info.GetPolicy ());
+    m_w.WriteU8 (info.IsReplication ());
+    m_w.WriteU32 (info.GetNNhlfe ());
+    for (uint32_t i = 0; i < info.GetNNhlfe (); ++i)
+      {
+        WriteNhlfe (info.GetNhlfe (i));
+      }
+  }
+
+  Writer& GetWriter (void)
+  {
+    return m_w;
+  }
+
+private:
+  Writer m_w;
+  std::map<std::string, uint32_t> m_policies;
+};
+
+class SnapshotReader
+{
+public:
+  SnapshotReader (std::istream &is) : m_r (is) {}
+
+  bool ReadLabelSpace (LabelSpaceState &space)
+  {
+    space.min = m_r.ReadU32 ();
+    space.max = m_r.ReadU32 ();
+    space.srgbBase = m_r.ReadU32 ();
+    space.srgbSize = m_r.ReadU32 ();
+    uint32_t nRanges = m_r.ReadU32 ();
+    if (!m_r.IsOk () || space.min < 0x10 || space.min >= space.max || space.max > 0xfffff)
+      {
+        return false;
+      }
+
+    uint32_t last = 0;
+    bool srgbAllocated = false;
+    for (uint32_t i = 0; i < nRanges && m_r.IsOk (); ++i)
+      {
+        uint32_t first = m_r.ReadU32 ();
+        uint32_t second = m_r.ReadU32 ();
+        if (first > second || first < space.min || second > space.max || (i > 0 && first <= last))
+          {
+            return false;
+          }
+        space.ranges.push_back (std::make_pair (first, second));
+        last = second;
+
+        // SRGB labels are allocated, so the block lies within one range
+        srgbAllocated = srgbAllocated || (space.srgbBase >= first && space.srgbBase <= second &&
+                                         space.srgbSize <= second - space.srgbBase + 1);
+      }
+
+    return m_r.IsOk () && (space.srgbSize == 0 || srgbAllocated);
+  }
+
+  const PolicyFactory* ReadPolicy (void)
+  {
+    uint32_t id = m_r.ReadU32 ();
+    if (!m_r.IsOk () || id > m_policies.size ())
+      {
+        return 0;
+      }
+
+    if (id == m_policies.size ())
+      {
+        m_policies.push_back (PolicyFactory ());
+        if (!m_policies.back ().Deserialize (m_r))
+          {
+            return 0;
+          }
+      }
+
+    return &m_policies[id];
+  }
+
+  bool ReadNhlfe (std::vector<Nhlfe> &nhlfes)
+  {
+    uint8_t opcode = m_r.ReadU8 ();
+    int32_t interface = m_r.ReadU32 ();
+
+    std::vector<uint32_t> labels;
+    if (opcode == OP_SWAP || opcode == OP_PUSH)
+      {
+        uint32_t nLabels = m_r.ReadU32 ();
+        // a label takes 4 bytes of the frame, deeper stacks can not be sent
+        if (!m_r.IsOk () || nLabels == 0 || nLabels > 0x4000)
+          {
+            return false;
+          }
+        labels.resize (nLabels);
+        for (uint32_t i = 0; i < nLabels; ++i)
+          {
+            labels[i] = m_r.ReadU32 ();
+          }
+      }
+    else if (opcode != OP_POP)
+      {
+        return false;
+      }
+
+    Address nextHop;
+    uint8_t size = m_r.ReadU8 ();
+    if (size > 0)
+      {
+        uint8_t buf[Address::MAX_SIZE + 2];
+        if (size > sizeof (buf) || size < 2)
+          {
+            return false;
+          }
+        m_r.ReadBytes (buf, size);
+        nextHop.CopyAllFrom (buf, size);
+      }
+
+    if (!m_r.IsOk ())
+      {
+        return false;
+      }
+
+    if (opcode == OP_POP)
+      {
+        nhlfes.push_back (MakeNhlfe (Pop (), interface, nextHop));
+      }
+    else if (opcode == OP_PUSH)
+      {
+        nhlfes.push_back (MakeNhlfe (Push (&labels[0], labels.size ()), interface, nextHop));
+      }
+    else
+      {
+        nhlfes.push_back (MakeNhlfe (Swap (&labels[0], labels.size ()), interface, nextHop));
+      }
+
+    return true;
+  }
+
+  // reads index, policy and NHLFEs of ILM or FTN
+  bool ReadForwardingInformation (uint32_t &index, const PolicyFactory *&policy, bool &replication,
+                                  std::vector<Nhlfe> &nhlfes)
+  {
+    index = m_r.ReadU32 ();
+    policy = ReadPolicy ();
+    if (policy == 0)
+      {
+        return false;
+      }
+
+    replication = m_r.ReadU8 () != 0;
+
+    uint32_t nNhlfe = m_r.ReadU32 ();
+    if (!m_r.IsOk () || nNhlfe == 0)
+      {
+        return false;
+      }
+
+    nhlfes.clear ();
+    for (uint32_t i = 0; i < nNhlfe; ++i)
+      {
+        if (!ReadNhlfe (nhlfes))
+          {
+            return false;
+          }
+      }
+
+    return true;
+  }
+
+  Reader& GetReader (void)
+  {
+    return m_r;
+  }
+
+private:
+  static Nhlfe MakeNhlfe (const Operation &op, int32_t interface, const Address &nextHop)
+  {
+    if (interface >= 0 && !nextHop.IsInvalid ())
+      {
+        return Nhlfe (op, interface, nextHop);
+      }
+    if (interface >= 0)
+      {
+        return Nhlfe (op, interface);
+      }
+    if (!nextHop.IsInvalid ())
+      {
+        return Nhlfe (op, nextHop);
+      }
+    return Nhlfe (op);
+  }
+
+  Reader m_r;
+  std::vector<PolicyFactory> m_policies;
+};
+
+template <class T>
+void
+AddNhlfes (const Ptr<T> &info, const std::vector<Nhlfe> &nhlfes, uint32_t index, bool replication)
+{
+  for (uint32_t i = 1; i < nhlfes.size (); ++i)
+    {
+      info->AddNhlfe (nhlfes[i]);
+    }
+  info->SetIndex (index);
+  info->SetReplication (replication);
+}
+
+void
+SetLabelSpace (LabelSpace *space, const LabelSpaceState &state)
+{
+  // both setters clear the space and check min < max, so the order depends on the current range
+  if (state.min < space->GetMaxValue ())
+    {
+      space->SetMinValue (state.min);
+      space->SetMaxValue (state.max);
+    }
+  else
+    {
+      space->SetMaxValue (state.max);
+      space->SetMinValue (state.min);
+    }
+  // the SRGB block is reserved first to set the SRGB, the saved ranges include its labels
+  if (state.srgbSize != 0)
+    {
+      space->ReserveSrgb (state.srgbBase, state.srgbSize);
+    }
+  space->SetAllocatedRanges (state.ranges);
+}
+
+} // anonymous namespace
+
+MplsLfibSnapshot::MplsLfibSnapshot ()
+  : m_nEntries (0),
+    m_time (0)
+{
+}
+
+MplsLfibSnapshot::~MplsLfibSnapshot ()
+{
+}
+
+uint32_t
+MplsLfibSnapshot::GetNEntries (void) const
+{
+  return m_nEntries;
+}
+
+int64_t
+MplsLfibSnapshot::GetTime (void) const
+{
+  return m_time;
+}
+
+void
+MplsLfibSnapshot::Save (const NodeContainer &nodes, std::ostream &os)
+{
+  SystemWallClockMs clock;
+  clock.Start ();
+
+  std::vector<Ptr<MplsNode> > mplsNodes;
+  for (NodeContainer::Iterator i = nodes.Begin (); i != nodes.End (); ++i)
+    {
+      Ptr<MplsNode> node = DynamicCast<MplsNode> (*i);
+      if (node != 0 && node->GetObject<Mpls> () != 0)
+        {
+          mplsNodes.push_back (node);
+        }
+    }
+
+  SnapshotWriter writer (os);
+  Writer &w = writer.GetWriter ();
+
+  w.WriteBytes ((const uint8_t*)MAGIC, sizeof (MAGIC));
+  w.WriteU32 (VERSION);
+  w.WriteU32 (mplsNodes.size ());
+
+  m_nEntries = 0;
+
+  for (std::vector<Ptr<MplsNode> >::const_iterator i = mplsNodes.begin (); i != mplsNodes.end (); ++i)
+    {
+      Ptr<MplsNode> node = *i;
+      Ptr<Mpls> mpls = node->GetObject<Mpls> ();
+
+      w.WriteU32 (node->GetId ());
+      w.WriteU8 (node->GetLabelSpaceType ());
+
+      if (node->GetLabelSpaceType () == MplsNode::PLATFORM)
+        {
+          w.WriteU32 (1);
+          writer.WriteLabelSpace (*node->GetLabelSpace (0));
+        }
+      else
+        {
+          w.WriteU32 (mpls->GetNInterfaces ());
+          for (uint32_t j = 0; j < mpls->GetNInterfaces (); ++j)
+            {
+              writer.WriteLabelSpace (*mpls->GetInterface (j)->GetLabelSpace ());
+            }
+        }
+
+      // entries of the flat label forwarding table are written as ILMs, the table is read through
+      // the const accessor which keeps the ILM lookup index
+      const MplsNode::IlmTable *ilms = Ptr<const MplsNode> (node)->GetIlmTable ();
+      const Ptr<FlatLfib> &flat = node->GetFlatLfib ();
+      uint32_t nIlm = ilms->size () + flat->GetNEntries ();
+      w.WriteU32 (nIlm);
+      for (MplsNode::IlmTable::const_iterator j = ilms->begin (); j != ilms->end (); ++j)
+        {
+          w.WriteU32 ((*j)->GetInterface ());
+          w.WriteU32 ((*j)->GetLabel ());
+          writer.WriteForwardingInformation (**j);
+        }
+      for (FlatLfib::Handle j = flat->GetNext (0); j.IsValid (); j = flat->GetNext (j.GetLabel () + 1))
+        {
+          Ptr<IncomingLabelMap> ilm = flat->GetIlm (j);
+          w.WriteU32 (ilm->GetInterface ());
+          w.WriteU32 (ilm->GetLabel ());
+          writer.WriteForwardingInformation (*ilm);
+        }
+
+      // FTNs of user defined FEC rules which can not be serialized are skipped
+      MplsNode::FtnTable *ftns = node->GetFtnTable ();
+      uint32_t nFtn = 0;
+      for (MplsNode::FtnTable::const_iterator j = ftns->begin (); j != ftns->end (); ++j)
+        {
+          if ((*j)->GetFec ().IsSerializable ())
+            {
+              nFtn++;
+            }
+          else
+            {
+              NS_LOG_WARN ("FTN of node " << node->GetId () << " with a user defined FEC is not saved");
+            }
+        }
+
+      w.WriteU32 (nFtn);
+      for (MplsNode::FtnTable::const_iterator j = ftns->begin (); j != ftns->end (); ++j)
+        {
+          if ((*j)->GetFec ().IsSerializable ())
+            {
+              (*j)->GetFec ().Serialize (os);
+              writer.WriteForwardingInformation (**j);
+            }
+        }
+
+      m_nEntries += nIlm + nFtn;
+    }
+
+  m_time = clock.End ();
+
+  NS_LOG_DEBUG ("Saved " << mplsNodes.size () << " nodes, " << m_nEntries << " entries in " << m_time << "ms");
+}
+
+bool
+MplsLfibSnapshot::Save (const NodeContainer &nodes, const std::string &filename)
+{
+  std::ofstream os (filename.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!os)
+    {
+      NS_LOG_WARN ("Can not open " << filename);
+      return false;
+    }
+
+  Save (nodes, os);
+  os.close ();
+  return !os.fail ();
+}
+
+bool
+MplsLfibSnapshot::Restore (const NodeContainer &nodes, std::istream &is)
+{
+  SystemWallClockMs clock;
+  clock.Start ();
+
+  m_nEntries = 0;
+
+  // nodes are matched by id
+  std::vector<Ptr<MplsNode> > nodeById;
+  for (NodeContainer::Iterator i = nodes.Begin (); i != nodes.End (); ++i)
+    {
+      Ptr<MplsNode> node = DynamicCast<MplsNode> (*i);
+      if (node != 0 && node->GetObject<Mpls> () != 0)
+        {
+          if (node->GetId () >= nodeById.size ())
+            {
+              nodeById.resize (node->GetId () + 1);
+            }
+          nodeById[node->GetId ()] = node;
+        }
+    }
+
+  SnapshotReader reader (is);
+  Reader &r = reader.GetReader ();
+
+  char magic[sizeof (MAGIC)];
+  r.ReadBytes ((uint8_t*)magic, sizeof (magic));
+  uint32_t version = r.ReadU32 ();
+  if (!r.IsOk () || std::memcmp (magic, MAGIC, sizeof (MAGIC)) != 0 || version != VERSION)
+    {
+      NS_LOG_WARN ("Not an LFIB snapshot or unsupported version");
+      return false;
+    }
+
+  uint32_t nNodes = r.ReadU32 ();
+  if (!r.IsOk () || nNodes > nodeById.size ())
+    {
+      NS_LOG_WARN ("Snapshot has more nodes than specified");
+      return false;
+    }
+
+  // whole snapshot is read before any node is changed
+  std::vector<NodeState> states (nNodes);
+  std::vector<Nhlfe> nhlfes;
+  uint32_t index;
+  const PolicyFactory *policy;
+  bool replication;
+
+  for (uint32_t i = 0; i < nNodes; ++i)
+    {
+      NodeState &state = states[i];
+      uint32_t id = r.ReadU32 ();
+      uint8_t type = r.ReadU8 ();
+      uint32_t nSpaces = r.ReadU32 ();
+      if (!r.IsOk () || id >= nodeById.size () || nodeById[id] == 0 || type > MplsNode::INTERFACE)
+        {
+          NS_LOG_WARN ("Unknown node " << id);
+          return false;
+        }
+
+      state.node = nodeById[id];
+      state.type = MplsNode::LabelSpaceType (type);
+
+      uint32_t nInterfaces = state.node->GetObject<Mpls> ()->GetNInterfaces ();
+      if (nSpaces != (type == MplsNode::PLATFORM ? 1 : nInterfaces))
+        {
+          NS_LOG_WARN ("Interfaces of node " << id << " differ from the saved ones");
+          return false;
+        }
+
+      state.spaces.resize (nSpaces);
+      for (uint32_t j = 0; j < nSpaces; ++j)
+        {
+          if (!reader.ReadLabelSpace (state.spaces[j]))
+            {
+              return false;
+            }
+        }
+
+      uint32_t nIlm = r.ReadU32 ();
+      for (uint32_t j = 0; j < nIlm && r.IsOk (); ++j)
+        {
+          int32_t interface = r.ReadU32 ();
+          uint32_t label = r.ReadU32 ();
+          if (interface < -1 || interface >= int32_t (nInterfaces) || label > 0xfffff ||
+              !reader.ReadForwardingInformation (index, policy, replication, nhlfes))
+            {
+              NS_LOG_WARN ("Malformed ILM of node " << id);
+              return false;
+            }
+
+          Ptr<IncomingLabelMap> ilm = Create<IncomingLabelMap> (interface, label, nhlfes[0], policy->Create ());
+          AddNhlfes (ilm, nhlfes, index, replication);
+          state.ilms.push_back (ilm);
+        }
+
+      uint32_t nFtn = r.ReadU32 ();
+      for (uint32_t j = 0; j < nFtn && r.IsOk (); ++j)
+        {
+          Fec *fec = Fec::Deserialize (r.GetStream ());
+          if (fec == 0 || !reader.ReadForwardingInformation (index, policy, replication, nhlfes))
+            {
+              delete fec;
+              NS_LOG_WARN ("Malformed FTN of node " << id);
+              return false;
+            }
+
+          Ptr<FecToNhlfe> ftn = Create<FecToNhlfe> (fec, nhlfes[0], policy->Create ());
+          AddNhlfes (ftn, nhlfes, index, replication);
+          state.ftns.push_back (ftn);
+        }
+
+      if (!r.IsOk ())
+        {
+          NS_LOG_WARN ("Unexpected end of snapshot");
+          return false;
+        }
+
+      m_nEntries += nIlm + nFtn;
+    }
+
+  for (std::vector<NodeState>::iterator i = states.begin (); i != states.end (); ++i)
+    {
+      Ptr<MplsNode> node = (*i).node;
+      Ptr<Mpls> mpls = node->GetObject<Mpls> ();
+
+      // label space type can be changed only if the spaces in use are empty
+      if (node->GetLabelSpaceType () == MplsNode::PLATFORM)
+        {
+          node->GetLabelSpace (0)->Clear ();
+        }
+      else
+        {
+          for (uint32_t j = 0; j < mpls->GetNInterfaces (); ++j)
+            {
+              mpls->GetInterface (j)->GetLabelSpace ()->Clear ();
+            }
+        }
+
+      if (node->GetLabelSpaceType () != (*i).type)
+        {
+          node->SetLabelSpaceType ((*i).type);
+        }
+
+      if ((*i).type == MplsNode::PLATFORM)
+        {
+          SetLabelSpace (node->GetLabelSpace (0), (*i).spaces[0]);
+        }
+      else
+        {
+          for (uint32_t j = 0; j < (*i).spaces.size (); ++j)
+            {
+              SetLabelSpace (mpls->GetInterface (j)->GetLabelSpace (), (*i).spaces[j]);
+            }
+        }
+
+      node->GetFlatLfib ()->Clear ();
+      node->GetIlmTable ()->swap ((*i).ilms);
+      node->GetFtnTable ()->swap ((*i).ftns);
+      node->RebuildIlmIndex ();
+    }
+
+  m_time = clock.End ();
+
+  NS_LOG_DEBUG ("Restored " << nNodes << " nodes, " << m_nEntries << " entries in " << m_time << "ms");
+  return true;
+}
+
+bool
+MplsLfibSnapshot::Restore (const NodeContainer &nodes, const std::string &filename)
+{
+  std::ifstream is (filename.c_str (), std::ios::in | std::ios::binary);
+  if (!is)
+    {
+      NS_LOG_WARN ("Can not open " << filename);
+      return false;
+    }
+
+  return Restore (nodes, is);
+}
+
+} // namespace ns3
@@ -0,0 +1,102 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010-2011 Andrey Churin, Stefano Avallone
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Andrey Churin <aachurin@gmail.com>
+ *         Stefano Avallone <stavallo@gmail.com>
+ */
+
+#ifndef MPLS_LFIB_SNAPSHOT_H
+#define MPLS_LFIB_SNAPSHOT_H
+
+#include <string>
+#include <istream>
+#include <ostream>
+
+#include "ns3/ptr.h"
+#include "ns3/node-container.h"
+#include "ns3/mpls-node.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup mpls
+ * \brief Saves and restores label forwarding state of mpls nodes in a compact binary form.
+ *
+ * A snapshot holds, for every node, the label space type, allocated labels and the SRGB of the
+ * platform or interface label spaces, the ILM table and the FTN table (with FEC expressions)
+ * including NHLFEs, the replication flag and selection policy parameters (type, attributes and
+ * weights).
+ * Equal policy parameters are written once and referenced by entries, restored entries with equal
+ * parameters share one policy object.
+ *
+ * Entries of the flat label forwarding table are saved as ILMs and restored into the ILM table
+ * (the flat table is cleared), MplsNode::FlattenIlmTable can move them again.
+ *
+ * Sharing is not saved: NHLFEs of entries on a shared next-hop group and pooled NHLFEs are
+ * written as plain NHLFEs of every entry, so restored entries neither share a group nor use the
+ * node NHLFE pool (MplsNode::InternNhlfes can pool them again). Fast reroute backups are not
+ * saved and are left untouched by Restore.
+ *
+ * The snapshot is read in one sequential pass. Tables are replaced only if the whole snapshot
+ * has been read successfully, the ILM lookup index of every node is built once. Nodes are
+ * matched by id and should have the same mpls interfaces as the saved ones.
+ */
+class MplsLfibSnapshot
+{
+public:
+  MplsLfibSnapshot ();
+  virtual ~MplsLfibSnapshot ();
+
+  /**
+   * @brief Write snapshot of the nodes to the stream, FTNs whose FEC is not serializable
+   * (see Fec::IsSerializable) are skipped with a warning
+   */
+  void Save (const NodeContainer &nodes, std::ostream &os);
+  /**
+   * @brief Write snapshot of the nodes to the file
+   * @return false if the file can not be written
+   */
+  bool Save (const NodeContainer &nodes, const std::string &filename);
+  /**
+   * @brief Read snapshot from the stream and replace label forwarding state of the nodes
+   * @return false if the snapshot is malformed or has another version, nodes are left untouched then
+   */
+  bool Restore (const NodeContainer &nodes, std::istream &is);
+  /**
+   * @brief Read snapshot from the file and replace label forwarding state of the nodes
+   * @return false if the file can not be read or is malformed
+   */
+  bool Restore (const NodeContainer &nodes, const std::string &filename);
+  /**
+   * @brief Returns number of ILM and FTN entries saved or restored by the last call
+   */
+  uint32_t GetNEntries (void) const;
+  /**
+   * @brief Returns wall-clock time (in milliseconds) spent by the last call
+   */
+  int64_t GetTime (void) const;
+
+  static const uint32_t VERSION = 3;
+
+private:
+  uint32_t m_nEntries;
+  int64_t m_time;
+};
+
+} // namespace ns3
+
+#endif /* MPLS_LFIB_SNAPSHOT_H */
@@ -19,6 +19,8 @@
  *         Stefano Avallone <stavallo@gmail.com>
  */
 
+#include <set>
+
 #include "ns3/assert.h"
 #include "ns3/log.h"
 #include "ns3/channel.h"
@@ -36,7 +38,8 @@ namespace ns3 {
 using namespace mpls;
 
 MplsNetworkDiscoverer::MplsNetworkDiscoverer ()
-  : m_vertexes (Create<MplsNetworkDiscoverer::Vertexes> ())
+  : m_vertexes (Create<MplsNetworkDiscoverer::Vertexes> ()),
+    m_records (Create<MplsNetworkDiscoverer::Records> ())
 {
 }
 
@@ -48,6 +51,7 @@ MplsNetworkDiscoverer::~MplsNetworkDiscoverer ()
 MplsNetworkDiscoverer::MplsNetworkDiscoverer (const MplsNetworkDiscoverer &o)
 {
   m_vertexes = o.m_vertexes;
+  m_records = o.m_records;
 }
 
 MplsNetworkDiscoverer& 
@@ -59,6 +63,7 @@ MplsNetworkDiscoverer::operator= (const MplsNetworkDiscoverer &o)
     }
 
   m_vertexes = o.m_vertexes;
+  m_records = o.m_records;
   return *this;
 }
 
@@ -80,16 +85,23 @@ MplsNetworkDiscoverer::Vertexes::Add (const Ipv4Address& addr, const Ptr<MplsNet
   m_vertexes[addr] = vertex;
 }
 
-const Ptr<MplsNetworkDiscoverer::Vertex>& 
-MplsNetworkDiscoverer::Vertexes::Get (const Ipv4Address &addr)
+void
+MplsNetworkDiscoverer::Vertexes::Remove (const Ipv4Address &addr)
+{
+  m_vertexes.Erase (addr);
+}
+
+Ptr<MplsNetworkDiscoverer::Vertex>
+MplsNetworkDiscoverer::Vertexes::Get (const Ipv4Address &addr) const
 {
-  return m_vertexes[addr];
+  const Ptr<Vertex> *vertex = m_vertexes.Find (addr);
+  return vertex != 0 ? *vertex : 0;
 }
 
 void
 MplsNetworkDiscoverer::Vertexes::Clear ()
 {
-  for (Iterator i = m_vertexes.begin (); i != m_vertexes.end (); ++i)
+  for (Iterator i = m_vertexes.Begin (); i != m_vertexes.End (); ++i)
     {
       if ((*i).second != 0) 
         {
@@ -98,19 +110,26 @@ MplsNetworkDiscoverer::Vertexes::Clear ()
         }
     }
     
-  m_vertexes.clear ();
+  m_vertexes.Clear ();
+}
+
+void
+MplsNetworkDiscoverer::Vertexes::Release ()
+{
+  // vertexes are still in use, drop references only
+  m_vertexes.Clear ();
 }
 
 MplsNetworkDiscoverer::Vertexes::Iterator
 MplsNetworkDiscoverer::Vertexes::Begin (void)
 {
-  return m_vertexes.begin ();
+  return m_vertexes.Begin ();
 }
 
 MplsNetworkDiscoverer::Vertexes::Iterator
 MplsNetworkDiscoverer::Vertexes::End (void)
 {
-  return m_vertexes.end ();
+  return m_vertexes.End ();
 }
 
 MplsNetworkDiscoverer::Vertex::Vertex (const Mac48Address& hwaddr, const Ptr<Interface> &interface)
@@ -145,8 +164,8 @@ MplsNetworkDiscoverer::Vertex::GetInterface (void) const
   return m_interface;
 }
 
-const Ptr<MplsNetworkDiscoverer::Vertex>&
-MplsNetworkDiscoverer::Vertex::GetVertex (const Ipv4Address &addr)
+Ptr<MplsNetworkDiscoverer::Vertex>
+MplsNetworkDiscoverer::Vertex::GetVertex (const Ipv4Address &addr) const
 {
   return m_vertexes->Get (addr);
 }
@@ -157,15 +176,47 @@ MplsNetworkDiscoverer::Vertex::GetVertexes (void)
   return m_vertexes;
 }
 
+void
+MplsNetworkDiscoverer::Vertex::ResetVertexes (void)
+{
+  m_vertexes->Release ();
+}
+
+MplsNetworkDiscoverer::Records::~Records ()
+{
+  Clear ();
+}
+
+void
+MplsNetworkDiscoverer::Records::Clear (void)
+{
+  for (RecordMap::iterator i = m_records.begin (), k = m_records.end (); i != k; ++i)
+    {
+      (*i).second.vertex->Clear ();
+    }
+
+  m_records.clear ();
+}
+
 void
 MplsNetworkDiscoverer::DiscoverNetwork (void)
 {
-  const NodeContainer& nodes = GetNetworkNodes ();
-  
   m_vertexes->Clear ();
-  
-  std::list<Ptr<Vertex> > cache;
-  
+  m_records->Clear ();
+  m_records->m_topology = 0;
+
+  UpdateNetwork ();
+}
+
+bool
+MplsNetworkDiscoverer::UpdateNetwork (void)
+{
+  const NodeContainer& nodes = GetNetworkNodes ();
+  Records::RecordMap &records = m_records->m_records;
+
+  // interfaces which are new, have changed addresses or new devices on the channel
+  std::vector<Ptr<Interface> > changed;
+
   for (NodeContainer::Iterator i = nodes.Begin (), k = nodes.End (); i != k; ++i)
     {
       Ptr<Mpls> mpls = (*i)->GetObject<Mpls> ();
@@ -180,71 +231,182 @@ MplsNetworkDiscoverer::DiscoverNetwork (void)
             }
 
           Address addr = dev->GetAddress ();
-          if (Mac48Address::IsMatchingType (addr))
+          if (!Mac48Address::IsMatchingType (addr))
             {
-              Ptr<Interface> mplsIf = mpls->GetInterfaceForDevice (dev);
-              if (mplsIf == 0)
-                {
-                  mplsIf = mpls->AddInterface (dev);
-                }
+              continue;
+            }
+
+          Ptr<Interface> mplsIf = mpls->GetInterfaceForDevice (dev);
+          if (mplsIf == 0)
+            {
+              mplsIf = mpls->AddInterface (dev);
+            }
 
-              Ptr<MplsNetworkDiscoverer::Vertex> vertex = 
-                  Create<MplsNetworkDiscoverer::Vertex> (Mac48Address::ConvertFrom (addr), mplsIf);
-              
-              if (AddVertexes (mplsIf, vertex))
+          std::vector<Ipv4Address> addresses;
+          GetAddresses (mplsIf, addresses);
+          Ptr<Channel> channel = dev->GetChannel ();
+          uint32_t nChannelDevices = channel != 0 ? channel->GetNDevices () : 0;
+
+          Records::RecordMap::iterator record = records.find (mplsIf);
+          if (record == records.end ())
+            {
+              Record r;
+              r.vertex = Create<MplsNetworkDiscoverer::Vertex> (Mac48Address::ConvertFrom (addr), mplsIf);
+              r.nChannelDevices = nChannelDevices;
+              record = records.insert (std::make_pair (mplsIf, r)).first;
+            }
+          else if ((*record).second.addresses == addresses && (*record).second.nChannelDevices == nChannelDevices)
+            {
+              continue;
+            }
+
+          // old addresses are removed before new ones are added, so an address may move between interfaces
+          Record &r = (*record).second;
+          for (std::vector<Ipv4Address>::const_iterator l = r.addresses.begin (); l != r.addresses.end (); ++l)
+            {
+              if (m_vertexes->Get (*l) == r.vertex)
                 {
-                  cache.push_back (vertex);
+                  m_vertexes->Remove (*l);
                 }
             }
+          r.addresses.swap (addresses);
+          r.nChannelDevices = nChannelDevices;
+          changed.push_back (mplsIf);
         }
     }
-    
-  for (std::list<Ptr<Vertex> >::iterator i = cache.begin (), k = cache.end (); i != k; ++i)
+
+  for (std::vector<Ptr<Interface> >::const_iterator i = changed.begin (); i != changed.end (); ++i)
     {
-      Ptr<Interface> mplsIf = (*i)->GetInterface ();
-      Ptr<NetDevice> dev1 = mplsIf->GetDevice ();
+      const Record &r = records[*i];
+      for (std::vector<Ipv4Address>::const_iterator j = r.addresses.begin (); j != r.addresses.end (); ++j)
+        {
+          if (m_vertexes->Get (*j) != 0)
+            {
+              NS_FATAL_ERROR ("Network discovery failed -- address " << *j << " already in use");
+            }
+
+          m_vertexes->Add (*j, r.vertex);
+        }
+    }
+
+  // links of the changed interfaces and of their neighbors should be rediscovered
+  std::vector<Ptr<Interface> > affected;
+  std::set<Ptr<Interface> > seen;
+
+  for (std::vector<Ptr<Interface> >::const_iterator i = changed.begin (); i != changed.end (); ++i)
+    {
+      if (seen.insert (*i).second)
+        {
+          affected.push_back (*i);
+        }
+
+      Ptr<NetDevice> dev1 = (*i)->GetDevice ();
       Ptr<Channel> channel = dev1->GetChannel ();
-      uint32_t nDevices = channel->GetNDevices ();
-      
+      uint32_t nDevices = channel != 0 ? channel->GetNDevices () : 0;
+
       for (uint32_t j = 0; j < nDevices; ++j)
         {
           Ptr<NetDevice> dev2 = channel->GetDevice (j);
-
-          if (dev1 == dev2) continue;
-
-          if (UpdateVertexes (dev1, dev2, *i)) 
+          Ptr<Mpls> mpls = dev2->GetNode ()->GetObject<Mpls> ();
+          if (dev1 == dev2 || mpls == 0)
             {
-              mplsIf->SetUp ();
+              continue;
             }
-          else 
+
+          Ptr<Interface> mplsIf = mpls->GetInterfaceForDevice (dev2);
+          if (mplsIf != 0 && records.find (mplsIf) != records.end () && seen.insert (mplsIf).second)
             {
-              mplsIf->SetDown ();
+              affected.push_back (mplsIf);
             }
         }
     }
 
-  // configure mac resolvers
-  for (std::list<Ptr<Vertex> >::iterator i = cache.begin (), k = cache.end (); i != k; ++i)
+  for (std::vector<Ptr<Interface> >::const_iterator i = affected.begin (); i != affected.end (); ++i)
     {
-      Ptr<Interface> mplsIf = (*i)->GetInterface ();
-      Ptr<Vertexes> vertexes = (*i)->GetVertexes ();
-      mplsIf->RemoveAllAddresses ();
-      
+      ConnectVertex (records[*i]);
+    }
+
+  NS_LOG_DEBUG ("NetworkDiscoverer: " << changed.size () << " interfaces changed, " << affected.size () <<
+                " interfaces updated");
+
+  if (affected.empty () && m_records->m_topology != 0)
+    {
+      return false;
+    }
+
+  BuildTopology ();
+
+  for (std::list<ChangeCallback>::const_iterator i = m_records->m_callbacks.begin ();
+       i != m_records->m_callbacks.end (); ++i)
+    {
+      (*i) (m_records->m_topology, affected);
+    }
+
+  return true;
+}
+
+void
+MplsNetworkDiscoverer::AddChangeCallback (ChangeCallback cb)
+{
+  m_records->m_callbacks.push_back (cb);
+}
+
+Ptr<const MplsTopology>
+MplsNetworkDiscoverer::GetTopology (void) const
+{
+  return m_records->m_topology;
+}
+
+void
+MplsNetworkDiscoverer::BuildTopology (void)
+{
+  // topology constructor is private, MplsTopology can not be created by Create<> ()
+  Ptr<MplsTopology> topology = Ptr<MplsTopology> (new MplsTopology (), false);
+
+  const NodeContainer& nodes = GetNetworkNodes ();
+  for (NodeContainer::Iterator i = nodes.Begin (), k = nodes.End (); i != k; ++i)
+    {
+      Ptr<MplsNode> node = DynamicCast<MplsNode> (*i);
+      if (node != 0)
+        {
+          topology->AddNode (node);
+        }
+    }
+
+  // vertex is registered once per address of the interface
+  std::set<Vertex*> visited;
+
+  for (Vertexes::Iterator i = m_vertexes->Begin (), k = m_vertexes->End (); i != k; ++i)
+    {
+      Ptr<Vertex> vertex = (*i).second;
+      if (vertex == 0 || !visited.insert (PeekPointer (vertex)).second)
+        {
+          continue;
+        }
+
+      std::set<Vertex*> neighbors;
+      Ptr<Vertexes> vertexes = vertex->GetVertexes ();
+
       for (Vertexes::Iterator j = vertexes->Begin (), l = vertexes->End (); j != l; ++j)
         {
-          mplsIf->AddAddress ((*j).first, (*j).second->GetHwAddr ());
+          if (neighbors.insert (PeekPointer ((*j).second)).second)
+            {
+              topology->AddLink (vertex->GetInterface (), (*j).second->GetInterface (), (*j).first);
+            }
         }
-    }  
+    }
+
+  topology->Finalize ();
+  m_records->m_topology = topology;
 }
 
-bool
-MplsNetworkDiscoverer::AddVertexes (const Ptr<Interface> &mplsIf, 
-    const Ptr<MplsNetworkDiscoverer::Vertex>& vertex)
+void
+MplsNetworkDiscoverer::GetAddresses (const Ptr<Interface> &mplsIf, std::vector<Ipv4Address> &addresses) const
 {
   int32_t ipv4if = mplsIf->LookupIpv4Interface ();
   if (ipv4if < 0) 
     {
-      return 0;
+      return;
     }
 
   Ptr<Ipv4> ipv4 = mplsIf->GetMpls ()->GetIpv4 ();
@@ -252,16 +414,52 @@ MplsNetworkDiscoverer::AddVertexes (const Ptr<Interface> &mplsIf,
   int32_t nAddresses = ipv4->GetNAddresses (ipv4if);
   for (int32_t i = 0; i < nAddresses; ++i)
     {
-      Ipv4Address addr = ipv4->GetAddress (ipv4if, i).GetLocal ();
-      if (m_vertexes->Get (addr) != 0)
+      addresses.push_back (ipv4->GetAddress (ipv4if, i).GetLocal ());
+    }
+}
+
+void
+MplsNetworkDiscoverer::ConnectVertex (const Record &record)
+{
+  Ptr<Vertex> vertex = record.vertex;
+  Ptr<Interface> mplsIf = vertex->GetInterface ();
+  vertex->ResetVertexes ();
+
+  // interface without addresses is not a part of the network
+  if (record.addresses.empty ())
+    {
+      mplsIf->RemoveAllAddresses ();
+      return;
+    }
+
+  Ptr<NetDevice> dev1 = mplsIf->GetDevice ();
+  Ptr<Channel> channel = dev1->GetChannel ();
+  uint32_t nDevices = channel->GetNDevices ();
+      
+  for (uint32_t j = 0; j < nDevices; ++j)
+    {
+      Ptr<NetDevice> dev2 = channel->GetDevice (j);
+
+      if (dev1 == dev2) continue;
+
+      if (UpdateVertexes (dev1, dev2, vertex)) 
+        {
+          mplsIf->SetUp ();
+        }
+      else 
         {
-          NS_FATAL_ERROR ("Network discovery failed -- address " << addr << " already in use");
+          mplsIf->SetDown ();
         }
+    }
 
-      m_vertexes->Add (addr, vertex);
+  // configure mac resolver
+  Ptr<Vertexes> vertexes = vertex->GetVertexes ();
+  mplsIf->RemoveAllAddresses ();
+      
+  for (Vertexes::Iterator j = vertexes->Begin (), l = vertexes->End (); j != l; ++j)
+    {
+      mplsIf->AddAddress ((*j).first, (*j).second->GetHwAddr ());
     }
-    
-  return nAddresses > 0;
 }
 
 bool
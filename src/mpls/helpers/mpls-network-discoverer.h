@@ -22,15 +22,21 @@
 #ifndef MPLS_NETWORK_DISCOVERER_H
 #define MPLS_NETWORK_DISCOVERER_H
 
+#include <vector>
+#include <list>
+#include <map>
+
 #include "ns3/ptr.h"
+#include "ns3/callback.h"
 #include "ns3/node.h"
 #include "ns3/node-container.h"
 #include "ns3/net-device.h"
 #include "ns3/mpls.h"
 #include "ns3/mpls-interface.h"
-#include "ns3/sgi-hashmap.h"
 
 #include "mpls-network-helper-base.h"
+#include "mpls-ipv4-address-map.h"
+#include "mpls-topology.h"
 
 namespace ns3 {
 
@@ -40,6 +46,12 @@ namespace ns3 {
 class MplsNetworkDiscoverer : public MplsNetworkHelperBase
 {
 public:
+  /**
+   * @brief Called when discovery changes the network: new topology and interfaces whose links,
+   * addresses or mac resolvers have been updated
+   */
+  typedef Callback<void, Ptr<const MplsTopology>, const std::vector<Ptr<mpls::Interface> >& > ChangeCallback;
+
   /**
    * @brief Create a new discoverer
    */
@@ -52,7 +64,26 @@ public:
    */
   virtual ~MplsNetworkDiscoverer(void);
   
+  /**
+   * @brief Discover links between mpls interfaces of network nodes, configure mac resolvers of
+   * interfaces and build network topology
+   */
   void DiscoverNetwork (void);
+  /**
+   * @brief Update the network discovered before, only interfaces whose addresses have been changed,
+   * new interfaces and interfaces sharing a channel with them are processed (mac resolvers of other
+   * interfaces are left untouched). Works as DiscoverNetwork if the network has not been discovered yet.
+   * @return true if something has been changed
+   */
+  bool UpdateNetwork (void);
+  /**
+   * @brief Register callback invoked after DiscoverNetwork or UpdateNetwork changed the network
+   */
+  void AddChangeCallback (ChangeCallback cb);
+  /**
+   * @brief Returns topology built by the last DiscoverNetwork or UpdateNetwork
+   */
+  Ptr<const MplsTopology> GetTopology (void) const;
   
 private:
   class Vertex;
@@ -60,18 +91,20 @@ private:
   class Vertexes : public SimpleRefCount<Vertexes>
   {
   public:
-    typedef sgi::hash_map<Ipv4Address, Ptr<Vertex>, Ipv4AddressHash>::iterator Iterator;
+    typedef Ipv4AddressMap<Ptr<Vertex> >::Iterator Iterator;
     
     Vertexes ();
     ~Vertexes ();
     void Add (const Ipv4Address &addr, const Ptr<Vertex> &vertex);
-    const Ptr<Vertex>& Get (const Ipv4Address &addr);
+    void Remove (const Ipv4Address &addr);
+    Ptr<Vertex> Get (const Ipv4Address &addr) const;
     void Clear (void);
+    void Release (void);
     
     Iterator Begin (void);
     Iterator End (void);
   private:
-    sgi::hash_map<Ipv4Address, Ptr<Vertex>, Ipv4AddressHash> m_vertexes;
+    Ipv4AddressMap<Ptr<Vertex> > m_vertexes;
   };
   
   class Vertex : public SimpleRefCount<Vertex>
@@ -81,8 +114,9 @@ private:
     ~Vertex ();
     const Mac48Address& GetHwAddr (void) const;
     const Ptr<mpls::Interface>& GetInterface (void) const;
-    const Ptr<Vertex>& GetVertex (const Ipv4Address &addr);
+    Ptr<Vertex> GetVertex (const Ipv4Address &addr) const;
     const Ptr<Vertexes>& GetVertexes (void);
+    void ResetVertexes (void);
     void Clear (void);
   private:
     Mac48Address m_hwaddr;
@@ -90,12 +124,36 @@ private:
     Ptr<Vertexes> m_vertexes;
   };
   
-  bool AddVertexes (const Ptr<mpls::Interface> &mplsIf, 
-                      const Ptr<MplsNetworkDiscoverer::Vertex>& vertex);
+  // state of an interface seen by the last discovery
+  struct Record
+  {
+    Ptr<Vertex> vertex;
+    std::vector<Ipv4Address> addresses;
+    uint32_t nChannelDevices;
+  };
+
+  class Records : public SimpleRefCount<Records>
+  {
+  public:
+    typedef std::map<Ptr<mpls::Interface>, Record> RecordMap;
+
+    ~Records ();
+    void Clear (void);
+
+    RecordMap m_records;
+    std::list<ChangeCallback> m_callbacks;
+    // shared by copies of the discoverer, so every copy sees the topology of the last update
+    Ptr<MplsTopology> m_topology;
+  };
+
+  void GetAddresses (const Ptr<mpls::Interface> &mplsIf, std::vector<Ipv4Address> &addresses) const;
+  void ConnectVertex (const Record &record);
   bool UpdateVertexes (const Ptr<NetDevice> &dev1, const Ptr<NetDevice> &dev2,
                          const Ptr<Vertex> &vertex);
+  void BuildTopology (void);
 
   Ptr<Vertexes> m_vertexes;
+  Ptr<Records> m_records;
 };
 
 } // namespace ns3
@@ -26,11 +26,13 @@
 namespace ns3 {
 
 NhlfeSelectionPolicyHelper::NhlfeSelectionPolicyHelper ()
+  : m_default (true)
 {
   ObjectFactory::SetTypeId ("ns3::mpls::NhlfeSelectionPolicy");
 }
 
 NhlfeSelectionPolicyHelper::NhlfeSelectionPolicyHelper (const std::string &id)
+  : m_default (false)
 {
   ObjectFactory::SetTypeId (id);
 }
@@ -43,12 +45,20 @@ void
 NhlfeSelectionPolicyHelper::SetAttribute (std::string name, const AttributeValue &value)
 {
   ObjectFactory::Set (name, value);
+  m_policy = 0;
+  m_default = false;
 }
 
 Ptr<mpls::NhlfeSelectionPolicy> 
 NhlfeSelectionPolicyHelper::Create (void) const
 {
-  return ObjectFactory::Create<mpls::NhlfeSelectionPolicy> ();
+  if (m_policy == 0)
+    {
+      m_policy = m_default ? mpls::NhlfeSelectionPolicy::GetDefault ()
+                           : ObjectFactory::Create<mpls::NhlfeSelectionPolicy> ();
+    }
+
+  return m_policy;
 }
 
 RoundRobinPolicyHelper::RoundRobinPolicyHelper ()
@@ -81,27 +91,33 @@ WeightedPolicyHelper::~WeightedPolicyHelper ()
 Ptr<mpls::NhlfeSelectionPolicy>
 WeightedPolicyHelper::Create (void) const
 {
-  Ptr<mpls::WeightedPolicy> policy = NhlfeSelectionPolicyHelper::Create<mpls::WeightedPolicy> ();
- 
-  policy->SetWeights (m_weight);
-  
-  return policy;
+  if (m_policy == 0)
+    {
+      Ptr<mpls::WeightedPolicy> policy = NhlfeSelectionPolicyHelper::Create<mpls::WeightedPolicy> ();
+      policy->SetWeights (m_weight);
+      m_policy = policy;
+    }
+
+  return m_policy;
 }
 
 
 void WeightedPolicyHelper::AddWeight(double w)
 {
+  m_policy = 0;
   m_weight.push_back (w);
 }
 
 void WeightedPolicyHelper::AddWeight(double w1, double w2)
 {
+  m_policy = 0;
   m_weight.push_back (w1);
   m_weight.push_back (w2);
 }
 
 void WeightedPolicyHelper::AddWeight(double w1, double w2, double w3)
 {
+  m_policy = 0;
   m_weight.push_back (w1);
   m_weight.push_back (w2);
   m_weight.push_back (w3);
@@ -109,6 +125,7 @@ void WeightedPolicyHelper::AddWeight(double w1, double w2, double w3)
 
 void WeightedPolicyHelper::AddWeight(double w1, double w2, double w3, double w4)
 {
+  m_policy = 0;
   m_weight.push_back (w1);
   m_weight.push_back (w2);
   m_weight.push_back (w3);
@@ -117,6 +134,7 @@ void WeightedPolicyHelper::AddWeight(double w1, double w2, double w3, double w4)
 
 void WeightedPolicyHelper::AddWeight(double w1, double w2, double w3, double w4, double w5)
 {
+  m_policy = 0;
   m_weight.push_back (w1);
   m_weight.push_back (w2);
   m_weight.push_back (w3);
@@ -126,6 +144,7 @@ void WeightedPolicyHelper::AddWeight(double w1, double w2, double w3, double w4,
 
 void WeightedPolicyHelper::AddWeight(double w1, double w2, double w3, double w4, double w5, double w6)
 {
+  m_policy = 0;
   m_weight.push_back (w1);
   m_weight.push_back (w2);
   m_weight.push_back (w3);
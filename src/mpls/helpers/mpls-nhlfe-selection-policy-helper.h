@@ -38,6 +38,8 @@ class NhlfeSelectionPolicyHelper: private ObjectFactory
 protected:
   using ObjectFactory::Create;
   NhlfeSelectionPolicyHelper (const std::string &id);
+
+  mutable Ptr<mpls::NhlfeSelectionPolicy> m_policy;
 public:
   /**
    * @brief Create a new NhlfeSelectionPolicyHelper object
@@ -45,8 +47,16 @@ public:
   NhlfeSelectionPolicyHelper ();
   virtual ~NhlfeSelectionPolicyHelper ();
   
+  /**
+   * @brief Returns the policy. Policies hold configuration only, so one instance is created on the
+   * first call and returned to every entry (copies of the helper made later share it too). The
+   * default policy without attributes is created by NhlfeSelectionPolicy::GetDefault
+   */
   virtual Ptr<mpls::NhlfeSelectionPolicy> Create (void) const;
   void SetAttribute (std::string name, const AttributeValue &value);
+
+private:
+  bool m_default;
 };
 
 /**
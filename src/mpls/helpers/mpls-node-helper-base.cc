@@ -27,4 +27,20 @@ MplsNodeHelperBase::~MplsNodeHelperBase ()
 {
 }
 
+void
+MplsNodeHelperBase::InternNhlfeGroups (const Ptr<mpls::NhlfePool> &pool, const NhlfeGroupVector &groups,
+                                       std::vector<NhlfeIdVector> &ids)
+{
+  ids.resize (groups.size ());
+  for (uint32_t i = 0; i < groups.size (); ++i)
+    {
+      ids[i].clear ();
+      ids[i].reserve (groups[i].size ());
+      for (NhlfeGroup::const_iterator j = groups[i].begin (); j != groups[i].end (); ++j)
+        {
+          ids[i].push_back (pool->Intern (*j));
+        }
+    }
+}
+
 } // namespace ns3
@@ -22,9 +22,12 @@
 #ifndef MPLS_NODE_HELPER_BASE_H
 #define MPLS_NODE_HELPER_BASE_H
 
+#include <vector>
+
 #include "ns3/ptr.h"
 #include "ns3/mpls.h"
 #include "ns3/mpls-node.h"
+#include "ns3/mpls-forwarding-information.h"
 
 #include "mpls-nhlfe-selection-policy-helper.h"
 
@@ -36,11 +39,30 @@ namespace ns3 {
 class MplsNodeHelperBase
 {
 public:
+  /**
+   * NHLFEs shared by the entries of a bulk insertion
+   */
+  typedef mpls::ForwardingInformation::NhlfeVector NhlfeGroup;
+  typedef std::vector<NhlfeGroup> NhlfeGroupVector;
+  /**
+   * Selection policies shared by the entries of a bulk insertion
+   */
+  typedef std::vector<Ptr<mpls::NhlfeSelectionPolicy> > PolicyVector;
+  typedef mpls::ForwardingInformation::NhlfeIdVector NhlfeIdVector;
+
   virtual ~MplsNodeHelperBase();
 
   virtual const Ptr<Mpls>& GetMpls (void) const = 0;
   virtual const Ptr<MplsNode>& GetNode (void) const = 0;
   virtual const NhlfeSelectionPolicyHelper& GetSelectionPolicy (void) const = 0;
+
+protected:
+  /**
+   * @brief Intern NHLFEs of every group in the pool
+   * @param ids NHLFE ids of the groups (output)
+   */
+  static void InternNhlfeGroups (const Ptr<mpls::NhlfePool> &pool, const NhlfeGroupVector &groups,
+                                 std::vector<NhlfeIdVector> &ids);
 };
 
 } // namespace ns3
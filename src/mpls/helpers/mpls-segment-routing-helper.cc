@@ -0,0 +1,523 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010-2011 Andrey Churin, Stefano Avallone
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Andrey Churin <aachurin@gmail.com>
+ *         Stefano Avallone <stavallo@gmail.com>
+ */
+
+#include <algorithm>
+#include <queue>
+#include <set>
+#include <functional>
+
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ns3/mpls-operations.h"
+
+#include "mpls-segment-routing-helper.h"
+
+NS_LOG_COMPONENT_DEFINE ("MplsSegmentRoutingHelper");
+
+namespace ns3 {
+
+using namespace mpls;
+
+MplsSegmentRoutingHelper::Segment::Segment (Ptr<Node> node)
+  : m_node (node),
+    m_interface (0),
+    m_binding (0)
+{
+}
+
+MplsSegmentRoutingHelper::Segment::Segment (Ptr<Interface> interface)
+  : m_node (0),
+    m_interface (interface),
+    m_binding (0)
+{
+}
+
+MplsSegmentRoutingHelper::Segment::Segment (Ptr<Node> node, Label binding)
+  : m_node (node),
+    m_interface (0),
+    m_binding (binding)
+{
+  NS_ASSERT_MSG (m_binding != 0, "MplsSegmentRoutingHelper::Segment (): Invalid binding label");
+}
+
+Ptr<Node>
+MplsSegmentRoutingHelper::Segment::GetNode (void) const
+{
+  return m_node;
+}
+
+Ptr<Interface>
+MplsSegmentRoutingHelper::Segment::GetInterface (void) const
+{
+  return m_interface;
+}
+
+uint32_t
+MplsSegmentRoutingHelper::Segment::GetBinding (void) const
+{
+  return m_binding;
+}
+
+MplsSegmentRoutingHelper::MplsSegmentRoutingHelper ()
+  : m_srgbBase (16000),
+    m_srgbSize (8000),
+    m_policy ()
+{
+}
+
+MplsSegmentRoutingHelper::~MplsSegmentRoutingHelper ()
+{
+}
+
+void
+MplsSegmentRoutingHelper::SetSrgb (uint32_t base, uint32_t size)
+{
+  NS_ASSERT_MSG (m_topology == 0, "MplsSegmentRoutingHelper::SetSrgb (): Segments are already installed");
+  m_srgbBase = base;
+  m_srgbSize = size;
+}
+
+void
+MplsSegmentRoutingHelper::SetSelectionPolicy (const NhlfeSelectionPolicyHelper &policy)
+{
+  m_policy = policy;
+}
+
+void
+MplsSegmentRoutingHelper::SetNodeIndex (Ptr<Node> node, uint32_t index)
+{
+  NS_ASSERT_MSG (index < m_srgbSize, "MplsSegmentRoutingHelper::SetNodeIndex (): Index is out of SRGB");
+  m_indexes.push_back (std::make_pair (node, index));
+}
+
+uint32_t
+MplsSegmentRoutingHelper::GetNIlm (void) const
+{
+  return m_ilms.size ();
+}
+
+void
+MplsSegmentRoutingHelper::Install (const MplsNetworkDiscoverer &network)
+{
+  NS_LOG_FUNCTION (this);
+
+  Uninstall ();
+
+  m_topology = network.GetTopology ();
+  NS_ASSERT_MSG (m_topology != 0, "MplsSegmentRoutingHelper::Install (): Call DiscoverNetwork first");
+
+  uint32_t nNodes = m_topology->GetNNodes ();
+  uint32_t nLinks = m_topology->GetNLinks ();
+
+  m_switches.reserve (nNodes);
+  m_sids.resize (nNodes);
+  for (uint32_t i = 0; i < nNodes; ++i)
+    {
+      Ptr<MplsNode> node = m_topology->GetNode (i);
+      if (node->GetId () >= m_nodeIndex.size ())
+        {
+          m_nodeIndex.resize (node->GetId () + 1, -1);
+        }
+      m_nodeIndex[node->GetId ()] = i;
+      m_switches.push_back (MplsSwitch (node));
+      m_switches.back ().SetSelectionPolicy (m_policy);
+      m_sids[i] = i;
+    }
+
+  // later indexes of the same node override earlier ones
+  for (std::vector<std::pair<Ptr<Node>, uint32_t> >::const_iterator i = m_indexes.begin (); i != m_indexes.end (); ++i)
+    {
+      int32_t node = GetNodeIndex (i->first);
+      if (node >= 0)
+        {
+          m_sids[node] = i->second;
+        }
+    }
+
+  std::vector<bool> used (m_srgbSize, false);
+  for (uint32_t i = 0; i < nNodes; ++i)
+    {
+      NS_ASSERT_MSG (m_sids[i] < m_srgbSize, "MplsSegmentRoutingHelper::Install (): Index of node " <<
+                     m_switches[i].GetNode ()->GetId () << " is out of SRGB");
+      NS_ASSERT_MSG (!used[m_sids[i]], "MplsSegmentRoutingHelper::Install (): Index " << m_sids[i] <<
+                     " is used by two nodes");
+      used[m_sids[i]] = true;
+
+      Ptr<MplsNode> node = m_switches[i].GetNode ();
+      NS_ASSERT_MSG (node->GetLabelSpaceType () == MplsNode::PLATFORM,
+                     "MplsSegmentRoutingHelper::Install (): Segment routing requires the platform label space");
+      if (!node->GetLabelSpace (0)->ReserveSrgb (m_srgbBase, m_srgbSize))
+        {
+          NS_FATAL_ERROR ("MplsSegmentRoutingHelper::Install (): SRGB overlaps labels allocated on node " <<
+                          node->GetId ());
+        }
+    }
+
+  // adjacency segments
+  m_linkUp.resize (nLinks);
+  m_adjacencyLabels.resize (nLinks);
+  for (uint32_t l = 0; l < nLinks; ++l)
+    {
+      const MplsTopology::Link &link = m_topology->GetLink (l);
+      MplsSwitch &sw = m_switches[link.from];
+
+      m_linkUp[l] = m_topology->GetLocalInterface (l)->IsUp ();
+      m_adjacencyLabels[l] = sw.GetNode ()->GetLabelSpace (0)->Allocate ();
+      Nhlfe nhlfe (Swap (Label (Label::IMPLICIT_NULL)), link.localIf, link.nextHop);
+      m_ilms.push_back (std::make_pair (link.from, sw.AddIlm (Label (m_adjacencyLabels[l]), nhlfe)));
+    }
+
+  // node segments, one SPF tree per segment node
+  m_trees.assign (nNodes * nNodes, -1);
+  std::vector<uint32_t> dist (nNodes);
+  for (uint32_t segment = 0; segment < nNodes; ++segment)
+    {
+      ComputeTree (segment, dist);
+
+      Label label (m_srgbBase + m_sids[segment]);
+      for (uint32_t node = 0; node < nNodes; ++node)
+        {
+          int32_t parent = m_trees[segment * nNodes + node];
+          if (parent < 0)
+            {
+              continue;
+            }
+
+          const MplsTopology::Link &link = m_topology->GetLink (parent);
+          Label outLabel = link.to == segment ? Label (Label::IMPLICIT_NULL) : label;
+          Nhlfe nhlfe (Swap (outLabel), link.localIf, link.nextHop);
+          m_ilms.push_back (std::make_pair (node, m_switches[node].AddIlm (label, nhlfe)));
+        }
+    }
+
+  NS_LOG_DEBUG ("Installed " << m_ilms.size () << " segments on " << nNodes << " nodes");
+}
+
+void
+MplsSegmentRoutingHelper::Uninstall (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_topology == 0)
+    {
+      return;
+    }
+
+  uint32_t nNodes = m_switches.size ();
+
+  // tables are filtered in a single pass per node
+  std::vector<std::set<IncomingLabelMap*> > ilms (nNodes);
+  for (std::vector<std::pair<uint32_t, Ptr<IncomingLabelMap> > >::const_iterator i = m_ilms.begin ();
+       i != m_ilms.end (); ++i)
+    {
+      ilms[i->first].insert (PeekPointer (i->second));
+    }
+
+  std::vector<std::set<FecToNhlfe*> > ftns (nNodes);
+  for (std::vector<std::pair<uint32_t, Ptr<FecToNhlfe> > >::const_iterator i = m_ftns.begin ();
+       i != m_ftns.end (); ++i)
+    {
+      ftns[i->first].insert (PeekPointer (i->second));
+    }
+
+  for (uint32_t i = 0; i < nNodes; ++i)
+    {
+      Ptr<MplsNode> node = m_switches[i].GetNode ();
+
+      MplsNode::IlmTable *ilmTable = node->GetIlmTable ();
+      for (MplsNode::IlmTable::iterator j = ilmTable->begin (); !ilms[i].empty () && j != ilmTable->end (); )
+        {
+          if (ilms[i].erase (PeekPointer (*j)))
+            {
+              j = ilmTable->erase (j);
+            }
+          else
+            {
+              ++j;
+            }
+        }
+
+      MplsNode::FtnTable *ftnTable = node->GetFtnTable ();
+      for (MplsNode::FtnTable::iterator j = ftnTable->begin (); !ftns[i].empty () && j != ftnTable->end (); )
+        {
+          if (ftns[i].erase (PeekPointer (*j)))
+            {
+              j = ftnTable->erase (j);
+            }
+          else
+            {
+              ++j;
+            }
+        }
+
+      node->GetLabelSpace (0)->ReleaseSrgb ();
+    }
+
+  for (uint32_t l = 0; l < m_adjacencyLabels.size (); ++l)
+    {
+      m_switches[m_topology->GetLink (l).from].GetNode ()->GetLabelSpace (0)->Deallocate (m_adjacencyLabels[l]);
+    }
+
+  for (std::vector<Binding>::const_iterator i = m_bindings.begin (); i != m_bindings.end (); ++i)
+    {
+      m_switches[i->node].GetNode ()->GetLabelSpace (0)->Deallocate (i->label);
+    }
+
+  m_topology = 0;
+  m_linkUp.clear ();
+  m_switches.clear ();
+  m_nodeIndex.clear ();
+  m_sids.clear ();
+  m_adjacencyLabels.clear ();
+  m_trees.clear ();
+  m_bindings.clear ();
+  m_ilms.clear ();
+  m_ftns.clear ();
+}
+
+Label
+MplsSegmentRoutingHelper::GetNodeLabel (Ptr<Node> node) const
+{
+  int32_t index = GetNodeIndex (node);
+  NS_ASSERT_MSG (index >= 0, "MplsSegmentRoutingHelper::GetNodeLabel (): Unknown node");
+  return Label (m_srgbBase + m_sids[index]);
+}
+
+Label
+MplsSegmentRoutingHelper::GetAdjacencyLabel (Ptr<Interface> interface) const
+{
+  int32_t link = GetLinkIndex (interface);
+  NS_ASSERT_MSG (link >= 0, "MplsSegmentRoutingHelper::GetAdjacencyLabel (): Interface has no adjacency");
+  return Label (m_adjacencyLabels[link]);
+}
+
+Nhlfe
+MplsSegmentRoutingHelper::GetNhlfe (Ptr<Node> ingress, const SegmentList &segments) const
+{
+  int32_t ingressIndex = GetNodeIndex (ingress);
+  NS_ASSERT_MSG (ingressIndex >= 0, "MplsSegmentRoutingHelper::GetNhlfe (): Unknown ingress");
+
+  std::vector<uint32_t> labels;
+  uint32_t end;
+  int32_t firstLink = GetLabels (ingressIndex, segments, false, labels, end);
+
+  NS_ASSERT_MSG (firstLink >= 0 || !labels.empty (), "MplsSegmentRoutingHelper::GetNhlfe (): Empty segment list");
+
+  // operations take the bottom label first
+  std::reverse (labels.begin (), labels.end ());
+
+  if (firstLink < 0)
+    {
+      // binding segment of the ingress, resolved by its own ILM
+      return Nhlfe (Push (&labels[0], labels.size ()));
+    }
+
+  const MplsTopology::Link &link = m_topology->GetLink (firstLink);
+  if (labels.empty ())
+    {
+      return Nhlfe (Swap (Label (Label::IMPLICIT_NULL)), link.localIf, link.nextHop);
+    }
+
+  return Nhlfe (Swap (&labels[0], labels.size ()), link.localIf, link.nextHop);
+}
+
+Label
+MplsSegmentRoutingHelper::AddBindingSid (Ptr<Node> node, const SegmentList &segments)
+{
+  NS_LOG_FUNCTION (this << node);
+
+  int32_t index = GetNodeIndex (node);
+  NS_ASSERT_MSG (index >= 0, "MplsSegmentRoutingHelper::AddBindingSid (): Unknown node");
+
+  // the ILM resolves the pushed labels itself, so the first segment is always encoded
+  std::vector<uint32_t> labels;
+  Binding binding;
+  GetLabels (index, segments, true, labels, binding.end);
+  NS_ASSERT_MSG (!labels.empty (), "MplsSegmentRoutingHelper::AddBindingSid (): Empty segment list");
+  std::reverse (labels.begin (), labels.end ());
+
+  binding.node = index;
+  binding.label = m_switches[index].GetNode ()->GetLabelSpace (0)->Allocate ();
+  m_bindings.push_back (binding);
+
+  Nhlfe nhlfe (Push (&labels[0], labels.size ()));
+  m_ilms.push_back (std::make_pair (uint32_t (index), m_switches[index].AddIlm (Label (binding.label), nhlfe)));
+
+  NS_LOG_DEBUG ("Binding segment " << Label (binding.label) << " -- " << nhlfe);
+
+  return Label (binding.label);
+}
+
+int32_t
+MplsSegmentRoutingHelper::GetLabels (uint32_t node, const SegmentList &segments, bool encodeFirst,
+                                     std::vector<uint32_t> &labels, uint32_t &end) const
+{
+  uint32_t nNodes = m_switches.size ();
+  int32_t firstLink = -1;
+
+  // labels from the top of the stack, every label is looked up where the previous segment ends
+  labels.reserve (segments.size ());
+
+  for (SegmentList::const_iterator i = segments.begin (); i != segments.end (); ++i)
+    {
+      bool first = firstLink < 0 && labels.empty ();
+
+      if (i->GetInterface () != 0)
+        {
+          int32_t link = -1;
+          for (uint32_t l = m_topology->GetOutBegin (node); l < m_topology->GetOutEnd (node) && link < 0; ++l)
+            {
+              if (m_topology->GetLocalInterface (l) == i->GetInterface ())
+                {
+                  link = l;
+                }
+            }
+          NS_ASSERT_MSG (link >= 0, "MplsSegmentRoutingHelper::GetLabels (): Adjacency segment should start "
+                         "at the end of the previous segment");
+
+          if (first)
+            {
+              firstLink = link;
+            }
+          if (!first || encodeFirst)
+            {
+              labels.push_back (m_adjacencyLabels[link]);
+            }
+          node = m_topology->GetLink (link).to;
+          continue;
+        }
+
+      int32_t target = GetNodeIndex (i->GetNode ());
+      NS_ASSERT_MSG (target >= 0, "MplsSegmentRoutingHelper::GetLabels (): Unknown segment node");
+
+      // node segment, a binding segment of another node is reached by its node segment first
+      if (uint32_t (target) != node)
+        {
+          uint32_t label = m_srgbBase + m_sids[target];
+          if (first)
+            {
+              firstLink = m_trees[target * nNodes + node];
+              NS_ASSERT_MSG (firstLink >= 0, "MplsSegmentRoutingHelper::GetLabels (): Segment node is unreachable");
+              if (encodeFirst || m_topology->GetLink (firstLink).to != uint32_t (target))
+                {
+                  labels.push_back (label);
+                }
+            }
+          else
+            {
+              labels.push_back (label);
+            }
+          node = target;
+        }
+
+      if (i->GetBinding () != 0)
+        {
+          std::vector<Binding>::const_iterator binding = m_bindings.begin ();
+          while (binding != m_bindings.end () && (binding->node != node || binding->label != i->GetBinding ()))
+            {
+              ++binding;
+            }
+          NS_ASSERT_MSG (binding != m_bindings.end (), "MplsSegmentRoutingHelper::GetLabels (): Unknown binding "
+                         "segment " << Label (i->GetBinding ()));
+
+          labels.push_back (binding->label);
+          node = binding->end;
+        }
+    }
+
+  end = node;
+  return firstLink;
+}
+
+int32_t
+MplsSegmentRoutingHelper::GetNodeIndex (Ptr<Node> node) const
+{
+  if (node == 0 || node->GetId () >= m_nodeIndex.size ())
+    {
+      return -1;
+    }
+  return m_nodeIndex[node->GetId ()];
+}
+
+int32_t
+MplsSegmentRoutingHelper::GetLinkIndex (Ptr<Interface> interface) const
+{
+  for (uint32_t l = 0; l < m_adjacencyLabels.size (); ++l)
+    {
+      if (m_topology->GetLocalInterface (l) == interface)
+        {
+          return l;
+        }
+    }
+  return -1;
+}
+
+void
+MplsSegmentRoutingHelper::ComputeTree (uint32_t segment, std::vector<uint32_t> &dist)
+{
+  typedef std::pair<uint32_t, uint32_t> Candidate;
+
+  uint32_t nNodes = m_switches.size ();
+  int32_t *parent = &m_trees[segment * nNodes];
+
+  std::fill (dist.begin (), dist.end (), uint32_t (-1));
+
+  std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate> > queue;
+  dist[segment] = 0;
+  queue.push (Candidate (0, segment));
+
+  while (!queue.empty ())
+    {
+      Candidate c = queue.top ();
+      queue.pop ();
+
+      if (c.first > dist[c.second])
+        {
+          continue;
+        }
+
+      for (uint32_t i = m_topology->GetInBegin (c.second); i < m_topology->GetInEnd (c.second); ++i)
+        {
+          int32_t l = m_topology->GetInLink (i);
+          if (!m_linkUp[l])
+            {
+              continue;
+            }
+
+          const MplsTopology::Link &link = m_topology->GetLink (l);
+          uint32_t d = c.first + link.metric;
+
+          // equal cost paths are broken by the lowest link index, so trees are reproducible
+          if (d < dist[link.from])
+            {
+              dist[link.from] = d;
+              parent[link.from] = l;
+              queue.push (Candidate (d, link.from));
+            }
+          else if (d == dist[link.from] && l < parent[link.from])
+            {
+              parent[link.from] = l;
+            }
+        }
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,209 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010-2011 Andrey Churin, Stefano Avallone
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Andrey Churin <aachurin@gmail.com>
+ *         Stefano Avallone <stavallo@gmail.com>
+ */
+
+#ifndef MPLS_SEGMENT_ROUTING_HELPER_H
+#define MPLS_SEGMENT_ROUTING_HELPER_H
+
+#include <vector>
+
+#include "ns3/ptr.h"
+#include "ns3/assert.h"
+#include "ns3/node.h"
+#include "ns3/mpls-node.h"
+#include "ns3/mpls-interface.h"
+#include "ns3/mpls-nhlfe.h"
+#include "ns3/mpls-incoming-label-map.h"
+#include "ns3/mpls-fec-to-nhlfe.h"
+
+#include "mpls-network-discoverer.h"
+#include "mpls-nhlfe-selection-policy-helper.h"
+#include "mpls-switch.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup mpls
+ * \brief Segment routing (SR-MPLS) over a discovered mpls network.
+ *
+ * Every node reserves the same segment routing global block (SRGB) in its platform label space.
+ * A node segment (prefix SID) has a global index, the label of the segment is the SRGB base plus
+ * the index on every node. Every node installs one ILM per node segment which follows the
+ * shortest path (ipv4 interface metrics) towards the segment node, the penultimate hop pops the
+ * label. Every adjacency gets an adjacency segment: a label allocated out of the SRGB, whose ILM
+ * pops the label and sends the packet over the adjacency.
+ *
+ * Paths are source routed: the ingress FTN pushes the labels of a segment list, transit nodes
+ * keep no per-path state. The first segment selects the outgoing adjacency of the ingress and
+ * is not encoded when it ends at the next hop. Segment lists may be of any depth.
+ *
+ * A binding segment (binding SID) is a label of one node whose ILM pops the label and pushes a
+ * stored segment list, resolved by the ILM of the same node. A long path can be split into
+ * binding segments, so the ingress pushes a short stack and every packet carries fewer labels.
+ */
+class MplsSegmentRoutingHelper
+{
+public:
+  /**
+   * @brief Node segment or adjacency segment
+   */
+  class Segment
+  {
+  public:
+    /**
+     * @brief Node segment, the shortest path to the node
+     */
+    Segment (Ptr<Node> node);
+    /**
+     * @brief Adjacency segment, the link attached to the interface. The interface should belong
+     * to the node where the previous segment ends (to the ingress for the first segment)
+     */
+    Segment (Ptr<mpls::Interface> interface);
+    /**
+     * @brief Binding segment added by AddBindingSid on the node. The node segment of the node is
+     * encoded before the binding label unless the previous segment ends at the node
+     */
+    Segment (Ptr<Node> node, mpls::Label binding);
+
+    Ptr<Node> GetNode (void) const;
+    Ptr<mpls::Interface> GetInterface (void) const;
+    /**
+     * @brief Returns the binding label, 0 for node and adjacency segments
+     */
+    uint32_t GetBinding (void) const;
+
+  private:
+    Ptr<Node> m_node;
+    Ptr<mpls::Interface> m_interface;
+    uint32_t m_binding;
+  };
+
+  typedef std::vector<Segment> SegmentList;
+
+  MplsSegmentRoutingHelper ();
+  virtual ~MplsSegmentRoutingHelper ();
+
+  /**
+   * @brief Set SRGB, 16000 - 23999 by default
+   */
+  void SetSrgb (uint32_t base, uint32_t size);
+  /**
+   * @brief Set selection policy used for installed ILM/FTN entries
+   */
+  void SetSelectionPolicy (const NhlfeSelectionPolicyHelper &policy);
+  /**
+   * @brief Set index of the node segment, nodes without an explicit index get the index of the
+   * node in the topology
+   */
+  void SetNodeIndex (Ptr<Node> node, uint32_t index);
+  /**
+   * @brief Reserve SRGB and install node and adjacency segments on all nodes of the network
+   * @param network discoverer, DiscoverNetwork should be called first
+   */
+  void Install (const MplsNetworkDiscoverer &network);
+  /**
+   * @brief Remove installed segments and FTNs, release SRGB and adjacency labels
+   */
+  void Uninstall (void);
+  /**
+   * @brief Returns label of the node segment
+   */
+  mpls::Label GetNodeLabel (Ptr<Node> node) const;
+  /**
+   * @brief Returns label of the adjacency segment of the link attached to the interface
+   */
+  mpls::Label GetAdjacencyLabel (Ptr<mpls::Interface> interface) const;
+  /**
+   * @brief Returns NHLFE pushing the segment list at the ingress
+   */
+  mpls::Nhlfe GetNhlfe (Ptr<Node> ingress, const SegmentList &segments) const;
+  /**
+   * @brief Map FEC to the segment list at the ingress
+   */
+  template <class T>
+  Ptr<mpls::FecToNhlfe> AddFtn (Ptr<Node> ingress, const T &fec, const SegmentList &segments);
+  /**
+   * @brief Install binding segment on the node, its ILM pushes the labels of the segment list
+   * @returns allocated binding label
+   */
+  mpls::Label AddBindingSid (Ptr<Node> node, const SegmentList &segments);
+  /**
+   * @brief Returns number of installed ILM entries (node, adjacency and binding segments)
+   */
+  uint32_t GetNIlm (void) const;
+
+private:
+  struct Binding
+  {
+    uint32_t node;
+    uint32_t label;
+    // node where the segment list ends
+    uint32_t end;
+  };
+
+  int32_t GetNodeIndex (Ptr<Node> node) const;
+  /**
+   * Compute labels (top of the stack first) of the segment list starting at the node. Labels of a
+   * first segment which ends at the next hop are encoded only if encodeFirst is set. Returns the
+   * first link of the path, -1 if the list starts with a binding segment of the node
+   */
+  int32_t GetLabels (uint32_t node, const SegmentList &segments, bool encodeFirst, std::vector<uint32_t> &labels,
+                     uint32_t &end) const;
+  int32_t GetLinkIndex (Ptr<mpls::Interface> interface) const;
+  void ComputeTree (uint32_t node, std::vector<uint32_t> &dist);
+
+  uint32_t m_srgbBase;
+  uint32_t m_srgbSize;
+  NhlfeSelectionPolicyHelper m_policy;
+  std::vector<std::pair<Ptr<Node>, uint32_t> > m_indexes;
+
+  Ptr<const MplsTopology> m_topology;
+  // links of interfaces which are down do not carry node segments
+  std::vector<bool> m_linkUp;
+  std::vector<MplsSwitch> m_switches;
+  // topology index by node id, -1 for unknown nodes
+  std::vector<int32_t> m_nodeIndex;
+  // segment index of every node
+  std::vector<uint32_t> m_sids;
+  // adjacency label of every link
+  std::vector<uint32_t> m_adjacencyLabels;
+  // next link towards every segment node (segment * nNodes + node)
+  std::vector<int32_t> m_trees;
+  std::vector<Binding> m_bindings;
+
+  std::vector<std::pair<uint32_t, Ptr<mpls::IncomingLabelMap> > > m_ilms;
+  std::vector<std::pair<uint32_t, Ptr<mpls::FecToNhlfe> > > m_ftns;
+};
+
+template <class T>
+Ptr<mpls::FecToNhlfe>
+MplsSegmentRoutingHelper::AddFtn (Ptr<Node> ingress, const T &fec, const SegmentList &segments)
+{
+  int32_t node = GetNodeIndex (ingress);
+  NS_ASSERT_MSG (node >= 0, "MplsSegmentRoutingHelper::AddFtn (): Unknown ingress");
+
+  Ptr<mpls::FecToNhlfe> ftn = m_switches[node].AddFtn (fec, GetNhlfe (ingress, segments));
+  m_ftns.push_back (std::make_pair (uint32_t (node), ftn));
+  return ftn;
+}
+
+} // namespace ns3
+
+#endif /* MPLS_SEGMENT_ROUTING_HELPER_H */
@@ -0,0 +1,449 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010-2011 Andrey Churin, Stefano Avallone
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Andrey Churin <aachurin@gmail.com>
+ *         Stefano Avallone <stavallo@gmail.com>
+ */
+
+#include <algorithm>
+#include <queue>
+#include <functional>
+
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/mpls-nhlfe.h"
+#include "ns3/mpls-operations.h"
+#include "ns3/mpls-fast-reroute.h"
+
+#include "mpls-ti-lfa-helper.h"
+
+NS_LOG_COMPONENT_DEFINE ("MplsTiLfaHelper");
+
+namespace ns3 {
+
+using namespace mpls;
+
+static const uint32_t INFINITE_DISTANCE = uint32_t (-1);
+
+MplsTiLfaHelper::MplsTiLfaHelper ()
+  : m_protection (LINK_PROTECTION),
+    m_nProtected (0),
+    m_nUnprotected (0),
+    m_maxStackDepth (0),
+    m_computeTime (0)
+{
+}
+
+MplsTiLfaHelper::~MplsTiLfaHelper ()
+{
+}
+
+void
+MplsTiLfaHelper::SetProtection (Protection protection)
+{
+  m_protection = protection;
+}
+
+uint32_t
+MplsTiLfaHelper::GetNProtected (void) const
+{
+  return m_nProtected;
+}
+
+uint32_t
+MplsTiLfaHelper::GetNUnprotected (void) const
+{
+  return m_nUnprotected;
+}
+
+uint32_t
+MplsTiLfaHelper::GetMaxStackDepth (void) const
+{
+  return m_maxStackDepth;
+}
+
+int64_t
+MplsTiLfaHelper::GetComputeTime (void) const
+{
+  return m_computeTime;
+}
+
+void
+MplsTiLfaHelper::RemoveBackups (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  for (std::vector<std::pair<Ptr<MplsNode>, int32_t> >::const_iterator i = m_protected.begin ();
+       i != m_protected.end (); ++i)
+    {
+      i->first->GetFastReroute ()->RemoveBackups (i->second);
+    }
+
+  m_protected.clear ();
+}
+
+uint32_t
+MplsTiLfaHelper::InstallBackups (const MplsNetworkDiscoverer &network, const MplsGlobalLabelHelper &labels)
+{
+  NS_LOG_FUNCTION (this);
+
+  SystemWallClockMs clock;
+  clock.Start ();
+
+  RemoveBackups ();
+  BuildGraph (network);
+  ComputeDistances ();
+
+  m_nProtected = 0;
+  m_nUnprotected = 0;
+  m_maxStackDepth = 0;
+
+  uint32_t nDetours = 0;
+  uint32_t nNodes = m_nodes.size ();
+
+  for (uint32_t plr = 0; plr < nNodes; ++plr)
+    {
+      // outgoing links are sorted by the interface, links of one interface fail together
+      uint32_t begin = m_topology->GetOutBegin (plr);
+      uint32_t end = m_topology->GetOutEnd (plr);
+      while (begin < end)
+        {
+          uint32_t interface = m_topology->GetLink (begin).localIf;
+          uint32_t next = begin + 1;
+          while (next < end && m_topology->GetLink (next).localIf == interface)
+            {
+              ++next;
+            }
+
+          uint32_t installed = 0;
+          if (m_linkUp[begin])
+            {
+              m_failed.clear ();
+              for (uint32_t l = begin; l < next; ++l)
+                {
+                  m_failed.push_back (l);
+                }
+              for (uint32_t i = m_topology->GetInBegin (plr); i < m_topology->GetInEnd (plr); ++i)
+                {
+                  uint32_t l = m_topology->GetInLink (i);
+                  if (m_topology->GetLink (l).remoteIf == interface)
+                    {
+                      m_failed.push_back (l);
+                    }
+                }
+
+              // with node protection the link repair path is used only towards the next-hop itself
+              ComputeRepairTree (plr, interface, -1);
+              for (uint32_t l = begin; l < next; ++l)
+                {
+                  installed += ProtectAdjacency (l, -1, m_protection == NODE_PROTECTION, labels);
+                }
+
+              for (uint32_t l = begin; l < next && m_protection == NODE_PROTECTION; ++l)
+                {
+                  int32_t nextHop = m_topology->GetLink (l).to;
+                  ComputeRepairTree (plr, interface, nextHop);
+                  installed += ProtectAdjacency (l, nextHop, false, labels);
+                }
+            }
+
+          if (installed != 0)
+            {
+              m_protected.push_back (std::make_pair (m_nodes[plr], int32_t (interface)));
+              nDetours += installed;
+            }
+
+          begin = next;
+        }
+    }
+
+  m_computeTime = clock.End ();
+
+  NS_LOG_DEBUG ("Installed " << nDetours << " detours on " << m_protected.size () << " interfaces, " <<
+                m_nProtected << " protected, " << m_nUnprotected << " unprotected destinations in " <<
+                m_computeTime << "ms");
+
+  return nDetours;
+}
+
+void
+MplsTiLfaHelper::BuildGraph (const MplsNetworkDiscoverer &network)
+{
+  m_topology = network.GetTopology ();
+  NS_ASSERT_MSG (m_topology != 0, "MplsTiLfaHelper::InstallBackups (): Call DiscoverNetwork first");
+
+  m_nodes.resize (m_topology->GetNNodes ());
+  for (uint32_t i = 0; i < m_nodes.size (); ++i)
+    {
+      m_nodes[i] = m_topology->GetNode (i);
+    }
+
+  m_linkUp.resize (m_topology->GetNLinks ());
+  for (uint32_t i = 0; i < m_linkUp.size (); ++i)
+    {
+      m_linkUp[i] = m_topology->GetLocalInterface (i)->IsUp ();
+    }
+
+  m_repairDist.resize (m_nodes.size ());
+  m_repairParent.resize (m_nodes.size ());
+}
+
+void
+MplsTiLfaHelper::ComputeDistances (void)
+{
+  typedef std::pair<uint32_t, uint32_t> Candidate;
+
+  uint32_t nNodes = m_nodes.size ();
+  m_dist.assign (nNodes * nNodes, INFINITE_DISTANCE);
+
+  std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate> > queue;
+
+  for (uint32_t source = 0; source < nNodes; ++source)
+    {
+      uint32_t *dist = &m_dist[source * nNodes];
+      dist[source] = 0;
+      queue.push (Candidate (0, source));
+
+      while (!queue.empty ())
+        {
+          Candidate c = queue.top ();
+          queue.pop ();
+
+          if (c.first > dist[c.second])
+            {
+              continue;
+            }
+
+          for (uint32_t l = m_topology->GetOutBegin (c.second); l < m_topology->GetOutEnd (c.second); ++l)
+            {
+              const MplsTopology::Link &link = m_topology->GetLink (l);
+              uint32_t d = c.first + link.metric;
+              if (m_linkUp[l] && d < dist[link.to])
+                {
+                  dist[link.to] = d;
+                  queue.push (Candidate (d, link.to));
+                }
+            }
+        }
+    }
+}
+
+void
+MplsTiLfaHelper::ComputeRepairTree (uint32_t plr, uint32_t interface, int32_t failedNode)
+{
+  typedef std::pair<uint32_t, uint32_t> Candidate;
+
+  std::fill (m_repairDist.begin (), m_repairDist.end (), INFINITE_DISTANCE);
+  std::fill (m_repairParent.begin (), m_repairParent.end (), -1);
+
+  std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate> > queue;
+  m_repairDist[plr] = 0;
+  queue.push (Candidate (0, plr));
+
+  while (!queue.empty ())
+    {
+      Candidate c = queue.top ();
+      queue.pop ();
+
+      if (c.first > m_repairDist[c.second])
+        {
+          continue;
+        }
+
+      for (uint32_t l = m_topology->GetOutBegin (c.second); l < m_topology->GetOutEnd (c.second); ++l)
+        {
+          const MplsTopology::Link &link = m_topology->GetLink (l);
+          if (!m_linkUp[l] || int32_t (link.to) == failedNode || (c.second == plr && link.localIf == interface))
+            {
+              continue;
+            }
+
+          // equal cost paths are broken by the lowest link index, so repair paths are reproducible
+          uint32_t d = c.first + link.metric;
+          if (d < m_repairDist[link.to])
+            {
+              m_repairDist[link.to] = d;
+              m_repairParent[link.to] = l;
+              queue.push (Candidate (d, link.to));
+            }
+          else if (d == m_repairDist[link.to] && int32_t (l) < m_repairParent[link.to])
+            {
+              m_repairParent[link.to] = l;
+            }
+        }
+    }
+}
+
+bool
+MplsTiLfaHelper::AvoidsFailure (uint32_t from, uint32_t to, int32_t failedNode) const
+{
+  uint32_t nNodes = m_nodes.size ();
+  const uint32_t *dist = &m_dist[from * nNodes];
+  uint64_t d = dist[to];
+
+  if (d == INFINITE_DISTANCE)
+    {
+      return false;
+    }
+
+  // every shortest path avoids a link if the best path over it is strictly longer
+  for (std::vector<uint32_t>::const_iterator i = m_failed.begin (); i != m_failed.end (); ++i)
+    {
+      const MplsTopology::Link &link = m_topology->GetLink (*i);
+      if (d >= uint64_t (dist[link.from]) + link.metric + m_dist[link.to * nNodes + to])
+        {
+          return false;
+        }
+    }
+
+  if (failedNode >= 0)
+    {
+      if (from == uint32_t (failedNode) || to == uint32_t (failedNode) ||
+          d >= uint64_t (dist[failedNode]) + m_dist[failedNode * nNodes + to])
+        {
+          return false;
+        }
+    }
+
+  return true;
+}
+
+bool
+MplsTiLfaHelper::GetRepairStack (uint32_t plr, uint32_t destination, int32_t failedNode,
+                                 const MplsGlobalLabelHelper &labels, std::vector<uint32_t> &stack,
+                                 uint32_t &firstLink)
+{
+  if (m_repairParent[destination] < 0)
+    {
+      return false;
+    }
+
+  // post-convergence path without the PLR, the packet is sent to its first node directly
+  m_path.clear ();
+  for (uint32_t v = destination; v != plr; v = m_topology->GetLink (m_repairParent[v]).from)
+    {
+      m_path.push_back (v);
+    }
+  std::reverse (m_path.begin (), m_path.end ());
+  firstLink = m_repairParent[m_path.front ()];
+
+  // segment ends: the farthest P-space node of the current segment start, until a Q-space node
+  // is reached, then the destination itself
+  std::vector<uint32_t> ends;
+  uint32_t c = 0;
+  while (!AvoidsFailure (m_path[c], destination, failedNode))
+    {
+      uint32_t j = c;
+      while (j + 1 < m_path.size () && AvoidsFailure (m_path[c], m_path[j + 1], failedNode))
+        {
+          ++j;
+        }
+
+      if (j == c)
+        {
+          // the next link of the path is not a shortest path, an adjacency segment would be needed
+          return false;
+        }
+
+      ends.push_back (m_path[j]);
+      c = j;
+    }
+  ends.push_back (destination);
+
+  // labels from the top of the stack, the segment end pops the label of its own LSP (PHP)
+  stack.clear ();
+  uint32_t start = m_path.front ();
+  for (std::vector<uint32_t>::const_iterator i = ends.begin (); i != ends.end (); ++i)
+    {
+      if (*i == start)
+        {
+          continue;
+        }
+
+      Label label (0);
+      if (!labels.GetLabel (m_nodes[start], m_nodes[*i], label))
+        {
+          return false;
+        }
+      stack.push_back (label);
+      start = *i;
+    }
+
+  // swap operation takes the bottom label first
+  std::reverse (stack.begin (), stack.end ());
+  return true;
+}
+
+uint32_t
+MplsTiLfaHelper::ProtectAdjacency (uint32_t link, int32_t failedNode, bool nextHopOnly,
+                                   const MplsGlobalLabelHelper &labels)
+{
+  const MplsTopology::Link &protectedLink = m_topology->GetLink (link);
+  uint32_t plr = protectedLink.from;
+  uint32_t nextHop = protectedLink.to;
+  uint32_t nNodes = m_nodes.size ();
+  const uint32_t *plrDist = &m_dist[plr * nNodes];
+  const uint32_t *nextHopDist = &m_dist[nextHop * nNodes];
+
+  Ptr<FastReroute> frr = m_nodes[plr]->GetFastReroute ();
+  std::vector<uint32_t> stack;
+  uint32_t installed = 0;
+
+  for (uint32_t destination = 0; destination < nNodes; ++destination)
+    {
+      if (destination == plr || (nextHopOnly && destination != nextHop) ||
+          (failedNode >= 0 && destination == uint32_t (failedNode)))
+        {
+          continue;
+        }
+
+      // destinations having a shortest path over the protected link
+      if (nextHopDist[destination] == INFINITE_DISTANCE ||
+          plrDist[destination] != protectedLink.metric + nextHopDist[destination])
+        {
+          continue;
+        }
+
+      Label primary (Label::IMPLICIT_NULL);
+      if (destination != nextHop && !labels.GetLabel (m_nodes[nextHop], m_nodes[destination], primary))
+        {
+          continue;
+        }
+
+      uint32_t firstLink;
+      if (!GetRepairStack (plr, destination, failedNode, labels, stack, firstLink))
+        {
+          ++m_nUnprotected;
+          continue;
+        }
+
+      const MplsTopology::Link &repairLink = m_topology->GetLink (firstLink);
+      Nhlfe detour = stack.empty () ? Nhlfe (Swap (Label (Label::IMPLICIT_NULL)), repairLink.localIf, repairLink.nextHop)
+        : Nhlfe (Swap (&stack[0], stack.size ()), repairLink.localIf, repairLink.nextHop);
+
+      frr->AddDetour (protectedLink.localIf, protectedLink.nextHop, primary, detour);
+
+      m_maxStackDepth = std::max (m_maxStackDepth, uint32_t (stack.size ()));
+      ++m_nProtected;
+      ++installed;
+    }
+
+  return installed;
+}
+
+} // namespace ns3
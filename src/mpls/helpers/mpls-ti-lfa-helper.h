@@ -0,0 +1,140 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010-2011 Andrey Churin, Stefano Avallone
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Andrey Churin <aachurin@gmail.com>
+ *         Stefano Avallone <stavallo@gmail.com>
+ */
+
+#ifndef MPLS_TI_LFA_HELPER_H
+#define MPLS_TI_LFA_HELPER_H
+
+#include <vector>
+
+#include "ns3/ptr.h"
+#include "ns3/node.h"
+#include "ns3/mpls-node.h"
+#include "ns3/mpls-interface.h"
+
+#include "mpls-network-discoverer.h"
+#include "mpls-global-label-helper.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup mpls
+ * \brief Topology independent loop-free alternates: computes a repair path of every protected
+ * adjacency towards every destination and installs it as a fast reroute detour.
+ *
+ * The repair path is the post-convergence path, i.e. the shortest path from the point of local
+ * repair (PLR) once the protected interface (and, with node protection, the next-hop node) is
+ * removed. Its first hop is used as the detour adjacency, the rest of the path is split into
+ * segments: a segment ends at the farthest node of the path which every shortest path of the
+ * intact network from the segment start reaches without crossing the failure (P-space), the last
+ * segment starts at the first node whose every shortest path to the destination avoids the
+ * failure (Q-space). Segments are expressed by the labels which MplsGlobalLabelHelper has bound
+ * to the node LSPs, so the repair label stack is swapped for the outgoing label of the primary
+ * NHLFE. Paths which would need an adjacency segment are reported as unprotected.
+ *
+ * Shortest path distances between all nodes are computed once (memory grows with the square of
+ * the number of nodes), then one post-convergence SPF is run per protected interface (per
+ * next-hop with node protection). Detours are installed via MplsNode::GetFastReroute and used
+ * once the protected interface fails.
+ */
+class MplsTiLfaHelper
+{
+public:
+  /**
+   * @brief Protected element
+   */
+  enum Protection
+  {
+    LINK_PROTECTION,  // repair paths avoid the failed interface
+    NODE_PROTECTION,  // repair paths avoid the next-hop node as well (link protection for the next-hop itself)
+  };
+
+  MplsTiLfaHelper ();
+  virtual ~MplsTiLfaHelper ();
+
+  /**
+   * @brief Set protected element, link protection by default
+   */
+  void SetProtection (Protection protection);
+  /**
+   * @brief Compute repair paths of all adjacencies of the network and install them as detours,
+   * backups installed before by this helper are removed first
+   * @param network discoverer, DiscoverNetwork should be called first
+   * @param labels label state of the network, PopulateLabelTables should be called first
+   * @return number of installed detours
+   */
+  uint32_t InstallBackups (const MplsNetworkDiscoverer &network, const MplsGlobalLabelHelper &labels);
+  /**
+   * @brief Remove backups of the interfaces protected by the last InstallBackups (bypass tunnels
+   * added to these interfaces by other means are removed too)
+   */
+  void RemoveBackups (void);
+  /**
+   * @brief Returns number of (adjacency, destination) pairs protected by the last InstallBackups
+   */
+  uint32_t GetNProtected (void) const;
+  /**
+   * @brief Returns number of (adjacency, destination) pairs left without a repair path
+   */
+  uint32_t GetNUnprotected (void) const;
+  /**
+   * @brief Returns the deepest repair label stack installed by the last InstallBackups
+   */
+  uint32_t GetMaxStackDepth (void) const;
+  /**
+   * @brief Returns wall-clock time (in milliseconds) spent by the last InstallBackups
+   */
+  int64_t GetComputeTime (void) const;
+
+private:
+  void BuildGraph (const MplsNetworkDiscoverer &network);
+  void ComputeDistances (void);
+  uint32_t ProtectAdjacency (uint32_t link, int32_t failedNode, bool nextHopOnly,
+                             const MplsGlobalLabelHelper &labels);
+  void ComputeRepairTree (uint32_t plr, uint32_t interface, int32_t failedNode);
+  bool AvoidsFailure (uint32_t from, uint32_t to, int32_t failedNode) const;
+  bool GetRepairStack (uint32_t plr, uint32_t destination, int32_t failedNode,
+                       const MplsGlobalLabelHelper &labels, std::vector<uint32_t> &stack, uint32_t &firstLink);
+
+  Protection m_protection;
+
+  Ptr<const MplsTopology> m_topology;
+  std::vector<Ptr<MplsNode> > m_nodes;
+  // links of interfaces which are down are ignored, as they are by MplsGlobalLabelHelper
+  std::vector<bool> m_linkUp;
+  // distance between every two nodes of the intact network (from * nNodes + to)
+  std::vector<uint32_t> m_dist;
+  // links of the failed interface, in both directions
+  std::vector<uint32_t> m_failed;
+  // post-convergence SPF tree from the PLR
+  std::vector<uint32_t> m_repairDist;
+  std::vector<int32_t> m_repairParent;
+  std::vector<uint32_t> m_path;
+
+  std::vector<std::pair<Ptr<MplsNode>, int32_t> > m_protected;
+  uint32_t m_nProtected;
+  uint32_t m_nUnprotected;
+  uint32_t m_maxStackDepth;
+  int64_t m_computeTime;
+};
+
+} // namespace ns3
+
+#endif /* MPLS_TI_LFA_HELPER_H */
@@ -0,0 +1,280 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010-2011 Andrey Churin, Stefano Avallone
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Andrey Churin <aachurin@gmail.com>
+ *         Stefano Avallone <stavallo@gmail.com>
+ */
+
+#include <algorithm>
+
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ns3/ipv4.h"
+#include "ns3/channel.h"
+#include "ns3/data-rate.h"
+#include "ns3/mpls.h"
+
+#include "mpls-topology.h"
+
+NS_LOG_COMPONENT_DEFINE ("MplsTopology");
+
+namespace ns3 {
+
+using namespace mpls;
+
+namespace {
+
+struct LinkOrder
+{
+  const std::vector<MplsTopology::Link> *links;
+
+  bool operator() (uint32_t a, uint32_t b) const
+  {
+    const MplsTopology::Link &x = (*links)[a];
+    const MplsTopology::Link &y = (*links)[b];
+    return x.from < y.from || (x.from == y.from && (x.localIf < y.localIf || (x.localIf == y.localIf && x.to < y.to)));
+  }
+};
+
+} // anonymous namespace
+
+MplsTopology::MplsTopology ()
+{
+}
+
+MplsTopology::~MplsTopology ()
+{
+}
+
+uint32_t
+MplsTopology::GetNNodes (void) const
+{
+  return m_nodes.size ();
+}
+
+Ptr<MplsNode>
+MplsTopology::GetNode (uint32_t index) const
+{
+  NS_ASSERT (index < m_nodes.size ());
+  return m_nodes[index];
+}
+
+int32_t
+MplsTopology::GetNodeIndex (Ptr<const Node> node) const
+{
+  if (node == 0 || node->GetId () >= m_nodeIndex.size ())
+    {
+      return -1;
+    }
+  return m_nodeIndex[node->GetId ()];
+}
+
+int32_t
+MplsTopology::GetNodeIndex (const Ipv4Address &address) const
+{
+  const uint32_t *index = m_addresses.Find (address);
+  return index != 0 ? int32_t (*index) : -1;
+}
+
+uint32_t
+MplsTopology::GetNLinks (void) const
+{
+  return m_links.size ();
+}
+
+const MplsTopology::Link&
+MplsTopology::GetLink (uint32_t index) const
+{
+  NS_ASSERT (index < m_links.size ());
+  return m_links[index];
+}
+
+Ptr<Interface>
+MplsTopology::GetLocalInterface (uint32_t link) const
+{
+  NS_ASSERT (link < m_links.size ());
+  return m_localInterfaces[link];
+}
+
+Ptr<Interface>
+MplsTopology::GetRemoteInterface (uint32_t link) const
+{
+  NS_ASSERT (link < m_links.size ());
+  return m_remoteInterfaces[link];
+}
+
+uint32_t
+MplsTopology::GetOutBegin (uint32_t node) const
+{
+  return m_outBegin[node];
+}
+
+uint32_t
+MplsTopology::GetOutEnd (uint32_t node) const
+{
+  return m_outBegin[node + 1];
+}
+
+uint32_t
+MplsTopology::GetInBegin (uint32_t node) const
+{
+  return m_inBegin[node];
+}
+
+uint32_t
+MplsTopology::GetInEnd (uint32_t node) const
+{
+  return m_inBegin[node + 1];
+}
+
+uint32_t
+MplsTopology::GetInLink (uint32_t i) const
+{
+  return m_inLinks[i];
+}
+
+void
+MplsTopology::AddNode (Ptr<MplsNode> node)
+{
+  if (node->GetId () >= m_nodeIndex.size ())
+    {
+      m_nodeIndex.resize (node->GetId () + 1, -1);
+    }
+
+  uint32_t index = m_nodes.size ();
+  m_nodeIndex[node->GetId ()] = index;
+  m_nodes.push_back (node);
+
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  if (ipv4 == 0)
+    {
+      return;
+    }
+
+  for (uint32_t i = 0; i < ipv4->GetNInterfaces (); ++i)
+    {
+      for (uint32_t j = 0; j < ipv4->GetNAddresses (i); ++j)
+        {
+          Ipv4Address address = ipv4->GetAddress (i, j).GetLocal ();
+          if (address != Ipv4Address::GetLoopback ())
+            {
+              m_addresses[address] = index;
+            }
+        }
+    }
+}
+
+void
+MplsTopology::AddLink (Ptr<Interface> local, Ptr<Interface> remote, const Ipv4Address &nextHop)
+{
+  int32_t from = GetNodeIndex (local->GetMpls ()->GetNode ());
+  int32_t to = GetNodeIndex (remote->GetMpls ()->GetNode ());
+  if (from < 0 || to < 0)
+    {
+      return;
+    }
+
+  Ptr<NetDevice> device = local->GetDevice ();
+
+  Link link;
+  link.from = from;
+  link.to = to;
+  link.localIf = local->GetIfIndex ();
+  link.remoteIf = remote->GetIfIndex ();
+  link.metric = 1;
+  link.mtu = device->GetMtu ();
+  link.rate = 0;
+  link.delay = Seconds (0);
+  link.nextHop = nextHop;
+
+  int32_t ipv4if = local->LookupIpv4Interface ();
+  if (ipv4if >= 0)
+    {
+      link.metric = std::max<uint32_t> (1, local->GetMpls ()->GetIpv4 ()->GetMetric (ipv4if));
+    }
+
+  DataRateValue rate;
+  if (device->GetAttributeFailSafe ("DataRate", rate))
+    {
+      link.rate = rate.Get ().GetBitRate ();
+    }
+
+  TimeValue delay;
+  if (device->GetChannel () != 0 && device->GetChannel ()->GetAttributeFailSafe ("Delay", delay))
+    {
+      link.delay = delay.Get ();
+    }
+
+  m_links.push_back (link);
+  m_localInterfaces.push_back (local);
+  m_remoteInterfaces.push_back (remote);
+}
+
+void
+MplsTopology::Finalize (void)
+{
+  uint32_t nNodes = m_nodes.size ();
+  uint32_t nLinks = m_links.size ();
+
+  // sort links by source node, so outgoing links of every node are contiguous
+  std::vector<uint32_t> order (nLinks);
+  for (uint32_t i = 0; i < nLinks; ++i)
+    {
+      order[i] = i;
+    }
+  LinkOrder compare;
+  compare.links = &m_links;
+  std::sort (order.begin (), order.end (), compare);
+
+  std::vector<Link> links (nLinks);
+  std::vector<Ptr<Interface> > localInterfaces (nLinks);
+  std::vector<Ptr<Interface> > remoteInterfaces (nLinks);
+  for (uint32_t i = 0; i < nLinks; ++i)
+    {
+      links[i] = m_links[order[i]];
+      localInterfaces[i] = m_localInterfaces[order[i]];
+      remoteInterfaces[i] = m_remoteInterfaces[order[i]];
+    }
+  m_links.swap (links);
+  m_localInterfaces.swap (localInterfaces);
+  m_remoteInterfaces.swap (remoteInterfaces);
+
+  m_outBegin.assign (nNodes + 1, 0);
+  m_inBegin.assign (nNodes + 1, 0);
+  for (std::vector<Link>::const_iterator i = m_links.begin (); i != m_links.end (); ++i)
+    {
+      ++m_outBegin[(*i).from + 1];
+      ++m_inBegin[(*i).to + 1];
+    }
+  for (uint32_t i = 0; i < nNodes; ++i)
+    {
+      m_outBegin[i + 1] += m_outBegin[i];
+      m_inBegin[i + 1] += m_inBegin[i];
+    }
+
+  std::vector<uint32_t> pos (m_inBegin.begin (), m_inBegin.end () - 1);
+  m_inLinks.resize (nLinks);
+  for (uint32_t i = 0; i < nLinks; ++i)
+    {
+      m_inLinks[pos[m_links[i].to]++] = i;
+    }
+
+  NS_LOG_DEBUG ("Topology: " << nNodes << " nodes, " << nLinks << " links, " << m_addresses.GetSize () <<
+                " addresses");
+}
+
+} // namespace ns3
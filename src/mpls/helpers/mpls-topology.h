@@ -0,0 +1,150 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010-2011 Andrey Churin, Stefano Avallone
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Andrey Churin <aachurin@gmail.com>
+ *         Stefano Avallone <stavallo@gmail.com>
+ */
+
+#ifndef MPLS_TOPOLOGY_H
+#define MPLS_TOPOLOGY_H
+
+#include <vector>
+
+#include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
+#include "ns3/nstime.h"
+#include "ns3/node.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/mpls-node.h"
+#include "ns3/mpls-interface.h"
+
+#include "mpls-ipv4-address-map.h"
+
+namespace ns3 {
+
+class MplsNetworkDiscoverer;
+
+/**
+ * \ingroup mpls
+ * \brief Immutable graph of a discovered mpls network in compressed sparse row form.
+ *
+ * Nodes are numbered densely from zero. Links are directed, sorted by the source node and then by
+ * the outgoing interface, so the outgoing links of a node form one range of link indexes. Incoming
+ * links of a node are listed in a separate index array. Link attributes are stored by value
+ * in one array, the graph is built by MplsNetworkDiscoverer (every update of the network creates a new one) and never changes,
+ * so it can be shared between path computations (including concurrent ones).
+ */
+class MplsTopology : public SimpleRefCount<MplsTopology>
+{
+public:
+  /**
+   * @brief Directed link between two mpls interfaces
+   */
+  struct Link
+  {
+    uint32_t from;          // index of the source node
+    uint32_t to;            // index of the destination node
+    uint32_t localIf;       // mpls interface index on the source node
+    uint32_t remoteIf;      // mpls interface index on the destination node
+    uint32_t metric;        // ipv4 interface metric (at least 1)
+    uint32_t mtu;           // device mtu
+    uint64_t rate;          // device data rate (bps), 0 if unknown
+    Time delay;             // channel delay, zero if unknown
+    Ipv4Address nextHop;    // address of the remote interface
+  };
+
+  ~MplsTopology ();
+
+  /**
+   * @brief Returns number of nodes
+   */
+  uint32_t GetNNodes (void) const;
+  /**
+   * @brief Returns node by index
+   */
+  Ptr<MplsNode> GetNode (uint32_t index) const;
+  /**
+   * @brief Returns index of the node or -1
+   */
+  int32_t GetNodeIndex (Ptr<const Node> node) const;
+  /**
+   * @brief Returns index of the node owning the address or -1
+   */
+  int32_t GetNodeIndex (const Ipv4Address &address) const;
+  /**
+   * @brief Returns number of links
+   */
+  uint32_t GetNLinks (void) const;
+  /**
+   * @brief Returns link by index
+   */
+  const Link& GetLink (uint32_t index) const;
+  /**
+   * @brief Returns mpls interface at the source of the link
+   */
+  Ptr<mpls::Interface> GetLocalInterface (uint32_t link) const;
+  /**
+   * @brief Returns mpls interface at the destination of the link
+   */
+  Ptr<mpls::Interface> GetRemoteInterface (uint32_t link) const;
+  /**
+   * @brief Returns index of the first outgoing link of the node, outgoing links are [GetOutBegin, GetOutEnd)
+   */
+  uint32_t GetOutBegin (uint32_t node) const;
+  /**
+   * @brief Returns index past the last outgoing link of the node
+   */
+  uint32_t GetOutEnd (uint32_t node) const;
+  /**
+   * @brief Returns position of the first incoming link of the node, incoming links are
+   * GetInLink (i) for i in [GetInBegin, GetInEnd)
+   */
+  uint32_t GetInBegin (uint32_t node) const;
+  /**
+   * @brief Returns position past the last incoming link of the node
+   */
+  uint32_t GetInEnd (uint32_t node) const;
+  /**
+   * @brief Returns link index at the position of the incoming links array
+   */
+  uint32_t GetInLink (uint32_t i) const;
+
+private:
+  friend class MplsNetworkDiscoverer;
+
+  MplsTopology ();
+
+  void AddNode (Ptr<MplsNode> node);
+  void AddLink (Ptr<mpls::Interface> local, Ptr<mpls::Interface> remote, const Ipv4Address &nextHop);
+  void Finalize (void);
+
+  std::vector<Ptr<MplsNode> > m_nodes;
+  std::vector<int32_t> m_nodeIndex;
+  Ipv4AddressMap<uint32_t> m_addresses;
+
+  std::vector<Link> m_links;
+  std::vector<Ptr<mpls::Interface> > m_localInterfaces;
+  std::vector<Ptr<mpls::Interface> > m_remoteInterfaces;
+
+  std::vector<uint32_t> m_outBegin;
+  std::vector<uint32_t> m_inBegin;
+  std::vector<uint32_t> m_inLinks;
+};
+
+} // namespace ns3
+
+#endif /* MPLS_TOPOLOGY_H */
@@ -20,9 +20,17 @@
  */
 
 #include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ns3/ipv4.h"
+#include "ns3/mpls.h"
+#include "ns3/mpls-label.h"
+#include "ns3/mpls-operations.h"
+#include "ns3/mpls-nhlfe.h"
 
 #include "mpls-tunnel-helper.h"
 
+NS_LOG_COMPONENT_DEFINE ("MplsTunnelHelper");
+
 namespace ns3 {
 
 using namespace mpls;
@@ -36,6 +44,18 @@ TunnelId::~TunnelId(void)
 {
 }
 
+bool
+TunnelId::operator== (const TunnelId &other) const
+{
+  return m_id == other.m_id;
+}
+
+bool
+TunnelId::operator< (const TunnelId &other) const
+{
+  return m_id < other.m_id;
+}
+
 size_t
 TunnelId::Hash::operator() (TunnelId const &x) const
 {
@@ -145,7 +165,15 @@ Lsp::End (void) const
   return m_nodes.end ();
 }
 
+MplsTunnelHelper::TunnelMap::TunnelMap ()
+  : m_addressesValid (false),
+    m_lastId (0)
+{
+}
+
 MplsTunnelHelper::MplsTunnelHelper(void)
+  : m_tunnels (Create<TunnelMap> ()),
+    m_policy ()
 {
 }
 
@@ -155,25 +183,275 @@ MplsTunnelHelper::~MplsTunnelHelper(void)
 
 MplsTunnelHelper::MplsTunnelHelper (const MplsTunnelHelper &o)
 {
-  //m_tunnels = o.m_tunnels;
+  m_tunnels = o.m_tunnels;
+  m_policy = o.m_policy;
 }
 
 MplsTunnelHelper& 
 MplsTunnelHelper::operator= (const MplsTunnelHelper &o)
 {
-  //m_tunnels = o.m_tunnels;
+  if (this == &o)
+    {
+      return *this;
+    }
+
+  m_tunnels = o.m_tunnels;
+  m_policy = o.m_policy;
   return *this;
 }
 
+void
+MplsTunnelHelper::SetTunnelSelectionPolicy (const NhlfeSelectionPolicyHelper &policy)
+{
+  m_policy = policy;
+}
+
 TunnelId 
 MplsTunnelHelper::CreateTunnel (const Lsp &lsp)
 {
-  return TunnelId (0);
+  PendingEntries pending;
+  TunnelId tunnel = AddTunnel (lsp, 0, pending);
+  CommitEntries (pending);
+  return tunnel;
+}
+
+std::vector<TunnelId>
+MplsTunnelHelper::CreateTunnels (const std::vector<Lsp> &lsps)
+{
+  NS_LOG_FUNCTION (this << lsps.size ());
+
+  PendingEntries pending;
+  std::vector<TunnelId> tunnels;
+  tunnels.reserve (lsps.size ());
+
+  for (std::vector<Lsp>::const_iterator i = lsps.begin (); i != lsps.end (); ++i)
+    {
+      tunnels.push_back (AddTunnel (*i, 0, pending));
+    }
+
+  CommitEntries (pending);
+  return tunnels;
 }
 
 void
 MplsTunnelHelper::DestroyTunnel (const TunnelId &tunnel)
 {
+  TunnelMap::Iterator i = m_tunnels->m_tunnels.find (tunnel);
+  NS_ASSERT_MSG (i != m_tunnels->m_tunnels.end (), "MplsTunnelHelper::DestroyTunnel (): unknown tunnel");
+
+  Tunnel &t = i->second;
+  t.ingress->GetFtnTable ()->remove (t.ftn);
+
+  for (std::vector<std::pair<Ptr<MplsNode>, Ptr<IncomingLabelMap> > >::iterator j = t.ilms.begin ();
+       j != t.ilms.end (); ++j)
+    {
+      Ptr<MplsNode> node = j->first;
+      Ptr<IncomingLabelMap> ilm = j->second;
+      node->GetIlmTable ()->remove (ilm);
+      node->GetLabelSpace (ilm->GetInterface ())->Deallocate (ilm->GetLabel ());
+    }
+
+  m_tunnels->m_tunnels.erase (i);
+}
+
+uint32_t
+MplsTunnelHelper::GetNTunnels (void) const
+{
+  return m_tunnels->m_tunnels.size ();
+}
+
+Ptr<MplsNode>
+MplsTunnelHelper::FindNode (const Ipv4Address &address)
+{
+  TunnelMap::AddressMap &addresses = m_tunnels->m_addresses;
+  if (m_tunnels->m_addressesValid)
+    {
+      Ptr<MplsNode> *node = addresses.Find (address);
+      return node != 0 ? *node : 0;
+    }
+
+  // the network is scanned once, an unknown address does not trigger another scan
+  m_tunnels->m_addressesValid = true;
+
+  const NodeContainer &nodes = GetNetworkNodes ();
+  for (NodeContainer::Iterator n = nodes.Begin (); n != nodes.End (); ++n)
+    {
+      Ptr<MplsNode> node = DynamicCast<MplsNode> (*n);
+      Ptr<Ipv4> ipv4 = (*n)->GetObject<Ipv4> ();
+      if (node == 0 || ipv4 == 0)
+        {
+          continue;
+        }
+
+      for (uint32_t j = 0; j < ipv4->GetNInterfaces (); ++j)
+        {
+          for (uint32_t k = 0; k < ipv4->GetNAddresses (j); ++k)
+            {
+              addresses[ipv4->GetAddress (j, k).GetLocal ()] = node;
+            }
+        }
+    }
+
+  Ptr<MplsNode> *node = addresses.Find (address);
+  return node != 0 ? *node : 0;
+}
+
+void
+MplsTunnelHelper::ResolvePath (const Lsp &lsp, std::vector<Hop> &hops)
+{
+  hops.clear ();
+
+  for (Lsp::Iterator i = lsp.Begin (); i != lsp.End (); ++i)
+    {
+      Hop hop;
+      hop.inIfIndex = -1;
+      hop.outIfIndex = -1;
+
+      if (i->GetNode () != 0)
+        {
+          hop.node = DynamicCast<MplsNode> (i->GetNode ());
+          NS_ASSERT_MSG (hop.node != 0, "MplsTunnelHelper::CreateTunnel (): Possible you use Node instead of MplsNode");
+        }
+      else
+        {
+          hop.node = FindNode (i->GetAddress ());
+          NS_ASSERT_MSG (hop.node != 0, "MplsTunnelHelper::CreateTunnel (): Unknown address " << i->GetAddress ());
+        }
+
+      if (!hops.empty ())
+        {
+          ConnectHops (*i, hops.back (), hop);
+        }
+
+      hops.push_back (hop);
+    }
+
+  NS_ASSERT_MSG (hops.size () > 1, "MplsTunnelHelper::CreateTunnel (): LSP should contain at least two nodes");
+}
+
+void
+MplsTunnelHelper::ConnectHops (const LspNode &lspNode, Hop &from, Hop &to) const
+{
+  NS_ASSERT_MSG (from.node != to.node, "MplsTunnelHelper::CreateTunnel (): LSP has a loop at node " 
+                 << to.node->GetId ());
+
+  Ptr<Ipv4> fromIpv4 = from.node->GetObject<Ipv4> ();
+  Ptr<Ipv4> toIpv4 = to.node->GetObject<Ipv4> ();
+  Ptr<Mpls> fromMpls = from.node->GetObject<Mpls> ();
+  Ptr<Mpls> toMpls = to.node->GetObject<Mpls> ();
+  NS_ASSERT_MSG (fromIpv4 != 0 && toIpv4 != 0, "MplsTunnelHelper::CreateTunnel (): There is no ipv4 installed");
+  NS_ASSERT_MSG (fromMpls != 0 && toMpls != 0, "MplsTunnelHelper::CreateTunnel (): There is no mpls installed");
+
+  // look for a pair of mpls enabled interfaces attached to the same subnet
+  for (uint32_t i = 0; i < fromIpv4->GetNInterfaces (); ++i)
+    {
+      Ptr<mpls::Interface> outIf = fromMpls->GetInterfaceForDevice (fromIpv4->GetNetDevice (i));
+      if (outIf == 0)
+        {
+          continue;
+        }
+
+      for (uint32_t j = 0; j < fromIpv4->GetNAddresses (i); ++j)
+        {
+          Ipv4InterfaceAddress local = fromIpv4->GetAddress (i, j);
+
+          for (uint32_t k = 0; k < toIpv4->GetNInterfaces (); ++k)
+            {
+              Ptr<mpls::Interface> inIf = toMpls->GetInterfaceForDevice (toIpv4->GetNetDevice (k));
+              if (inIf == 0)
+                {
+                  continue;
+                }
+
+              for (uint32_t l = 0; l < toIpv4->GetNAddresses (k); ++l)
+                {
+                  Ipv4Address remote = toIpv4->GetAddress (k, l).GetLocal ();
+
+                  if (lspNode.GetNode () == 0 && remote != lspNode.GetAddress ())
+                    {
+                      continue;
+                    }
+
+                  if (local.GetMask ().IsMatch (local.GetLocal (), remote))
+                    {
+                      from.outIfIndex = outIf->GetIfIndex ();
+                      from.nextHop = remote;
+                      to.inIfIndex = inIf->GetIfIndex ();
+                      return;
+                    }
+                }
+            }
+        }
+    }
+
+  NS_FATAL_ERROR ("MplsTunnelHelper::CreateTunnel (): Nodes " << from.node->GetId () << " and "
+                  << to.node->GetId () << " are not adjacent");
+}
+
+TunnelId
+MplsTunnelHelper::AddTunnel (const Lsp &lsp, Fec *fec, PendingEntries &pending)
+{
+  std::vector<Hop> hops;
+  ResolvePath (lsp, hops);
+
+  uint32_t egress = hops.size () - 1;
+
+  // label bound to the tunnel by every node, the penultimate hop pops it
+  std::vector<uint32_t> labels (hops.size (), Label::IMPLICIT_NULL);
+  for (uint32_t i = 1; i < egress; ++i)
+    {
+      labels[i] = hops[i].node->GetLabelSpace (hops[i].inIfIndex)->Allocate ();
+    }
+
+  if (fec == 0)
+    {
+      fec = Fec::Build (Ipv4Destination (hops[egress - 1].nextHop));
+    }
+
+  Tunnel tunnel;
+  tunnel.ingress = hops[0].node;
+  tunnel.ftn = Create<FecToNhlfe> (fec, Nhlfe (Swap (labels[1]), hops[0].outIfIndex, hops[0].nextHop), 
+                                   m_policy.Create ());
+  pending[tunnel.ingress].ftns.push_back (tunnel.ftn);
+
+  tunnel.ilms.reserve (egress);
+  for (uint32_t i = 1; i < egress; ++i)
+    {
+      Ptr<IncomingLabelMap> ilm = Create<IncomingLabelMap> (hops[i].inIfIndex, labels[i], 
+        Nhlfe (Swap (labels[i + 1]), hops[i].outIfIndex, hops[i].nextHop), m_policy.Create ());
+      pending[hops[i].node].ilms.push_back (ilm);
+      tunnel.ilms.push_back (std::make_pair (hops[i].node, ilm));
+    }
+
+  TunnelId id (++m_tunnels->m_lastId);
+  m_tunnels->m_tunnels.insert (std::make_pair (id, tunnel));
+
+  NS_LOG_DEBUG ("Tunnel " << id.m_id << " created, ingress node " << tunnel.ingress->GetId () 
+                << ", " << hops.size () << " nodes");
+  return id;
+}
+
+void
+MplsTunnelHelper::CommitEntries (PendingEntries &pending)
+{
+  for (PendingEntries::iterator i = pending.begin (); i != pending.end (); ++i)
+    {
+      Ptr<MplsNode> node = i->first;
+      NodeEntries &entries = i->second;
+
+      if (!entries.ilms.empty ())
+        {
+          MplsNode::IlmTable *ilmTable = node->GetIlmTable ();
+          ilmTable->splice (ilmTable->end (), entries.ilms);
+          node->RebuildIlmIndex ();
+        }
+
+      if (!entries.ftns.empty ())
+        {
+          MplsNode::FtnTable *ftnTable = node->GetFtnTable ();
+          ftnTable->splice (ftnTable->end (), entries.ftns);
+        }
+    }
 }
 
 }// namespace ns3
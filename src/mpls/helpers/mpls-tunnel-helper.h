@@ -22,10 +22,24 @@
 #ifndef MPLS_TUNNEL_HELPER_H
 #define MPLS_TUNNEL_HELPER_H
 
+#include <list>
+#include <map>
+#include <vector>
+#include <utility>
+
 #include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/node.h"
+#include "ns3/mpls-node.h"
 #include "ns3/mpls-interface.h"
+#include "ns3/mpls-fec.h"
+#include "ns3/mpls-incoming-label-map.h"
+#include "ns3/mpls-fec-to-nhlfe.h"
 
+#include "mpls-ipv4-address-map.h"
 #include "mpls-network-helper-base.h"
+#include "mpls-nhlfe-selection-policy-helper.h"
 
 namespace ns3 {
 
@@ -39,6 +53,9 @@ class TunnelId
 public:
   ~TunnelId ();
 
+  bool operator== (const TunnelId &other) const;
+  bool operator< (const TunnelId &other) const;
+
   class Hash : public std::unary_function<TunnelId, size_t> 
   {
   public:
@@ -97,7 +114,13 @@ private:
 
 
 /**
- * \brief 
+ * \brief Creates explicitly routed LSPs (tunnels) in the network.
+ *
+ * Every node of the LSP except the ingress binds a label to the tunnel, allocated from the label space
+ * of the incoming interface. The ingress gets a FTN entry, transit nodes get ILM entries bound to the
+ * incoming interface, the penultimate hop pops the label (implicit null). An LSP node can be specified
+ * either by a node or by an address of the node's interface the LSP enters through. Addresses are
+ * resolved through a table built on the first lookup, so assign them before creating tunnels.
  */
 class MplsTunnelHelper : public MplsNetworkHelperBase
 {
@@ -113,23 +136,100 @@ public:
 
   MplsTunnelHelper (const MplsTunnelHelper &o);
   MplsTunnelHelper& operator= (const MplsTunnelHelper &o);
-  
+
+  /**
+   * @brief Set selection policy used for ILM/FTN entries of new tunnels
+   */
+  void SetTunnelSelectionPolicy (const NhlfeSelectionPolicyHelper &policy);
+  /**
+   * @brief Create tunnel for the /32 FEC of the address the LSP enters the egress through
+   * @param lsp LSP nodes, the first one is the ingress and the last one is the egress
+   * @return tunnel identifier
+   */
   TunnelId CreateTunnel (const Lsp &lsp);
+  /**
+   * @brief Create tunnel for the specified FEC
+   * @param lsp LSP nodes, the first one is the ingress and the last one is the egress
+   * @param fec FEC mapped to the tunnel at the ingress
+   * @return tunnel identifier
+   */
+  template <class T>
+  TunnelId CreateTunnel (const Lsp &lsp, const T &fec);
+  /**
+   * @brief Create tunnels in one batch. Entries are added to ILM/FTN tables of every node at once
+   * and ILM index of every node is rebuilt once per batch
+   * @param lsps LSPs, see CreateTunnel (const Lsp &lsp)
+   * @return tunnel identifiers in the same order as LSPs
+   */
+  std::vector<TunnelId> CreateTunnels (const std::vector<Lsp> &lsps);
+  /**
+   * @brief Remove ILM/FTN entries of the tunnel and release its labels
+   */
   void DestroyTunnel (const TunnelId &tunnel);
-    
+  /**
+   * @brief Returns number of created tunnels
+   */
+  uint32_t GetNTunnels (void) const;
+
 private:
-/*  class TunnelMap : public SimpleRefCount<TunnelMap>
+  struct Hop
+  {
+    Ptr<MplsNode> node;
+    int32_t inIfIndex;
+    int32_t outIfIndex;
+    Ipv4Address nextHop;
+  };
+
+  struct Tunnel
+  {
+    Ptr<MplsNode> ingress;
+    Ptr<FecToNhlfe> ftn;
+    std::vector<std::pair<Ptr<MplsNode>, Ptr<IncomingLabelMap> > > ilms;
+  };
+
+  struct NodeEntries
+  {
+    MplsNode::IlmTable ilms;
+    MplsNode::FtnTable ftns;
+  };
+
+  typedef std::map<Ptr<MplsNode>, NodeEntries> PendingEntries;
+
+  class TunnelMap : public SimpleRefCount<TunnelMap>
   {
   public:
-    typedef sgi::hash_map<TunnelId, TunnelId::Hash> HashMap;
-    typedef sgi::hash_map<TunnelId, TunnelId::Hash>::iterator Iterator;
-    HashMap m_tunnels;
+    typedef std::map<TunnelId, Tunnel> Map;
+    typedef std::map<TunnelId, Tunnel>::iterator Iterator;
+    typedef Ipv4AddressMap<Ptr<MplsNode> > AddressMap;
+
+    TunnelMap ();
+
+    Map m_tunnels;
+    AddressMap m_addresses;
+    bool m_addressesValid;
+    uint32_t m_lastId;
   };
-  
-  Ptr<Interface> FindInterfaceForAddress (const Ipv4Address &addr);
-  Ptr<TunnelMap> m_tunnels;*/
+
+  Ptr<MplsNode> FindNode (const Ipv4Address &address);
+  void ResolvePath (const Lsp &lsp, std::vector<Hop> &hops);
+  void ConnectHops (const LspNode &lspNode, Hop &from, Hop &to) const;
+  TunnelId AddTunnel (const Lsp &lsp, Fec *fec, PendingEntries &pending);
+  void CommitEntries (PendingEntries &pending);
+
+  Ptr<TunnelMap> m_tunnels;
+  NhlfeSelectionPolicyHelper m_policy;
 };
 
+template <class T>
+TunnelId
+MplsTunnelHelper::CreateTunnel (const Lsp &lsp, const T &fec)
+{
+  PendingEntries pending;
+  TunnelId tunnel = AddTunnel (lsp, Fec::Build (fec), pending);
+  CommitEntries (pending);
+  return tunnel;
+}
+
 } // namespace ns3
 
 #endif /* MPLS_TUNNEL_HELPER_H */
@@ -0,0 +1,241 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010-2011 Andrey Churin, Stefano Avallone
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Andrey Churin <aachurin@gmail.com>
+ *         Stefano Avallone <stavallo@gmail.com>
+ */
+
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+#include "mpls-fast-reroute.h"
+
+NS_LOG_COMPONENT_DEFINE ("mpls::FastReroute");
+
+namespace ns3 {
+namespace mpls {
+
+FastReroute::FastReroute ()
+{
+}
+
+FastReroute::~FastReroute ()
+{
+}
+
+FastReroute::Protection&
+FastReroute::GetProtection (int32_t interface, const Address &nextHop)
+{
+  NS_ASSERT_MSG (interface >= 0, "FastReroute: protected interface should be set");
+
+  if ((uint32_t)interface >= m_protections.size ())
+    {
+      m_protections.resize (interface + 1);
+      m_failed.resize (interface + 1, false);
+    }
+
+  ProtectionList &list = m_protections[interface];
+  for (ProtectionList::iterator i = list.begin (); i != list.end (); ++i)
+    {
+      if (i->nextHop == nextHop)
+        {
+          return *i;
+        }
+    }
+
+  list.push_back (Protection ());
+  list.back ().nextHop = nextHop;
+  return list.back ();
+}
+
+void
+FastReroute::SetInterfaceLiveness (const Ptr<InterfaceLiveness> &liveness)
+{
+  m_liveness = liveness;
+}
+
+void
+FastReroute::UpdateLiveness (int32_t interface)
+{
+  // NHLFEs of a failed interface are selectable only while fast reroute can send them elsewhere
+  if (m_liveness != 0 && IsFailed (interface))
+    {
+      m_liveness->SetAlive (interface, HasBackups (interface));
+    }
+}
+
+void
+FastReroute::AddBypass (int32_t interface, const Address &nextHop, const Nhlfe &bypass)
+{
+  NS_LOG_FUNCTION (this << interface << nextHop << bypass);
+  NS_ASSERT_MSG (bypass.GetInterface () >= 0 && bypass.GetInterface () != interface,
+                 "FastReroute::AddBypass (): bypass should use another outgoing interface");
+
+  Protection &protection = GetProtection (interface, nextHop);
+  protection.bypass.assign (1, bypass);
+  UpdateLiveness (interface);
+}
+
+void
+FastReroute::AddDetour (int32_t interface, const Address &nextHop, Label label, const Nhlfe &detour)
+{
+  NS_LOG_FUNCTION (this << interface << nextHop << label << detour);
+  NS_ASSERT_MSG (detour.GetInterface () >= 0 && detour.GetInterface () != interface,
+                 "FastReroute::AddDetour (): detour should use another outgoing interface");
+
+  Protection &protection = GetProtection (interface, nextHop);
+  protection.detours.erase (label);
+  protection.detours.insert (std::make_pair (uint32_t (label), detour));
+  UpdateLiveness (interface);
+}
+
+void
+FastReroute::RemoveBackups (int32_t interface)
+{
+  if (interface >= 0 && (uint32_t)interface < m_protections.size ())
+    {
+      m_protections[interface].clear ();
+      UpdateLiveness (interface);
+    }
+}
+
+bool
+FastReroute::HasBackups (int32_t interface) const
+{
+  return interface >= 0 && (uint32_t)interface < m_protections.size () && !m_protections[interface].empty ();
+}
+
+uint32_t
+FastReroute::Fail (int32_t interface)
+{
+  NS_LOG_FUNCTION (this << interface);
+
+  if (interface < 0)
+    {
+      return 0;
+    }
+
+  if ((uint32_t)interface >= m_failed.size ())
+    {
+      m_protections.resize (interface + 1);
+      m_failed.resize (interface + 1, false);
+    }
+
+  if (m_failed[interface])
+    {
+      return 0;
+    }
+
+  m_failed[interface] = true;
+
+  uint32_t adjacencies = m_protections[interface].size ();
+  if (adjacencies == 0)
+    {
+      return 0;
+    }
+
+  Event event;
+  event.time = Simulator::Now ();
+  event.interface = interface;
+  event.adjacencies = adjacencies;
+  m_events.push_back (event);
+
+  NS_LOG_DEBUG ("Interface " << interface << " failed -- " << adjacencies << " adjacencies switched to backup");
+
+  return adjacencies;
+}
+
+void
+FastReroute::Restore (int32_t interface)
+{
+  NS_LOG_FUNCTION (this << interface);
+
+  if (interface >= 0 && (uint32_t)interface < m_failed.size ())
+    {
+      m_failed[interface] = false;
+    }
+}
+
+bool
+FastReroute::IsFailed (int32_t interface) const
+{
+  return interface >= 0 && (uint32_t)interface < m_failed.size () && m_failed[interface];
+}
+
+const Nhlfe*
+FastReroute::Lookup (int32_t interface, const Nhlfe &primary, bool &bypass) const
+{
+  if (!IsFailed (interface))
+    {
+      return 0;
+    }
+
+  const ProtectionList &list = m_protections[interface];
+  const Protection *any = 0;
+  for (ProtectionList::const_iterator i = list.begin (); i != list.end (); ++i)
+    {
+      if (i->nextHop == primary.GetNextHop ())
+        {
+          any = &*i;
+          break;
+        }
+      if (i->nextHop.IsInvalid ())
+        {
+          any = &*i;
+        }
+    }
+
+  if (any == 0)
+    {
+      return 0;
+    }
+
+  if (!any->detours.empty () && primary.GetOpCode () == OP_SWAP)
+    {
+      std::map<uint32_t, Nhlfe>::const_iterator j = any->detours.find (primary.GetLabel (0));
+      if (j != any->detours.end ())
+        {
+          bypass = false;
+          return &j->second;
+        }
+    }
+
+  if (any->bypass.empty ())
+    {
+      return 0;
+    }
+
+  bypass = true;
+  return &any->bypass.front ();
+}
+
+uint32_t
+FastReroute::GetNEvents (void) const
+{
+  return m_events.size ();
+}
+
+const FastReroute::Event&
+FastReroute::GetEvent (uint32_t index) const
+{
+  NS_ASSERT_MSG (index < m_events.size (), "Invalid event index");
+  return m_events[index];
+}
+
+} // namespace mpls
+} // namespace ns3
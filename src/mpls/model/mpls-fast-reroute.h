@@ -0,0 +1,155 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010-2011 Andrey Churin, Stefano Avallone
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Andrey Churin <aachurin@gmail.com>
+ *         Stefano Avallone <stavallo@gmail.com>
+ */
+
+#ifndef MPLS_FAST_REROUTE_H
+#define MPLS_FAST_REROUTE_H
+
+#include <map>
+#include <vector>
+
+#include "ns3/simple-ref-count.h"
+#include "ns3/ptr.h"
+#include "ns3/address.h"
+#include "ns3/nstime.h"
+
+#include "mpls-label.h"
+#include "mpls-nhlfe.h"
+#include "mpls-interface-liveness.h"
+
+namespace ns3 {
+namespace mpls {
+
+/**
+ * \ingroup mpls
+ * \brief Precomputed backup NHLFEs of the protected adjacencies (RFC 4090 fast reroute)
+ *
+ * An adjacency is an outgoing interface and a next-hop. Facility backup protects all LSPs of an
+ * adjacency with one bypass tunnel: the primary NHLFE operation is performed as usual, then the
+ * labels of the bypass NHLFE are pushed and the packet is sent to the bypass interface and
+ * next-hop. One-to-one backup replaces the primary NHLFE swapping to the specified label with a
+ * detour NHLFE. Detours take precedence over the bypass of the same adjacency.
+ *
+ * Backups are used only while the protected interface is failed. Failing or restoring an
+ * interface flips its adjacencies at once, the forwarding path tests one flag per interface for
+ * unprotected traffic. Every failure of an interface with backups is recorded as an event.
+ *
+ * NHLFEs of a failed interface stay selectable (alive in the interface liveness bitmap) as long as
+ * the interface has backups, adding or removing backups of a failed interface updates the bitmap.
+ */
+class FastReroute : public SimpleRefCount<FastReroute>
+{
+public:
+  /**
+   * \brief Record of an interface failure
+   */
+  struct Event
+  {
+    Time time;              //!< simulation time of the switchover
+    int32_t interface;      //!< failed interface
+    uint32_t adjacencies;   //!< number of adjacencies switched to backup
+  };
+
+  FastReroute ();
+  ~FastReroute ();
+
+  /**
+   * @brief Set bitmap of selectable interfaces updated when backups of a failed interface change
+   */
+  void SetInterfaceLiveness (const Ptr<InterfaceLiveness> &liveness);
+  /**
+   * @brief Protect adjacency with a bypass tunnel (facility backup)
+   * @param interface protected outgoing interface
+   * @param nextHop protected next-hop (invalid address protects every next-hop of the interface)
+   * @param bypass outgoing interface and next-hop of the bypass tunnel, labels of a swap operation
+   * are pushed on top of the stack (pop pushes nothing)
+   */
+  void AddBypass (int32_t interface, const Address &nextHop, const Nhlfe &bypass);
+  /**
+   * @brief Protect LSP with a detour (one-to-one backup)
+   * @param interface protected outgoing interface
+   * @param nextHop protected next-hop
+   * @param label outgoing label of the protected primary NHLFE
+   * @param detour NHLFE used instead of the primary one
+   */
+  void AddDetour (int32_t interface, const Address &nextHop, Label label, const Nhlfe &detour);
+  /**
+   * @brief Remove backups of the interface
+   */
+  void RemoveBackups (int32_t interface);
+  /**
+   * @brief Returns true if some adjacency of the interface has a backup
+   */
+  bool HasBackups (int32_t interface) const;
+  /**
+   * @brief Switch adjacencies of the interface to their backups
+   * @return number of switched adjacencies
+   */
+  uint32_t Fail (int32_t interface);
+  /**
+   * @brief Switch adjacencies of the interface back to the primary NHLFEs
+   */
+  void Restore (int32_t interface);
+  /**
+   * @brief Returns true if the interface is failed
+   */
+  bool IsFailed (int32_t interface) const;
+  /**
+   * @brief Returns backup of the primary NHLFE or 0 if the adjacency is not failed or not protected
+   * @param interface resolved outgoing interface of the primary NHLFE
+   * @param bypass true if the returned NHLFE is a bypass tunnel, false for a detour (output)
+   */
+  const Nhlfe* Lookup (int32_t interface, const Nhlfe &primary, bool &bypass) const;
+  /**
+   * @brief Returns number of recorded failure events
+   */
+  uint32_t GetNEvents (void) const;
+  /**
+   * @brief Returns failure event by index
+   */
+  const Event& GetEvent (uint32_t index) const;
+
+private:
+  FastReroute (const FastReroute &);
+  FastReroute& operator= (const FastReroute &);
+
+  struct Protection
+  {
+    Address nextHop;
+    std::vector<Nhlfe> bypass;              // at most one
+    std::map<uint32_t, Nhlfe> detours;      // by outgoing label
+  };
+
+  typedef std::vector<Protection> ProtectionList;
+
+  Protection& GetProtection (int32_t interface, const Address &nextHop);
+  void UpdateLiveness (int32_t interface);
+
+  // indexed by interface
+  std::vector<ProtectionList> m_protections;
+  std::vector<bool> m_failed;
+  std::vector<Event> m_events;
+  Ptr<InterfaceLiveness> m_liveness;
+};
+
+} // namespace mpls
+} // namespace ns3
+
+#endif /* MPLS_FAST_REROUTE_H */
@@ -33,6 +33,28 @@ FecToNhlfe::FecToNhlfe (Fec* fec, const Nhlfe &nhlfe, Ptr<NhlfeSelectionPolicy>
   AddNhlfe (nhlfe);
 }
 
+FecToNhlfe::FecToNhlfe (Fec* fec, const NhlfeVector &nhlfe, Ptr<NhlfeSelectionPolicy> policy)
+  : ForwardingInformation (nhlfe, policy),
+    m_fec (fec)
+{
+  NS_ASSERT (fec != 0);
+}
+
+FecToNhlfe::FecToNhlfe (Fec* fec, const Ptr<NhlfePool> &pool, const NhlfeIdVector &ids,
+                        Ptr<NhlfeSelectionPolicy> policy)
+  : ForwardingInformation (pool, ids, policy),
+    m_fec (fec)
+{
+  NS_ASSERT (fec != 0);
+}
+
+FecToNhlfe::FecToNhlfe (Fec* fec, const Ptr<NextHopGroup> &group, Ptr<NhlfeSelectionPolicy> policy)
+  : ForwardingInformation (group, policy),
+    m_fec (fec)
+{
+  NS_ASSERT (fec != 0);
+}
+
 FecToNhlfe::~FecToNhlfe ()
 {
   delete m_fec;
@@ -52,6 +74,12 @@ FecToNhlfe::SetFec (Fec* fec)
   m_fec = fec;
 }
 
+uint32_t
+FecToNhlfe::GetMemoryUsage (void) const
+{
+  return sizeof (*this) + ForwardingInformation::GetMemoryUsage ();
+}
+
 void
 FecToNhlfe::Print (std::ostream &os) const
 {
@@ -52,6 +52,25 @@ public:
    * @param nhlfe NHLFE (at least one NHLFE should be set)
    */
   FecToNhlfe (Fec *fec, const Nhlfe &nhlfe, Ptr<NhlfeSelectionPolicy> policy);
+  /**
+   * @brief Construct FTN with a group of NHLFEs at once
+   * @param fec forwarding equivalence class
+   * @param nhlfe NHLFEs (at least one NHLFE should be set)
+   */
+  FecToNhlfe (Fec *fec, const NhlfeVector &nhlfe, Ptr<NhlfeSelectionPolicy> policy);
+  /**
+   * @brief Construct FTN referencing NHLFEs of the pool
+   * @param fec forwarding equivalence class
+   * @param pool NHLFE pool
+   * @param ids NHLFE ids (at least one NHLFE should be set)
+   */
+  FecToNhlfe (Fec *fec, const Ptr<NhlfePool> &pool, const NhlfeIdVector &ids, Ptr<NhlfeSelectionPolicy> policy);
+  /**
+   * @brief Construct FTN referencing a shared NHLFE group
+   * @param fec forwarding equivalence class
+   * @param group NHLFE group
+   */
+  FecToNhlfe (Fec *fec, const Ptr<NextHopGroup> &group, Ptr<NhlfeSelectionPolicy> policy);
   /**
    * @brief Destructor
    */
@@ -64,6 +83,7 @@ public:
    * @brief Set new FEC
    */
   void SetFec (Fec* fec);
+  virtual uint32_t GetMemoryUsage (void) const;
   /**
    * @brief Print FTN
    * @param os the stream to print to
@@ -19,6 +19,8 @@
  *         Stefano Avallone <stavallo@gmail.com>
  */
 
+#include "ns3/assert.h"
+#include "ns3/fatal-error.h"
 #include "ns3/ipv4-header.h"
 #include "ns3/ipv6-header.h"
 #include "ns3/tcp-header.h"
@@ -32,6 +34,265 @@ Fec::~Fec ()
 {
 }
 
+void
+Fec::Serialize (std::ostream &os) const
+{
+  NS_FATAL_ERROR ("Fec::Serialize (): FEC rule can not be serialized");
+}
+
+bool
+Fec::IsSerializable (void) const
+{
+  return false;
+}
+
+void
+Fec::WriteU8 (std::ostream &os, uint8_t value)
+{
+  os.put (value);
+}
+
+void
+Fec::WriteU16 (std::ostream &os, uint16_t value)
+{
+  char buf[2] = { char (value >> 8), char (value) };
+  os.write (buf, 2);
+}
+
+void
+Fec::WriteU32 (std::ostream &os, uint32_t value)
+{
+  char buf[4] = { char (value >> 24), char (value >> 16), char (value >> 8), char (value) };
+  os.write (buf, 4);
+}
+
+uint8_t
+Fec::ReadU8 (std::istream &is)
+{
+  return uint8_t (is.get ());
+}
+
+uint16_t
+Fec::ReadU16 (std::istream &is)
+{
+  unsigned char buf[2] = { 0, 0 };
+  is.read ((char*)buf, 2);
+  return (uint16_t (buf[0]) << 8) | buf[1];
+}
+
+uint32_t
+Fec::ReadU32 (std::istream &is)
+{
+  unsigned char buf[4] = { 0, 0, 0, 0 };
+  is.read ((char*)buf, 4);
+  return (uint32_t (buf[0]) << 24) | (uint32_t (buf[1]) << 16) | (uint32_t (buf[2]) << 8) | buf[3];
+}
+
+namespace {
+
+// FEC expressions are templates, so expressions built at run time consist of these dynamic nodes
+class DynamicAnd : public Fec
+{
+public:
+  DynamicAnd (Fec *a, Fec *b) : m_a (a), m_b (b) {}
+  ~DynamicAnd () { delete m_a; delete m_b; }
+
+  bool operator() (PacketDemux &pd) const { return (*m_a) (pd) && (*m_b) (pd); }
+  void Print (std::ostream &os) const { os << "("; m_a->Print (os); os << " & "; m_b->Print (os); os << ")"; }
+  void Serialize (std::ostream &os) const { WriteU8 (os, FEC_AND); m_a->Serialize (os); m_b->Serialize (os); }
+  bool IsSerializable (void) const { return m_a->IsSerializable () && m_b->IsSerializable (); }
+
+private:
+  DynamicAnd (const DynamicAnd &);
+  DynamicAnd& operator= (const DynamicAnd &);
+
+  Fec *m_a;
+  Fec *m_b;
+};
+
+class DynamicOr : public Fec
+{
+public:
+  DynamicOr (Fec *a, Fec *b) : m_a (a), m_b (b) {}
+  ~DynamicOr () { delete m_a; delete m_b; }
+
+  bool operator() (PacketDemux &pd) const { return (*m_a) (pd) || (*m_b) (pd); }
+  void Print (std::ostream &os) const { os << "("; m_a->Print (os); os << " | "; m_b->Print (os); os << ")"; }
+  void Serialize (std::ostream &os) const { WriteU8 (os, FEC_OR); m_a->Serialize (os); m_b->Serialize (os); }
+  bool IsSerializable (void) const { return m_a->IsSerializable () && m_b->IsSerializable (); }
+
+private:
+  DynamicOr (const DynamicOr &);
+  DynamicOr& operator= (const DynamicOr &);
+
+  Fec *m_a;
+  Fec *m_b;
+};
+
+class DynamicNot : public Fec
+{
+public:
+  DynamicNot (Fec *a) : m_a (a) {}
+  ~DynamicNot () { delete m_a; }
+
+  bool operator() (PacketDemux &pd) const { return !(*m_a) (pd); }
+  void Print (std::ostream &os) const { os << "~"; m_a->Print (os); }
+  void Serialize (std::ostream &os) const { WriteU8 (os, FEC_NOT); m_a->Serialize (os); }
+  bool IsSerializable (void) const { return m_a->IsSerializable (); }
+
+private:
+  DynamicNot (const DynamicNot &);
+  DynamicNot& operator= (const DynamicNot &);
+
+  Fec *m_a;
+};
+
+} // anonymous namespace
+
+Fec*
+Fec::BuildAnd (Fec *a, Fec *b)
+{
+  NS_ASSERT (a != 0 && b != 0);
+  return new DynamicAnd (a, b);
+}
+
+Fec*
+Fec::BuildOr (Fec *a, Fec *b)
+{
+  NS_ASSERT (a != 0 && b != 0);
+  return new DynamicOr (a, b);
+}
+
+Fec*
+Fec::BuildNot (Fec *a)
+{
+  NS_ASSERT (a != 0);
+  return new DynamicNot (a);
+}
+
+Fec*
+Fec::Deserialize (std::istream &is)
+{
+  return Deserialize (is, 0);
+}
+
+Fec*
+Fec::Deserialize (std::istream &is, uint32_t depth)
+{
+  uint8_t code = ReadU8 (is);
+  if (!is)
+    {
+      return 0;
+    }
+
+  // operands are read recursively, a malformed input must not exhaust the stack
+  if ((code == FEC_AND || code == FEC_OR || code == FEC_NOT) && depth >= MAX_DEPTH)
+    {
+      return 0;
+    }
+
+  Fec *fec = 0;
+
+  switch (code)
+    {
+      case FEC_AND:
+      case FEC_OR:
+        {
+          Fec *a = Deserialize (is, depth + 1);
+          Fec *b = a != 0 ? Deserialize (is, depth + 1) : 0;
+          if (b == 0)
+            {
+              delete a;
+              return 0;
+            }
+          fec = code == FEC_AND ? BuildAnd (a, b) : BuildOr (a, b);
+          break;
+        }
+      case FEC_NOT:
+        {
+          Fec *a = Deserialize (is, depth + 1);
+          if (a == 0)
+            {
+              return 0;
+            }
+          fec = BuildNot (a);
+          break;
+        }
+      case FEC_IPV4_SOURCE:
+      case FEC_IPV4_DESTINATION:
+        {
+          Ipv4Address address (ReadU32 (is));
+          Ipv4Mask mask (ReadU32 (is));
+          fec = code == FEC_IPV4_SOURCE ? (Fec*)new Ipv4Source (address, mask) : (Fec*)new Ipv4Destination (address, mask);
+          break;
+        }
+      case FEC_IPV6_SOURCE:
+      case FEC_IPV6_DESTINATION:
+        {
+          uint8_t address[16];
+          uint8_t prefix[16];
+          is.read ((char*)address, 16);
+          is.read ((char*)prefix, 16);
+          if (code == FEC_IPV6_SOURCE)
+            {
+              fec = new Ipv6Source (Ipv6Address (address), Ipv6Prefix (prefix));
+            }
+          else
+            {
+              fec = new Ipv6Destination (Ipv6Address (address), Ipv6Prefix (prefix));
+            }
+          break;
+        }
+      case FEC_UDP_SOURCE_PORT:
+        fec = new UdpSourcePort (ReadU16 (is));
+        break;
+      case FEC_UDP_DESTINATION_PORT:
+        fec = new UdpDestinationPort (ReadU16 (is));
+        break;
+      case FEC_TCP_SOURCE_PORT:
+        fec = new TcpSourcePort (ReadU16 (is));
+        break;
+      case FEC_TCP_DESTINATION_PORT:
+        fec = new TcpDestinationPort (ReadU16 (is));
+        break;
+      case FEC_UDP_SOURCE_PORT_RANGE:
+      case FEC_UDP_DESTINATION_PORT_RANGE:
+      case FEC_TCP_SOURCE_PORT_RANGE:
+      case FEC_TCP_DESTINATION_PORT_RANGE:
+        {
+          uint16_t minPort = ReadU16 (is);
+          uint16_t maxPort = ReadU16 (is);
+          if (code == FEC_UDP_SOURCE_PORT_RANGE)
+            {
+              fec = new UdpSourcePortRange (minPort, maxPort);
+            }
+          else if (code == FEC_UDP_DESTINATION_PORT_RANGE)
+            {
+              fec = new UdpDestinationPortRange (minPort, maxPort);
+            }
+          else if (code == FEC_TCP_SOURCE_PORT_RANGE)
+            {
+              fec = new TcpSourcePortRange (minPort, maxPort);
+            }
+          else
+            {
+              fec = new TcpDestinationPortRange (minPort, maxPort);
+            }
+          break;
+        }
+      default:
+        return 0;
+    }
+
+  if (!is)
+    {
+      delete fec;
+      return 0;
+    }
+
+  return fec;
+}
+
 template <class Address, class Mask>
 static void AsciiToPrefix (char const *addrstr, Address &address, Mask &mask, bool slash)
 {
@@ -95,6 +356,14 @@ Ipv4Source::Print (std::ostream &os) const
     }
 }
 
+void
+Ipv4Source::Serialize (std::ostream &os) const
+{
+  WriteU8 (os, FEC_IPV4_SOURCE);
+  WriteU32 (os, m_address.Get ());
+  WriteU32 (os, m_mask.Get ());
+}
+
 Ipv4Destination::Ipv4Destination (const Ipv4Address &address, const Ipv4Mask &mask)
   : m_address (address),
     m_mask (mask)
@@ -130,6 +399,14 @@ Ipv4Destination::Print (std::ostream &os) const
     }
 }
 
+void
+Ipv4Destination::Serialize (std::ostream &os) const
+{
+  WriteU8 (os, FEC_IPV4_DESTINATION);
+  WriteU32 (os, m_address.Get ());
+  WriteU32 (os, m_mask.Get ());
+}
+
 Ipv6Source::Ipv6Source (const Ipv6Address &address, const Ipv6Prefix &mask)
   : m_address (address),
     m_mask (mask)
@@ -165,6 +442,19 @@ Ipv6Source::Print (std::ostream &os) const
     }
 }
 
+void
+Ipv6Source::Serialize (std::ostream &os) const
+{
+  uint8_t address[16];
+  uint8_t prefix[16];
+  m_address.Serialize (address);
+  m_mask.GetBytes (prefix);
+
+  WriteU8 (os, FEC_IPV6_SOURCE);
+  os.write ((const char*)address, 16);
+  os.write ((const char*)prefix, 16);
+}
+
 Ipv6Destination::Ipv6Destination (const Ipv6Address &address, const Ipv6Prefix &mask)
   : m_address (address),
     m_mask (mask)
@@ -200,6 +490,19 @@ Ipv6Destination::Print (std::ostream &os) const
     }
 }
 
+void
+Ipv6Destination::Serialize (std::ostream &os) const
+{
+  uint8_t address[16];
+  uint8_t prefix[16];
+  m_address.Serialize (address);
+  m_mask.GetBytes (prefix);
+
+  WriteU8 (os, FEC_IPV6_DESTINATION);
+  os.write ((const char*)address, 16);
+  os.write ((const char*)prefix, 16);
+}
+
 UdpSourcePort::UdpSourcePort (uint16_t port)
   : m_port (port)
 {
@@ -224,6 +527,13 @@ UdpSourcePort::Print (std::ostream &os) const
   os << "udp src:" << m_port;
 }
 
+void
+UdpSourcePort::Serialize (std::ostream &os) const
+{
+  WriteU8 (os, FEC_UDP_SOURCE_PORT);
+  WriteU16 (os, m_port);
+}
+
 
 UdpSourcePortRange::UdpSourcePortRange (uint16_t minPort, uint16_t maxPort)
   : m_minPort (minPort),
@@ -250,6 +560,14 @@ UdpSourcePortRange::Print (std::ostream &os) const
   os << "udp src:" << m_minPort << "-" << m_maxPort;
 }
 
+void
+UdpSourcePortRange::Serialize (std::ostream &os) const
+{
+  WriteU8 (os, FEC_UDP_SOURCE_PORT_RANGE);
+  WriteU16 (os, m_minPort);
+  WriteU16 (os, m_maxPort);
+}
+
 UdpDestinationPort::UdpDestinationPort (uint16_t port)
   : m_port (port)
 {
@@ -274,6 +592,13 @@ UdpDestinationPort::Print (std::ostream &os) const
   os << "udp dst:" << m_port;
 }
 
+void
+UdpDestinationPort::Serialize (std::ostream &os) const
+{
+  WriteU8 (os, FEC_UDP_DESTINATION_PORT);
+  WriteU16 (os, m_port);
+}
+
 UdpDestinationPortRange::UdpDestinationPortRange (uint16_t minPort, uint16_t maxPort)
   : m_minPort (minPort),
     m_maxPort (maxPort)
@@ -298,6 +623,14 @@ UdpDestinationPortRange::Print (std::ostream &os) const
 {
   os << "udp dst:" << m_minPort << "-" << m_maxPort;
 }
+
+void
+UdpDestinationPortRange::Serialize (std::ostream &os) const
+{
+  WriteU8 (os, FEC_UDP_DESTINATION_PORT_RANGE);
+  WriteU16 (os, m_minPort);
+  WriteU16 (os, m_maxPort);
+}
   
 TcpSourcePort::TcpSourcePort (uint16_t port)
   : m_port (port)
@@ -323,6 +656,13 @@ TcpSourcePort::Print (std::ostream &os) const
   os << "tcp src:" << m_port;
 }
 
+void
+TcpSourcePort::Serialize (std::ostream &os) const
+{
+  WriteU8 (os, FEC_TCP_SOURCE_PORT);
+  WriteU16 (os, m_port);
+}
+
 TcpSourcePortRange::TcpSourcePortRange (uint16_t minPort, uint16_t maxPort)
   : m_minPort (minPort),
     m_maxPort (maxPort)
@@ -348,6 +688,14 @@ TcpSourcePortRange::Print (std::ostream &os) const
   os << "tcp src:" << m_minPort << "-" << m_maxPort;
 }
 
+void
+TcpSourcePortRange::Serialize (std::ostream &os) const
+{
+  WriteU8 (os, FEC_TCP_SOURCE_PORT_RANGE);
+  WriteU16 (os, m_minPort);
+  WriteU16 (os, m_maxPort);
+}
+
 
 TcpDestinationPort::TcpDestinationPort (uint16_t port)
   : m_port (port)
@@ -373,6 +721,13 @@ TcpDestinationPort::Print (std::ostream &os) const
   os << "tcp dst:" << m_port;
 }
 
+void
+TcpDestinationPort::Serialize (std::ostream &os) const
+{
+  WriteU8 (os, FEC_TCP_DESTINATION_PORT);
+  WriteU16 (os, m_port);
+}
+
 
 TcpDestinationPortRange::TcpDestinationPortRange (uint16_t minPort, uint16_t maxPort)
   : m_minPort (minPort),
@@ -399,5 +754,13 @@ TcpDestinationPortRange::Print (std::ostream &os) const
   os << "tcp dst:" << m_minPort << "-" << m_maxPort;
 }
 
+void
+TcpDestinationPortRange::Serialize (std::ostream &os) const
+{
+  WriteU8 (os, FEC_TCP_DESTINATION_PORT_RANGE);
+  WriteU16 (os, m_minPort);
+  WriteU16 (os, m_maxPort);
+}
+
 } // namespace mpls
 } // namespace ns3
@@ -23,6 +23,8 @@
 #define MPLS_FEC_H
 
 #include <ostream>
+#include <istream>
+#include <stdint.h>
 
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv6-address.h"
@@ -50,8 +52,61 @@ public:
    */  
   virtual bool operator() (PacketDemux &pd) const = 0;
   virtual void Print (std::ostream &os) const = 0;
+  /**
+   * @brief Write FEC to the stream in binary form (see Deserialize).
+   * User defined FEC rules should override it to be saved in LFIB snapshots
+   */
+  virtual void Serialize (std::ostream &os) const;
+  /**
+   * @brief Check if Serialize can write the FEC, user defined FEC rules overriding Serialize
+   * should override it as well
+   */
+  virtual bool IsSerializable (void) const;
+  /**
+   * @brief Read FEC written by Serialize, conjunctions, disjunctions and negations may be nested
+   * up to MAX_DEPTH levels
+   * @returns new FEC (owned by the caller) or 0 if the input is malformed
+   */
+  static Fec* Deserialize (std::istream &is);
+
+  static const uint32_t MAX_DEPTH = 64;
 
   template <class T> static Fec* Build (const T &fec) { return new T(fec); }
+  /**
+   * @brief Build conjunction, disjunction or negation of FECs at run time (operands are owned by the result)
+   */
+  static Fec* BuildAnd (Fec *a, Fec *b);
+  static Fec* BuildOr (Fec *a, Fec *b);
+  static Fec* BuildNot (Fec *a);
+
+  // rule codes of the binary form
+  enum Code
+  {
+    FEC_AND = 1,
+    FEC_OR,
+    FEC_NOT,
+    FEC_IPV4_SOURCE,
+    FEC_IPV4_DESTINATION,
+    FEC_IPV6_SOURCE,
+    FEC_IPV6_DESTINATION,
+    FEC_UDP_SOURCE_PORT,
+    FEC_UDP_SOURCE_PORT_RANGE,
+    FEC_UDP_DESTINATION_PORT,
+    FEC_UDP_DESTINATION_PORT_RANGE,
+    FEC_TCP_SOURCE_PORT,
+    FEC_TCP_SOURCE_PORT_RANGE,
+    FEC_TCP_DESTINATION_PORT,
+    FEC_TCP_DESTINATION_PORT_RANGE
+  };
+
+protected:
+  static Fec* Deserialize (std::istream &is, uint32_t depth);
+  static void WriteU8 (std::ostream &os, uint8_t value);
+  static void WriteU16 (std::ostream &os, uint16_t value);
+  static void WriteU32 (std::ostream &os, uint32_t value);
+  static uint8_t ReadU8 (std::istream &is);
+  static uint16_t ReadU16 (std::istream &is);
+  static uint32_t ReadU32 (std::istream &is);
 };
 
 template <class A, class B>
@@ -66,6 +121,8 @@ public:
   
   bool operator() (PacketDemux &pd) const { return m_a (pd) && m_b (pd); }
   void Print (std::ostream &os) const {os << "(" << m_a << " & " << m_b << ")";};
+  void Serialize (std::ostream &os) const { Fec::WriteU8 (os, Fec::FEC_AND); m_a.Serialize (os); m_b.Serialize (os); }
+  bool IsSerializable (void) const { return m_a.IsSerializable () && m_b.IsSerializable (); }
 };
 
 template <class A, class B>
@@ -80,6 +137,8 @@ public:
   
   bool operator() (PacketDemux &pd) const { return m_a (pd) || m_b (pd); }
   void Print (std::ostream &os) const {os << "(" << m_a << " | " << m_b << ")";};  
+  void Serialize (std::ostream &os) const { Fec::WriteU8 (os, Fec::FEC_OR); m_a.Serialize (os); m_b.Serialize (os); }
+  bool IsSerializable (void) const { return m_a.IsSerializable () && m_b.IsSerializable (); }
 };
 
 template <class A>
@@ -93,6 +152,8 @@ public:
   
   bool operator() (PacketDemux &pd) const { return !m_a (pd); }
   void Print (std::ostream &os) const {os << "~" << m_a; };
+  void Serialize (std::ostream &os) const { Fec::WriteU8 (os, Fec::FEC_NOT); m_a.Serialize (os); }
+  bool IsSerializable (void) const { return m_a.IsSerializable (); }
 };
 
 template <class C>
@@ -125,6 +186,8 @@ public:
 
   bool operator() (PacketDemux &pd) const;
   void Print (std::ostream &os) const;
+  void Serialize (std::ostream &os) const;
+  bool IsSerializable (void) const { return true; }
 
 private:
   Ipv4Address m_address;
@@ -145,6 +208,8 @@ public:
 
   bool operator() (PacketDemux &pd) const;
   void Print (std::ostream &os) const;
+  void Serialize (std::ostream &os) const;
+  bool IsSerializable (void) const { return true; }
 
 private:
   Ipv4Address m_address;
@@ -165,6 +230,8 @@ public:
 
   bool operator() (PacketDemux &pd) const;
   void Print (std::ostream &os) const;  
+  void Serialize (std::ostream &os) const;
+  bool IsSerializable (void) const { return true; }
 
 private:
   Ipv6Address m_address;
@@ -185,6 +252,8 @@ public:
 
   bool operator() (PacketDemux &pd) const;
   void Print (std::ostream &os) const;
+  void Serialize (std::ostream &os) const;
+  bool IsSerializable (void) const { return true; }
   
 private:
   Ipv6Address m_address;
@@ -204,6 +273,8 @@ public:
 
   bool operator() (PacketDemux &pd) const;
   void Print (std::ostream &os) const;
+  void Serialize (std::ostream &os) const;
+  bool IsSerializable (void) const { return true; }
   
 private:
   uint16_t m_port;
@@ -222,6 +293,8 @@ public:
 
   bool operator() (PacketDemux &pd) const;
   void Print (std::ostream &os) const;
+  void Serialize (std::ostream &os) const;
+  bool IsSerializable (void) const { return true; }
   
 private:
   uint16_t m_minPort;
@@ -241,6 +314,8 @@ public:
 
   bool operator() (PacketDemux &pd) const;
   void Print (std::ostream &os) const;
+  void Serialize (std::ostream &os) const;
+  bool IsSerializable (void) const { return true; }
   
 private:
   uint16_t m_port;
@@ -259,6 +334,8 @@ public:
 
   bool operator() (PacketDemux &pd) const;
   void Print (std::ostream &os) const;
+  void Serialize (std::ostream &os) const;
+  bool IsSerializable (void) const { return true; }
   
 private:
   uint16_t m_minPort;
@@ -278,6 +355,8 @@ public:
 
   bool operator() (PacketDemux &pd) const;
   void Print (std::ostream &os) const;
+  void Serialize (std::ostream &os) const;
+  bool IsSerializable (void) const { return true; }
   
 private:
   uint16_t m_port;
@@ -296,6 +375,8 @@ public:
 
   bool operator() (PacketDemux &pd) const;
   void Print (std::ostream &os) const;
+  void Serialize (std::ostream &os) const;
+  bool IsSerializable (void) const { return true; }
   
 private:
   uint16_t m_minPort;
@@ -315,6 +396,8 @@ public:
 
   bool operator() (PacketDemux &pd) const;
   void Print (std::ostream &os) const;
+  void Serialize (std::ostream &os) const;
+  bool IsSerializable (void) const { return true; }
   
 private:
   uint16_t m_port;
@@ -333,6 +416,8 @@ public:
 
   bool operator() (PacketDemux &pd) const;
   void Print (std::ostream &os) const;
+  void Serialize (std::ostream &os) const;
+  bool IsSerializable (void) const { return true; }
   
 private:
   uint16_t m_minPort;
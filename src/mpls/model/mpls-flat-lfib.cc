@@ -0,0 +1,358 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010-2011 Andrey Churin, Stefano Avallone
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Andrey Churin <aachurin@gmail.com>
+ *         Stefano Avallone <stavallo@gmail.com>
+ */
+
+#include "ns3/assert.h"
+#include "ns3/fatal-error.h"
+
+#include "mpls-flat-lfib.h"
+
+namespace ns3 {
+namespace mpls {
+
+const uint32_t FlatLfib::NO_ENTRY;
+
+FlatLfib::Handle::Handle ()
+  : m_label (NO_ENTRY)
+{
+}
+
+FlatLfib::Handle::Handle (uint32_t label)
+  : m_label (label)
+{
+}
+
+bool
+FlatLfib::Handle::IsValid (void) const
+{
+  return m_label != NO_ENTRY;
+}
+
+uint32_t
+FlatLfib::Handle::GetLabel (void) const
+{
+  return m_label;
+}
+
+FlatLfib::FlatLfib (const Ptr<NhlfePool> &pool)
+  : m_pool (pool),
+    m_nEntries (0)
+{
+  NS_ASSERT (pool != 0);
+}
+
+FlatLfib::~FlatLfib ()
+{
+  for (std::vector<NhlfeSelectionState*>::iterator i = m_states.begin (); i != m_states.end (); ++i)
+    {
+      delete *i;
+    }
+}
+
+uint32_t
+FlatLfib::AddGroup (const NhlfeIdVector &ids)
+{
+  NS_ASSERT_MSG (!ids.empty (), "FlatLfib::AddGroup (): at least one NHLFE should be set");
+
+  std::map<NhlfeIdVector, uint32_t>::const_iterator i = m_groupIds.find (ids);
+  if (i != m_groupIds.end ())
+    {
+      return i->second;
+    }
+
+  uint32_t id = m_groupTable.size ();
+  m_groupTable.push_back (ids);
+  m_groupIds.insert (std::make_pair (ids, id));
+  return id;
+}
+
+void
+FlatLfib::SetGroup (uint32_t group, const NhlfeIdVector &ids)
+{
+  NS_ASSERT_MSG (group < m_groupTable.size (), "FlatLfib::SetGroup (): invalid group");
+
+  std::map<NhlfeIdVector, uint32_t>::iterator i = m_groupIds.find (m_groupTable[group]);
+  if (i != m_groupIds.end () && i->second == group)
+    {
+      m_groupIds.erase (i);
+    }
+
+  m_groupTable[group] = ids;
+  if (group < m_liveVersions.size ())
+    {
+      m_liveVersions[group] = 0;
+    }
+  if (!ids.empty ())
+    {
+      m_groupIds.insert (std::make_pair (ids, group));
+    }
+}
+
+const FlatLfib::NhlfeIdVector&
+FlatLfib::GetGroup (uint32_t group) const
+{
+  NS_ASSERT_MSG (group < m_groupTable.size (), "FlatLfib::GetGroup (): invalid group");
+  return m_groupTable[group];
+}
+
+uint32_t
+FlatLfib::AddPolicy (const Ptr<NhlfeSelectionPolicy> &policy)
+{
+  NS_ASSERT (policy != 0);
+
+  for (uint32_t i = 0; i < m_policyTable.size (); ++i)
+    {
+      if (m_policyTable[i] == policy)
+        {
+          return i;
+        }
+    }
+
+  m_policyTable.push_back (policy);
+  return m_policyTable.size () - 1;
+}
+
+void
+FlatLfib::Reserve (uint32_t maxLabel)
+{
+  NS_ASSERT_MSG (maxLabel <= 0xfffff, "FlatLfib::Reserve (): invalid label");
+
+  if (maxLabel < m_groups.size ())
+    {
+      return;
+    }
+
+  m_interfaces.resize (maxLabel + 1, -1);
+  m_groups.resize (maxLabel + 1, NO_ENTRY);
+  m_policies.resize (maxLabel + 1, 0);
+  if (!m_states.empty ())
+    {
+      m_states.resize (maxLabel + 1, 0);
+    }
+}
+
+FlatLfib::Handle
+FlatLfib::Add (int32_t interface, Label label, uint32_t group, uint32_t policy)
+{
+  NS_ASSERT_MSG (group < m_groupTable.size (), "FlatLfib::Add (): invalid NHLFE group");
+  NS_ASSERT_MSG (policy < m_policyTable.size (), "FlatLfib::Add (): invalid policy");
+
+  Reserve (label);
+  if (m_groups[label] != NO_ENTRY)
+    {
+      NS_FATAL_ERROR ("FlatLfib::Add (): label " << label << " is already in use");
+    }
+
+  m_interfaces[label] = interface;
+  m_groups[label] = group;
+  m_policies[label] = policy;
+
+  NhlfeSelectionState *state = m_policyTable[policy]->CreateState ();
+  if (state != 0)
+    {
+      if (m_states.empty ())
+        {
+          m_states.resize (m_groups.size (), 0);
+        }
+      m_states[label] = state;
+    }
+
+  ++m_nEntries;
+  return Handle (label);
+}
+
+FlatLfib::Handle
+FlatLfib::Add (const Ptr<IncomingLabelMap> &ilm)
+{
+  NhlfeIdVector ids;
+  ids.reserve (ilm->GetNNhlfe ());
+  for (uint32_t i = 0; i < ilm->GetNNhlfe (); ++i)
+    {
+      ids.push_back (m_pool->Intern (ilm->GetNhlfe (i)));
+    }
+
+  return Add (ilm->GetInterface (), ilm->GetLabel (), AddGroup (ids), AddPolicy (ilm->GetPolicy ()));
+}
+
+void
+FlatLfib::Remove (Handle handle)
+{
+  uint32_t label = handle.GetLabel ();
+  NS_ASSERT_MSG (label < m_groups.size () && m_groups[label] != NO_ENTRY, "FlatLfib::Remove (): invalid handle");
+
+  m_groups[label] = NO_ENTRY;
+  m_interfaces[label] = -1;
+  if (!m_states.empty ())
+    {
+      delete m_states[label];
+      m_states[label] = 0;
+    }
+  --m_nEntries;
+}
+
+bool
+FlatLfib::Contains (Label label) const
+{
+  return label < m_groups.size () && m_groups[label] != NO_ENTRY;
+}
+
+FlatLfib::Handle
+FlatLfib::Lookup (Label label, int32_t interface) const
+{
+  if (!Contains (label))
+    {
+      return Handle ();
+    }
+
+  int32_t entryInterface = m_interfaces[label];
+  if (entryInterface >= 0 && entryInterface != interface)
+    {
+      return Handle ();
+    }
+
+  return Handle (label);
+}
+
+FlatLfib::Handle
+FlatLfib::GetNext (Label label) const
+{
+  for (uint32_t i = label; i < m_groups.size (); ++i)
+    {
+      if (m_groups[i] != NO_ENTRY)
+        {
+          return Handle (i);
+        }
+    }
+
+  return Handle ();
+}
+
+void
+FlatLfib::Clear (void)
+{
+  for (std::vector<NhlfeSelectionState*>::iterator i = m_states.begin (); i != m_states.end (); ++i)
+    {
+      delete *i;
+    }
+
+  std::vector<int32_t> ().swap (m_interfaces);
+  std::vector<uint32_t> ().swap (m_groups);
+  std::vector<uint32_t> ().swap (m_policies);
+  std::vector<NhlfeSelectionState*> ().swap (m_states);
+  m_groupTable.clear ();
+  m_groupIds.clear ();
+  m_policyTable.clear ();
+  m_liveTable.clear ();
+  m_liveVersions.clear ();
+  m_nEntries = 0;
+}
+
+ForwardingInformation::Iterator
+FlatLfib::GetIterator (Handle handle) const
+{
+  uint32_t label = handle.GetLabel ();
+  NS_ASSERT_MSG (label < m_groups.size () && m_groups[label] != NO_ENTRY, "FlatLfib::GetIterator (): invalid handle");
+
+  return ForwardingInformation::Iterator (PeekPointer (m_policyTable[m_policies[label]]),
+                                          m_states.empty () ? 0 : m_states[label],
+                                          PeekPointer (m_pool), &m_groupTable[m_groups[label]]);
+}
+
+ForwardingInformation::Iterator
+FlatLfib::GetIterator (Handle handle, const InterfaceLiveness &liveness) const
+{
+  ForwardingInformation::Iterator i = GetIterator (handle);
+
+  if (liveness.IsAllAlive ())
+    {
+      return i;
+    }
+
+  uint32_t group = m_groups[handle.GetLabel ()];
+  const NhlfeIdVector &ids = m_groupTable[group];
+  if (m_liveVersions.size () < m_groupTable.size ())
+    {
+      m_liveVersions.resize (m_groupTable.size (), 0);
+      m_liveTable.resize (m_groupTable.size ());
+    }
+
+  std::vector<uint32_t> &live = m_liveTable[group];
+  if (m_liveVersions[group] != liveness.GetVersion ())
+    {
+      m_liveVersions[group] = liveness.GetVersion ();
+      live.clear ();
+      for (uint32_t j = 0; j < ids.size (); ++j)
+        {
+          if (liveness.IsAlive (m_pool->GetInterface (ids[j])))
+            {
+              live.push_back (j);
+            }
+        }
+    }
+
+  i.Restrict (live.size () == ids.size () ? 0 : &live);
+  return i;
+}
+
+Ptr<IncomingLabelMap>
+FlatLfib::GetIlm (Handle handle) const
+{
+  uint32_t label = handle.GetLabel ();
+  NS_ASSERT_MSG (label < m_groups.size () && m_groups[label] != NO_ENTRY, "FlatLfib::GetIlm (): invalid handle");
+
+  return Create<IncomingLabelMap> (m_interfaces[label], label, m_pool, m_groupTable[m_groups[label]],
+                                   m_policyTable[m_policies[label]]);
+}
+
+uint32_t
+FlatLfib::GetNEntries (void) const
+{
+  return m_nEntries;
+}
+
+uint64_t
+FlatLfib::GetMemoryUsage (void) const
+{
+  uint64_t size = sizeof (*this)
+    + m_interfaces.capacity () * sizeof (int32_t)
+    + m_groups.capacity () * sizeof (uint32_t)
+    + m_policies.capacity () * sizeof (uint32_t)
+    + m_states.capacity () * sizeof (NhlfeSelectionState*)
+    + m_groupTable.capacity () * sizeof (NhlfeIdVector)
+    + m_policyTable.capacity () * sizeof (Ptr<NhlfeSelectionPolicy>)
+    + m_liveTable.capacity () * sizeof (std::vector<uint32_t>)
+    + m_liveVersions.capacity () * sizeof (uint32_t);
+
+  for (std::vector<std::vector<uint32_t> >::const_iterator i = m_liveTable.begin (); i != m_liveTable.end (); ++i)
+    {
+      size += i->capacity () * sizeof (uint32_t);
+    }
+
+  // groups are kept twice: in the table and as keys of the map (a map node holds about four pointers)
+  for (std::vector<NhlfeIdVector>::const_iterator i = m_groupTable.begin (); i != m_groupTable.end (); ++i)
+    {
+      size += 2 * i->capacity () * sizeof (uint32_t) + sizeof (NhlfeIdVector) + sizeof (uint32_t) + 4 * sizeof (void*);
+    }
+
+  return size;
+}
+
+} // namespace mpls
+} // namespace ns3
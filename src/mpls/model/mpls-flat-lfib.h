@@ -0,0 +1,191 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010-2011 Andrey Churin, Stefano Avallone
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Andrey Churin <aachurin@gmail.com>
+ *         Stefano Avallone <stavallo@gmail.com>
+ */
+
+#ifndef MPLS_FLAT_LFIB_H
+#define MPLS_FLAT_LFIB_H
+
+#include <map>
+#include <vector>
+
+#include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
+
+#include "mpls-label.h"
+#include "mpls-nhlfe-pool.h"
+#include "mpls-nhlfe-selection-policy.h"
+#include "mpls-forwarding-information.h"
+#include "mpls-interface-liveness.h"
+#include "mpls-incoming-label-map.h"
+
+namespace ns3 {
+namespace mpls {
+
+/**
+ * \ingroup mpls
+ * \brief Label forwarding table kept in parallel arrays indexed by the incoming label
+ *
+ * For every label the table keeps the incoming interface (-1 for any), the id of the NHLFE group
+ * and the id of the selection policy. NHLFE groups reference NHLFEs of the node NHLFE pool, policies
+ * are shared by all entries which use them (per-entry state is kept only for policies that need it).
+ * There is at most one entry per label, ILMs bound to different interfaces with the same label
+ * should be kept in the ILM table of the node.
+ *
+ * Entries referencing the same group share it, so a next-hop change is made once by SetGroup
+ * whatever the number of labels using it.
+ *
+ * Entries are referenced by Handle. Add accepts ILMs built by the helpers and GetIlm returns an
+ * equivalent IncomingLabelMap, so the table can be used with code written for Ptr<IncomingLabelMap>.
+ */
+class FlatLfib : public SimpleRefCount<FlatLfib>
+{
+public:
+  /**
+   * \brief Reference to an entry of the table
+   */
+  class Handle
+  {
+  public:
+    Handle ();
+    explicit Handle (uint32_t label);
+    /**
+     * @brief Returns false for the null handle
+     */
+    bool IsValid (void) const;
+    /**
+     * @brief Returns incoming label of the entry
+     */
+    uint32_t GetLabel (void) const;
+
+  private:
+    uint32_t m_label;
+  };
+
+  typedef ForwardingInformation::NhlfeIdVector NhlfeIdVector;
+
+  FlatLfib (const Ptr<NhlfePool> &pool);
+  ~FlatLfib ();
+
+  /**
+   * @brief Add group of NHLFEs, ids refer to the NHLFE pool of the table
+   * @return group id, equal groups get the same id
+   */
+  uint32_t AddGroup (const NhlfeIdVector &ids);
+  /**
+   * @brief Replace NHLFEs of the group, the change applies to every entry referencing the group.
+   * The group may become empty, packets of its entries are dropped then
+   */
+  void SetGroup (uint32_t group, const NhlfeIdVector &ids);
+  /**
+   * @brief Returns NHLFE ids of the group
+   */
+  const NhlfeIdVector& GetGroup (uint32_t group) const;
+  /**
+   * @brief Add selection policy, the same policy object gets the same id
+   * @return policy id
+   */
+  uint32_t AddPolicy (const Ptr<NhlfeSelectionPolicy> &policy);
+  /**
+   * @brief Make room for labels up to the specified one
+   */
+  void Reserve (uint32_t maxLabel);
+  /**
+   * @brief Add entry for the label
+   * @param interface incoming interface or -1
+   * @param label incoming label, the simulation is aborted if there is an entry for it
+   * @param group NHLFE group id
+   * @param policy selection policy id
+   */
+  Handle Add (int32_t interface, Label label, uint32_t group, uint32_t policy);
+  /**
+   * @brief Add entry equal to the ILM (NHLFEs are interned, the policy is shared)
+   */
+  Handle Add (const Ptr<IncomingLabelMap> &ilm);
+  /**
+   * @brief Remove entry
+   */
+  void Remove (Handle handle);
+  /**
+   * @brief Returns true if there is an entry for the label
+   */
+  bool Contains (Label label) const;
+  /**
+   * @brief Returns entry matching label and incoming interface or the null handle
+   */
+  Handle Lookup (Label label, int32_t interface) const;
+  /**
+   * @brief Returns the entry with the lowest label not less than the specified one or the null handle.
+   * The label array is scanned, so walking the whole table costs the highest label in use rather
+   * than the number of entries. It is meant for dumps and snapshots, not for forwarding
+   */
+  Handle GetNext (Label label) const;
+  /**
+   * @brief Remove all entries, groups and policies
+   */
+  void Clear (void);
+  /**
+   * @brief Returns iterator over NHLFEs of the entry
+   */
+  ForwardingInformation::Iterator GetIterator (Handle handle) const;
+  /**
+   * @brief Returns iterator over NHLFEs of the entry whose outgoing interface is alive. The
+   * selectable NHLFEs are cached per group and found again only after a liveness change
+   */
+  ForwardingInformation::Iterator GetIterator (Handle handle, const InterfaceLiveness &liveness) const;
+  /**
+   * @brief Returns ILM equal to the entry (a copy, changing it does not change the table)
+   */
+  Ptr<IncomingLabelMap> GetIlm (Handle handle) const;
+  /**
+   * @brief Returns number of entries
+   */
+  uint32_t GetNEntries (void) const;
+  /**
+   * @brief Returns approximate number of bytes used by the table (NHLFE pool excluded)
+   */
+  uint64_t GetMemoryUsage (void) const;
+
+  static const uint32_t NO_ENTRY = 0xffffffff;
+
+private:
+  FlatLfib (const FlatLfib &);
+  FlatLfib& operator= (const FlatLfib &);
+
+  Ptr<NhlfePool> m_pool;
+  // indexed by label
+  std::vector<int32_t> m_interfaces;
+  std::vector<uint32_t> m_groups;
+  std::vector<uint32_t> m_policies;
+  std::vector<NhlfeSelectionState*> m_states;  // empty until a policy with state is used
+
+  std::vector<NhlfeIdVector> m_groupTable;
+  std::map<NhlfeIdVector, uint32_t> m_groupIds;
+  std::vector<Ptr<NhlfeSelectionPolicy> > m_policyTable;
+  uint32_t m_nEntries;
+
+  // indexes of the selectable NHLFEs of every group, empty until an interface goes down
+  mutable std::vector<std::vector<uint32_t> > m_liveTable;
+  mutable std::vector<uint32_t> m_liveVersions;  // liveness version a group has been filtered for, 0 if not yet
+};
+
+} // namespace mpls
+} // namespace ns3
+
+#endif /* MPLS_FLAT_LFIB_H */
@@ -28,22 +28,71 @@ namespace ns3 {
 namespace mpls {
 
 ForwardingInformation::ForwardingInformation (Ptr<NhlfeSelectionPolicy> policy)
-  : m_index (0)
+  : m_index (0),
+    m_state (0),
+    m_replication (false),
+    m_live (0),
+    m_liveVersion (0)
 {
   SetPolicy (policy);
 }
 
+ForwardingInformation::ForwardingInformation (const NhlfeVector &nhlfe, Ptr<NhlfeSelectionPolicy> policy)
+  : m_nhlfe (nhlfe),
+    m_index (0),
+    m_state (0),
+    m_replication (false),
+    m_live (0),
+    m_liveVersion (0)
+{
+  NS_ASSERT_MSG (!nhlfe.empty (), "ForwardingInformation::ForwardingInformation (): at least one NHLFE should be set");
+  SetPolicy (policy);
+}
+
+ForwardingInformation::ForwardingInformation (const Ptr<NhlfePool> &pool, const NhlfeIdVector &ids,
+                                              Ptr<NhlfeSelectionPolicy> policy)
+  : m_pool (pool),
+    m_ids (ids),
+    m_index (0),
+    m_state (0),
+    m_replication (false),
+    m_live (0),
+    m_liveVersion (0)
+{
+  NS_ASSERT (pool != 0);
+  NS_ASSERT_MSG (!ids.empty (), "ForwardingInformation::ForwardingInformation (): at least one NHLFE should be set");
+  SetPolicy (policy);
+}
+
+ForwardingInformation::ForwardingInformation (const Ptr<NextHopGroup> &group, Ptr<NhlfeSelectionPolicy> policy)
+  : m_group (group),
+    m_index (0),
+    m_state (0),
+    m_replication (false),
+    m_live (0),
+    m_liveVersion (0)
+{
+  NS_ASSERT (group != 0);
+  SetPolicy (policy);
+}
+
 ForwardingInformation::~ForwardingInformation ()
 {
+  delete m_state;
+  delete m_live;
   m_policy = 0;
   m_nhlfe.clear ();
+  m_pool = 0;
+  m_group = 0;
 }
 
 void 
 ForwardingInformation::SetPolicy (const Ptr<NhlfeSelectionPolicy> &policy)
 {
   NS_ASSERT (policy != 0);
+  delete m_state;
   m_policy = policy;
+  m_state = policy->CreateState ();
 }
 
 Ptr<NhlfeSelectionPolicy>
@@ -51,26 +100,127 @@ ForwardingInformation::GetPolicy (void) const
 {
   return m_policy;
 }
+
+void
+ForwardingInformation::SetReplication (bool replication)
+{
+  m_replication = replication;
+}
+
+bool
+ForwardingInformation::IsReplication (void) const
+{
+  return m_replication;
+}
   
 uint32_t
 ForwardingInformation::AddNhlfe (const Nhlfe& nhlfe)
 {
+  NS_ASSERT_MSG (m_group == 0, "NHLFEs of a shared group should be changed via the group");
+
+  m_liveVersion = 0;
+
+  if (m_pool != 0)
+    {
+      m_ids.push_back (m_pool->Intern (nhlfe));
+      return m_ids.size () - 1;
+    }
+
   uint32_t index = m_nhlfe.size ();
   m_nhlfe.push_back (nhlfe);
   return index;
 }
 
+Nhlfe
+ForwardingInformation::GetNhlfe (uint32_t index) const
+{
+  NS_ASSERT_MSG (index < GetNNhlfe (), "Invalid NHLFE index");
+
+  if (m_group != 0)
+    {
+      return m_group->GetNhlfe (index);
+    }
+
+  if (m_pool != 0)
+    {
+      return m_pool->Get (m_ids[index]);
+    }
+
+  return m_nhlfe[index];
+}
+
 void
 ForwardingInformation::RemoveNhlfe (uint32_t index)
 {
-  NS_ASSERT_MSG (index < m_nhlfe.size (), "Invalid NHLFE index");
+  NS_ASSERT_MSG (index < GetNNhlfe (), "Invalid NHLFE index");
+  NS_ASSERT_MSG (m_group == 0, "NHLFEs of a shared group should be changed via the group");
+
+  m_liveVersion = 0;
+
+  if (m_pool != 0)
+    {
+      m_ids.erase (m_ids.begin () + index);
+      return;
+    }
+
   m_nhlfe.erase (m_nhlfe.begin () + index);
 }
 
 uint32_t
 ForwardingInformation::GetNNhlfe (void) const
 {
-  return m_nhlfe.size ();
+  if (m_group != 0)
+    {
+      return m_group->GetNNhlfe ();
+    }
+
+  return m_pool != 0 ? m_ids.size () : m_nhlfe.size ();
+}
+
+void
+ForwardingInformation::Intern (const Ptr<NhlfePool> &pool)
+{
+  NS_ASSERT (pool != 0);
+
+  // NHLFEs of a shared group are kept once anyway
+  if (m_group != 0 || m_pool == pool)
+    {
+      return;
+    }
+
+  NhlfeIdVector ids;
+  ids.reserve (GetNNhlfe ());
+  for (uint32_t i = 0; i < GetNNhlfe (); ++i)
+    {
+      ids.push_back (pool->Intern (GetNhlfe (i)));
+    }
+
+  m_ids.swap (ids);
+  NhlfeVector ().swap (m_nhlfe);
+  m_pool = pool;
+}
+
+const Ptr<NhlfePool>&
+ForwardingInformation::GetNhlfePool (void) const
+{
+  return m_pool;
+}
+
+const Ptr<NextHopGroup>&
+ForwardingInformation::GetNextHopGroup (void) const
+{
+  return m_group;
+}
+
+uint32_t
+ForwardingInformation::GetMemoryUsage (void) const
+{
+  uint32_t size = m_nhlfe.capacity () * sizeof (Nhlfe) + m_ids.capacity () * sizeof (uint32_t);
+  if (m_live != 0)
+    {
+      size += sizeof (*m_live) + m_live->capacity () * sizeof (uint32_t);
+    }
+  return m_state != 0 ? size + m_state->GetMemoryUsage () : size;
 }
 
 uint32_t
@@ -89,19 +239,53 @@ void
 ForwardingInformation::Print (std::ostream &os) const
 {
   os << "nhlfe(s): [";
-  m_policy->Print (os);
+  if (m_replication)
+    {
+      os << "replicate";
+    }
+  else
+    {
+      m_policy->PrintState (os, m_state);
+    }
   os << "] ";
-  for (NhlfeVector::const_iterator n = m_nhlfe.begin (); n != m_nhlfe.end (); ++n)
+  if (m_group != 0)
+  {
+    os << "group ";
+    m_group->Print (os);
+    return;
+  }
+  for (uint32_t i = 0; i < GetNNhlfe (); ++i)
   {
     os << "(";
-    n->Print (os);
+    GetNhlfe (i).Print (os);
     os << ") ";
   }
 }
 
-ForwardingInformation::Iterator::Iterator (const Ptr<NhlfeSelectionPolicy> &policy, const NhlfeVector *nhlfe, uint32_t index)
+ForwardingInformation::Iterator::Iterator (const NhlfeSelectionPolicy *policy, NhlfeSelectionState *state,
+                                           const NhlfeVector *nhlfe, uint32_t index)
   : m_policy (policy),
+    m_state (state),
     m_nhlfe (nhlfe),
+    m_pool (0),
+    m_ids (0),
+    m_indexes (0),
+    m_count (nhlfe->size ()),
+    m_size (nhlfe->size ()),
+    m_index (index)
+{
+}
+
+ForwardingInformation::Iterator::Iterator (const NhlfeSelectionPolicy *policy, NhlfeSelectionState *state,
+                                           const NhlfePool *pool, const NhlfeIdVector *ids, uint32_t index)
+  : m_policy (policy),
+    m_state (state),
+    m_nhlfe (0),
+    m_pool (pool),
+    m_ids (ids),
+    m_indexes (0),
+    m_count (ids->size ()),
+    m_size (ids->size ()),
     m_index (index)
 {
 }
@@ -114,7 +298,13 @@ ForwardingInformation::Iterator&
 ForwardingInformation::Iterator::operator= (const ForwardingInformation::Iterator& iter)
 {
   m_policy = iter.m_policy;
+  m_state = iter.m_state;
   m_nhlfe = iter.m_nhlfe;
+  m_pool = iter.m_pool;
+  m_ids = iter.m_ids;
+  m_indexes = iter.m_indexes;
+  m_count = iter.m_count;
+  m_size = iter.m_size;
   m_index = iter.m_index;
   return (*this);
 }
@@ -134,25 +324,100 @@ ForwardingInformation::Iterator::operator= (const ForwardingInformation::Iterato
 const Nhlfe&
 ForwardingInformation::Iterator::Get ()
 {
-   return m_policy->Get (*m_nhlfe, m_index++);
+  uint32_t i = m_policy->Get (m_count, m_index++, m_state, m_indexes);
+
+  if (m_pool == 0)
+    {
+      return (*m_nhlfe)[i];
+    }
+
+  return m_pool->Get ((*m_ids)[i]);
 }
 
 bool
 ForwardingInformation::Iterator::Select (const Ptr<const Interface> &interface, const Ptr<const Packet> &packet)
 {
-  return m_policy->Select (*m_nhlfe, m_index, interface, packet);
+  return m_policy->Select (m_index, m_state, interface, packet);
+}
+
+void
+ForwardingInformation::Iterator::Restrict (const std::vector<uint32_t> *indexes)
+{
+  m_indexes = indexes;
+  m_size = indexes != 0 ? indexes->size () : m_count;
 }
 
 bool
 ForwardingInformation::Iterator::HasNext (void) const
 {
-  return m_index < m_nhlfe->size (); 
+  return m_index < m_size;
 }
 
 ForwardingInformation::Iterator
 ForwardingInformation::GetIterator (void) const
 {
-  return ForwardingInformation::Iterator(m_policy, &m_nhlfe);
+  if (m_group != 0)
+    {
+      return ForwardingInformation::Iterator(PeekPointer (m_policy), m_state, &m_group->GetNhlfes ());
+    }
+
+  if (m_pool != 0)
+    {
+      return ForwardingInformation::Iterator(PeekPointer (m_policy), m_state, PeekPointer (m_pool), &m_ids);
+    }
+
+  return ForwardingInformation::Iterator(PeekPointer (m_policy), m_state, &m_nhlfe);
+}
+
+ForwardingInformation::Iterator
+ForwardingInformation::GetIterator (const InterfaceLiveness &liveness) const
+{
+  ForwardingInformation::Iterator i = GetIterator ();
+
+  if (liveness.IsAllAlive ())
+    {
+      return i;
+    }
+
+  if (m_group != 0)
+    {
+      i.Restrict (m_group->GetLive (liveness));
+      return i;
+    }
+
+  if (m_liveVersion != liveness.GetVersion ())
+    {
+      m_liveVersion = liveness.GetVersion ();
+
+      uint32_t n = GetNNhlfe ();
+      std::vector<uint32_t> live;
+      live.reserve (n);
+      for (uint32_t j = 0; j < n; ++j)
+        {
+          int32_t interface = m_pool != 0 ? m_pool->GetInterface (m_ids[j]) : m_nhlfe[j].GetInterface ();
+          if (liveness.IsAlive (interface))
+            {
+              live.push_back (j);
+            }
+        }
+
+      if (live.size () == n)
+        {
+          delete m_live;
+          m_live = 0;
+        }
+      else
+        {
+          if (m_live == 0)
+            {
+              m_live = new std::vector<uint32_t>;
+            }
+          m_live->swap (live);
+        }
+    }
+
+  i.Restrict (m_live);
+  return i;
 }
 
 std::ostream& operator<< (std::ostream& os, const Ptr<ForwardingInformation>& info)
@@ -27,6 +27,9 @@
 
 #include "ns3/simple-ref-count.h"
 #include "mpls-nhlfe.h"
+#include "mpls-nhlfe-pool.h"
+#include "mpls-next-hop-group.h"
+#include "mpls-interface-liveness.h"
 #include "mpls-nhlfe-selection-policy.h"
 
 namespace ns3 {
@@ -44,7 +47,7 @@ public:
    */
   virtual ~ForwardingInformation ();
   /**
-   * @brief Add new NHLFE
+   * @brief Add new NHLFE (NHLFEs of a shared group are changed via the group)
    * @param nhlfe Next Hop Label Forwarding Entry
 	 * @return NHLFE index
    */
@@ -53,7 +56,7 @@ public:
    * @brief Get NHLFE by index
    * @param index NHLFE index
    */
-  const Nhlfe& GetNhlfe (uint32_t index);
+  Nhlfe GetNhlfe (uint32_t index) const;
   /**
    * @brief Remove the specific NHLFE
    * @param nhlfe NHLFE
@@ -73,24 +76,54 @@ public:
    */
   void SetIndex (uint32_t index);
   /**
-   * @brief Set nhlfe selection policy
+   * @brief Set nhlfe selection policy (the policy may be shared, per-entry state is created here)
    */
   void SetPolicy (const Ptr<NhlfeSelectionPolicy> &policy);
   /**
    * @brief Set nhlfe selection policy
    */
   Ptr<NhlfeSelectionPolicy> GetPolicy (void) const;
+  /**
+   * @brief Make the entry a point-to-multipoint branch point: the packet is replicated to every
+   * NHLFE with an alive interface, the selection policy is not consulted. Replicating ILMs are
+   * not moved to the flat LFIB, so the flag should be set before MplsNode::FlattenIlmTable
+   */
+  void SetReplication (bool replication);
+  /**
+   * @brief Returns true if the packet is replicated to all NHLFEs
+   */
+  bool IsReplication (void) const;
+  /**
+   * @brief Move NHLFEs to the pool, the entry keeps their ids only
+   */
+  void Intern (const Ptr<NhlfePool> &pool);
+  /**
+   * @brief Returns NHLFE pool or 0 if NHLFEs are kept by the entry
+   */
+  const Ptr<NhlfePool>& GetNhlfePool (void) const;
+  /**
+   * @brief Returns shared NHLFE group or 0 if the entry does not reference a group
+   */
+  const Ptr<NextHopGroup>& GetNextHopGroup (void) const;
+  /**
+   * @brief Returns approximate number of bytes used by the entry (shared pool, group and policy excluded)
+   */
+  virtual uint32_t GetMemoryUsage (void) const;
   /**
    * @brief Print NHLFE
    */
   virtual void Print (std::ostream &os) const = 0;
 
   typedef std::vector<Nhlfe> NhlfeVector;
+  typedef std::vector<uint32_t> NhlfeIdVector;
   
   class Iterator// : public std::iterator<std::input_iterator_tag, Nhlfe> 
   {
   public:
-    Iterator(const Ptr<NhlfeSelectionPolicy> &policy, const NhlfeVector *nhlfe, uint32_t index=0);
+    Iterator(const NhlfeSelectionPolicy *policy, NhlfeSelectionState *state, const NhlfeVector *nhlfe,
+             uint32_t index=0);
+    Iterator(const NhlfeSelectionPolicy *policy, NhlfeSelectionState *state, const NhlfePool *pool,
+             const NhlfeIdVector *ids, uint32_t index=0);
     ~Iterator();
 
     Iterator& operator=(const Iterator& iter);
@@ -99,21 +132,53 @@ public:
     bool HasNext (void) const;
     const Nhlfe& Get (void);
     bool Select (const Ptr<const Interface> &interface, const Ptr<const Packet> &packet);
+    /**
+     * @brief Iterate over NHLFEs with the specified ascending indexes only (all NHLFEs if 0). The
+     * policy is given the indexes, so its per-NHLFE state stays with the same NHLFEs
+     */
+    void Restrict (const std::vector<uint32_t> *indexes);
 
   private:
-    Ptr<NhlfeSelectionPolicy> m_policy;
+    // the iterator lives no longer than the forwarding information, so plain pointers are enough
+    const NhlfeSelectionPolicy *m_policy;
+    NhlfeSelectionState *m_state;
     const NhlfeVector *m_nhlfe;
+    const NhlfePool *m_pool;
+    const NhlfeIdVector *m_ids;
+    const std::vector<uint32_t> *m_indexes;
+    uint32_t m_count;  // NHLFEs of the entry
+    uint32_t m_size;   // NHLFEs to be tried
     uint32_t m_index;
   };
 
   Iterator GetIterator (void) const;
+  /**
+   * @brief Returns iterator over NHLFEs whose outgoing interface is alive. The selectable NHLFEs
+   * are cached by the entry and found again only after a liveness change
+   */
+  Iterator GetIterator (const InterfaceLiveness &liveness) const;
 
 protected: 
   ForwardingInformation (Ptr<NhlfeSelectionPolicy> policy);
+  ForwardingInformation (const NhlfeVector &nhlfe, Ptr<NhlfeSelectionPolicy> policy);
+  ForwardingInformation (const Ptr<NhlfePool> &pool, const NhlfeIdVector &ids, Ptr<NhlfeSelectionPolicy> policy);
+  ForwardingInformation (const Ptr<NextHopGroup> &group, Ptr<NhlfeSelectionPolicy> policy);
   NhlfeVector m_nhlfe;
+  Ptr<NhlfePool> m_pool;
+  NhlfeIdVector m_ids;
+  Ptr<NextHopGroup> m_group;
   uint32_t m_index;
   
   Ptr<NhlfeSelectionPolicy> m_policy;
+  NhlfeSelectionState *m_state;
+  bool m_replication;
+
+  mutable std::vector<uint32_t> *m_live;  // indexes of selectable NHLFEs, 0 if all are selectable
+  mutable uint32_t m_liveVersion;         // liveness version m_live has been built for
+
+private:
+  ForwardingInformation (const ForwardingInformation &);
+  ForwardingInformation& operator= (const ForwardingInformation &);
 };
 
 std::ostream& operator<< (std::ostream& os, const Ptr<ForwardingInformation>& info);
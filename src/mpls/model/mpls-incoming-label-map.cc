@@ -40,6 +40,30 @@ IncomingLabelMap::IncomingLabelMap (int32_t interface, Label label, const Nhlfe
   AddNhlfe (nhlfe);
 }
 
+IncomingLabelMap::IncomingLabelMap (int32_t interface, Label label, const NhlfeVector &nhlfe,
+                                    Ptr<NhlfeSelectionPolicy> policy)
+  : ForwardingInformation (nhlfe, policy),
+    m_interface (interface),
+    m_label (label)
+{
+}
+
+IncomingLabelMap::IncomingLabelMap (int32_t interface, Label label, const Ptr<NhlfePool> &pool,
+                                    const NhlfeIdVector &ids, Ptr<NhlfeSelectionPolicy> policy)
+  : ForwardingInformation (pool, ids, policy),
+    m_interface (interface),
+    m_label (label)
+{
+}
+
+IncomingLabelMap::IncomingLabelMap (int32_t interface, Label label, const Ptr<NextHopGroup> &group,
+                                    Ptr<NhlfeSelectionPolicy> policy)
+  : ForwardingInformation (group, policy),
+    m_interface (interface),
+    m_label (label)
+{
+}
+
 IncomingLabelMap::~IncomingLabelMap ()
 {
 }
@@ -68,6 +92,12 @@ IncomingLabelMap::SetInterface (int32_t interface)
   m_interface = interface;
 }
 
+uint32_t
+IncomingLabelMap::GetMemoryUsage (void) const
+{
+  return sizeof (*this) + ForwardingInformation::GetMemoryUsage ();
+}
+
 void
 IncomingLabelMap::Print (std::ostream &os) const
 {
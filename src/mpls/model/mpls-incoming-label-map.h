@@ -59,6 +59,29 @@ public:
    * @param nhlfe NHLFE (at least one NHLFE should be set)
    */
   IncomingLabelMap (Label label, const Nhlfe &nhlfe, Ptr<NhlfeSelectionPolicy> policy);
+  /**
+   * @brief Construct ILM with a group of NHLFEs at once
+   * @param interface incoming interface (-1 for any)
+   * @param label incoming label
+   * @param nhlfe NHLFEs (at least one NHLFE should be set)
+   */
+  IncomingLabelMap (int32_t interface, Label label, const NhlfeVector &nhlfe, Ptr<NhlfeSelectionPolicy> policy);
+  /**
+   * @brief Construct ILM referencing NHLFEs of the pool
+   * @param interface incoming interface (-1 for any)
+   * @param label incoming label
+   * @param pool NHLFE pool
+   * @param ids NHLFE ids (at least one NHLFE should be set)
+   */
+  IncomingLabelMap (int32_t interface, Label label, const Ptr<NhlfePool> &pool, const NhlfeIdVector &ids,
+                    Ptr<NhlfeSelectionPolicy> policy);
+  /**
+   * @brief Construct ILM referencing a shared NHLFE group
+   * @param interface incoming interface (-1 for any)
+   * @param label incoming label
+   * @param group NHLFE group
+   */
+  IncomingLabelMap (int32_t interface, Label label, const Ptr<NextHopGroup> &group, Ptr<NhlfeSelectionPolicy> policy);
   /**
    * @brief Destuctor
    */
@@ -79,6 +102,7 @@ public:
    * @brief Set incoming interface
    */
   void SetInterface (int32_t interface);
+  virtual uint32_t GetMemoryUsage (void) const;
   /**
    * @brief Print ILM
    * @param os the stream to print to
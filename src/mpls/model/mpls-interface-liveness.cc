@@ -0,0 +1,73 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010-2011 Andrey Churin, Stefano Avallone
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Andrey Churin <aachurin@gmail.com>
+ *         Stefano Avallone <stavallo@gmail.com>
+ */
+
+#include "ns3/assert.h"
+
+#include "mpls-interface-liveness.h"
+
+namespace ns3 {
+namespace mpls {
+
+InterfaceLiveness::InterfaceLiveness ()
+  : m_nDead (0),
+    m_version (1)
+{
+}
+
+InterfaceLiveness::~InterfaceLiveness ()
+{
+}
+
+void
+InterfaceLiveness::SetAlive (int32_t interface, bool alive)
+{
+  NS_ASSERT (interface >= 0);
+
+  if (IsAlive (interface) == alive)
+    {
+      return;
+    }
+
+  uint32_t i = interface;
+  if ((i >> 5) >= m_dead.size ())
+    {
+      m_dead.resize ((i >> 5) + 1, 0);
+    }
+
+  if (alive)
+    {
+      m_dead[i >> 5] &= ~(1u << (i & 31));
+      --m_nDead;
+    }
+  else
+    {
+      m_dead[i >> 5] |= 1u << (i & 31);
+      ++m_nDead;
+    }
+
+  if (++m_version == 0)
+    {
+      m_version = 1;
+    }
+}
+
+} // namespace mpls
+} // namespace ns3
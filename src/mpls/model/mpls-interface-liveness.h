@@ -0,0 +1,93 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010-2011 Andrey Churin, Stefano Avallone
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Andrey Churin <aachurin@gmail.com>
+ *         Stefano Avallone <stavallo@gmail.com>
+ */
+
+#ifndef MPLS_INTERFACE_LIVENESS_H
+#define MPLS_INTERFACE_LIVENESS_H
+
+#include <vector>
+#include <stdint.h>
+
+#include "ns3/simple-ref-count.h"
+
+namespace ns3 {
+namespace mpls {
+
+/**
+ * \ingroup mpls
+ * \brief Bitmap of mpls interfaces whose NHLFEs can not be selected
+ *
+ * Interfaces report themselves here when they are disabled or their link goes down (and back).
+ * NHLFE selection tests one bit per outgoing interface. Every change bumps the version, so entries
+ * may cache the set of their selectable NHLFEs and rebuild it only after a change. Interfaces not
+ * reported (and unspecified interfaces) are alive.
+ */
+class InterfaceLiveness : public SimpleRefCount<InterfaceLiveness>
+{
+public:
+  InterfaceLiveness ();
+  ~InterfaceLiveness ();
+
+  /**
+   * @brief Mark interface alive or dead
+   */
+  void SetAlive (int32_t interface, bool alive);
+  /**
+   * @brief Returns false if NHLFEs of the interface can not be selected
+   */
+  bool IsAlive (int32_t interface) const;
+  /**
+   * @brief Returns true if there are no dead interfaces
+   */
+  bool IsAllAlive (void) const;
+  /**
+   * @brief Returns version of the bitmap, it is changed by every change of the bitmap (never 0)
+   */
+  uint32_t GetVersion (void) const;
+
+private:
+  std::vector<uint32_t> m_dead;
+  uint32_t m_nDead;
+  uint32_t m_version;
+};
+
+inline bool
+InterfaceLiveness::IsAlive (int32_t interface) const
+{
+  uint32_t i = interface;
+  return interface < 0 || (i >> 5) >= m_dead.size () || !(m_dead[i >> 5] & (1u << (i & 31)));
+}
+
+inline bool
+InterfaceLiveness::IsAllAlive (void) const
+{
+  return m_nDead == 0;
+}
+
+inline uint32_t
+InterfaceLiveness::GetVersion (void) const
+{
+  return m_version;
+}
+
+} // namespace mpls
+} // namespace ns3
+
+#endif /* MPLS_INTERFACE_LIVENESS_H */
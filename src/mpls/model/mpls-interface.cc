@@ -32,6 +32,7 @@
 #include "ns3/ipv4.h"
 
 #include "mpls-interface.h"
+#include "mpls-node.h"
 
 NS_LOG_COMPONENT_DEFINE ("mpls::Interface");
 
@@ -123,6 +124,7 @@ void
 Interface::SetMpls (const Ptr<Mpls> &mpls)
 {
   m_mpls = mpls;
+  UpdateLiveness ();
 }
 
 Ptr<Mpls>
@@ -135,6 +137,9 @@ void
 Interface::SetDevice (const Ptr<NetDevice> &device)
 {
   m_device = device;
+  // devices can not remove link change callbacks, so the callback holds a reference to the
+  // interface rather than a raw pointer, NotifyLinkChange ignores it once the interface is disposed
+  m_device->AddLinkChangeCallback (MakeCallback (&Interface::NotifyLinkChange, Ptr<Interface> (this)));
 }
 
 void 
@@ -171,12 +176,56 @@ void
 Interface::SetUp ()
 {
   m_ifup = true;
+  UpdateLiveness ();
 }
 
 void
 Interface::SetDown ()
 {
   m_ifup = false;
+  UpdateLiveness ();
+}
+
+void
+Interface::NotifyLinkChange (void)
+{
+  if (m_device == 0)
+    {
+      return;
+    }
+
+  UpdateLiveness ();
+}
+
+void
+Interface::UpdateLiveness (void)
+{
+  if (m_mpls == 0)
+    {
+      return;
+    }
+
+  Ptr<MplsNode> node = m_mpls->GetNode ();
+  if (node == 0)
+    {
+      return;
+    }
+
+  bool alive = m_ifup && (m_device == 0 || m_device->IsLinkUp ());
+  const Ptr<FastReroute> &frr = node->GetFastReroute ();
+
+  if (alive)
+    {
+      frr->Restore (m_ifIndex);
+      node->GetInterfaceLiveness ()->SetAlive (m_ifIndex, true);
+    }
+  else
+    {
+      frr->Fail (m_ifIndex);
+      // NHLFEs of a protected interface stay selectable, fast reroute sends them to the backups
+      // (and updates the bitmap when backups of the failed interface change)
+      node->GetInterfaceLiveness ()->SetAlive (m_ifIndex, frr->HasBackups (m_ifIndex));
+    }
 }
 
 void
@@ -101,11 +101,13 @@ public:
    */
   bool IsDown () const;
   /**
-   * @brief Enable interface
+   * @brief Enable interface. The interface is alive while it is enabled and its link is up,
+   * adjacencies of the interface are switched back from fast reroute backups then
    */
   void SetUp ();
   /**
-   * @brief Disable interface
+   * @brief Disable interface, adjacencies of the interface are switched to fast reroute backups
+   * and its unprotected NHLFEs are not selected any more
    */
   void SetDown ();
   /**
@@ -151,6 +153,9 @@ protected:
   virtual void DoDispose (void);
 
 private:
+  void NotifyLinkChange (void);
+  void UpdateLiveness (void);
+
   Ptr<Mpls> m_mpls;
   Ptr<NetDevice> m_device;
   int32_t m_ipv4if;
@@ -90,6 +90,12 @@ Ipv4Protocol::GetRoutingProtocol (void) const
   return m_routingProtocol->GetRoutingProtocol ();
 }
 
+Ptr<Ipv4Routing>
+Ipv4Protocol::GetMplsRouting (void) const
+{
+  return m_routingProtocol;
+}
+
 } // namespace mpls
 } // namespace ns3
 
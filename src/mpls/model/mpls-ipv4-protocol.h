@@ -50,6 +50,10 @@ public:
   // methods defined in parent class
   void SetRoutingProtocol (Ptr<Ipv4RoutingProtocol> routingProtocol);
   Ptr<Ipv4RoutingProtocol> GetRoutingProtocol (void) const;
+  /**
+   * @brief Returns the mpls routing hook, which keeps the route cache
+   */
+  Ptr<Ipv4Routing> GetMplsRouting (void) const;
 
 protected:
   void NotifyNewAggregate ();
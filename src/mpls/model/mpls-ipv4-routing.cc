@@ -22,6 +22,7 @@
 #include "ns3/log.h"
 #include "ns3/assert.h"
 #include "ns3/simulator.h"
+#include "ns3/uinteger.h"
 
 #include "mpls-ipv4-routing.h"
 
@@ -34,7 +35,10 @@ NS_OBJECT_ENSURE_REGISTERED (Ipv4Routing);
 
 Ipv4Routing::Ipv4Routing ()
   : m_mpls (0),
-    m_ipv4 (0)
+    m_ipv4 (0),
+    m_routeCacheSize (0),
+    m_routeCacheHits (0),
+    m_routeCacheMisses (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -50,6 +54,11 @@ Ipv4Routing::GetTypeId (void)
   static TypeId tid = TypeId ("ns3::mpls::Ipv4Routing")
     .SetParent<Ipv4RoutingProtocol> ()
     .AddConstructor<Ipv4Routing> ()
+    .AddAttribute ("RouteCacheSize",
+                   "The maximum number of cached routes, zero (the default) disables the cache.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&Ipv4Routing::m_routeCacheSize),
+                   MakeUintegerChecker<uint32_t> ())
   ;
   return tid;
 }
@@ -59,6 +68,7 @@ Ipv4Routing::DoDispose (void)
 {
   m_mpls = 0;
   m_routingProtocol = 0;
+  m_routeCache.clear ();
   Ipv4RoutingProtocol::DoDispose ();
 }
 
@@ -68,7 +78,35 @@ Ipv4Routing::RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<NetDevice
   NS_LOG_FUNCTION (this << &oif << p << header);
 
   NS_ASSERT_MSG (m_routingProtocol != 0, "Need Ipv4 routing object to process packet");
-  return m_routingProtocol->RouteOutput (p, header, oif, sockerr);
+
+  if (m_routeCacheSize == 0)
+    {
+      return m_routingProtocol->RouteOutput (p, header, oif, sockerr);
+    }
+
+  RouteCache::key_type key (header.GetDestination (), oif != 0 ? oif->GetIfIndex () + 1 : 0);
+  RouteCache::const_iterator i = m_routeCache.find (key);
+  if (i != m_routeCache.end ())
+    {
+      ++m_routeCacheHits;
+      sockerr = Socket::ERROR_NOTERROR;
+      return i->second;
+    }
+
+  ++m_routeCacheMisses;
+  Ptr<Ipv4Route> route = m_routingProtocol->RouteOutput (p, header, oif, sockerr);
+
+  // failures are not cached, the cache is emptied rather than aged when it is full
+  if (route != 0)
+    {
+      if (m_routeCache.size () >= m_routeCacheSize)
+        {
+          m_routeCache.clear ();
+        }
+      m_routeCache.insert (std::make_pair (key, route));
+    }
+
+  return route;
 }
 
 bool
@@ -117,6 +155,8 @@ Ipv4Routing::NotifyInterfaceUp (uint32_t interface)
 {
   NS_LOG_FUNCTION (this << interface);
 
+  FlushRouteCache ();
+
   if (m_routingProtocol != 0)
     {
       m_routingProtocol->NotifyInterfaceUp (interface);
@@ -128,6 +168,8 @@ Ipv4Routing::NotifyInterfaceDown (uint32_t interface)
 {
   NS_LOG_FUNCTION (this << interface);
 
+  FlushRouteCache ();
+
   if (m_routingProtocol != 0)
     {
       m_routingProtocol->NotifyInterfaceDown (interface);
@@ -139,6 +181,8 @@ Ipv4Routing::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address)
 {
   NS_LOG_FUNCTION (this << interface << address);
 
+  FlushRouteCache ();
+
   if (m_routingProtocol != 0)
     {
       m_routingProtocol->NotifyAddAddress (interface, address);
@@ -150,6 +194,8 @@ Ipv4Routing::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress addre
 {
   NS_LOG_FUNCTION (this << interface << address);
 
+  FlushRouteCache ();
+
   if (m_routingProtocol != 0)
     {
       m_routingProtocol->NotifyRemoveAddress (interface, address);
@@ -163,6 +209,32 @@ Ipv4Routing::SetRoutingProtocol (const Ptr<Ipv4RoutingProtocol> &routingProtocol
 
   m_routingProtocol = routingProtocol;
   routingProtocol->SetIpv4 (m_ipv4);
+  FlushRouteCache ();
+}
+
+void
+Ipv4Routing::FlushRouteCache (void)
+{
+  m_routeCache.clear ();
+}
+
+uint64_t
+Ipv4Routing::GetRouteCacheHits (void) const
+{
+  return m_routeCacheHits;
+}
+
+uint64_t
+Ipv4Routing::GetRouteCacheMisses (void) const
+{
+  return m_routeCacheMisses;
+}
+
+double
+Ipv4Routing::GetRouteCacheHitRate (void) const
+{
+  uint64_t lookups = m_routeCacheHits + m_routeCacheMisses;
+  return lookups != 0 ? double (m_routeCacheHits) / lookups : 0;
 }
 
 Ptr<Ipv4RoutingProtocol>
@@ -22,6 +22,8 @@
 #ifndef MPLS_IPV4_ROUTING_H
 #define MPLS_IPV4_ROUTING_H
 
+#include <map>
+
 #include "ns3/ptr.h"
 #include "ns3/net-device.h"
 #include "ns3/packet.h"
@@ -41,6 +43,16 @@ namespace mpls {
 /**
  * \brief
  * Mpls ipv4 routing hook
+ *
+ * Routes returned by the underlying routing protocol to RouteOutput are cached by destination and
+ * output device, so packets leaving an LSP and locally originated packets skip the table walk of
+ * the routing protocol. The cache is flushed when an interface goes up or down, when an address is
+ * added or removed and when the routing protocol is replaced; other changes of the routing tables
+ * (static routes, recomputed global routes) require FlushRouteCache. RouteInput decisions are
+ * delivered by callbacks of the routing protocol (possibly deferred) and are not cached.
+ *
+ * The cache is disabled by default, since a stale route is used until the cache is flushed. Set
+ * the RouteCacheSize attribute to enable it.
  */
 class Ipv4Routing : public Ipv4RoutingProtocol
 {
@@ -76,14 +88,37 @@ public:
 
   void SetMpls (Ptr<Mpls> mpls);
   void SetIpv4 (Ptr<Ipv4> ipv4);
+  /**
+   * @brief Remove all cached routes
+   */
+  void FlushRouteCache (void);
+  /**
+   * @brief Returns number of RouteOutput calls answered from the cache
+   */
+  uint64_t GetRouteCacheHits (void) const;
+  /**
+   * @brief Returns number of RouteOutput calls passed to the routing protocol
+   */
+  uint64_t GetRouteCacheMisses (void) const;
+  /**
+   * @brief Returns share of RouteOutput calls answered from the cache
+   */
+  double GetRouteCacheHitRate (void) const;
     
 protected:
   void DoDispose (void);
 
 private:
+  // destination and output device index plus one (zero for any device)
+  typedef std::map<std::pair<Ipv4Address, uint32_t>, Ptr<Ipv4Route> > RouteCache;
+
   Ptr<Mpls> m_mpls;
   Ptr<Ipv4> m_ipv4;  
   Ptr<Ipv4RoutingProtocol> m_routingProtocol;
+  RouteCache m_routeCache;
+  uint32_t m_routeCacheSize;
+  uint64_t m_routeCacheHits;
+  uint64_t m_routeCacheMisses;
 };
 
 } // namespace mpls
@@ -27,7 +27,9 @@ namespace mpls {
 
 LabelSpace::LabelSpace ()
   : m_min (0x1000),
-    m_max (0xfffff)
+    m_max (0xfffff),
+    m_srgbBase (0),
+    m_srgbSize (0)
 {
 }
 
@@ -81,6 +83,236 @@ LabelSpace::Allocate ()
   return Label (value);
 }
 
+Label
+LabelSpace::Allocate (uint32_t count)
+{
+  NS_ASSERT (count > 0);
+
+  uint32_t value = m_min;
+  LabelRangeList::iterator i = m_ranges.begin ();
+
+  // look for the first gap which fits the block
+  while (i != m_ranges.end () && (*i).first < value + count)
+    {
+      value = (*i).second + 1;
+      ++i;
+    }
+
+  uint32_t last = value + count - 1;
+  NS_ASSERT_MSG (last <= m_max, "Cannot allocate label block");
+
+  bool joinPrev = i != m_ranges.begin ();
+  bool joinNext = i != m_ranges.end () && (*i).first == last + 1;
+
+  if (joinPrev)
+    {
+      LabelRangeList::iterator prev = i;
+      --prev;
+      joinPrev = (*prev).second + 1 == value;
+
+      if (joinPrev && joinNext)
+        {
+          (*prev).second = (*i).second;
+          m_ranges.erase (i);
+          return Label (value);
+        }
+
+      if (joinPrev)
+        {
+          (*prev).second = last;
+          return Label (value);
+        }
+    }
+
+  if (joinNext)
+    {
+      (*i).first = value;
+    }
+  else
+    {
+      m_ranges.insert (i, std::make_pair (value, last));
+    }
+
+  return Label (value);
+}
+
+bool
+LabelSpace::Reserve (const Label &label)
+{
+  uint32_t value = label;
+  NS_ASSERT_MSG (value >= m_min && value <= m_max, "LabelSpace::Reserve (): Label is out of range");
+
+  // skip ranges which end before value - 1
+  LabelRangeList::iterator i = m_ranges.begin ();
+  while (i != m_ranges.end () && (*i).second + 1 < value)
+    {
+      ++i;
+    }
+
+  if (i == m_ranges.end ())
+    {
+      m_ranges.insert (i, std::make_pair (value, value));
+      return true;
+    }
+
+  LabelRange& r = *i;
+
+  if (r.first <= value && value <= r.second)
+    {
+      return false;
+    }
+
+  if (r.second + 1 == value)
+    {
+      r.second = value;
+      LabelRangeList::iterator next = i;
+      ++next;
+      if (next != m_ranges.end () && (*next).first == value + 1)
+        {
+          r.second = (*next).second;
+          m_ranges.erase (next);
+        }
+    }
+  else if (r.first == value + 1)
+    {
+      r.first = value;
+    }
+  else
+    {
+      m_ranges.insert (i, std::make_pair (value, value));
+    }
+
+  return true;
+}
+
+bool
+LabelSpace::Reserve (const Label &label, uint32_t count)
+{
+  NS_ASSERT (count > 0);
+
+  uint32_t first = label;
+  uint32_t last = first + count - 1;
+  NS_ASSERT_MSG (first >= m_min && last <= m_max && last >= first, "LabelSpace::Reserve (): Block is out of range");
+
+  // skip ranges which end before the block
+  LabelRangeList::iterator i = m_ranges.begin ();
+  while (i != m_ranges.end () && (*i).second < first)
+    {
+      ++i;
+    }
+
+  if (i != m_ranges.end () && (*i).first <= last)
+    {
+      return false;
+    }
+
+  bool joinNext = i != m_ranges.end () && (*i).first == last + 1;
+
+  if (i != m_ranges.begin ())
+    {
+      LabelRangeList::iterator prev = i;
+      --prev;
+      if ((*prev).second + 1 == first)
+        {
+          if (joinNext)
+            {
+              (*prev).second = (*i).second;
+              m_ranges.erase (i);
+            }
+          else
+            {
+              (*prev).second = last;
+            }
+          return true;
+        }
+    }
+
+  if (joinNext)
+    {
+      (*i).first = first;
+    }
+  else
+    {
+      m_ranges.insert (i, std::make_pair (first, last));
+    }
+
+  return true;
+}
+
+bool
+LabelSpace::ReserveSrgb (uint32_t base, uint32_t size)
+{
+  if (m_srgbSize != 0 || !Reserve (base, size))
+    {
+      return false;
+    }
+
+  m_srgbBase = base;
+  m_srgbSize = size;
+  return true;
+}
+
+void
+LabelSpace::ReleaseSrgb (void)
+{
+  if (m_srgbSize != 0)
+    {
+      Deallocate (m_srgbBase, m_srgbSize);
+      m_srgbBase = 0;
+      m_srgbSize = 0;
+    }
+}
+
+uint32_t
+LabelSpace::GetSrgbBase (void) const
+{
+  return m_srgbBase;
+}
+
+uint32_t
+LabelSpace::GetSrgbSize (void) const
+{
+  return m_srgbSize;
+}
+
+void
+LabelSpace::Deallocate (const Label &label, uint32_t count)
+{
+  uint32_t first = label;
+  uint32_t last = first + count - 1;
+  LabelRangeList::iterator i = m_ranges.begin ();
+
+  while (i != m_ranges.end () && (*i).first <= last)
+    {
+      LabelRange& r = *i;
+
+      if (r.second < first)
+        {
+          ++i;
+        }
+      else if (r.first < first && r.second > last)
+        {
+          m_ranges.insert (i, std::make_pair (r.first, first - 1));
+          r.first = last + 1;
+          return;
+        }
+      else if (r.first < first)
+        {
+          r.second = first - 1;
+          ++i;
+        }
+      else if (r.second > last)
+        {
+          r.first = last + 1;
+          return;
+        }
+      else
+        {
+          i = m_ranges.erase (i);
+        }
+    }
+}
+
 void
 LabelSpace::Deallocate (const Label &label)
 {
@@ -148,6 +380,8 @@ void
 LabelSpace::Clear (void)
 {
   m_ranges.clear ();
+  m_srgbBase = 0;
+  m_srgbSize = 0;
 }
 
 void
@@ -172,5 +406,37 @@ LabelSpace::IsEmpty (void) const
   return m_ranges.size () == 0;
 }
 
+uint32_t
+LabelSpace::GetMinValue (void) const
+{
+  return m_min;
+}
+
+uint32_t
+LabelSpace::GetMaxValue (void) const
+{
+  return m_max;
+}
+
+void
+LabelSpace::GetAllocatedRanges (RangeVector &ranges) const
+{
+  ranges.assign (m_ranges.begin (), m_ranges.end ());
+}
+
+void
+LabelSpace::SetAllocatedRanges (const RangeVector &ranges)
+{
+  m_ranges.clear ();
+  for (RangeVector::const_iterator i = ranges.begin (); i != ranges.end (); ++i)
+    {
+      NS_ASSERT_MSG ((*i).first <= (*i).second && (*i).first >= m_min && (*i).second <= m_max,
+                     "LabelSpace::SetAllocatedRanges (): Invalid label range");
+      NS_ASSERT_MSG (m_ranges.empty () || m_ranges.back ().second < (*i).first,
+                     "LabelSpace::SetAllocatedRanges (): Ranges should be sorted and disjoint");
+      m_ranges.push_back (*i);
+    }
+}
+
 } // namespace mpls
 } // namespace ns3
@@ -24,6 +24,7 @@
 
 #include <ostream>
 #include <list>
+#include <vector>
 #include <stdint.h>
 
 #include "ns3/simple-ref-count.h"
@@ -40,6 +41,8 @@ namespace mpls {
 class LabelSpace
 {
 public:
+  typedef std::vector<std::pair<uint32_t, uint32_t> > RangeVector;
+
   /**
    * @brief Create label space
    */
@@ -52,10 +55,52 @@ public:
    * @brief Allocate label
    */
   Label Allocate ();
+  /**
+   * @brief Allocate a block of consecutive labels
+   * @param count number of labels
+   * @returns the first label of the block
+   */
+  Label Allocate (uint32_t count);
+  /**
+   * @brief Mark the specific label as allocated (label should be in the space range)
+   * @returns false if the label is already allocated
+   */
+  bool Reserve (const Label &label);
+  /**
+   * @brief Mark a block of consecutive labels as allocated (block should be in the space range)
+   * @param label the first label of the block
+   * @param count number of labels
+   * @returns false if some label of the block is already allocated, nothing is reserved then
+   */
+  bool Reserve (const Label &label, uint32_t count);
+  /**
+   * @brief Reserve the segment routing global block (SRGB), labels of global segments are
+   * the base plus the segment index
+   * @returns false if some label of the block is already allocated or the SRGB is already reserved
+   */
+  bool ReserveSrgb (uint32_t base, uint32_t size);
+  /**
+   * @brief Release the segment routing global block
+   */
+  void ReleaseSrgb (void);
+  /**
+   * @brief Returns the first label of the SRGB
+   */
+  uint32_t GetSrgbBase (void) const;
+  /**
+   * @brief Returns size of the SRGB, 0 if it is not reserved
+   */
+  uint32_t GetSrgbSize (void) const;
   /**
    * @brief Allocate label
    */
   void Deallocate (const Label &label);
+  /**
+   * @brief Deallocate a block of consecutive labels
+   * @param label the first label of the block
+   * @param count number of labels
+   */
+  void Deallocate (const Label &label, uint32_t count);
   /**
    * @brief Clear space
    */
@@ -72,6 +117,22 @@ public:
    * @brief Clear space and set new min and max values
    */
   bool IsEmpty (void) const;
+  /**
+   * @brief Returns min value
+   */
+  uint32_t GetMinValue (void) const;
+  /**
+   * @brief Returns max value
+   */
+  uint32_t GetMaxValue (void) const;
+  /**
+   * @brief Returns allocated labels as sorted ranges [first, last] of consecutive labels
+   */
+  void GetAllocatedRanges (RangeVector &ranges) const;
+  /**
+   * @brief Replace allocated labels by sorted, disjoint ranges (as returned by GetAllocatedRanges)
+   */
+  void SetAllocatedRanges (const RangeVector &ranges);
 private:
   typedef std::pair<uint32_t, uint32_t> LabelRange;
   typedef std::list<LabelRange> LabelRangeList;  
@@ -79,6 +140,8 @@ private:
   LabelRangeList m_ranges;
   uint32_t m_min;
   uint32_t m_max;
+  uint32_t m_srgbBase;
+  uint32_t m_srgbSize;
 };
 
 } // namespace mpls
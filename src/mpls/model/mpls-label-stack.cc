@@ -19,6 +19,8 @@
  *         Stefano Avallone <stavallo@gmail.com>
  */
 
+#include <algorithm>
+
 #include "ns3/log.h"
 #include "ns3/assert.h"
 #include "mpls-label-stack.h"
@@ -64,6 +66,15 @@ LabelStack::Push (uint32_t s)
   m_entries.push_back (s);
 }
 
+void
+LabelStack::Rewrite (uint32_t pop, const uint32_t *entries, uint32_t count)
+{
+  NS_LOG_FUNCTION (this << pop << count);
+
+  m_entries.erase (m_entries.end () - std::min<uint32_t> (pop, m_entries.size ()), m_entries.end ());
+  m_entries.insert (m_entries.end (), entries, entries + count);
+}
+
 void
 LabelStack::Swap (uint32_t s)
 {
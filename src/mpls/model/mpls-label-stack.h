@@ -67,6 +67,11 @@ public:
    * @brief Add a new entry to the top of the stack
    */
   void Push (uint32_t s);
+  /**
+   * @brief Remove up to pop entries from the top, then add the entries in one step, the last one
+   * becomes the top (executes a compiled NHLFE operation)
+   */
+  void Rewrite (uint32_t pop, const uint32_t *entries, uint32_t count);
   /**
    * @brief Swap an entry on the stack's top
    */
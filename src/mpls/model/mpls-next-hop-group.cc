@@ -0,0 +1,170 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010-2011 Andrey Churin, Stefano Avallone
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Andrey Churin <aachurin@gmail.com>
+ *         Stefano Avallone <stavallo@gmail.com>
+ */
+
+#include "ns3/assert.h"
+
+#include "mpls-next-hop-group.h"
+
+namespace ns3 {
+namespace mpls {
+
+NextHopGroup::NextHopGroup ()
+  : m_version (0),
+    m_allAlive (true),
+    m_liveVersion (0),
+    m_liveGroupVersion (0)
+{
+}
+
+NextHopGroup::NextHopGroup (const NhlfeVector &nhlfe)
+  : m_nhlfe (nhlfe),
+    m_version (0),
+    m_allAlive (true),
+    m_liveVersion (0),
+    m_liveGroupVersion (0)
+{
+}
+
+NextHopGroup::~NextHopGroup ()
+{
+}
+
+uint32_t
+NextHopGroup::AddNhlfe (const Nhlfe &nhlfe)
+{
+  m_nhlfe.push_back (nhlfe);
+  ++m_version;
+  return m_nhlfe.size () - 1;
+}
+
+void
+NextHopGroup::SetNhlfe (uint32_t index, const Nhlfe &nhlfe)
+{
+  NS_ASSERT_MSG (index < m_nhlfe.size (), "Invalid NHLFE index");
+  m_nhlfe[index] = nhlfe;
+  ++m_version;
+}
+
+void
+NextHopGroup::SetNhlfes (const NhlfeVector &nhlfe)
+{
+  m_nhlfe = nhlfe;
+  ++m_version;
+}
+
+void
+NextHopGroup::RemoveNhlfe (uint32_t index)
+{
+  NS_ASSERT_MSG (index < m_nhlfe.size (), "Invalid NHLFE index");
+  m_nhlfe.erase (m_nhlfe.begin () + index);
+  ++m_version;
+}
+
+uint32_t
+NextHopGroup::RemoveNextHop (int32_t interface, const Address &nextHop)
+{
+  uint32_t count = 0;
+  for (NhlfeVector::iterator i = m_nhlfe.begin (); i != m_nhlfe.end (); )
+    {
+      if (i->GetInterface () == interface && i->GetNextHop () == nextHop)
+        {
+          i = m_nhlfe.erase (i);
+          ++count;
+        }
+      else
+        {
+          ++i;
+        }
+    }
+
+  if (count != 0)
+    {
+      ++m_version;
+    }
+
+  return count;
+}
+
+const Nhlfe&
+NextHopGroup::GetNhlfe (uint32_t index) const
+{
+  NS_ASSERT_MSG (index < m_nhlfe.size (), "Invalid NHLFE index");
+  return m_nhlfe[index];
+}
+
+const NextHopGroup::NhlfeVector&
+NextHopGroup::GetNhlfes (void) const
+{
+  return m_nhlfe;
+}
+
+uint32_t
+NextHopGroup::GetNNhlfe (void) const
+{
+  return m_nhlfe.size ();
+}
+
+uint32_t
+NextHopGroup::GetVersion (void) const
+{
+  return m_version;
+}
+
+const std::vector<uint32_t>*
+NextHopGroup::GetLive (const InterfaceLiveness &liveness) const
+{
+  if (m_liveVersion != liveness.GetVersion () || m_liveGroupVersion != m_version)
+    {
+      m_liveVersion = liveness.GetVersion ();
+      m_liveGroupVersion = m_version;
+      m_live.clear ();
+      for (uint32_t i = 0; i < m_nhlfe.size (); ++i)
+        {
+          if (liveness.IsAlive (m_nhlfe[i].GetInterface ()))
+            {
+              m_live.push_back (i);
+            }
+        }
+      m_allAlive = m_live.size () == m_nhlfe.size ();
+    }
+
+  return m_allAlive ? 0 : &m_live;
+}
+
+uint32_t
+NextHopGroup::GetMemoryUsage (void) const
+{
+  return sizeof (*this) + m_nhlfe.capacity () * sizeof (Nhlfe) + m_live.capacity () * sizeof (uint32_t);
+}
+
+void
+NextHopGroup::Print (std::ostream &os) const
+{
+  for (NhlfeVector::const_iterator i = m_nhlfe.begin (); i != m_nhlfe.end (); ++i)
+    {
+      os << "(";
+      i->Print (os);
+      os << ") ";
+    }
+}
+
+} // namespace mpls
+} // namespace ns3
@@ -0,0 +1,126 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010-2011 Andrey Churin, Stefano Avallone
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Andrey Churin <aachurin@gmail.com>
+ *         Stefano Avallone <stavallo@gmail.com>
+ */
+
+#ifndef MPLS_NEXT_HOP_GROUP_H
+#define MPLS_NEXT_HOP_GROUP_H
+
+#include <vector>
+#include <ostream>
+
+#include "ns3/simple-ref-count.h"
+#include "ns3/address.h"
+
+#include "mpls-nhlfe.h"
+#include "mpls-interface-liveness.h"
+
+namespace ns3 {
+namespace mpls {
+
+/**
+ * \ingroup mpls
+ * \brief NHLFEs shared by many ILMs and FTNs
+ *
+ * Entries built on a group reference it instead of keeping own NHLFEs, so a next-hop change is
+ * made once in the group and takes effect for every entry, however many labels and prefixes use
+ * it (prefix independent convergence). The group may become empty, packets of its entries are
+ * dropped then. Per-entry selection state stays with the entries.
+ */
+class NextHopGroup : public SimpleRefCount<NextHopGroup>
+{
+public:
+  typedef std::vector<Nhlfe> NhlfeVector;
+
+  NextHopGroup ();
+  /**
+   * @brief Construct group of the NHLFEs
+   */
+  NextHopGroup (const NhlfeVector &nhlfe);
+  ~NextHopGroup ();
+
+  /**
+   * @brief Add NHLFE
+   * @return NHLFE index
+   */
+  uint32_t AddNhlfe (const Nhlfe &nhlfe);
+  /**
+   * @brief Replace NHLFE by index
+   */
+  void SetNhlfe (uint32_t index, const Nhlfe &nhlfe);
+  /**
+   * @brief Replace all NHLFEs of the group at once
+   */
+  void SetNhlfes (const NhlfeVector &nhlfe);
+  /**
+   * @brief Remove NHLFE by index
+   */
+  void RemoveNhlfe (uint32_t index);
+  /**
+   * @brief Remove NHLFEs with the specified outgoing interface and next-hop
+   * @return number of removed NHLFEs
+   */
+  uint32_t RemoveNextHop (int32_t interface, const Address &nextHop);
+  /**
+   * @brief Returns NHLFE by index
+   */
+  const Nhlfe& GetNhlfe (uint32_t index) const;
+  /**
+   * @brief Returns NHLFEs of the group
+   */
+  const NhlfeVector& GetNhlfes (void) const;
+  /**
+   * @brief Returns NHLFE count
+   */
+  uint32_t GetNNhlfe (void) const;
+  /**
+   * @brief Returns number of changes made to the group
+   */
+  uint32_t GetVersion (void) const;
+  /**
+   * @brief Returns indexes of NHLFEs whose outgoing interface is alive or 0 if all of them are. The
+   * indexes are shared by all entries of the group and found again only after a change
+   */
+  const std::vector<uint32_t>* GetLive (const InterfaceLiveness &liveness) const;
+  /**
+   * @brief Returns approximate number of bytes used by the group
+   */
+  uint32_t GetMemoryUsage (void) const;
+  /**
+   * @brief Print NHLFEs of the group
+   */
+  void Print (std::ostream &os) const;
+
+private:
+  NextHopGroup (const NextHopGroup &);
+  NextHopGroup& operator= (const NextHopGroup &);
+
+  NhlfeVector m_nhlfe;
+  uint32_t m_version;
+
+  mutable std::vector<uint32_t> m_live;
+  mutable bool m_allAlive;
+  mutable uint32_t m_liveVersion;       // liveness version m_live has been built for
+  mutable uint32_t m_liveGroupVersion;  // group version m_live has been built for
+};
+
+} // namespace mpls
+} // namespace ns3
+
+#endif /* MPLS_NEXT_HOP_GROUP_H */
@@ -0,0 +1,218 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010-2011 Andrey Churin, Stefano Avallone
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Andrey Churin <aachurin@gmail.com>
+ *         Stefano Avallone <stavallo@gmail.com>
+ */
+
+#include "ns3/assert.h"
+
+#include "mpls-nhlfe-pool.h"
+
+namespace ns3 {
+namespace mpls {
+
+NhlfePool::NhlfePool ()
+{
+}
+
+NhlfePool::~NhlfePool ()
+{
+}
+
+uint32_t
+NhlfePool::Hash (uint32_t adjacency, const Nhlfe &nhlfe)
+{
+  // FNV-1a over the adjacency, the opcode and the labels (labels are valid for swap and push only)
+  uint32_t opcode = nhlfe.GetOpCode ();
+  uint32_t nLabels = opcode != OP_POP ? nhlfe.GetNLabels () : 0;
+  uint32_t hash = 2166136261U;
+  hash = (hash ^ adjacency) * 16777619U;
+  hash = (hash ^ opcode) * 16777619U;
+  for (uint32_t i = 0; i < nLabels; ++i)
+    {
+      hash = (hash ^ nhlfe.GetLabel (i)) * 16777619U;
+    }
+  return hash;
+}
+
+bool
+NhlfePool::IsEqual (uint32_t id, uint32_t adjacency, const Nhlfe &nhlfe) const
+{
+  if (m_nhlfeAdjacencies[id] != adjacency || GetOpCode (id) != nhlfe.GetOpCode ())
+    {
+      return false;
+    }
+
+  uint32_t nLabels = GetNLabels (id);
+  if (nLabels != (nhlfe.GetOpCode () != OP_POP ? nhlfe.GetNLabels () : 0))
+    {
+      return false;
+    }
+
+  const Nhlfe &stored = m_nhlfes[id];
+  for (uint32_t i = 0; i < nLabels; ++i)
+    {
+      if (stored.GetLabel (i) != nhlfe.GetLabel (i))
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+void
+NhlfePool::Rehash (uint32_t nSlots)
+{
+  std::vector<uint32_t> slots (nSlots, 0);
+  for (uint32_t id = 0; id < m_nhlfes.size (); ++id)
+    {
+      uint32_t slot = Hash (m_nhlfeAdjacencies[id], m_nhlfes[id]) & (nSlots - 1);
+      while (slots[slot] != 0)
+        {
+          slot = (slot + 1) & (nSlots - 1);
+        }
+      slots[slot] = id + 1;
+    }
+  m_slots.swap (slots);
+}
+
+uint32_t
+NhlfePool::Intern (const Nhlfe &nhlfe)
+{
+  Adjacency adjacency (nhlfe.GetInterface (), nhlfe.GetNextHop ());
+  std::map<Adjacency, uint32_t>::const_iterator a = m_adjacencyIds.find (adjacency);
+  uint32_t adjacencyId;
+  if (a != m_adjacencyIds.end ())
+    {
+      adjacencyId = a->second;
+    }
+  else
+    {
+      adjacencyId = m_adjacencies.size ();
+      m_adjacencies.push_back (adjacency);
+      m_adjacencyIds.insert (std::make_pair (adjacency, adjacencyId));
+    }
+
+  // the table is kept at most half full, so probe sequences stay short
+  if (2 * (m_nhlfes.size () + 1) > m_slots.size ())
+    {
+      Rehash (m_slots.empty () ? 16 : 2 * m_slots.size ());
+    }
+
+  uint32_t mask = m_slots.size () - 1;
+  uint32_t slot = Hash (adjacencyId, nhlfe) & mask;
+  while (m_slots[slot] != 0)
+    {
+      if (IsEqual (m_slots[slot] - 1, adjacencyId, nhlfe))
+        {
+          return m_slots[slot] - 1;
+        }
+      slot = (slot + 1) & mask;
+    }
+
+  uint32_t id = m_nhlfes.size ();
+  m_nhlfes.push_back (nhlfe);
+  m_nhlfeAdjacencies.push_back (adjacencyId);
+  m_slots[slot] = id + 1;
+  return id;
+}
+
+const Nhlfe&
+NhlfePool::Get (uint32_t id) const
+{
+  NS_ASSERT_MSG (id < m_nhlfes.size (), "NhlfePool::Get (): invalid NHLFE id");
+  return m_nhlfes[id];
+}
+
+uint32_t
+NhlfePool::GetOpCode (uint32_t id) const
+{
+  NS_ASSERT_MSG (id < m_nhlfes.size (), "NhlfePool::GetOpCode (): invalid NHLFE id");
+  return m_nhlfes[id].GetOpCode ();
+}
+
+uint32_t
+NhlfePool::GetNLabels (uint32_t id) const
+{
+  NS_ASSERT_MSG (id < m_nhlfes.size (), "NhlfePool::GetNLabels (): invalid NHLFE id");
+  return m_nhlfes[id].GetOpCode () != OP_POP ? m_nhlfes[id].GetNLabels () : 0;
+}
+
+uint32_t
+NhlfePool::GetLabel (uint32_t id, uint32_t index) const
+{
+  NS_ASSERT_MSG (index < GetNLabels (id), "NhlfePool::GetLabel (): invalid label index");
+  return m_nhlfes[id].GetLabel (index);
+}
+
+uint32_t
+NhlfePool::GetAdjacency (uint32_t id) const
+{
+  NS_ASSERT_MSG (id < m_nhlfes.size (), "NhlfePool::GetAdjacency (): invalid NHLFE id");
+  return m_nhlfeAdjacencies[id];
+}
+
+int32_t
+NhlfePool::GetInterface (uint32_t id) const
+{
+  return m_adjacencies[GetAdjacency (id)].first;
+}
+
+const Address&
+NhlfePool::GetNextHop (uint32_t id) const
+{
+  return m_adjacencies[GetAdjacency (id)].second;
+}
+
+uint32_t
+NhlfePool::GetN (void) const
+{
+  return m_nhlfes.size ();
+}
+
+uint32_t
+NhlfePool::GetNAdjacencies (void) const
+{
+  return m_adjacencies.size ();
+}
+
+uint64_t
+NhlfePool::GetMemoryUsage (void) const
+{
+  // a map node holds the value and about four pointers of the tree, labels of deep stacks are
+  // kept outside of the NHLFE
+  uint64_t node = 4 * sizeof (void*);
+  uint64_t labels = 0;
+  for (std::vector<Nhlfe>::const_iterator i = m_nhlfes.begin (); i != m_nhlfes.end (); ++i)
+    {
+      if (i->GetNLabels () > 6)
+        {
+          labels += i->GetNLabels () * sizeof (uint32_t);
+        }
+    }
+
+  return sizeof (*this)
+    + m_adjacencies.capacity () * sizeof (Adjacency)
+    + m_adjacencyIds.size () * (sizeof (Adjacency) + sizeof (uint32_t) + node)
+    + m_nhlfes.capacity () * sizeof (Nhlfe) + labels
+    + m_nhlfeAdjacencies.capacity () * sizeof (uint32_t)
+    + m_slots.capacity () * sizeof (uint32_t);
+}
+
+} // namespace mpls
+} // namespace ns3
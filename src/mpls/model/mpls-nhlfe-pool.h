@@ -0,0 +1,114 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010-2011 Andrey Churin, Stefano Avallone
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Andrey Churin <aachurin@gmail.com>
+ *         Stefano Avallone <stavallo@gmail.com>
+ */
+
+#ifndef MPLS_NHLFE_POOL_H
+#define MPLS_NHLFE_POOL_H
+
+#include <map>
+#include <vector>
+#include <utility>
+
+#include "ns3/simple-ref-count.h"
+#include "ns3/address.h"
+
+#include "mpls-nhlfe.h"
+
+namespace ns3 {
+namespace mpls {
+
+/**
+ * \ingroup mpls
+ * \brief Per-node store of distinct NHLFEs
+ *
+ * Every distinct NHLFE is kept once, compiled, and referenced by a 32-bit id, so forwarding uses
+ * the stored NHLFE in place. Equal NHLFEs are found by a hash of the stored entries, no separate
+ * copy of the key is kept. Outgoing interface and next-hop pairs are numbered as adjacencies. Ids
+ * are stable, NHLFEs are never removed from the pool.
+ */
+class NhlfePool : public SimpleRefCount<NhlfePool>
+{
+public:
+  NhlfePool ();
+  ~NhlfePool ();
+
+  /**
+   * @brief Returns id of the NHLFE, equal NHLFEs get the same id
+   */
+  uint32_t Intern (const Nhlfe &nhlfe);
+  /**
+   * @brief Returns NHLFE with the specified id, the reference stays valid until the next Intern
+   */
+  const Nhlfe& Get (uint32_t id) const;
+  /**
+   * @brief Returns operation code of the NHLFE
+   */
+  uint32_t GetOpCode (uint32_t id) const;
+  /**
+   * @brief Returns labels count of the NHLFE
+   */
+  uint32_t GetNLabels (uint32_t id) const;
+  /**
+   * @brief Returns label of the NHLFE by index
+   */
+  uint32_t GetLabel (uint32_t id, uint32_t index) const;
+  /**
+   * @brief Returns adjacency (outgoing interface and next-hop) id of the NHLFE
+   */
+  uint32_t GetAdjacency (uint32_t id) const;
+  /**
+   * @brief Returns outgoing interface of the NHLFE
+   */
+  int32_t GetInterface (uint32_t id) const;
+  /**
+   * @brief Returns next-hop of the NHLFE
+   */
+  const Address& GetNextHop (uint32_t id) const;
+  /**
+   * @brief Returns number of distinct NHLFEs
+   */
+  uint32_t GetN (void) const;
+  /**
+   * @brief Returns number of distinct adjacencies
+   */
+  uint32_t GetNAdjacencies (void) const;
+  /**
+   * @brief Returns approximate number of bytes used by the pool
+   */
+  uint64_t GetMemoryUsage (void) const;
+
+private:
+  typedef std::pair<int32_t, Address> Adjacency;
+
+  static uint32_t Hash (uint32_t adjacency, const Nhlfe &nhlfe);
+  bool IsEqual (uint32_t id, uint32_t adjacency, const Nhlfe &nhlfe) const;
+  void Rehash (uint32_t nSlots);
+
+  std::vector<Adjacency> m_adjacencies;
+  std::map<Adjacency, uint32_t> m_adjacencyIds;
+  std::vector<Nhlfe> m_nhlfes;
+  std::vector<uint32_t> m_nhlfeAdjacencies;  // adjacency id of every NHLFE
+  std::vector<uint32_t> m_slots;             // open addressing hash table of ids + 1, 0 is free
+};
+
+} // namespace mpls
+} // namespace ns3
+
+#endif /* MPLS_NHLFE_POOL_H */
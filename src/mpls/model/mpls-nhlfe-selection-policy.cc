@@ -24,13 +24,25 @@
 #include "ns3/uinteger.h"
 #include "ns3/integer.h"
 #include "ns3/boolean.h"
+#include <algorithm>
 #include <functional>
+#include <list>
 
 #include "mpls-nhlfe-selection-policy.h"
 
 namespace ns3 {
 namespace mpls {
 
+NhlfeSelectionState::~NhlfeSelectionState ()
+{
+}
+
+uint32_t
+NhlfeSelectionState::GetMemoryUsage (void) const
+{
+  return sizeof (NhlfeSelectionState);
+}
+
 NS_OBJECT_ENSURE_REGISTERED (NhlfeSelectionPolicy);
 
 TypeId
@@ -63,20 +75,35 @@ NhlfeSelectionPolicy::~NhlfeSelectionPolicy ()
 {
 }
 
-const Nhlfe&
-NhlfeSelectionPolicy::Get (const std::vector<Nhlfe> &nhlfe, uint32_t index)
+Ptr<NhlfeSelectionPolicy>
+NhlfeSelectionPolicy::GetDefault (void)
+{
+  // not kept between calls: a later Config::SetDefault must apply, and a policy must not outlive
+  // the simulation it was created for
+  return CreateObject<NhlfeSelectionPolicy> ();
+}
+
+NhlfeSelectionState*
+NhlfeSelectionPolicy::CreateState (void) const
+{
+  return 0;
+}
+
+uint32_t
+NhlfeSelectionPolicy::Get (uint32_t size, uint32_t index, NhlfeSelectionState *state,
+                           const std::vector<uint32_t> *live) const
 {
   if (index == 0) 
     {
-        DoStart (nhlfe.size ());
+        DoStart (state, size, live);
     }
 
-  return DoGet (nhlfe, index);
+  return DoGet (size, index, state, live);
 }
 
 bool
-NhlfeSelectionPolicy::Select (const std::vector<Nhlfe> &nhlfe, uint32_t index, 
-  const Ptr<const Interface> &interface, const Ptr<const Packet> &packet)
+NhlfeSelectionPolicy::Select (uint32_t index, NhlfeSelectionState *state,
+  const Ptr<const Interface> &interface, const Ptr<const Packet> &packet) const
 {
   Ptr<Queue> queue = interface->GetDevice ()->GetQueue ();
   
@@ -92,23 +119,24 @@ NhlfeSelectionPolicy::Select (const std::vector<Nhlfe> &nhlfe, uint32_t index,
         }
     }
     
-  return DoSelect (nhlfe, index, interface, packet);
+  return DoSelect (index, state, interface, packet);
 }
 
 void
-NhlfeSelectionPolicy::DoStart (uint32_t size)
+NhlfeSelectionPolicy::DoStart (NhlfeSelectionState *state, uint32_t size, const std::vector<uint32_t> *live) const
 {
 }
 
-const Nhlfe&
-NhlfeSelectionPolicy::DoGet (const std::vector<Nhlfe> &nhlfe, uint32_t index)
+uint32_t
+NhlfeSelectionPolicy::DoGet (uint32_t size, uint32_t index, NhlfeSelectionState *state,
+                             const std::vector<uint32_t> *live) const
 {
-  return nhlfe[index];
+  return live != 0 ? (*live)[index] : index;
 }
 
 bool
-NhlfeSelectionPolicy::DoSelect (const std::vector<Nhlfe> &nhlfe, uint32_t index, 
-  const Ptr<const Interface> &interface, const Ptr<const Packet> &packet)
+NhlfeSelectionPolicy::DoSelect (uint32_t index, NhlfeSelectionState *state,
+  const Ptr<const Interface> &interface, const Ptr<const Packet> &packet) const
 {
   return true;
 }
@@ -119,6 +147,20 @@ NhlfeSelectionPolicy::Print (std::ostream &os) const
   os << "default policy";
 }
 
+void
+NhlfeSelectionPolicy::PrintState (std::ostream &os, const NhlfeSelectionState *state) const
+{
+  Print (os);
+}
+
+class RoundRobinPolicy::State : public NhlfeSelectionState
+{
+public:
+  State () : m_index (0) {}
+  uint32_t GetMemoryUsage (void) const { return sizeof (State); }
+  uint32_t m_index;
+};
+
 NS_OBJECT_ENSURE_REGISTERED (RoundRobinPolicy);
 
 TypeId
@@ -132,7 +174,6 @@ RoundRobinPolicy::GetTypeId (void)
 }
 
 RoundRobinPolicy::RoundRobinPolicy ()
-  : m_index (0)
 {
 }
 
@@ -140,17 +181,38 @@ RoundRobinPolicy::~RoundRobinPolicy ()
 {
 }
 
-const Nhlfe&
-RoundRobinPolicy::DoGet (const std::vector<Nhlfe>& nhlfe, uint32_t index)
+NhlfeSelectionState*
+RoundRobinPolicy::CreateState (void) const
+{
+  return new State;
+}
+
+uint32_t
+RoundRobinPolicy::DoGet (uint32_t size, uint32_t index, NhlfeSelectionState *state,
+                         const std::vector<uint32_t> *live) const
 {
-  index = m_index++;
+  State *s = static_cast<State*> (state);
+
+  // the position runs over the selectable NHLFEs only
+  if (live != 0)
+    {
+      size = live->size ();
+    }
+
+  // NHLFEs may have been removed since the last packet (e.g. from a shared group)
+  if (s->m_index >= size)
+    {
+      s->m_index = 0;
+    }
+
+  index = s->m_index++;
 
-  if (m_index >= nhlfe.size ())
+  if (s->m_index >= size)
     {
-      m_index = 0;
+      s->m_index = 0;
     }
 
-  return nhlfe[index];
+  return live != 0 ? (*live)[index] : index;
 }
 
 void
@@ -159,6 +221,20 @@ RoundRobinPolicy::Print (std::ostream& os) const
   os << "round robin policy";
 }
 
+class StaRoundRobinPolicy::State : public NhlfeSelectionState
+{
+public:
+  State () : m_mapping (), m_iter (m_mapping.begin ()), m_last (m_mapping.begin ()) {}
+  // list nodes keep two links besides the value
+  uint32_t GetMemoryUsage (void) const
+  {
+    return sizeof (State) + m_mapping.size () * (sizeof (uint32_t) + 2 * sizeof (void*));
+  }
+  std::list<uint32_t> m_mapping;           // NHLFE indexes, the least recently selected first
+  std::list<uint32_t>::iterator m_iter;
+  std::list<uint32_t>::iterator m_last;    // NHLFE returned by the last DoGet
+};
+
 NS_OBJECT_ENSURE_REGISTERED (StaRoundRobinPolicy);
 
 TypeId
@@ -172,55 +248,72 @@ StaRoundRobinPolicy::GetTypeId (void)
 }
 
 StaRoundRobinPolicy::StaRoundRobinPolicy ()
-  : m_mapping ()
 {
-  m_iter = m_mapping.begin ();
 }
 
 StaRoundRobinPolicy::~StaRoundRobinPolicy ()
 {
 }
 
+NhlfeSelectionState*
+StaRoundRobinPolicy::CreateState (void) const
+{
+  return new State;
+}
+
 void
-StaRoundRobinPolicy::DoStart (uint32_t size)
+StaRoundRobinPolicy::DoStart (NhlfeSelectionState *state, uint32_t size, const std::vector<uint32_t> *live) const
 {
-  if (m_mapping.size () != size)
+  State *s = static_cast<State*> (state);
+
+  if (s->m_mapping.size () != size)
     {
-      m_mapping.resize (size);
+      s->m_mapping.resize (size);
       uint32_t idx = 0;
-      for (std::list<uint32_t>::iterator i = m_mapping.begin (); i != m_mapping.end (); ++i, ++idx)
+      for (std::list<uint32_t>::iterator i = s->m_mapping.begin (); i != s->m_mapping.end (); ++i, ++idx)
         {
           *i = idx;
         }
     }
-  m_iter = m_mapping.begin ();    
+  s->m_iter = s->m_mapping.begin ();    
 }
 
-const Nhlfe&
-StaRoundRobinPolicy::DoGet (const std::vector<Nhlfe>& nhlfe, uint32_t index)
+uint32_t
+StaRoundRobinPolicy::DoGet (uint32_t size, uint32_t index, NhlfeSelectionState *state,
+                            const std::vector<uint32_t> *live) const
 {
-  index = *m_iter;
+  State *s = static_cast<State*> (state);
+
+  // NHLFEs which are not selectable are passed over, they keep their place in the order
+  while (live != 0 && !std::binary_search (live->begin (), live->end (), *s->m_iter))
+    {
+      if (++s->m_iter == s->m_mapping.end ())
+        {
+          s->m_iter = s->m_mapping.begin ();
+        }
+    }
+
+  s->m_last = s->m_iter;
+  index = *s->m_iter;
   
-  ++m_iter;
+  ++s->m_iter;
   
-  if (m_iter == m_mapping.end ())
+  if (s->m_iter == s->m_mapping.end ())
     {
-      m_iter = m_mapping.begin ();
+      s->m_iter = s->m_mapping.begin ();
     }
 
-  return nhlfe[index];
+  return index;
 }
 
 bool 
-StaRoundRobinPolicy::DoSelect (const std::vector<Nhlfe>& nhlfe, uint32_t index,
-  const Ptr<const Interface>& interface, const Ptr<const Packet>& packet)
+StaRoundRobinPolicy::DoSelect (uint32_t index, NhlfeSelectionState *state,
+  const Ptr<const Interface>& interface, const Ptr<const Packet>& packet) const
 {
-  if (m_iter != m_mapping.begin ())
-    {
-      --m_iter;
-      m_mapping.push_back (*m_iter);
-      m_mapping.erase (m_iter);
-    }
+  State *s = static_cast<State*> (state);
+
+  // the selected NHLFE becomes the most recently used one
+  s->m_mapping.splice (s->m_mapping.end (), s->m_mapping, s->m_last);
 
   return true;
 }
@@ -231,6 +324,41 @@ StaRoundRobinPolicy::Print (std::ostream& os) const
   os << "sta round robin policy";
 }
 
+namespace {
+
+// order of the weighted policy while some NHLFEs are not selectable, the required ratio of a
+// selectable NHLFE is scaled to its share of the weight of all selectable ones
+struct LiveShareOrder
+{
+  LiveShareOrder (double scale) : m_scale (scale) {}
+
+  bool operator() (const WeightedPolicy::NhlfeInfo &x, const WeightedPolicy::NhlfeInfo &y) const
+  {
+    if (x.m_selectable != y.m_selectable)
+      {
+        return x.m_selectable;
+      }
+    return x.m_requiredRatio * m_scale - x.m_currentRatio > y.m_requiredRatio * m_scale - y.m_currentRatio;
+  }
+
+  double m_scale;
+};
+
+} // anonymous namespace
+
+class WeightedPolicy::State : public NhlfeSelectionState
+{
+public:
+  State () : m_Ctot (0), m_mapping (), m_iter (m_mapping.begin ()) {}
+  uint32_t GetMemoryUsage (void) const
+  {
+    return sizeof (State) + m_mapping.size () * (sizeof (NhlfeInfo) + 2 * sizeof (void*));
+  }
+  uint32_t m_Ctot;
+  std::list<NhlfeInfo> m_mapping;
+  std::list<NhlfeInfo>::iterator m_iter;
+};
+
 NS_OBJECT_ENSURE_REGISTERED (WeightedPolicy);
 
 TypeId
@@ -259,12 +387,10 @@ WeightedPolicy::GetTypeId (void)
 }
 
 WeightedPolicy::WeightedPolicy ()
-  : m_Ctot (0),
-    m_Cmin (1000),
+  : m_Cmin (1000),
     m_Cmax (1000000),
     m_byteCounter (true),
-    m_weights (),
-    m_mapping ()
+    m_weights ()
 {
 }
 
@@ -272,51 +398,79 @@ WeightedPolicy::~WeightedPolicy ()
 {
 }
 
+NhlfeSelectionState*
+WeightedPolicy::CreateState (void) const
+{
+  return new State;
+}
+
 void
-WeightedPolicy::DoStart (uint32_t size)
+WeightedPolicy::DoStart (NhlfeSelectionState *state, uint32_t size, const std::vector<uint32_t> *live) const
 {
-  if (m_mapping.size () != size)
+  State *s = static_cast<State*> (state);
+
+  if (s->m_mapping.size () != size)
     {
-      m_mapping.resize (size);
+      s->m_mapping.resize (size);
       uint32_t idx = 0;
-      for (std::list<NhlfeInfo>::iterator i = m_mapping.begin (); i != m_mapping.end (); ++i, ++idx)
+      for (std::list<NhlfeInfo>::iterator i = s->m_mapping.begin (); i != s->m_mapping.end (); ++i, ++idx)
         {
           i->m_index = idx;
-	  i->m_currentRatio = 0.0;
-	  i->m_requiredRatio = (idx < m_weights.size () ? m_weights[idx] : 0.0);
+          i->m_currentRatio = 0.0;
+          i->m_requiredRatio = (idx < m_weights.size () ? m_weights[idx] : 0.0);
+          i->m_selectable = true;
+        }
+      s->m_mapping.sort (std::mem_fun_ref (&NhlfeInfo::DecreasingDiffOrder));
+    }
+
+  if (live != 0)
+    {
+      // selectable NHLFEs first, ranked by their share of the weight of the selectable ones
+      double liveWeight = 0.0;
+      for (std::list<NhlfeInfo>::iterator i = s->m_mapping.begin (); i != s->m_mapping.end (); ++i)
+        {
+          i->m_selectable = std::binary_search (live->begin (), live->end (), i->m_index);
+          if (i->m_selectable)
+            {
+              liveWeight += i->m_requiredRatio;
+            }
         }
-      m_mapping.sort (std::mem_fun_ref (&NhlfeInfo::DecreasingDiffOrder));
+      s->m_mapping.sort (LiveShareOrder (liveWeight > 0.0 ? 1.0 / liveWeight : 0.0));
     }
-  m_iter = m_mapping.begin ();    
+  s->m_iter = s->m_mapping.begin ();    
 }
 
-const Nhlfe&
-WeightedPolicy::DoGet (const std::vector< Nhlfe >& nhlfe, uint32_t index)
+uint32_t
+WeightedPolicy::DoGet (uint32_t size, uint32_t index, NhlfeSelectionState *state,
+                       const std::vector<uint32_t> *live) const
 {
-    return nhlfe[(m_iter++)->m_index];
+  State *s = static_cast<State*> (state);
+  return (s->m_iter++)->m_index;
 }
 
 bool 
-WeightedPolicy::DoSelect(const std::vector< Nhlfe >& nhlfe, uint32_t index,
-  const Ptr< const Interface >& interface, const Ptr< const Packet >& packet)
+WeightedPolicy::DoSelect(uint32_t index, NhlfeSelectionState *state,
+  const Ptr< const Interface >& interface, const Ptr< const Packet >& packet) const
 {
-  --m_iter;
+  State *s = static_cast<State*> (state);
+
+  --s->m_iter;
   uint32_t incr = (m_byteCounter ? packet->GetSize () : 1);
   
-  for (std::list<NhlfeInfo>::iterator i = m_mapping.begin (); i != m_mapping.end (); ++i)
+  for (std::list<NhlfeInfo>::iterator i = s->m_mapping.begin (); i != s->m_mapping.end (); ++i)
   {
-    if (i != m_iter)
-      i->m_currentRatio = (i->m_currentRatio * m_Ctot) / (m_Ctot + incr);
+    if (i != s->m_iter)
+      i->m_currentRatio = (i->m_currentRatio * s->m_Ctot) / (s->m_Ctot + incr);
     else
-      i->m_currentRatio = (i->m_currentRatio * m_Ctot + incr) / (m_Ctot + incr);
+      i->m_currentRatio = (i->m_currentRatio * s->m_Ctot + incr) / (s->m_Ctot + incr);
   }
   
-  m_Ctot += incr;
+  s->m_Ctot += incr;
 
-  if (m_Ctot > m_Cmax)
-    m_Ctot = m_Cmin;
+  if (s->m_Ctot > m_Cmax)
+    s->m_Ctot = m_Cmin;
   
-  m_mapping.sort (std::mem_fun_ref (&NhlfeInfo::DecreasingDiffOrder));
+  s->m_mapping.sort (std::mem_fun_ref (&NhlfeInfo::DecreasingDiffOrder));
   
   return true;
 }
@@ -326,7 +480,23 @@ void
 WeightedPolicy::Print (std::ostream& os) const
 {
   os << "weighted policy { ";
-  for (std::list<NhlfeInfo>::const_iterator i = m_mapping.begin (); i != m_mapping.end (); ++i)
+  for (uint32_t i = 0; i < m_weights.size (); ++i)
+    os << "(" << i << ";" << m_weights[i] << ") ";
+  os << "}";
+}
+
+void
+WeightedPolicy::PrintState (std::ostream& os, const NhlfeSelectionState *state) const
+{
+  const State *s = static_cast<const State*> (state);
+  if (s == 0 || s->m_mapping.empty ())
+    {
+      Print (os);
+      return;
+    }
+
+  os << "weighted policy { ";
+  for (std::list<NhlfeInfo>::const_iterator i = s->m_mapping.begin (); i != s->m_mapping.end (); ++i)
     os << "(" << i->m_index << ";" << i->m_requiredRatio << ";" << i->m_currentRatio << ") ";
   os << "}";
 }
@@ -337,6 +507,12 @@ WeightedPolicy::SetWeights (const std::vector<double>& weights)
   m_weights = weights;
 }
 
+const std::vector<double>&
+WeightedPolicy::GetWeights (void) const
+{
+  return m_weights;
+}
+
 bool
 WeightedPolicy::NhlfeInfo::DecreasingDiffOrder (const WeightedPolicy::NhlfeInfo& y) const
 {
@@ -35,9 +35,28 @@ namespace mpls {
 class Nhlfe;
 class Interface;
 
+/**
+ * \ingroup mpls
+ * \brief Per-entry state of a NHLFE selection policy
+ */
+class NhlfeSelectionState
+{
+public:
+  virtual ~NhlfeSelectionState ();
+  /**
+   * @brief Returns approximate number of bytes used by the state, states of derived policies
+   * should override it
+   */
+  virtual uint32_t GetMemoryUsage (void) const;
+};
+
 /**
  * \ingroup mpls
  * \brief Abstract NHLFE selection policy
+ *
+ * A policy object holds configuration only and may be shared by any number of ILMs and FTNs.
+ * Policies that need to remember something between packets (round robin position, counters)
+ * keep it in a NhlfeSelectionState created by CreateState for every entry.
  */
 class NhlfeSelectionPolicy : public Object
 {
@@ -48,28 +67,50 @@ public:
   virtual ~NhlfeSelectionPolicy ();
   
   /**
-   * @brief Returns NHLFE for specified index (called by the Iterator)
+   * @brief Returns a new default policy built from the current attribute defaults, the caller
+   * shares it among the entries it creates
    */
-  const Nhlfe& Get (const std::vector<Nhlfe> &nhlfe, uint32_t index);
+  static Ptr<NhlfeSelectionPolicy> GetDefault (void);
+  /**
+   * @brief Create per-entry state (owned by the caller)
+   * @return 0 if the policy does not need state
+   */
+  virtual NhlfeSelectionState* CreateState (void) const;
+  /**
+   * @brief Returns index of the NHLFE to be tried at the specified step (called by the Iterator)
+   * @param size Number of NHLFEs of the entry
+   * @param index Step
+   * @param state Per-entry state
+   * @param live Ascending indexes of the selectable NHLFEs or 0 if all are selectable. Policies
+   * keep their state by NHLFE index, so it survives a liveness change
+   */
+  uint32_t Get (uint32_t size, uint32_t index, NhlfeSelectionState *state,
+                const std::vector<uint32_t> *live = 0) const;
   /**
    * @brief Returns true if nhlfe can be selected
-   * @param nhlfe Nhlfe vector
-   * @param index Nhlfe index
+   * @param index Step
+   * @param state Per-entry state
    * @param iface Outgoing interface
    * @param packet Packet
    */
-  bool Select (const std::vector<Nhlfe> &nhlfe, uint32_t index, 
-                const Ptr<const Interface> &interface, const Ptr<const Packet> &packet);   
+  bool Select (uint32_t index, NhlfeSelectionState *state,
+                const Ptr<const Interface> &interface, const Ptr<const Packet> &packet) const;
   /**
    * @brief Print policy 
    */
   virtual void Print (std::ostream &os) const;
+  /**
+   * @brief Print policy together with the per-entry state (prints the policy only by default)
+   * @param state Per-entry state created by CreateState or 0
+   */
+  virtual void PrintState (std::ostream &os, const NhlfeSelectionState *state) const;
 
 protected:
-  virtual void DoStart (uint32_t size);
-  virtual const Nhlfe& DoGet (const std::vector<Nhlfe> &nhlfe, uint32_t index);
-  virtual bool DoSelect (const std::vector<Nhlfe> &nhlfe, uint32_t index, 
-                          const Ptr<const Interface> &interface, const Ptr<const Packet> &packet);   
+  virtual void DoStart (NhlfeSelectionState *state, uint32_t size, const std::vector<uint32_t> *live) const;
+  virtual uint32_t DoGet (uint32_t size, uint32_t index, NhlfeSelectionState *state,
+                          const std::vector<uint32_t> *live) const;
+  virtual bool DoSelect (uint32_t index, NhlfeSelectionState *state,
+                          const Ptr<const Interface> &interface, const Ptr<const Packet> &packet) const;
   //template <class T> Ptr<Queue> GetQueue (const Ptr<T> &device) { return device->GetQueue (); };
 private:
   int32_t m_maxPackets;
@@ -87,13 +128,15 @@ public:
   
   RoundRobinPolicy ();
   virtual ~RoundRobinPolicy ();
+  virtual NhlfeSelectionState* CreateState (void) const;
   virtual void Print (std::ostream &os) const;
 
 protected:
-  virtual const Nhlfe& DoGet (const std::vector<Nhlfe> &nhlfe, uint32_t index);
+  virtual uint32_t DoGet (uint32_t size, uint32_t index, NhlfeSelectionState *state,
+                          const std::vector<uint32_t> *live) const;
 
 private:
-  uint32_t m_index;
+  class State;
 };
 
 /**
@@ -107,23 +150,26 @@ public:
   
   StaRoundRobinPolicy ();
   virtual ~StaRoundRobinPolicy ();
+  virtual NhlfeSelectionState* CreateState (void) const;
   virtual void Print (std::ostream &os) const;
   
 protected:
-  virtual void DoStart (uint32_t size);
-  virtual const Nhlfe& DoGet (const std::vector<Nhlfe> &nhlfe, uint32_t index);
-  virtual bool DoSelect (const std::vector<Nhlfe> &nhlfe, uint32_t index, 
-      const Ptr<const Interface> &interface, const Ptr<const Packet> &packet);   
+  virtual void DoStart (NhlfeSelectionState *state, uint32_t size, const std::vector<uint32_t> *live) const;
+  virtual uint32_t DoGet (uint32_t size, uint32_t index, NhlfeSelectionState *state,
+                          const std::vector<uint32_t> *live) const;
+  virtual bool DoSelect (uint32_t index, NhlfeSelectionState *state,
+      const Ptr<const Interface> &interface, const Ptr<const Packet> &packet) const;
   
 private:
-  std::list<uint32_t> m_mapping;
-  std::list<uint32_t>::iterator m_iter;
-  
+  class State;
 };
 
 /**
  * \ingroup mpls
  * \brief NHLFE Weighted selection policy
+ *
+ * The weight of a NHLFE is taken by its index in the entry. While some NHLFEs are not selectable
+ * the traffic is split among the others in proportion to their weights.
  */
 class WeightedPolicy : public NhlfeSelectionPolicy
 {
@@ -132,9 +178,12 @@ public:
   
   WeightedPolicy ();
   virtual ~WeightedPolicy ();
+  virtual NhlfeSelectionState* CreateState (void) const;
   virtual void Print (std::ostream &os) const;
+  virtual void PrintState (std::ostream &os, const NhlfeSelectionState *state) const;
   
   void SetWeights (const std::vector<double>& weights);
+  const std::vector<double>& GetWeights (void) const;
   
   class NhlfeInfo
   {
@@ -142,25 +191,25 @@ public:
     uint32_t m_index;
     double m_currentRatio;
     double m_requiredRatio;
+    bool m_selectable;
     
     bool DecreasingDiffOrder (const NhlfeInfo& y) const;
   };
   
 protected:
-  virtual void DoStart (uint32_t size);
-  virtual const Nhlfe& DoGet (const std::vector<Nhlfe> &nhlfe, uint32_t index);
-  virtual bool DoSelect (const std::vector<Nhlfe> &nhlfe, uint32_t index, 
-     const Ptr<const Interface> &interface, const Ptr<const Packet> &packet);   
+  virtual void DoStart (NhlfeSelectionState *state, uint32_t size, const std::vector<uint32_t> *live) const;
+  virtual uint32_t DoGet (uint32_t size, uint32_t index, NhlfeSelectionState *state,
+                          const std::vector<uint32_t> *live) const;
+  virtual bool DoSelect (uint32_t index, NhlfeSelectionState *state,
+     const Ptr<const Interface> &interface, const Ptr<const Packet> &packet) const;
   
 private:
-  uint32_t m_Ctot;
+  class State;
+
   uint32_t m_Cmin;
   uint32_t m_Cmax;
   bool m_byteCounter;
   std::vector<double> m_weights;
-    
-  std::list<NhlfeInfo> m_mapping;
-  std::list<NhlfeInfo>::iterator m_iter;
 };
 
 } // namespace mpls
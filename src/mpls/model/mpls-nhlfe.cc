@@ -19,6 +19,8 @@
  *         Stefano Avallone <stavallo@gmail.com>
  */
  
+#include <algorithm>
+
 #include "ns3/assert.h"
 #include "ns3/ipv4-address.h"
 #include "mpls-nhlfe.h"
@@ -27,37 +29,143 @@ namespace ns3 {
 namespace mpls {
 
 Nhlfe::Nhlfe (const Operation& op, int32_t outInterface)
-  : m_interface (outInterface)
+  : m_interface (outInterface),
+    m_opcode (OP_POP),
+    m_pop (0),
+    m_skip (0),
+    m_count (0)
 {
   NS_ASSERT_MSG (outInterface >= 0, "Invalid outgoing interface index");
   op.Accept (*this);
+  Compile ();
 }
 
 Nhlfe::Nhlfe (const Operation& op, const Address& nextHop)
   : m_interface (-1),
-    m_nextHop (nextHop)
+    m_nextHop (nextHop),
+    m_opcode (OP_POP),
+    m_pop (0),
+    m_skip (0),
+    m_count (0)
 {
   NS_ASSERT_MSG (!nextHop.IsInvalid (), "Invalid next-hop address");
   op.Accept (*this);
+  Compile ();
 }
 
 Nhlfe::Nhlfe (const Operation& op, int32_t outInterface, const Address& nextHop)
   : m_interface (outInterface),
-    m_nextHop (nextHop)
+    m_nextHop (nextHop),
+    m_opcode (OP_POP),
+    m_pop (0),
+    m_skip (0),
+    m_count (0)
 {
   NS_ASSERT_MSG (outInterface >= 0, "Invalid outgoing interface index");
   NS_ASSERT_MSG (!nextHop.IsInvalid (), "Invalid next-hop address");
   op.Accept (*this);
+  Compile ();
 }
 
 Nhlfe::Nhlfe (const Operation& op)
-  : m_interface (-1)
+  : m_interface (-1),
+    m_opcode (OP_POP),
+    m_pop (0),
+    m_skip (0),
+    m_count (0)
 {
   op.Accept (*this);
+  Compile ();
+}
+
+Nhlfe::Nhlfe (const Nhlfe &nhlfe)
+  : m_interface (nhlfe.m_interface),
+    m_nextHop (nhlfe.m_nextHop),
+    m_opcode (nhlfe.m_opcode),
+    m_pop (nhlfe.m_pop),
+    m_skip (nhlfe.m_skip),
+    m_count (0)
+{
+  ShareLabels (nhlfe);
+}
+
+Nhlfe&
+Nhlfe::operator= (const Nhlfe &nhlfe)
+{
+  if (this != &nhlfe)
+    {
+      ReleaseLabels ();
+      m_interface = nhlfe.m_interface;
+      m_nextHop = nhlfe.m_nextHop;
+      m_opcode = nhlfe.m_opcode;
+      m_pop = nhlfe.m_pop;
+      m_skip = nhlfe.m_skip;
+      ShareLabels (nhlfe);
+    }
+  return *this;
 }
 
 Nhlfe::~Nhlfe ()
 {
+  ReleaseLabels ();
+}
+
+void
+Nhlfe::SetLabels (const uint32_t *labels, uint32_t count)
+{
+  ReleaseLabels ();
+
+  uint32_t *entries = m_labels;
+  if (count > INLINE_LABELS)
+    {
+      m_array = new LabelArray;
+      m_array->refs = 1;
+      m_array->labels.resize (count);
+      entries = &m_array->labels[0];
+    }
+
+  for (uint32_t i = 0; i < count; ++i)
+    {
+      entries[i] = shim::Get (labels[i]);
+    }
+
+  m_count = count;
+}
+
+void
+Nhlfe::Compile (void)
+{
+  // every operation replaces or removes the incoming top entry, an implicit null label is not
+  // pushed (penultimate hop popping)
+  m_pop = 1;
+  m_skip = m_count != 0 && shim::GetLabel (GetEntries ()[0]) == Label::IMPLICIT_NULL ? 1 : 0;
+}
+
+void
+Nhlfe::ShareLabels (const Nhlfe &nhlfe)
+{
+  if (nhlfe.m_count > INLINE_LABELS)
+    {
+      m_array = nhlfe.m_array;
+      ++m_array->refs;
+    }
+  else
+    {
+      std::copy (nhlfe.m_labels, nhlfe.m_labels + nhlfe.m_count, m_labels);
+    }
+
+  m_count = nhlfe.m_count;
+}
+
+void
+Nhlfe::ReleaseLabels (void)
+{
+  if (m_count > INLINE_LABELS && --m_array->refs == 0)
+    {
+      delete m_array;
+    }
+
+  m_count = 0;
 }
 
 int32_t
@@ -87,7 +195,31 @@ Nhlfe::GetNLabels (void) const
 uint32_t 
 Nhlfe::GetLabel (uint32_t index) const
 {
-  return m_labels[index];
+  return shim::GetLabel (GetEntries ()[index]);
+}
+
+uint32_t
+Nhlfe::GetNPop (void) const
+{
+  return m_pop;
+}
+
+uint32_t
+Nhlfe::GetNShims (void) const
+{
+  return m_count - m_skip;
+}
+
+const uint32_t*
+Nhlfe::GetShims (void) const
+{
+  return GetEntries () + m_skip;
+}
+
+const uint32_t*
+Nhlfe::GetEntries (void) const
+{
+  return m_count > INLINE_LABELS ? &m_array->labels[0] : m_labels;
 }
   
 void
@@ -102,7 +234,14 @@ Nhlfe::Print (std::ostream &os) const
         os << "swap";
         for (uint32_t i = 0; i < m_count; ++i)
           {
-            os << "," << Label (m_labels[i]);
+            os << "," << Label (GetLabel (i));
+          }
+        break;
+      case OP_PUSH:
+        os << "push";
+        for (uint32_t i = 0; i < m_count; ++i)
+          {
+            os << "," << Label (GetLabel (i));
           }
         break;
     }
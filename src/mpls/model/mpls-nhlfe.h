@@ -23,6 +23,7 @@
 #define MPLS_NHLFE_H
 
 #include <ostream>
+#include <vector>
 
 #include "ns3/address.h"
 
@@ -38,6 +39,13 @@ class Operation;
  * \brief A representation of the "Next Hop Label Forwarding Entry" (NHLFE)
  *
  * The "Next Hop Label Forwarding Entry" (NHLFE) is used to forward a labeled packet.
+ *
+ * The operation is compiled when the NHLFE is constructed into one rewrite of the label stack:
+ * pop GetNPop () entries (as many as the stack has), then push GetNShims () precomputed label stack
+ * entries (TC and TTL fields clear, the TTL of the top entry is set on transmission). Every
+ * operation is executed the same way: pop is pop-1/push-0, swap is pop-1/push-1, swap with
+ * several labels and push are pop-1/push-k, penultimate hop popping (swap to implicit null) is
+ * pop-1/push-0. A packet whose stack is empty after the rewrite is forwarded by ipv4.
  */
 class Nhlfe
 {
@@ -66,6 +74,8 @@ public:
    * @param nextHop next-hop
    */
   Nhlfe (const Operation& op, int32_t outInterface, const Address& nextHop);
+  Nhlfe (const Nhlfe &nhlfe);
+  Nhlfe& operator= (const Nhlfe &nhlfe);
   /**
    * @brief Destructor
    */
@@ -90,16 +100,53 @@ public:
    * @brief Return label by index
    */
   uint32_t GetLabel (uint32_t index) const;
+  /**
+   * @brief Return number of stack entries popped by the compiled operation
+   */
+  uint32_t GetNPop (void) const;
+  /**
+   * @brief Return number of stack entries pushed by the compiled operation
+   */
+  uint32_t GetNShims (void) const;
+  /**
+   * @brief Return stack entries pushed by the compiled operation, the last one becomes the top
+   */
+  const uint32_t* GetShims (void) const;
   void Print (std::ostream &os) const;
 private:
+  // stack entries of deep stacks, shared by copies of the NHLFE
+  struct LabelArray
+  {
+    uint32_t refs;
+    std::vector<uint32_t> labels;
+  };
+
+  static const uint32_t INLINE_LABELS = 6;
+
+  void SetLabels (const uint32_t *labels, uint32_t count);
+  void ShareLabels (const Nhlfe &nhlfe);
+  void ReleaseLabels (void);
+  void Compile (void);
+  const uint32_t* GetEntries (void) const;
+
   int32_t m_interface;
   Address m_nextHop;
-  uint32_t m_opcode;
+  uint8_t m_opcode;
+  // compiled operation: entries popped, leading entries not pushed (implicit null)
+  uint8_t m_pop;
+  uint8_t m_skip;
   uint32_t m_count;
-  uint32_t m_labels[6];
+  // label stack entries of the labels, up to INLINE_LABELS are kept in place, so the size of the
+  // NHLFE does not grow
+  union
+  {
+    uint32_t m_labels[INLINE_LABELS];
+    LabelArray *m_array;
+  };
   
   friend class Swap;
   friend class Pop;
+  friend class Push;
 };
 
 /**
@@ -22,6 +22,8 @@
 #define NS_LOG_APPEND_CONTEXT \
   std::clog << Simulator::Now ().GetSeconds () << " [node " << GetId () << "] ";
 
+#include <algorithm>
+
 #include "ns3/log.h"
 #include "ns3/assert.h"
 #include "ns3/callback.h"
@@ -39,6 +41,19 @@ NS_OBJECT_ENSURE_REGISTERED (MplsNode);
 
 using namespace mpls;
 
+namespace {
+
+struct LabelLess
+{
+  bool operator() (const std::pair<uint32_t, Ptr<IncomingLabelMap> > &a,
+                   const std::pair<uint32_t, Ptr<IncomingLabelMap> > &b) const
+  {
+    return a.first < b.first;
+  }
+};
+
+} // anonymous namespace
+
 TypeId
 MplsNode::GetTypeId (void)
 {
@@ -67,9 +82,15 @@ MplsNode::GetTypeId (void)
 
 MplsNode::MplsNode ()
   : m_mpls (0),
+    m_ilmIndexValid (false),
+    m_nhlfePool (Create<NhlfePool> ()),
+    m_flatLfib (Create<FlatLfib> (m_nhlfePool)),
+    m_fastReroute (Create<FastReroute> ()),
+    m_interfaceLiveness (Create<InterfaceLiveness> ()),
     m_labelSpaceType (PLATFORM)
 {
   NS_LOG_FUNCTION (this);
+  m_fastReroute->SetInterfaceLiveness (m_interfaceLiveness);
 }
 
 MplsNode::~MplsNode ()
@@ -92,6 +113,7 @@ void
 MplsNode::DoDispose (void)
 {
   m_mpls = 0;
+  m_ilmIndex.clear ();
   Object::DoDispose ();
 }
 
@@ -117,7 +139,7 @@ MplsNode::SetLabelSpaceType (LabelSpaceType type)
           uint32_t nInterfaces = m_mpls->GetNInterfaces ();
           for (uint32_t i = 0; i < nInterfaces; i++)
             {
-              NS_ASSERT_MSG (!m_mpls->GetInterface (i)->GetLabelSpace ()->IsEmpty (), 
+              NS_ASSERT_MSG (m_mpls->GetInterface (i)->GetLabelSpace ()->IsEmpty (), 
                             "Clear interface label space before change type");
             }
         }
@@ -130,6 +152,12 @@ MplsNode::SetLabelSpaceType (LabelSpaceType type)
   m_labelSpaceType = type;
 }
 
+MplsNode::LabelSpaceType
+MplsNode::GetLabelSpaceType (void) const
+{
+  return m_labelSpaceType;
+}
+
 void
 MplsNode::SetMinLabelValue (uint32_t value)
 {
@@ -146,6 +174,13 @@ MplsNode::SetMaxLabelValue (uint32_t value)
 
 MplsNode::IlmTable*
 MplsNode::GetIlmTable (void)
+{
+  m_ilmIndexValid = false;
+  return &m_ilmTable;
+}
+
+const MplsNode::IlmTable*
+MplsNode::GetIlmTable (void) const
 {
   return &m_ilmTable;
 }
@@ -156,24 +191,129 @@ MplsNode::GetFtnTable (void)
   return &m_ftnTable;
 }
 
+const Ptr<NhlfePool>&
+MplsNode::GetNhlfePool (void) const
+{
+  return m_nhlfePool;
+}
+
+void
+MplsNode::InternNhlfes (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  for (IlmTable::const_iterator i = m_ilmTable.begin (); i != m_ilmTable.end (); ++i)
+    {
+      (*i)->Intern (m_nhlfePool);
+    }
+  for (FtnTable::const_iterator i = m_ftnTable.begin (); i != m_ftnTable.end (); ++i)
+    {
+      (*i)->Intern (m_nhlfePool);
+    }
+}
+
+const Ptr<FlatLfib>&
+MplsNode::GetFlatLfib (void) const
+{
+  return m_flatLfib;
+}
+
+const Ptr<FastReroute>&
+MplsNode::GetFastReroute (void) const
+{
+  return m_fastReroute;
+}
+
+const Ptr<InterfaceLiveness>&
+MplsNode::GetInterfaceLiveness (void) const
+{
+  return m_interfaceLiveness;
+}
+
+uint32_t
+MplsNode::FlattenIlmTable (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  uint32_t count = 0;
+  IlmTable::iterator i = m_ilmTable.begin ();
+  while (i != m_ilmTable.end ())
+    {
+      // there is one slot per label, ILMs on a shared group keep referencing it, the flat table
+      // forwards to one NHLFE only, so replicating ILMs stay in the table
+      if (m_flatLfib->Contains ((*i)->GetLabel ()) || (*i)->GetNextHopGroup () != 0 ||
+          (*i)->IsReplication ())
+        {
+          ++i;
+          continue;
+        }
+      m_flatLfib->Add (*i);
+      i = m_ilmTable.erase (i);
+      ++count;
+    }
+
+  m_ilmIndexValid = false;
+  return count;
+}
+
+void
+MplsNode::AddIlm (const Ptr<IncomingLabelMap> &ilm)
+{
+  NS_LOG_FUNCTION (this << ilm);
+
+  m_ilmTable.push_back (ilm);
+  if (m_ilmIndexValid)
+    {
+      // behind the ILMs with the same label, as the table order is kept for equal labels
+      std::pair<uint32_t, Ptr<IncomingLabelMap> > entry (ilm->GetLabel (), ilm);
+      m_ilmIndex.insert (std::upper_bound (m_ilmIndex.begin (), m_ilmIndex.end (), entry, LabelLess ()),
+                         entry);
+    }
+}
+
+void
+MplsNode::RebuildIlmIndex (void)
+{
+  NS_LOG_FUNCTION (this << m_ilmTable.size ());
+
+  m_ilmIndex.clear ();
+  m_ilmIndex.reserve (m_ilmTable.size ());
+  for (IlmTable::const_iterator i = m_ilmTable.begin (); i != m_ilmTable.end (); ++i)
+    {
+      m_ilmIndex.push_back (std::make_pair ((*i)->GetLabel (), *i));
+    }
+  std::stable_sort (m_ilmIndex.begin (), m_ilmIndex.end (), LabelLess ());
+  m_ilmIndexValid = true;
+}
+
 Ptr<IncomingLabelMap>
 MplsNode::LookupIlm (Label label, int32_t interface)
 {
   NS_LOG_FUNCTION (this << label << interface);
 
-  for (IlmTable::const_iterator i = m_ilmTable.begin (); i != m_ilmTable.end (); ++i)
+  if (!m_ilmIndexValid)
+    {
+      RebuildIlmIndex ();
+    }
+
+  std::pair<IlmIndex::const_iterator, IlmIndex::const_iterator> ilms =
+    std::equal_range (m_ilmIndex.begin (), m_ilmIndex.end (),
+                      std::make_pair (uint32_t (label), Ptr<IncomingLabelMap> ()), LabelLess ());
+
+  // entries bound to the incoming interface take precedence over the platform-wide ones
+  for (IlmIndex::const_iterator i = ilms.first; i != ilms.second; ++i)
     {
-      if ((*i)->GetLabel () == label && (*i)->GetInterface () == interface)
+      if (i->second->GetInterface () == interface)
         {
-          return *i;
+          return i->second;
         }
     }
 
-  for (IlmTable::const_iterator i = m_ilmTable.begin (); i != m_ilmTable.end (); ++i)
+  for (IlmIndex::const_iterator i = ilms.first; i != ilms.second; ++i)
     {
-      if ((*i)->GetLabel () == label && (*i)->GetInterface () < 0)
+      if (i->second->GetInterface () < 0)
         {
-          return *i;
+          return i->second;
         }
     }
 
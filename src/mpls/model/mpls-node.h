@@ -23,12 +23,18 @@
 #define MPLS_NODE_H
 
 #include <ostream>
+#include <utility>
+#include <vector>
 
 #include "ns3/object.h"
 #include "ns3/ptr.h"
 #include "ns3/node.h"
 #include "mpls-incoming-label-map.h"
 #include "mpls-fec-to-nhlfe.h"
+#include "mpls-nhlfe-pool.h"
+#include "mpls-flat-lfib.h"
+#include "mpls-fast-reroute.h"
+#include "mpls-interface-liveness.h"
 #include "mpls-label-space.h"
 #include "mpls-label.h"
 #include "mpls.h"
@@ -64,9 +70,18 @@ public:
   virtual ~MplsNode ();
 
   /**
-   * @brief Get ILM table
+   * @brief Get ILM table. The table may be modified by the caller, so the ILM lookup index
+   * is rebuilt on the next lookup
    */
   IlmTable* GetIlmTable (void);
+  /**
+   * @brief Get ILM table for reading, the ILM lookup index is kept
+   */
+  const IlmTable* GetIlmTable (void) const;
+  /**
+   * @brief Append ILM to the ILM table, the ILM lookup index is updated in place
+   */
+  void AddIlm (const Ptr<IncomingLabelMap> &ilm);
   /**
    * @brief Get Ftn table
    */
@@ -75,6 +90,43 @@ public:
    * @brief Lookup ilm
    */
   Ptr<IncomingLabelMap> LookupIlm (Label label, int32_t interface);
+  /**
+   * @brief Rebuild ILM lookup index now (otherwise it is rebuilt lazily on the next lookup).
+   * Should be called if label or interface of an installed ILM has been changed
+   */
+  void RebuildIlmIndex (void);
+  /**
+   * @brief Returns pool of distinct NHLFEs of the node
+   */
+  const Ptr<NhlfePool>& GetNhlfePool (void) const;
+  /**
+   * @brief Move NHLFEs of all ILMs and FTNs to the node NHLFE pool
+   */
+  void InternNhlfes (void);
+  /**
+   * @brief Returns flat label forwarding table of the node, it is looked up before the ILM table
+   */
+  const Ptr<FlatLfib>& GetFlatLfib (void) const;
+  /**
+   * @brief Move ILMs to the flat label forwarding table. ILMs whose label is already used there
+   * and ILMs referencing a shared NHLFE group stay in the ILM table
+   *
+   * Moved ILMs are copied into the flat table and dropped from the ILM table. Helpers which keep
+   * Ptrs to the ILMs they installed (tunnel, global label, LDP and segment routing helpers) are not
+   * told: changing or removing those ILMs no longer affects forwarding. Flatten the table only
+   * once such helpers are done with the node.
+   * @return number of moved ILMs
+   */
+  uint32_t FlattenIlmTable (void);
+  /**
+   * @brief Returns backup NHLFEs of the protected adjacencies of the node
+   */
+  const Ptr<FastReroute>& GetFastReroute (void) const;
+  /**
+   * @brief Returns bitmap of interfaces whose NHLFEs can not be selected, it is kept by the
+   * interfaces of the node
+   */
+  const Ptr<InterfaceLiveness>& GetInterfaceLiveness (void) const;
   /**
    * @brief Lookup ftn
    */
@@ -87,6 +139,10 @@ public:
    * @brief Set label space type
    */
   void SetLabelSpaceType (LabelSpaceType type);
+  /**
+   * @brief Returns label space type
+   */
+  LabelSpaceType GetLabelSpaceType (void) const;
   /**
    * @brief Set minimum label value
    */
@@ -101,9 +157,18 @@ protected:
   void DoDispose (void);
 
 private:
+  // ILMs sorted by label, ILMs of one label keep the table order
+  typedef std::vector<std::pair<uint32_t, Ptr<IncomingLabelMap> > > IlmIndex;
+
   Ptr<Mpls> m_mpls;
   IlmTable m_ilmTable;
+  IlmIndex m_ilmIndex;
+  bool m_ilmIndexValid;
   FtnTable m_ftnTable;
+  Ptr<NhlfePool> m_nhlfePool;
+  Ptr<FlatLfib> m_flatLfib;
+  Ptr<FastReroute> m_fastReroute;
+  Ptr<InterfaceLiveness> m_interfaceLiveness;
   LabelSpaceType m_labelSpaceType;
   LabelSpace m_labelSpace;
   bool m_interfaceAutoInstall;
@@ -97,6 +97,21 @@ Swap::Swap (Label label1, Label label2, Label label3, Label label4,
   m_labels[5] = label6;
 }
 
+Swap::Swap (const uint32_t *labels, uint32_t count)
+  : m_count (count)
+{
+  NS_ASSERT_MSG (count > 0, "Swap::Swap (): Invalid labels count");
+  if (count > 6)
+    {
+      m_deepLabels.assign (labels, labels + count);
+      return;
+    }
+  for (uint32_t i = 0; i < count; ++i)
+    {
+      m_labels[i] = labels[i];
+    }
+}
+
 Swap::~Swap ()
 {
 }
@@ -105,11 +120,38 @@ void
 Swap::Accept (Nhlfe& nhlfe) const
 {
   nhlfe.m_opcode = OP_SWAP;
-  nhlfe.m_count = m_count;
-  for (uint32_t i = 0; i < m_count; ++i) 
-    {
-      nhlfe.m_labels[i] = m_labels[i];
-    }
+  nhlfe.SetLabels (m_count > 6 ? &m_deepLabels[0] : m_labels, m_count);
+}
+
+Push::Push (Label label1)
+  : Swap (label1)
+{
+}
+
+Push::Push (Label label1, Label label2)
+  : Swap (label1, label2)
+{
+}
+
+Push::Push (Label label1, Label label2, Label label3)
+  : Swap (label1, label2, label3)
+{
+}
+
+Push::Push (const uint32_t *labels, uint32_t count)
+  : Swap (labels, count)
+{
+}
+
+Push::~Push ()
+{
+}
+
+void
+Push::Accept (Nhlfe& nhlfe) const
+{
+  nhlfe.m_opcode = OP_PUSH;
+  nhlfe.SetLabels (m_count > 6 ? &m_deepLabels[0] : m_labels, m_count);
 }
 
 } // namespace mpls
@@ -23,6 +23,7 @@
 #define MPLS_OPERATIONS_H
 
 #include <stdint.h>
+#include <vector>
 
 #include "mpls-label.h"
 #include "mpls-nhlfe.h"
@@ -32,6 +33,7 @@ namespace mpls {
 
 const uint32_t OP_POP = 0;
 const uint32_t OP_SWAP = 1;
+const uint32_t OP_PUSH = 2;
 
 class Nhlfe;
 /**
@@ -70,12 +72,38 @@ public:
   Swap (Label label1, Label label2, Label label3, Label label4);
   Swap (Label label1, Label label2, Label label3, Label label4, Label label5);
   Swap (Label label1, Label label2, Label label3, Label label4, Label label5, Label label6);
+  /**
+   * @brief Swap with labels[0] and push the other labels, the last label becomes the top of the
+   * stack. Any number of labels is accepted (segment lists), NHLFEs keep up to 6 labels in place
+   */
+  Swap (const uint32_t *labels, uint32_t count);
   virtual ~Swap ();
   virtual void Accept (Nhlfe& nhlfe) const;
 
 protected:
   uint32_t m_count;
   uint32_t m_labels[6];
+  std::vector<uint32_t> m_deepLabels;
+};
+
+/**
+ * \ingroup mpls
+ * \brief Push operation (binding SID)
+ *
+ * Pops the incoming label (if any) and pushes the labels, the last label becomes the top of the
+ * stack. An NHLFE without outgoing interface and next-hop forwards the packet according to the
+ * new top label, looked up in the platform ILM of the same node, so a single label can stand
+ * for a stored segment list.
+ */
+class Push : public Swap
+{
+public:
+  Push (Label label1);
+  Push (Label label1, Label label2);
+  Push (Label label1, Label label2, Label label3);
+  Push (const uint32_t *labels, uint32_t count);
+  virtual ~Push ();
+  virtual void Accept (Nhlfe& nhlfe) const;
 };
 
 } // namespace mpls
@@ -58,7 +58,8 @@ MplsProtocol::GetTypeId (void)
 
 MplsProtocol::MplsProtocol ()
   : m_node (0),
-    m_ipv4 (0)
+    m_ipv4 (0),
+    m_bindingDepth (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -118,6 +119,7 @@ MplsProtocol::DoDispose (void)
     }
 
   m_interfaces.clear ();
+  m_ipv4Routes.clear ();
   m_node = 0;
   m_ipv4 = 0;
 
@@ -244,11 +246,7 @@ MplsProtocol::ReceiveMpls (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t
         m_dropTrace (p, DROP_BROADCAST_NOT_SUPPORTED, ifIndex);
         return;
 
-      case NetDevice::PACKET_MULTICAST:
-        NS_LOG_DEBUG ("Dropping received packet -- multicast");
-        m_dropTrace (p, DROP_MULTICAST_NOT_SUPPORTED, ifIndex);
-        return;
-
+      // multicast frames carry point-to-multipoint LSPs, they are looked up like unicast ones
       default:
         break;
     }
@@ -328,7 +326,26 @@ MplsProtocol::ReceiveMpls (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t
 
   NS_LOG_DEBUG ("Searching of label mapping for label " << (Label)label << 
                 " if" << ifIndex << " dev" << device->GetIfIndex ());
-  
+
+  LabelForward (packet, label, ifIndex, stack, ttl);
+}
+
+void
+MplsProtocol::LabelForward (const Ptr<Packet> &packet, uint32_t label, int32_t ifIndex, LabelStack &stack,
+    int8_t ttl)
+{
+  const Ptr<FlatLfib> &lfib = m_node->GetFlatLfib ();
+  if (lfib->GetNEntries () != 0)
+    {
+      FlatLfib::Handle handle = lfib->Lookup (label, ifIndex);
+      if (handle.IsValid ())
+        {
+          NS_LOG_DEBUG ("Found suitable entry in the flat table");
+          MplsForward (packet, lfib->GetIterator (handle, *m_node->GetInterfaceLiveness ()), stack, ttl);
+          return;
+        }
+    }
+
   Ptr<IncomingLabelMap> ilm = m_node->LookupIlm (label, ifIndex);
 
   if (ilm == 0)
@@ -350,15 +367,29 @@ MplsProtocol::MplsForward (const Ptr<Packet> &packet, const Ptr<ForwardingInform
 {
   NS_LOG_FUNCTION (this << packet << fwd << stack << (uint32_t)ttl);
 
+  if (fwd->IsReplication ())
+    {
+      ReplicateForward (packet, fwd, stack, ttl);
+      return;
+    }
+
+  NS_LOG_DEBUG ("Search of the suitable nhlfe for " << fwd);
+
+  MplsForward (packet, fwd->GetIterator (*m_node->GetInterfaceLiveness ()), stack, ttl);
+}
+
+void
+MplsProtocol::MplsForward (const Ptr<Packet> &packet, ForwardingInformation::Iterator i,
+    LabelStack &stack, int8_t ttl)
+{
   Ptr<Interface> outInterface;
   Mac48Address hwaddr;
   uint32_t stackSize = stack.GetSize ();
+  const Ptr<FastReroute> &frr = m_node->GetFastReroute ();
+  const InterfaceLiveness &liveness = *m_node->GetInterfaceLiveness ();
 
-  NS_LOG_DEBUG ("Search of the suitable nhlfe for " << fwd);
-    
   uint32_t idx = 0;
   // find first suitable nhlfe
-  ForwardingInformation::Iterator i = fwd->GetIterator ();
   while (i.HasNext ())
     {
       const Nhlfe& nhlfe = i.Get ();
@@ -372,6 +403,14 @@ MplsProtocol::MplsForward (const Ptr<Packet> &packet, const Ptr<ForwardingInform
           continue;
         }
       
+      // Binding SID, the pushed labels are resolved by this node
+      if (opCode == OP_PUSH && outIfIndex < 0 && nhlfe.GetNextHop ().IsInvalid ())
+        {
+          NS_LOG_DEBUG ("nhlfe " << idx << " " << nhlfe << " selected (*)");
+          BindingForward (packet, nhlfe, stack, ttl);
+          return;
+        }
+
       // Perform ip forwarding if stack has only one label and 
       // nhlfe operation is POP
       if (outIfIndex < 0 && stackSize == 1 && nhlfe.GetOpCode () == OP_POP)
@@ -382,58 +421,57 @@ MplsProtocol::MplsForward (const Ptr<Packet> &packet, const Ptr<ForwardingInform
           return;
         }
 
-      const Address& nextHop = nhlfe.GetNextHop ();
-      
-      if (outIfIndex >= 0)
+      if (!liveness.IsAlive (outIfIndex))
         {
-          outInterface = GetInterface (outIfIndex);
-
-          NS_ASSERT_MSG (outInterface != 0, "Invalid outgoing interface index -- " << 
-                                            "nhlfe " << idx << " " << nhlfe);
+          NS_LOG_DEBUG ("nhlfe " << idx << " " << nhlfe << " -- mpls interface is not alive");
+          continue;
+        }
 
-          if (nextHop.IsInvalid ())
-            {
-              NS_ASSERT_MSG (!outInterface->GetDevice ()->NeedsArp (), 
-                              "Invalid next-hop address -- nhlfe " << idx << " " << nhlfe);
-              hwaddr = Mac48Address::GetBroadcast (); 
-            }
-          else
+      // the next-hop of a failed adjacency may be unresolvable already, so the backup is looked up
+      // before the primary next-hop unless the outgoing interface is known from the next-hop only
+      bool resolved = false;
+      if (outIfIndex < 0)
+        {
+          if (!ResolveNextHop (nhlfe, outInterface, hwaddr))
             {
-              if (!outInterface->LookupAddress (nextHop, hwaddr))
-                {
-                  NS_LOG_WARN ("nhlfe " << idx << " " << nhlfe << " -- next-hop is unreachable");
-                  continue;
-                }
+              NS_LOG_WARN ("nhlfe " << idx << " " << nhlfe << " -- next-hop is unreachable");
+              continue;
             }
+          outIfIndex = outInterface->GetIfIndex ();
+          resolved = true;
         }
-      else 
+
+      bool bypass = false;
+      const Nhlfe *backup = frr->Lookup (outIfIndex, nhlfe, bypass);
+
+      if (backup != 0)
         {
-          outInterface = 0;
-          for (InterfaceList::iterator i = m_interfaces.begin (); i != m_interfaces.end (); ++i)
+          NS_LOG_DEBUG ("nhlfe " << idx << " " << nhlfe << " -- protected adjacency failed, backup " << *backup);
+
+          if (FastRerouteForward (packet, nhlfe, *backup, bypass, stack, ttl))
             {
-              if ((*i)->LookupAddress (nextHop, hwaddr)) 
-                {
-                  outInterface = (*i);
-                  break;
-                }
+              return;
             }
         }
-        
-      if (outInterface == 0)
+
+      // NHLFEs of a failed interface are selectable for the sake of their backups only
+      if (frr->IsFailed (outIfIndex))
         {
-          NS_LOG_WARN ("nhlfe " << idx << " " << nhlfe << " -- next-hop is unavailable");
+          NS_LOG_DEBUG ("nhlfe " << idx << " " << nhlfe << " -- link is down and there is no usable backup");
           continue;
         }
-      
+
+      if (!resolved && !ResolveNextHop (nhlfe, outInterface, hwaddr))
+        {
+          NS_LOG_WARN ("nhlfe " << idx << " " << nhlfe << " -- next-hop is unreachable");
+          continue;
+        }
+
       if (!outInterface->IsUp ())
         {
           NS_LOG_DEBUG ("nhlfe " << idx << " " << nhlfe << " -- mpls interface disabled");
         }
-      // XXX: never happens
-      // else if (!outInterface->GetDevice ()->IsLinkUp ()) 
-      //  {
-      //    NS_LOG_DEBUG ("nhlfe " << idx << " " << nhlfe << " -- link down");
-      //  }
+      // link down is reported by the interface to the liveness bitmap
       else if (!i.Select(outInterface, packet)) 
         {
           NS_LOG_DEBUG ("nhlfe " << idx << " " << nhlfe << " -- omitted by the policy");
@@ -444,7 +482,7 @@ MplsProtocol::MplsForward (const Ptr<Packet> &packet, const Ptr<ForwardingInform
 
           if (!RealMplsForward (packet, nhlfe, stack, ttl, outInterface, hwaddr))
             {
-              IpForward (packet, ttl, outInterface->GetDevice ());
+              IpForward (packet, ttl, outInterface, nhlfe.GetNextHop (), hwaddr);
             }
             
           return;
@@ -458,43 +496,247 @@ MplsProtocol::MplsForward (const Ptr<Packet> &packet, const Ptr<ForwardingInform
   m_dropTrace (packet, DROP_NO_SUITABLE_NHLFE, -1); 
 }
 
+void
+MplsProtocol::ReplicateForward (const Ptr<Packet> &packet, const Ptr<ForwardingInformation> &fwd,
+    const LabelStack &stack, int8_t ttl)
+{
+  NS_LOG_FUNCTION (this << packet << fwd << stack << (uint32_t)ttl);
+
+  uint32_t stackSize = stack.GetSize ();
+  const Ptr<FastReroute> &frr = m_node->GetFastReroute ();
+  uint32_t nBranches = 0;
+  uint32_t idx = 0;
+
+  for (ForwardingInformation::Iterator i = fwd->GetIterator (*m_node->GetInterfaceLiveness ()); i.HasNext (); ++idx)
+    {
+      const Nhlfe& nhlfe = i.Get ();
+
+      uint32_t opCode = nhlfe.GetOpCode ();
+      int32_t outIfIndex = nhlfe.GetInterface ();
+
+      if (stackSize == 0 && opCode == OP_POP)
+        {
+          NS_LOG_WARN ("nhlfe " << idx << " " << nhlfe << " -- invalid nhlfe");
+          continue;
+        }
+
+      // Packet::Copy shares the payload buffer, every branch differs in its label stack only
+      Ptr<Packet> replica = packet->Copy ();
+      LabelStack branch (stack);
+
+      if (opCode == OP_PUSH && outIfIndex < 0 && nhlfe.GetNextHop ().IsInvalid ())
+        {
+          NS_LOG_DEBUG ("nhlfe " << idx << " " << nhlfe << " -- binding branch");
+          BindingForward (replica, nhlfe, branch, ttl);
+          ++nBranches;
+          continue;
+        }
+
+      // the node is a leaf of the tree as well (bud node)
+      if (outIfIndex < 0 && stackSize == 1 && opCode == OP_POP)
+        {
+          NS_LOG_DEBUG ("nhlfe " << idx << " " << nhlfe << " -- local branch");
+          IpForward (replica, ttl, 0);
+          ++nBranches;
+          continue;
+        }
+
+      // the backup is looked up before the primary next-hop is resolved, as in MplsForward
+      Ptr<Interface> outInterface;
+      Mac48Address hwaddr;
+      bool resolved = false;
+      if (outIfIndex < 0)
+        {
+          if (!ResolveNextHop (nhlfe, outInterface, hwaddr))
+            {
+              NS_LOG_WARN ("nhlfe " << idx << " " << nhlfe << " -- next-hop is unreachable");
+              continue;
+            }
+          outIfIndex = outInterface->GetIfIndex ();
+          resolved = true;
+        }
+
+      bool bypass = false;
+      const Nhlfe *backup = frr->Lookup (outIfIndex, nhlfe, bypass);
+
+      if (backup != 0 && FastRerouteForward (replica, nhlfe, *backup, bypass, branch, ttl))
+        {
+          ++nBranches;
+          continue;
+        }
+
+      if (frr->IsFailed (outIfIndex))
+        {
+          NS_LOG_DEBUG ("nhlfe " << idx << " " << nhlfe << " -- link is down and there is no usable backup");
+          continue;
+        }
+
+      if (!resolved && !ResolveNextHop (nhlfe, outInterface, hwaddr))
+        {
+          NS_LOG_WARN ("nhlfe " << idx << " " << nhlfe << " -- next-hop is unreachable");
+          continue;
+        }
+
+      if (!outInterface->IsUp ())
+        {
+          NS_LOG_DEBUG ("nhlfe " << idx << " " << nhlfe << " -- mpls interface disabled");
+          continue;
+        }
+
+      NS_LOG_DEBUG ("nhlfe " << idx << " " << nhlfe << " -- branch");
+
+      if (!RealMplsForward (replica, nhlfe, branch, ttl, outInterface, hwaddr))
+        {
+          IpForward (replica, ttl, outInterface, nhlfe.GetNextHop (), hwaddr);
+        }
+      ++nBranches;
+    }
+
+  if (nBranches == 0)
+    {
+      NS_LOG_DEBUG ("Dropping received packet -- there is no suitable nhlfe");
+      m_dropTrace (packet, DROP_NO_SUITABLE_NHLFE, -1);
+    }
+}
+
+bool
+MplsProtocol::ResolveNextHop (const Nhlfe &nhlfe, Ptr<Interface> &outInterface, Mac48Address &hwaddr)
+{
+  int32_t outIfIndex = nhlfe.GetInterface ();
+  const Address& nextHop = nhlfe.GetNextHop ();
+
+  if (outIfIndex >= 0)
+    {
+      outInterface = GetInterface (outIfIndex);
+
+      NS_ASSERT_MSG (outInterface != 0, "Invalid outgoing interface index -- nhlfe " << nhlfe);
+
+      if (nextHop.IsInvalid ())
+        {
+          NS_ASSERT_MSG (!outInterface->GetDevice ()->NeedsArp (), "Invalid next-hop address -- nhlfe " << nhlfe);
+          hwaddr = Mac48Address::GetBroadcast ();
+          return true;
+        }
+
+      return outInterface->LookupAddress (nextHop, hwaddr);
+    }
+
+  for (InterfaceList::iterator i = m_interfaces.begin (); i != m_interfaces.end (); ++i)
+    {
+      if ((*i)->LookupAddress (nextHop, hwaddr))
+        {
+          outInterface = (*i);
+          return true;
+        }
+    }
+
+  outInterface = 0;
+  return false;
+}
+
+void
+MplsProtocol::BindingForward (const Ptr<Packet> &packet, const Nhlfe &nhlfe, LabelStack &stack, int8_t ttl)
+{
+  NS_LOG_FUNCTION (this << packet << nhlfe << stack << (uint32_t)ttl);
+
+  // binding SIDs may refer to each other, a misconfigured chain must not recurse forever
+  if (m_bindingDepth == MAX_BINDING_DEPTH)
+    {
+      NS_LOG_WARN ("Dropping received packet -- too many nested binding SIDs");
+      m_dropTrace (packet, DROP_BINDING_LOOP, -1);
+      return;
+    }
+
+  stack.Rewrite (nhlfe.GetNPop (), nhlfe.GetShims (), nhlfe.GetNShims ());
+
+  // a push of implicit null only pushes nothing, there is no label left to resolve
+  if (stack.IsEmpty ())
+    {
+      NS_LOG_WARN ("Dropping received packet -- empty label stack after binding SID");
+      m_dropTrace (packet, DROP_EMPTY_STACK, -1);
+      return;
+    }
+
+  uint32_t label = shim::GetLabel (stack.Peek ());
+  NS_LOG_DEBUG ("Binding SID expanded, searching of label mapping for label " << Label (label));
+
+  ++m_bindingDepth;
+  LabelForward (packet, label, -1, stack, ttl);
+  --m_bindingDepth;
+}
+
+bool
+MplsProtocol::FastRerouteForward (const Ptr<Packet> &packet, const Nhlfe &primary, const Nhlfe &backup,
+    bool bypass, LabelStack &stack, int8_t ttl)
+{
+  NS_LOG_FUNCTION (this << packet << primary << backup << bypass << stack << (uint32_t)ttl);
+
+  Ptr<Interface> outInterface = GetInterface (backup.GetInterface ());
+  Mac48Address hwaddr;
+
+  if (outInterface == 0 || !outInterface->IsUp ())
+    {
+      NS_LOG_WARN ("backup " << backup << " -- mpls interface disabled");
+      return false;
+    }
+
+  const Address& nextHop = backup.GetNextHop ();
+
+  if (nextHop.IsInvalid ())
+    {
+      NS_ASSERT_MSG (!outInterface->GetDevice ()->NeedsArp (), "Invalid next-hop address -- backup " << backup);
+      hwaddr = Mac48Address::GetBroadcast ();
+    }
+  else if (!outInterface->LookupAddress (nextHop, hwaddr))
+    {
+      NS_LOG_WARN ("backup " << backup << " -- next-hop is unreachable");
+      return false;
+    }
+
+  // a detour replaces the primary NHLFE, a bypass tunnel is pushed on top of its result
+  const Nhlfe &nhlfe = bypass ? primary : backup;
+
+  if (!RealMplsForward (packet, nhlfe, stack, ttl, outInterface, hwaddr, bypass ? &backup : 0))
+    {
+      IpForward (packet, ttl, outInterface, nextHop, hwaddr);
+    }
+
+  return true;
+}
+
 bool
 MplsProtocol::RealMplsForward (const Ptr<Packet> &packet, const Nhlfe &nhlfe, LabelStack &stack, 
-    int8_t ttl, const Ptr<Interface> &outInterface, const Mac48Address& hwaddr)
+    int8_t ttl, const Ptr<Interface> &outInterface, const Mac48Address& hwaddr, const Nhlfe *bypass)
 {
   NS_LOG_FUNCTION (this << packet << nhlfe << stack << (uint32_t)ttl << outInterface << hwaddr);
 
-  switch (nhlfe.GetOpCode ())
+  // the operation was compiled into one rewrite of the stack when the NHLFE was constructed
+  stack.Rewrite (nhlfe.GetNPop (), nhlfe.GetShims (), nhlfe.GetNShims ());
+
+  // labels below a popped one (and a bypass tunnel, whose merge point expects the packet without
+  // this label) are still label switched
+  if (stack.IsEmpty () && bypass == 0)
     {
-      case OP_POP:
-        NS_ASSERT_MSG (!stack.IsEmpty (), "POP operation on the empty stack");
-        stack.Pop ();
-        break;
+      NS_LOG_DEBUG ("Stack is empty -- ipv4 based forwarding must be used");
+      return false;
+    }
 
-      case OP_SWAP:
-        for (uint32_t i = 0, c = nhlfe.GetNLabels (); i < c; ++i)
-          {
-            Label label = nhlfe.GetLabel (i);
-            if (label == Label::IMPLICIT_NULL)
-              {
-                // Penultimate Hop Popping
-                NS_LOG_DEBUG ("Pop the stack, implicit_null label was encountered -- "
-                              "ipv4 based forwarding must be used");
-                return false;
-              }
-            if (i)
-              {
-                stack.Push (shim::Get (label));
-              }
-            else  
-              {
-                stack.Swap (shim::Get (label));
-              }
-          }
-        break;
+  if (bypass != 0)
+    {
+      if (!stack.IsEmpty ())
+        {
+          shim::SetTtl (stack.Peek (), ttl);
+        }
 
-      default:
-        NS_ASSERT_MSG (0, "Invalid operation code");
+      stack.Rewrite (0, bypass->GetShims (), bypass->GetNShims ());
+
+      if (stack.IsEmpty ())
+        {
+          NS_LOG_DEBUG ("Stack is empty -- ipv4 based forwarding must be used on the bypass");
+          return false;
+        }
+
+      NS_LOG_DEBUG ("Bypass tunnel " << *bypass << " pushed");
     }
 
   // TODO:
@@ -547,7 +789,8 @@ MplsProtocol::IpForward (const Ptr<Packet> &packet, uint8_t ttl, Ptr<NetDevice>
   header.SetTtl (ttl);
 
   Socket::SocketErrno sockerr;
-  Ptr<Ipv4RoutingProtocol> routing = m_ipv4->GetRoutingProtocol ();
+  // the mpls routing hook keeps the route cache of the underlying routing protocol
+  Ptr<Ipv4RoutingProtocol> routing = m_ipv4->GetMplsRouting ();
       
   NS_ASSERT_MSG (routing != 0, "Need a ipv4 routing protocol object");
 
@@ -618,5 +861,69 @@ IpProbe::Print (std::ostream& os) const
 {
 }
 
+void
+MplsProtocol::IpForward (const Ptr<Packet> &packet, uint8_t ttl, const Ptr<Interface> &outInterface,
+    const Address &nextHop, const Mac48Address &hwaddr)
+{
+  NS_LOG_FUNCTION (this << packet << (uint32_t)ttl << outInterface << hwaddr);
+
+  Ptr<NetDevice> device = outInterface->GetDevice ();
+  int32_t ipv4if = outInterface->LookupIpv4Interface ();
+
+  if (m_ipv4 == 0 || ipv4if < 0 || !m_ipv4->IsUp (ipv4if) || m_ipv4->GetNAddresses (ipv4if) == 0)
+    {
+      IpForward (packet, ttl, device);
+      return;
+    }
+
+  Ipv4Header header;
+  packet->RemoveHeader (header);
+  header.SetTtl (ttl);
+
+  // the packet leaves the LSP towards the next-hop of the NHLFE, which is already resolved
+  if (packet->GetSize () + header.GetSerializedSize () > device->GetMtu ())
+    {
+      NS_LOG_DEBUG ("Packet is too big -- ipv4 fragments it on the adjacency route");
+      m_ipv4->SendWithHeader (packet, header, GetIpv4Route (outInterface, ipv4if, nextHop));
+      return;
+    }
+
+  if (Node::ChecksumEnabled ())
+    {
+      header.EnableChecksum ();
+    }
+  packet->AddHeader (header);
+
+  NS_LOG_DEBUG ("Sending ipv4 packet via if" << outInterface->GetIfIndex () << " dev" << device->GetIfIndex () <<
+                " hwaddr " << hwaddr);
+
+  device->Send (packet, hwaddr, Ipv4L3Protocol::PROT_NUMBER);
+}
+
+Ptr<Ipv4Route>
+MplsProtocol::GetIpv4Route (const Ptr<Interface> &outInterface, int32_t ipv4if, const Address &nextHop)
+{
+  Ipv4Address gateway = Ipv4Address::IsMatchingType (nextHop) ? Ipv4Address::ConvertFrom (nextHop) :
+                                                                Ipv4Address::GetZero ();
+  Ipv4Address source = m_ipv4->GetAddress (ipv4if, 0).GetLocal ();
+  uint32_t ifIndex = outInterface->GetIfIndex ();
+  if (ifIndex >= m_ipv4Routes.size ())
+    {
+      m_ipv4Routes.resize (ifIndex + 1);
+    }
+
+  // one route per interface, its destination is not used by ipv4 when sending
+  Ptr<Ipv4Route> &route = m_ipv4Routes[ifIndex];
+  if (route == 0 || route->GetGateway () != gateway || route->GetSource () != source)
+    {
+      route = Create<Ipv4Route> ();
+      route->SetGateway (gateway);
+      route->SetOutputDevice (outInterface->GetDevice ());
+      route->SetSource (source);
+    }
+
+  return route;
+}
+
 } // namespace mpls
 } // namespace ns3
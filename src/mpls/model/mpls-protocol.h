@@ -112,15 +112,45 @@ protected:
 private:
   typedef std::vector<Ptr<Interface> > InterfaceList;
 
+  static const uint32_t MAX_BINDING_DEPTH = 8;
+
+  void LabelForward (const Ptr<Packet> &packet, uint32_t label, int32_t ifIndex, LabelStack &stack, int8_t ttl);
   void MplsForward (const Ptr<Packet> &packet, const Ptr<ForwardingInformation> &fwd, LabelStack &stack, int8_t ttl);
+  void MplsForward (const Ptr<Packet> &packet, ForwardingInformation::Iterator i, LabelStack &stack, int8_t ttl);
+  /**
+   * Point-to-multipoint branch point: forwards a copy of the packet to every NHLFE of the entry
+   */
+  void ReplicateForward (const Ptr<Packet> &packet, const Ptr<ForwardingInformation> &fwd,
+                         const LabelStack &stack, int8_t ttl);
+  void BindingForward (const Ptr<Packet> &packet, const Nhlfe &nhlfe, LabelStack &stack, int8_t ttl);
+  bool FastRerouteForward (const Ptr<Packet> &packet, const Nhlfe &primary, const Nhlfe &backup, bool bypass,
+                           LabelStack &stack, int8_t ttl);
   bool RealMplsForward (const Ptr<Packet> &packet, const Nhlfe &nhlfe, LabelStack &stack, int8_t ttl,
-                          const Ptr<Interface> &outInterface, const Mac48Address &hwaddr);
+                          const Ptr<Interface> &outInterface, const Mac48Address &hwaddr, const Nhlfe *bypass = 0);
+  /**
+   * Finds outgoing interface and hardware address of the NHLFE next-hop, false if it is unreachable
+   */
+  bool ResolveNextHop (const Nhlfe &nhlfe, Ptr<Interface> &outInterface, Mac48Address &hwaddr);
   void IpForward (const Ptr<Packet> &packet, uint8_t ttl, Ptr<NetDevice> outDev);
+  /**
+   * Penultimate hop popping: sends the ipv4 packet to the already resolved next-hop of the NHLFE,
+   * falls back to the ipv4 routing lookup if ipv4 is not enabled on the interface. The packet is
+   * handed to the device directly unless it has to be fragmented, so the Tx and UnicastForward
+   * traces of ipv4 (and the Tx trace of mpls) are not fired for it
+   */
+  void IpForward (const Ptr<Packet> &packet, uint8_t ttl, const Ptr<Interface> &outInterface,
+                  const Address &nextHop, const Mac48Address &hwaddr);
+  Ptr<Ipv4Route> GetIpv4Route (const Ptr<Interface> &outInterface, int32_t ipv4if, const Address &nextHop);
 
   Ptr<MplsNode> m_node;
   Ptr<mpls::Ipv4Protocol> m_ipv4;
   InterfaceList m_interfaces;
   bool m_interfaceAutoInstall;
+  // routes to the next-hops of PHP NHLFEs by interface, used when ipv4 has to fragment (rebuilt
+  // when the next-hop or the interface address changes)
+  std::vector<Ptr<Ipv4Route> > m_ipv4Routes;
+  // nesting of binding SIDs resolved for the current packet
+  uint32_t m_bindingDepth;
 
   PacketDemux m_demux;
   
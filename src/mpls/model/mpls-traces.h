@@ -48,13 +48,14 @@ enum DropReason
     DROP_NO_SUITABLE_NHLFE,          /**< An NHLFE suitable to process the packet has not been found */
     DROP_EMPTY_STACK,                /**< Empty label stack */
     DROP_BROADCAST_NOT_SUPPORTED,    /**< Received a broadcast packet */
-    DROP_MULTICAST_NOT_SUPPORTED,    /**< Received a multicast packet */
+    DROP_MULTICAST_NOT_SUPPORTED,    /**< Unused, multicast packets carry point-to-multipoint LSPs */
     DROP_IPV6_NOT_SUPPORTED,         /**< Received an IPv6 packet */
     DROP_ILLEGAL_IPV4_EXPLICIT_NULL, /**< IPv4 Explicit Null label not at the bottom of the stack */
     DROP_ILLEGAL_IPV6_EXPLICIT_NULL, /**< IPv6 Explicit Null label not at the bottom of the stack */
     DROP_NO_IPV4,                    /**< IPv4 is not installed on the node */
     DROP_INTERFACE_DOWN,             /**< Interface is down so can not send packet */
     DROP_SEND_FAILED,                /**< Sending the packet through the identified interface failed */
+    DROP_BINDING_LOOP,               /**< Binding SIDs are nested too deep (a loop of binding SIDs) */
   };
 
 
@@ -19,17 +19,172 @@
  *         Stefano Avallone <stavallo@gmail.com>
  */
 
+#include <sstream>
+
 #include "ns3/simulator.h"
 #include "ns3/test.h"
 #include "ns3/log.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/address.h"
+#include "ns3/uinteger.h"
+#include "ns3/integer.h"
+#include "ns3/config.h"
+
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4.h"
+#include "ns3/arp-l3-protocol.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/ipv4-interface-address.h"
+#include "ns3/udp-l4-protocol.h"
+#include "ns3/tcp-l4-protocol.h"
 
+#include "ns3/mpls.h"
 #include "ns3/mpls-nhlfe.h"
+#include "ns3/mpls-node.h"
+#include "ns3/mpls-ipv4-protocol.h"
+#include "ns3/mpls-ipv4-routing.h"
+#include "ns3/mpls-network-configurator.h"
+#include "ns3/mpls-global-label-helper.h"
+#include "ns3/mpls-cspf-helper.h"
+#include "ns3/mpls-ti-lfa-helper.h"
+#include "ns3/mpls-segment-routing-helper.h"
+#include "ns3/mpls-lfib-snapshot.h"
+#include "ns3/mpls-config-loader.h"
+#include "ns3/mpls-switch.h"
+#include "ns3/mpls-nhlfe-selection-policy.h"
+#include "ns3/mpls-protocol.h"
+#include "ns3/mpls-traces.h"
+#include "ns3/mpls-fast-reroute.h"
 
 namespace ns3 {
 namespace mpls {
 
+/**
+ * Creates mpls nodes connected by point-to-point simple channels and discovers the network,
+ * link i connects nodes links[i][0] and links[i][1] and gets the 10.0.i.0/24 subnet
+ */
+static NodeContainer
+CreateNetwork (MplsNetworkConfigurator &network, uint32_t nNodes, const uint32_t links[][2], uint32_t nLinks)
+{
+  NodeContainer nodes = network.CreateAndInstall (nNodes);
+  Ipv4AddressHelper address;
+
+  for (uint32_t i = 0; i < nLinks; ++i)
+    {
+      Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+      NetDeviceContainer devices;
+      for (uint32_t j = 0; j < 2; ++j)
+        {
+          Ptr<SimpleNetDevice> dev = CreateObject<SimpleNetDevice> ();
+          dev->SetAddress (Mac48Address::Allocate ());
+          dev->SetChannel (channel);
+          nodes.Get (links[i][j])->AddDevice (dev);
+          devices.Add (dev);
+        }
+      address.SetBase (Ipv4Address (0x0a000000 | (i << 8)), Ipv4Mask ("255.255.255.0"));
+      address.Assign (devices);
+    }
+
+  network.DiscoverNetwork ();
+  return nodes;
+}
+
+/**
+ * Returns mpls interface of the node device
+ */
+static Ptr<Interface>
+GetMplsInterface (Ptr<Node> node, uint32_t device)
+{
+  return node->GetObject<Mpls> ()->GetInterfaceForDevice (node->GetDevice (device));
+}
+
+/**
+ * Returns ILM of the node bound to the label or 0
+ */
+static Ptr<IncomingLabelMap>
+FindIlm (Ptr<Node> node, uint32_t label)
+{
+  MplsNode::IlmTable *ilms = DynamicCast<MplsNode> (node)->GetIlmTable ();
+  for (MplsNode::IlmTable::const_iterator i = ilms->begin (); i != ilms->end (); ++i)
+    {
+      if ((*i)->GetLabel () == label)
+        {
+          return *i;
+        }
+    }
+  return 0;
+}
+
+/**
+ * Delivers a labeled packet to the mpls protocol of the node as if it was received by the device,
+ * labels are listed from the top of the stack (the payload is 100 bytes of zeros by default)
+ */
+static void
+ReceiveLabeled (Ptr<Node> node, uint32_t device, const uint32_t *labels, uint32_t count, Ptr<Packet> packet = 0)
+{
+  LabelStack stack;
+  for (uint32_t i = count; i > 0; --i)
+    {
+      stack.Push (shim::SetTtl2 (shim::Get (labels[i - 1]), 64));
+    }
+
+  if (packet == 0)
+    {
+      packet = Create<Packet> (100);
+    }
+  packet->AddHeader (stack);
+
+  Ptr<NetDevice> dev = node->GetDevice (device);
+  DynamicCast<MplsProtocol> (node->GetObject<Mpls> ())->ReceiveMpls (dev, packet, Mpls::PROT_NUMBER,
+    Mac48Address ("00:00:00:00:00:01"), dev->GetAddress (), NetDevice::PACKET_HOST);
+}
+
+/**
+ * Records labeled packets sent and dropped by the mpls protocol of a node
+ */
+class TxRecorder
+{
+public:
+  TxRecorder (Ptr<Node> node)
+    : m_nDrops (0)
+  {
+    Ptr<Object> mpls = node->GetObject<Mpls> ();
+    mpls->TraceConnectWithoutContext ("Tx", MakeCallback (&TxRecorder::Tx, this));
+    mpls->TraceConnectWithoutContext ("Drop", MakeCallback (&TxRecorder::Drop, this));
+  }
+
+  void Tx (const Ptr<const Packet> &packet, int32_t ifIndex)
+  {
+    LabelStack stack;
+    packet->Copy ()->RemoveHeader (stack);
+    m_interfaces.push_back (ifIndex);
+    m_labels.push_back (shim::GetLabel (stack.Peek ()));
+    m_sizes.push_back (stack.GetSize ());
+  }
+
+  void Drop (const Ptr<const Packet> &packet, traces::DropReason reason, int32_t ifIndex)
+  {
+    ++m_nDrops;
+  }
+
+  void Clear (void)
+  {
+    m_interfaces.clear ();
+    m_labels.clear ();
+    m_sizes.clear ();
+    m_nDrops = 0;
+  }
+
+  std::vector<int32_t> m_interfaces;  //!< outgoing interface of every sent packet
+  std::vector<uint32_t> m_labels;     //!< top label of every sent packet
+  std::vector<uint32_t> m_sizes;      //!< label stack size of every sent packet
+  uint32_t m_nDrops;                  //!< number of dropped packets
+};
+
 class NhlfeTestCase : public TestCase
 {
 public:
@@ -65,6 +220,1878 @@ NhlfeTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (nhlfe.GetInterface (), 0, "Invalid outgoing interface??");
 }
 
+class GlobalLabelTestCase : public TestCase
+{
+public:
+  /**
+   * @brief Constructor.
+   */
+  GlobalLabelTestCase ();
+  /**
+   * @brief Destructor.
+   */
+  virtual ~GlobalLabelTestCase ();
+  /**
+   * @brief Run unit tests for this class.
+   */
+  virtual void DoRun (void);
+
+};
+
+GlobalLabelTestCase::GlobalLabelTestCase () :
+  TestCase ("Verify LSPs installed by MplsGlobalLabelHelper")
+{
+}
+
+GlobalLabelTestCase::~GlobalLabelTestCase ()
+{
+}
+
+void
+GlobalLabelTestCase::DoRun (void)
+{
+  // 0 - 1 - 2
+  const uint32_t links[][2] = { { 0, 1 }, { 1, 2 } };
+  MplsNetworkConfigurator network;
+  NodeContainer nodes = CreateNetwork (network, 3, links, 2);
+
+  MplsGlobalLabelHelper helper;
+  helper.PopulateLabelTables (network);
+
+  // one ILM per (node, egress) pair, FTNs only where the next-hop is not the egress itself
+  NS_TEST_ASSERT_MSG_EQ (helper.GetNIlm (), 6, "Invalid number of ILM entries");
+  NS_TEST_ASSERT_MSG_EQ (helper.GetNFtn (), 2, "Invalid number of FTN entries");
+
+  Label label0 (0);
+  Label label1 (0);
+  Label label2 (0);
+  NS_TEST_ASSERT_MSG_EQ (helper.GetLabel (nodes.Get (0), nodes.Get (2), label0), true, "No LSP from 0 to 2");
+  NS_TEST_ASSERT_MSG_EQ (helper.GetLabel (nodes.Get (1), nodes.Get (2), label1), true, "No LSP from 1 to 2");
+  NS_TEST_ASSERT_MSG_EQ (helper.GetLabel (nodes.Get (2), nodes.Get (2), label2), false, "The egress has no ILM");
+
+  Ptr<IncomingLabelMap> ilm = FindIlm (nodes.Get (0), label0);
+  NS_TEST_ASSERT_MSG_NE (ilm, 0, "ILM of the LSP is not installed");
+  NS_TEST_ASSERT_MSG_EQ (ilm->GetNhlfe (0).GetLabel (0), uint32_t (label1), "Label of the next hop is not used");
+
+  ilm = FindIlm (nodes.Get (1), label1);
+  NS_TEST_ASSERT_MSG_NE (ilm, 0, "ILM of the LSP is not installed");
+  NS_TEST_ASSERT_MSG_EQ (ilm->GetNhlfe (0).GetLabel (0), Label::IMPLICIT_NULL, "Penultimate hop should pop");
+
+  helper.ClearLabelTables ();
+  NS_TEST_ASSERT_MSG_EQ (helper.GetNIlm (), 0, "ILM entries are not removed");
+  NS_TEST_ASSERT_MSG_EQ (DynamicCast<MplsNode> (nodes.Get (0))->GetIlmTable ()->size (), 0, "ILM table is not empty");
+
+  Simulator::Destroy ();
+}
+
+class GlobalLabelRepairTestCase : public TestCase
+{
+public:
+  /**
+   * @brief Constructor.
+   */
+  GlobalLabelRepairTestCase ();
+  /**
+   * @brief Destructor.
+   */
+  virtual ~GlobalLabelRepairTestCase ();
+  /**
+   * @brief Run unit tests for this class.
+   */
+  virtual void DoRun (void);
+
+};
+
+GlobalLabelRepairTestCase::GlobalLabelRepairTestCase () :
+  TestCase ("Verify incremental repair of centrally installed LSPs")
+{
+}
+
+GlobalLabelRepairTestCase::~GlobalLabelRepairTestCase ()
+{
+}
+
+void
+GlobalLabelRepairTestCase::DoRun (void)
+{
+  // ring 0 - 1 - 2 - 3 - 0, device 1 of node 0 is on the link to 1, device 2 on the link to 3
+  const uint32_t links[][2] = { { 0, 1 }, { 1, 2 }, { 2, 3 }, { 3, 0 } };
+  MplsNetworkConfigurator network;
+  NodeContainer nodes = CreateNetwork (network, 4, links, 4);
+
+  MplsGlobalLabelHelper helper;
+  helper.PopulateLabelTables (network);
+  uint32_t nEntries = helper.GetNIlm () + helper.GetNFtn ();
+
+  Label label (0);
+  NS_TEST_ASSERT_MSG_EQ (helper.GetLabel (nodes.Get (0), nodes.Get (1), label), true, "No LSP from 0 to 1");
+  Ptr<IncomingLabelMap> ilm = FindIlm (nodes.Get (0), label);
+  NS_TEST_ASSERT_MSG_EQ (ilm->GetNhlfe (0).GetInterface (), int32_t (GetMplsInterface (nodes.Get (0), 1)->GetIfIndex ()),
+                         "The LSP should take the direct link");
+
+  helper.NotifyLinkDown (GetMplsInterface (nodes.Get (0), 1));
+
+  NS_TEST_ASSERT_MSG_GT (helper.GetNChangedEntries (), 0, "No entry has been repaired");
+  NS_TEST_ASSERT_MSG_LT (helper.GetNChangedEntries (), nEntries, "Unaffected entries should be kept");
+  NS_TEST_ASSERT_MSG_EQ (helper.GetLabel (nodes.Get (0), nodes.Get (1), label), true, "LSP from 0 to 1 is lost");
+
+  ilm = FindIlm (nodes.Get (0), label);
+  NS_TEST_ASSERT_MSG_NE (ilm, 0, "ILM of the repaired LSP is not installed");
+  NS_TEST_ASSERT_MSG_EQ (ilm->GetNhlfe (0).GetInterface (), int32_t (GetMplsInterface (nodes.Get (0), 2)->GetIfIndex ()),
+                         "The repaired LSP should go around the ring");
+
+  Simulator::Destroy ();
+}
+
+class TunnelTestCase : public TestCase
+{
+public:
+  /**
+   * @brief Constructor.
+   */
+  TunnelTestCase ();
+  /**
+   * @brief Destructor.
+   */
+  virtual ~TunnelTestCase ();
+  /**
+   * @brief Run unit tests for this class.
+   */
+  virtual void DoRun (void);
+
+};
+
+TunnelTestCase::TunnelTestCase () :
+  TestCase ("Verify tunnel creation and removal")
+{
+}
+
+TunnelTestCase::~TunnelTestCase ()
+{
+}
+
+void
+TunnelTestCase::DoRun (void)
+{
+  // 0 - 1 - 2
+  const uint32_t links[][2] = { { 0, 1 }, { 1, 2 } };
+  MplsNetworkConfigurator network;
+  NodeContainer nodes = CreateNetwork (network, 3, links, 2);
+  Ptr<MplsNode> ingress = DynamicCast<MplsNode> (nodes.Get (0));
+  Ptr<MplsNode> transit = DynamicCast<MplsNode> (nodes.Get (1));
+
+  TunnelId tunnel = network.CreateTunnel (LspNode (nodes.Get (0)) + LspNode (nodes.Get (1)) + LspNode (nodes.Get (2)));
+
+  NS_TEST_ASSERT_MSG_EQ (network.GetNTunnels (), 1, "Tunnel is not registered");
+  NS_TEST_ASSERT_MSG_EQ (ingress->GetFtnTable ()->size (), 1, "FTN is not installed at the ingress");
+  NS_TEST_ASSERT_MSG_EQ (transit->GetIlmTable ()->size (), 1, "ILM is not installed at the transit node");
+  NS_TEST_ASSERT_MSG_EQ (DynamicCast<MplsNode> (nodes.Get (2))->GetIlmTable ()->size (), 0, "The egress has no ILM");
+
+  Ptr<IncomingLabelMap> ilm = transit->GetIlmTable ()->front ();
+  NS_TEST_ASSERT_MSG_EQ (ingress->GetFtnTable ()->front ()->GetNhlfe (0).GetLabel (0), uint32_t (ilm->GetLabel ()),
+                         "The ingress should push the label bound by the transit node");
+  NS_TEST_ASSERT_MSG_EQ (ilm->GetNhlfe (0).GetLabel (0), Label::IMPLICIT_NULL, "Penultimate hop should pop");
+
+  network.DestroyTunnel (tunnel);
+
+  NS_TEST_ASSERT_MSG_EQ (network.GetNTunnels (), 0, "Tunnel is not removed");
+  NS_TEST_ASSERT_MSG_EQ (ingress->GetFtnTable ()->size (), 0, "FTN is not removed");
+  NS_TEST_ASSERT_MSG_EQ (transit->GetIlmTable ()->size (), 0, "ILM is not removed");
+
+  std::vector<Lsp> lsps;
+  lsps.push_back (LspNode (nodes.Get (0)) + LspNode (nodes.Get (1)) + LspNode (nodes.Get (2)));
+  lsps.push_back (LspNode (nodes.Get (2)) + LspNode (nodes.Get (1)) + LspNode (nodes.Get (0)));
+  std::vector<TunnelId> tunnels = network.CreateTunnels (lsps);
+
+  NS_TEST_ASSERT_MSG_EQ (tunnels.size (), 2, "Every LSP of the batch should be created");
+  NS_TEST_ASSERT_MSG_EQ (transit->GetIlmTable ()->size (), 2, "Batch entries are not installed");
+  ilm = transit->GetIlmTable ()->back ();
+  NS_TEST_ASSERT_MSG_EQ (transit->LookupIlm (ilm->GetLabel (), ilm->GetInterface ()), ilm, "ILM of the batch is not found");
+
+  Simulator::Destroy ();
+}
+
+class CspfTestCase : public TestCase
+{
+public:
+  /**
+   * @brief Constructor.
+   */
+  CspfTestCase ();
+  /**
+   * @brief Destructor.
+   */
+  virtual ~CspfTestCase ();
+  /**
+   * @brief Run unit tests for this class.
+   */
+  virtual void DoRun (void);
+
+};
+
+CspfTestCase::CspfTestCase () :
+  TestCase ("Verify constrained path computation")
+{
+}
+
+CspfTestCase::~CspfTestCase ()
+{
+}
+
+void
+CspfTestCase::DoRun (void)
+{
+  // ring 0 - 1 - 2 - 3 - 0, device 1 of node 0 is on the link to 1
+  const uint32_t links[][2] = { { 0, 1 }, { 1, 2 }, { 2, 3 }, { 3, 0 } };
+  MplsNetworkConfigurator network;
+  NodeContainer nodes = CreateNetwork (network, 4, links, 4);
+  Ptr<Interface> direct = GetMplsInterface (nodes.Get (0), 1);
+
+  MplsCspfHelper cspf;
+  cspf.BuildGraph (network);
+
+  MplsCspfHelper::Constraints constraints;
+  MplsCspfHelper::Path path;
+  NS_TEST_ASSERT_MSG_EQ (cspf.ComputePath (nodes.Get (0), nodes.Get (1), constraints, path), true, "No path found");
+  NS_TEST_ASSERT_MSG_EQ (path.size (), 1, "Unconstrained path should take the direct link");
+
+  // excluded color prunes the direct link
+  cspf.SetAdminColors (direct, 0x1);
+  constraints.excludeAny = 0x1;
+  NS_TEST_ASSERT_MSG_EQ (cspf.ComputePath (nodes.Get (0), nodes.Get (1), constraints, path), true, "No path found");
+  NS_TEST_ASSERT_MSG_EQ (path.size (), 3, "Path should avoid the excluded link");
+
+  constraints.hopLimit = 2;
+  NS_TEST_ASSERT_MSG_EQ (cspf.ComputePath (nodes.Get (0), nodes.Get (1), constraints, path), false,
+                         "Hop limit should make the request infeasible");
+
+  // the second tunnel does not fit into the remaining bandwidth of the direct link
+  cspf.SetAdminColors (direct, 0);
+  cspf.SetReservableBandwidth (direct, 1000000);
+  constraints = MplsCspfHelper::Constraints ();
+  constraints.bandwidth = 600000;
+  NS_TEST_ASSERT_MSG_EQ (cspf.PlaceTunnel (nodes.Get (0), nodes.Get (1), constraints, path), true, "No path found");
+  NS_TEST_ASSERT_MSG_EQ (path.size (), 1, "First tunnel should take the direct link");
+  NS_TEST_ASSERT_MSG_EQ (cspf.GetAvailableBandwidth (direct), 400000, "Bandwidth is not reserved");
+  NS_TEST_ASSERT_MSG_EQ (cspf.PlaceTunnel (nodes.Get (0), nodes.Get (1), constraints, path), true, "No path found");
+  NS_TEST_ASSERT_MSG_EQ (path.size (), 3, "Second tunnel should go around the ring");
+  NS_TEST_ASSERT_MSG_EQ (cspf.GetExplicitRoute (path).size (), 3, "Every hop should be in the explicit route");
+
+  // lowering the reservable bandwidth below the reserved one leaves nothing available
+  cspf.SetReservableBandwidth (direct, 500000);
+  NS_TEST_ASSERT_MSG_EQ (cspf.GetAvailableBandwidth (direct), 0, "Available bandwidth should not wrap around");
+  constraints.bandwidth = 1;
+  NS_TEST_ASSERT_MSG_EQ (cspf.ComputePath (nodes.Get (0), nodes.Get (1), constraints, path), true, "No path found");
+  NS_TEST_ASSERT_MSG_EQ (path.size (), 3, "Overbooked link should not be feasible");
+
+  Simulator::Destroy ();
+}
+
+class CspfBatchTestCase : public TestCase
+{
+public:
+  /**
+   * @brief Constructor.
+   */
+  CspfBatchTestCase ();
+  /**
+   * @brief Destructor.
+   */
+  virtual ~CspfBatchTestCase ();
+  /**
+   * @brief Run unit tests for this class.
+   */
+  virtual void DoRun (void);
+
+};
+
+CspfBatchTestCase::CspfBatchTestCase () :
+  TestCase ("Verify batch placement does not depend on the number of threads")
+{
+}
+
+CspfBatchTestCase::~CspfBatchTestCase ()
+{
+}
+
+void
+CspfBatchTestCase::DoRun (void)
+{
+  // ring 0 - 1 - 2 - 3 - 0 with a chord 0 - 2
+  const uint32_t links[][2] = { { 0, 1 }, { 1, 2 }, { 2, 3 }, { 3, 0 }, { 0, 2 } };
+  MplsNetworkConfigurator network;
+  NodeContainer nodes = CreateNetwork (network, 4, links, 5);
+
+  MplsCspfHelper::Constraints constraints;
+  constraints.bandwidth = 400000;
+
+  // every pair twice, links take two tunnels only, so later requests are detoured or rejected
+  std::vector<MplsCspfHelper::Request> requests;
+  for (uint32_t k = 0; k < 2; ++k)
+    {
+      for (uint32_t i = 0; i < nodes.GetN (); ++i)
+        {
+          for (uint32_t j = 0; j < nodes.GetN (); ++j)
+            {
+              if (i != j)
+                {
+                  requests.push_back (MplsCspfHelper::Request (nodes.Get (i), nodes.Get (j), constraints));
+                }
+            }
+        }
+    }
+
+  std::vector<MplsCspfHelper::Path> serial;
+  std::vector<MplsCspfHelper::Path> parallel;
+  uint32_t nPlaced[2];
+
+  for (uint32_t k = 0; k < 2; ++k)
+    {
+      MplsCspfHelper cspf;
+      cspf.BuildGraph (network);
+      for (uint32_t i = 0; i < nodes.GetN (); ++i)
+        {
+          for (uint32_t j = 1; j < nodes.Get (i)->GetNDevices (); ++j)
+            {
+              cspf.SetReservableBandwidth (GetMplsInterface (nodes.Get (i), j), 1000000);
+            }
+        }
+      nPlaced[k] = cspf.PlaceTunnels (requests, k == 0 ? serial : parallel, k == 0 ? 1 : 4);
+    }
+
+  NS_TEST_ASSERT_MSG_EQ (serial.size (), requests.size (), "Every request should get a path entry");
+  NS_TEST_ASSERT_MSG_LT (nPlaced[0], requests.size (), "Some requests should exceed the link bandwidth");
+  NS_TEST_ASSERT_MSG_EQ (nPlaced[0], nPlaced[1], "Number of placed tunnels depends on the number of threads");
+  for (uint32_t i = 0; i < requests.size (); ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ ((serial[i] == parallel[i]), true, "Path " << i << " depends on the number of threads");
+    }
+
+  Simulator::Destroy ();
+}
+
+class TopologyTestCase : public TestCase
+{
+public:
+  /**
+   * @brief Constructor.
+   */
+  TopologyTestCase ();
+  /**
+   * @brief Destructor.
+   */
+  virtual ~TopologyTestCase ();
+  /**
+   * @brief Run unit tests for this class.
+   */
+  virtual void DoRun (void);
+
+};
+
+TopologyTestCase::TopologyTestCase () :
+  TestCase ("Verify the topology exported by the network discoverer")
+{
+}
+
+TopologyTestCase::~TopologyTestCase ()
+{
+}
+
+void
+TopologyTestCase::DoRun (void)
+{
+  // 0 - 1 - 2
+  const uint32_t links[][2] = { { 0, 1 }, { 1, 2 } };
+  MplsNetworkConfigurator network;
+  NodeContainer nodes = CreateNetwork (network, 3, links, 2);
+
+  Ptr<const MplsTopology> topology = network.GetTopology ();
+  NS_TEST_ASSERT_MSG_NE (topology, 0, "Topology is not built");
+  NS_TEST_ASSERT_MSG_EQ (topology->GetNNodes (), 3, "Invalid number of nodes");
+  NS_TEST_ASSERT_MSG_EQ (topology->GetNLinks (), 4, "Every link should be exported in both directions");
+
+  int32_t middle = topology->GetNodeIndex (nodes.Get (1));
+  NS_TEST_ASSERT_MSG_NE (middle, -1, "Node is not indexed");
+  NS_TEST_ASSERT_MSG_EQ (topology->GetNodeIndex (Ipv4Address ("10.0.1.1")), middle, "Address is not indexed");
+  NS_TEST_ASSERT_MSG_EQ (topology->GetOutEnd (middle) - topology->GetOutBegin (middle), 2, "Invalid out degree");
+  NS_TEST_ASSERT_MSG_EQ (topology->GetInEnd (middle) - topology->GetInBegin (middle), 2, "Invalid in degree");
+
+  for (uint32_t i = topology->GetOutBegin (middle); i < topology->GetOutEnd (middle); ++i)
+    {
+      const MplsTopology::Link &link = topology->GetLink (i);
+      NS_TEST_ASSERT_MSG_EQ (link.from, uint32_t (middle), "Outgoing link does not start at the node");
+      NS_TEST_ASSERT_MSG_EQ (topology->GetNodeIndex (link.nextHop), int32_t (link.to), "Next-hop is not on the remote node");
+      NS_TEST_ASSERT_MSG_EQ (topology->GetLocalInterface (i)->GetIfIndex (), link.localIf, "Invalid local interface");
+    }
+
+  for (uint32_t i = topology->GetInBegin (middle); i < topology->GetInEnd (middle); ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (topology->GetLink (topology->GetInLink (i)).to, uint32_t (middle),
+                             "Incoming link does not end at the node");
+    }
+
+  Simulator::Destroy ();
+}
+
+class NetworkUpdateTestCase : public TestCase
+{
+public:
+  /**
+   * @brief Constructor.
+   */
+  NetworkUpdateTestCase ();
+  /**
+   * @brief Destructor.
+   */
+  virtual ~NetworkUpdateTestCase ();
+  /**
+   * @brief Run unit tests for this class.
+   */
+  virtual void DoRun (void);
+
+private:
+  void NetworkChanged (Ptr<const MplsTopology> topology, const std::vector<Ptr<Interface> > &interfaces);
+
+  uint32_t m_nChanges;
+  uint32_t m_nInterfaces;
+};
+
+NetworkUpdateTestCase::NetworkUpdateTestCase () :
+  TestCase ("Verify incremental update of the discovered network")
+{
+}
+
+NetworkUpdateTestCase::~NetworkUpdateTestCase ()
+{
+}
+
+void
+NetworkUpdateTestCase::NetworkChanged (Ptr<const MplsTopology> topology, const std::vector<Ptr<Interface> > &interfaces)
+{
+  m_nChanges++;
+  m_nInterfaces = interfaces.size ();
+}
+
+void
+NetworkUpdateTestCase::DoRun (void)
+{
+  m_nChanges = 0;
+  m_nInterfaces = 0;
+
+  // 0 - 1 - 2
+  const uint32_t links[][2] = { { 0, 1 }, { 1, 2 } };
+  MplsNetworkConfigurator network;
+  NodeContainer nodes = CreateNetwork (network, 3, links, 2);
+  network.AddChangeCallback (MakeCallback (&NetworkUpdateTestCase::NetworkChanged, this));
+
+  NS_TEST_ASSERT_MSG_EQ (network.UpdateNetwork (), false, "Nothing has been changed");
+  NS_TEST_ASSERT_MSG_EQ (m_nChanges, 0, "Callback invoked without changes");
+
+  // a copy shares the discovered state, it should see updates made through the original
+  MplsNetworkConfigurator copy (network);
+
+  // renumber the far end of the 1 - 2 link
+  Ptr<Ipv4> ipv4 = nodes.Get (2)->GetObject<Ipv4> ();
+  int32_t ipv4if = ipv4->GetInterfaceForDevice (nodes.Get (2)->GetDevice (1));
+  ipv4->RemoveAddress (ipv4if, 0);
+  ipv4->AddAddress (ipv4if, Ipv4InterfaceAddress (Ipv4Address ("10.0.1.3"), Ipv4Mask ("255.255.255.0")));
+
+  NS_TEST_ASSERT_MSG_EQ (network.UpdateNetwork (), true, "Address change is not detected");
+  NS_TEST_ASSERT_MSG_EQ (m_nChanges, 1, "Callback is not invoked");
+  NS_TEST_ASSERT_MSG_EQ (m_nInterfaces, 2, "Both ends of the link should be updated");
+
+  Ptr<const MplsTopology> topology = network.GetTopology ();
+  int32_t far = topology->GetNodeIndex (nodes.Get (2));
+  NS_TEST_ASSERT_MSG_EQ (topology->GetNodeIndex (Ipv4Address ("10.0.1.2")), -1, "Removed address is still indexed");
+  NS_TEST_ASSERT_MSG_EQ (topology->GetNodeIndex (Ipv4Address ("10.0.1.3")), far, "New address is not indexed");
+  NS_TEST_ASSERT_MSG_EQ (topology->GetNodeIndex (Ipv4Address ("10.0.0.1")), topology->GetNodeIndex (nodes.Get (0)),
+                         "Unchanged address is lost");
+  NS_TEST_ASSERT_MSG_EQ (topology->GetNLinks (), 4, "Links should survive the renumbering");
+  NS_TEST_ASSERT_MSG_EQ (copy.UpdateNetwork (), false, "Copy should see the update of the original");
+  NS_TEST_ASSERT_MSG_EQ (copy.GetTopology (), topology, "Copy keeps a stale topology");
+
+  NS_TEST_ASSERT_MSG_EQ (network.UpdateNetwork (), false, "Nothing has been changed");
+  NS_TEST_ASSERT_MSG_EQ (m_nChanges, 1, "Callback invoked without changes");
+
+  Simulator::Destroy ();
+}
+
+class InstallerTestCase : public TestCase
+{
+public:
+  /**
+   * @brief Constructor.
+   */
+  InstallerTestCase ();
+  /**
+   * @brief Destructor.
+   */
+  virtual ~InstallerTestCase ();
+  /**
+   * @brief Run unit tests for this class.
+   */
+  virtual void DoRun (void);
+
+};
+
+InstallerTestCase::InstallerTestCase () :
+  TestCase ("Verify the protocols aggregated by the installer")
+{
+}
+
+InstallerTestCase::~InstallerTestCase ()
+{
+}
+
+void
+InstallerTestCase::DoRun (void)
+{
+  MplsNetworkConfigurator network;
+  NodeContainer nodes = network.CreateAndInstall (3);
+
+  NS_TEST_ASSERT_MSG_EQ (nodes.GetN (), 3, "Invalid number of nodes");
+  NS_TEST_ASSERT_MSG_EQ (network.GetNetworkNodes ().GetN (), 3, "Nodes are not a part of the network");
+
+  for (uint32_t i = 0; i < nodes.GetN (); ++i)
+    {
+      Ptr<Node> node = nodes.Get (i);
+      Ptr<Mpls> mpls = node->GetObject<Mpls> ();
+      NS_TEST_ASSERT_MSG_NE (mpls, 0, "Mpls is not aggregated");
+      NS_TEST_ASSERT_MSG_NE (DynamicCast<Ipv4Protocol> (node->GetObject<Ipv4> ()), 0, "Ipv4 is not mpls aware");
+      NS_TEST_ASSERT_MSG_EQ (mpls->GetIpv4 (), node->GetObject<Ipv4> (), "Mpls does not see ipv4");
+      NS_TEST_ASSERT_MSG_NE (node->GetObject<Ipv4> ()->GetRoutingProtocol (), 0, "Routing is not set");
+      NS_TEST_ASSERT_MSG_NE (node->GetObject<UdpL4Protocol> (), 0, "Udp is not aggregated");
+      NS_TEST_ASSERT_MSG_NE (node->GetObject<TcpL4Protocol> (), 0, "Tcp is not aggregated");
+      NS_TEST_ASSERT_MSG_NE (node->GetObject<ArpL3Protocol> (), 0, "Arp is not aggregated");
+    }
+
+  Simulator::Destroy ();
+}
+
+/**
+ * FEC rule defined by the user, it can not be serialized
+ */
+class AnyPacket : public FecOperand<AnyPacket>
+{
+public:
+  bool operator() (PacketDemux &pd) const { return true; }
+  void Print (std::ostream &os) const { os << "any"; }
+};
+
+class LfibSnapshotTestCase : public TestCase
+{
+public:
+  /**
+   * @brief Constructor.
+   */
+  LfibSnapshotTestCase ();
+  /**
+   * @brief Destructor.
+   */
+  virtual ~LfibSnapshotTestCase ();
+  /**
+   * @brief Run unit tests for this class.
+   */
+  virtual void DoRun (void);
+
+};
+
+LfibSnapshotTestCase::LfibSnapshotTestCase () :
+  TestCase ("Verify save and restore of the LFIB snapshot")
+{
+}
+
+LfibSnapshotTestCase::~LfibSnapshotTestCase ()
+{
+}
+
+void
+LfibSnapshotTestCase::DoRun (void)
+{
+  const uint32_t links[][2] = { { 0, 1 }, { 0, 1 } };
+  MplsNetworkConfigurator network;
+  NodeContainer nodes = CreateNetwork (network, 2, links, 2);
+  Ptr<MplsNode> node = DynamicCast<MplsNode> (nodes.Get (0));
+
+  std::vector<double> weights;
+  weights.push_back (1);
+  weights.push_back (3);
+  Ptr<WeightedPolicy> policy = CreateObject<WeightedPolicy> ();
+  policy->SetWeights (weights);
+
+  Ptr<IncomingLabelMap> ilm = Create<IncomingLabelMap> (100, Nhlfe (Swap (200), 1, Ipv4Address ("10.0.0.2")), policy);
+  ilm->AddNhlfe (Nhlfe (Swap (300), 2, Ipv4Address ("10.0.1.2")));
+  node->GetIlmTable ()->push_back (ilm);
+  node->GetFtnTable ()->push_back (Create<FecToNhlfe> (Fec::Build (Ipv4Destination ("10.0.5.0", Ipv4Mask ("/24"))),
+                                                       Nhlfe (Push (400), 1, Ipv4Address ("10.0.0.2")),
+                                                       CreateObject<RoundRobinPolicy> ()));
+  node->GetFtnTable ()->push_back (Create<FecToNhlfe> (Fec::Build (AnyPacket ()),
+                                                       Nhlfe (Push (500), 1, Ipv4Address ("10.0.0.2")),
+                                                       CreateObject<RoundRobinPolicy> ()));
+  node->GetLabelSpace (0)->ReserveSrgb (16000, 100);
+
+  MplsLfibSnapshot snapshot;
+  std::stringstream ss;
+  snapshot.Save (nodes, ss);
+  std::string data = ss.str ();
+  NS_TEST_ASSERT_MSG_EQ (snapshot.GetNEntries (), 2, "FTN of the user defined FEC should be skipped");
+
+  node->GetIlmTable ()->clear ();
+  node->GetFtnTable ()->clear ();
+
+  std::istringstream is (data);
+  NS_TEST_ASSERT_MSG_EQ (snapshot.Restore (nodes, is), true, "Snapshot is not restored");
+  NS_TEST_ASSERT_MSG_EQ (node->GetIlmTable ()->size (), 1, "ILM is not restored");
+  NS_TEST_ASSERT_MSG_EQ (node->GetFtnTable ()->size (), 1, "FTN is not restored");
+
+  Ptr<IncomingLabelMap> restored = node->LookupIlm (100, -1);
+  NS_TEST_ASSERT_MSG_NE (restored, 0, "Restored ILM is not indexed");
+  NS_TEST_ASSERT_MSG_EQ (restored->GetNNhlfe (), 2, "NHLFEs are not restored");
+  NS_TEST_ASSERT_MSG_EQ (restored->GetNhlfe (1).GetLabel (0), 300, "Label is not restored");
+  Ptr<WeightedPolicy> weighted = DynamicCast<WeightedPolicy> (restored->GetPolicy ());
+  NS_TEST_ASSERT_MSG_NE (weighted, 0, "Policy type is not restored");
+  NS_TEST_ASSERT_MSG_EQ ((weighted->GetWeights () == weights), true, "Weights are not restored");
+
+  LabelSpace *space = node->GetLabelSpace (0);
+  NS_TEST_ASSERT_MSG_EQ (space->GetSrgbBase (), 16000, "SRGB is not restored");
+  NS_TEST_ASSERT_MSG_EQ (space->GetSrgbSize (), 100, "SRGB is not restored");
+  NS_TEST_ASSERT_MSG_EQ (space->Reserve (16050), false, "SRGB labels are not allocated");
+  space->ReleaseSrgb ();
+  NS_TEST_ASSERT_MSG_EQ (space->Reserve (16050), true, "Restored SRGB is not released");
+  space->Deallocate (16050);
+
+  // nested FECs are read up to the depth limit only
+  std::string terminal (1, char (Fec::FEC_IPV4_DESTINATION));
+  terminal += std::string (8, '\0');
+  std::istringstream nested (std::string (Fec::MAX_DEPTH, char (Fec::FEC_NOT)) + terminal);
+  Fec *fec = Fec::Deserialize (nested);
+  NS_TEST_ASSERT_MSG_NE (fec, 0, "FEC within the depth limit is rejected");
+  delete fec;
+  std::istringstream tooDeep (std::string (Fec::MAX_DEPTH + 1, char (Fec::FEC_NOT)) + terminal);
+  NS_TEST_ASSERT_MSG_EQ (Fec::Deserialize (tooDeep), 0, "FEC nested beyond the depth limit is accepted");
+
+  // weights of a policy which is not weighted
+  std::string weightedName = std::string ("\0\0\0\x19", 4) + "ns3::mpls::WeightedPolicy";
+  std::string otherName = std::string ("\0\0\0\x1b", 4) + "ns3::mpls::RoundRobinPolicy";
+  std::string malformed = data;
+  std::string::size_type pos = malformed.find (weightedName);
+  NS_TEST_ASSERT_MSG_NE (pos, std::string::npos, "Policy type is not saved");
+  malformed.replace (pos, weightedName.size (), otherName);
+
+  std::istringstream bad (malformed);
+  NS_TEST_ASSERT_MSG_EQ (snapshot.Restore (nodes, bad), false, "Malformed policy is accepted");
+  NS_TEST_ASSERT_MSG_EQ (node->LookupIlm (100, -1), restored, "Tables are changed by failed restore");
+
+  Simulator::Destroy ();
+}
+
+class ConfigLoaderTestCase : public TestCase
+{
+public:
+  /**
+   * @brief Constructor.
+   */
+  ConfigLoaderTestCase ();
+  /**
+   * @brief Destructor.
+   */
+  virtual ~ConfigLoaderTestCase ();
+  /**
+   * @brief Run unit tests for this class.
+   */
+  virtual void DoRun (void);
+
+};
+
+ConfigLoaderTestCase::ConfigLoaderTestCase () :
+  TestCase ("Verify loading of static ILM and FTN tables")
+{
+}
+
+ConfigLoaderTestCase::~ConfigLoaderTestCase ()
+{
+}
+
+void
+ConfigLoaderTestCase::DoRun (void)
+{
+  const uint32_t links[][2] = { { 0, 1 }, { 0, 1 } };
+  MplsNetworkConfigurator network;
+  NodeContainer nodes = CreateNetwork (network, 2, links, 2);
+  Ptr<MplsNode> node = DynamicCast<MplsNode> (nodes.Get (0));
+
+  uint32_t id0 = nodes.Get (0)->GetId ();
+  uint32_t id1 = nodes.Get (1)->GetId ();
+  std::ostringstream config;
+  config << "# two NHLFEs of one ILM\n"
+         << "ilm " << id0 << " - 5000 swap 200 1 10.0.0.2\n"
+         << "ilm " << id0 << " - 5000 swap 300 2 10.0.1.2   # same key\n"
+         << "\n"
+         << "ftn " << id0 << " dst=10.0.5.0/24&!udp-dst=53 push 400,401 1 10.0.0.2\n"
+         << "ilm " << id1 << " - 400 pop - - -\n";
+  std::istringstream is (config.str ());
+
+  MplsConfigLoader loader;
+  NS_TEST_ASSERT_MSG_EQ (loader.Load (nodes, is), 3, "Invalid number of entries");
+  NS_TEST_ASSERT_MSG_EQ (node->GetIlmTable ()->size (), 1, "Lines with the same key should share the ILM");
+  NS_TEST_ASSERT_MSG_EQ (node->GetFtnTable ()->size (), 1, "FTN is not loaded");
+
+  Ptr<IncomingLabelMap> ilm = node->LookupIlm (5000, -1);
+  NS_TEST_ASSERT_MSG_NE (ilm, 0, "ILM is not indexed");
+  NS_TEST_ASSERT_MSG_EQ (ilm->GetNNhlfe (), 2, "Invalid number of NHLFEs");
+  NS_TEST_ASSERT_MSG_EQ (ilm->GetNhlfe (1).GetLabel (0), 300, "Invalid outgoing label");
+  NS_TEST_ASSERT_MSG_EQ (ilm->GetNhlfe (1).GetInterface (), 2, "Invalid outgoing interface");
+
+  Nhlfe push = node->GetFtnTable ()->front ()->GetNhlfe (0);
+  NS_TEST_ASSERT_MSG_EQ (push.GetNLabels (), 2, "Invalid number of pushed labels");
+
+  // labels below the dynamic range of the label space are not reserved
+  LabelSpace::RangeVector ranges;
+  node->GetLabelSpace (0)->GetAllocatedRanges (ranges);
+  NS_TEST_ASSERT_MSG_EQ (ranges.size (), 1, "Static label is not reserved");
+  NS_TEST_ASSERT_MSG_EQ (ranges[0].first, 5000, "Static label is not reserved");
+  NS_TEST_ASSERT_MSG_EQ (ranges[0].second, 5000, "Static label is not reserved");
+
+  NS_TEST_ASSERT_MSG_NE (DynamicCast<MplsNode> (nodes.Get (1))->LookupIlm (400, -1), 0, "ILM of the other node is not loaded");
+
+  // an ILM bound to an interface does not clash with the platform ILM of the same label
+  std::ostringstream more;
+  more << "ilm " << id0 << " 1 20 pop - - -\n"
+       << "ilm " << id0 << " - 20 swap 500 2 10.0.1.2\n"
+       << "ftn " << id0 << " dst6=2001:db8::/32 push 600 1 10.0.0.2\n";
+  std::istringstream moreIs (more.str ());
+  NS_TEST_ASSERT_MSG_EQ (loader.Load (nodes, moreIs), 3, "Invalid number of entries");
+  NS_TEST_ASSERT_MSG_EQ (node->LookupIlm (20, 1)->GetInterface (), 1, "Interface ILM is not indexed");
+  NS_TEST_ASSERT_MSG_EQ (node->LookupIlm (20, 2)->GetInterface (), -1, "Platform ILM is not indexed");
+  NS_TEST_ASSERT_MSG_NE (node->LookupIlm (5000, -1), 0, "ILM of the first load is lost");
+
+  Simulator::Destroy ();
+}
+
+class BulkInsertionTestCase : public TestCase
+{
+public:
+  /**
+   * @brief Constructor.
+   */
+  BulkInsertionTestCase ();
+  /**
+   * @brief Destructor.
+   */
+  virtual ~BulkInsertionTestCase ();
+  /**
+   * @brief Run unit tests for this class.
+   */
+  virtual void DoRun (void);
+
+};
+
+BulkInsertionTestCase::BulkInsertionTestCase () :
+  TestCase ("Verify bulk insertion of ILMs and FTNs")
+{
+}
+
+BulkInsertionTestCase::~BulkInsertionTestCase ()
+{
+}
+
+void
+BulkInsertionTestCase::DoRun (void)
+{
+  MplsNetworkConfigurator network;
+  NodeContainer nodes = network.CreateAndInstall (1);
+  MplsSwitch sw (nodes.Get (0));
+
+  MplsSwitch::NhlfeGroupVector groups (2);
+  groups[0].push_back (Nhlfe (Swap (100), Ipv4Address ("10.0.0.2")));
+  groups[1].push_back (Nhlfe (Swap (100), Ipv4Address ("10.0.0.2")));
+  groups[1].push_back (Nhlfe (Swap (200), Ipv4Address ("10.0.1.2")));
+
+  MplsSwitch::PolicyVector policies;
+  policies.push_back (CreateObject<RoundRobinPolicy> ());
+  policies.push_back (CreateObject<StaRoundRobinPolicy> ());
+
+  std::vector<MplsIlmHelper::IlmEntry> ilms;
+  for (uint32_t i = 0; i < 10; ++i)
+    {
+      ilms.push_back (MplsIlmHelper::IlmEntry (-1, 16 + i, i % 2, i % 2));
+    }
+
+  NS_TEST_ASSERT_MSG_EQ (sw.AddIlms (ilms.begin (), ilms.end (), groups, policies), 10, "Invalid number of ILMs");
+  NS_TEST_ASSERT_MSG_EQ (sw.GetNode ()->GetIlmTable ()->size (), 10, "ILMs are not added");
+  NS_TEST_ASSERT_MSG_EQ (sw.GetNode ()->GetNhlfePool ()->GetN (), 2, "Equal NHLFEs should be interned once");
+
+  for (uint32_t i = 0; i < 10; ++i)
+    {
+      Ptr<IncomingLabelMap> ilm = sw.GetNode ()->LookupIlm (16 + i, -1);
+      NS_TEST_ASSERT_MSG_NE (ilm, 0, "ILM " << 16 + i << " is not indexed");
+      NS_TEST_ASSERT_MSG_EQ (ilm->GetNNhlfe (), groups[i % 2].size (), "Invalid number of NHLFEs");
+      NS_TEST_ASSERT_MSG_EQ (ilm->GetPolicy (), policies[i % 2], "Policy should be shared");
+    }
+
+  std::vector<MplsFtnHelper::FtnEntry> ftns;
+  ftns.push_back (MplsFtnHelper::FtnEntry (Fec::Build (Ipv4Destination ("10.1.0.1")), 0));
+  ftns.push_back (MplsFtnHelper::FtnEntry (Fec::Build (Ipv4Destination ("10.1.0.2")), 1));
+
+  NS_TEST_ASSERT_MSG_EQ (sw.AddFtns (ftns.begin (), ftns.end (), groups), 2, "Invalid number of FTNs");
+  MplsNode::FtnTable *table = sw.GetNode ()->GetFtnTable ();
+  NS_TEST_ASSERT_MSG_EQ (table->size (), 2, "FTNs are not added");
+  NS_TEST_ASSERT_MSG_EQ (table->back ()->GetNNhlfe (), 2, "Invalid number of NHLFEs");
+  NS_TEST_ASSERT_MSG_EQ (table->front ()->GetPolicy (), table->back ()->GetPolicy (),
+                         "Default policy should be shared by the batch");
+
+  // attribute defaults set after the first default policy was created are taken into account
+  Config::SetDefault ("ns3::mpls::NhlfeSelectionPolicy::MaxPacketsInTxQueue", IntegerValue (5));
+  IntegerValue maxPackets;
+  NhlfeSelectionPolicy::GetDefault ()->GetAttribute ("MaxPacketsInTxQueue", maxPackets);
+  Config::SetDefault ("ns3::mpls::NhlfeSelectionPolicy::MaxPacketsInTxQueue", IntegerValue (-1));
+  NS_TEST_ASSERT_MSG_EQ (maxPackets.Get (), 5, "Default policy ignores attribute defaults");
+
+  Simulator::Destroy ();
+}
+
+class SharedPolicyTestCase : public TestCase
+{
+public:
+  /**
+   * @brief Constructor.
+   */
+  SharedPolicyTestCase ();
+  /**
+   * @brief Destructor.
+   */
+  virtual ~SharedPolicyTestCase ();
+  /**
+   * @brief Run unit tests for this class.
+   */
+  virtual void DoRun (void);
+
+};
+
+SharedPolicyTestCase::SharedPolicyTestCase () :
+  TestCase ("Verify per-entry state of a shared selection policy")
+{
+}
+
+SharedPolicyTestCase::~SharedPolicyTestCase ()
+{
+}
+
+void
+SharedPolicyTestCase::DoRun (void)
+{
+  const uint32_t links[][2] = { { 0, 1 }, { 0, 1 } };
+  MplsNetworkConfigurator network;
+  NodeContainer nodes = CreateNetwork (network, 2, links, 2);
+  Ptr<Interface> interface = GetMplsInterface (nodes.Get (0), 1);
+
+  std::vector<double> weights (2, 0.5);
+  Ptr<WeightedPolicy> policy = CreateObject<WeightedPolicy> ();
+  policy->SetWeights (weights);
+
+  Ptr<IncomingLabelMap> used = Create<IncomingLabelMap> (100, Nhlfe (Swap (200), 1), policy);
+  used->AddNhlfe (Nhlfe (Swap (300), 2));
+  Ptr<IncomingLabelMap> unused = Create<IncomingLabelMap> (101, Nhlfe (Swap (201), 1), policy);
+  unused->AddNhlfe (Nhlfe (Swap (301), 2));
+
+  ForwardingInformation::Iterator i = used->GetIterator ();
+  NS_TEST_ASSERT_MSG_EQ (i.Get ().GetLabel (0), 200, "Equal ratios should start with the first NHLFE");
+  NS_TEST_ASSERT_MSG_EQ (i.Select (interface, Create<Packet> (100)), true, "NHLFE is not selected");
+
+  i = used->GetIterator ();
+  NS_TEST_ASSERT_MSG_EQ (i.Get ().GetLabel (0), 300, "NHLFE below its ratio should be tried first");
+
+  // current ratios are printed from the state of the entry
+  std::ostringstream os1;
+  used->Print (os1);
+  NS_TEST_ASSERT_MSG_NE (os1.str ().find ("(1;0.5;0) (0;0.5;1)"), std::string::npos, "Invalid ratios " << os1.str ());
+
+  std::ostringstream os2;
+  unused->Print (os2);
+  NS_TEST_ASSERT_MSG_NE (os2.str ().find ("(0;0.5) (1;0.5)"), std::string::npos, "State is shared " << os2.str ());
+
+  i = unused->GetIterator ();
+  NS_TEST_ASSERT_MSG_EQ (i.Get ().GetLabel (0), 201, "State is shared");
+
+  Simulator::Destroy ();
+}
+
+class NhlfePoolTestCase : public TestCase
+{
+public:
+  /**
+   * @brief Constructor.
+   */
+  NhlfePoolTestCase ();
+  /**
+   * @brief Destructor.
+   */
+  virtual ~NhlfePoolTestCase ();
+  /**
+   * @brief Run unit tests for this class.
+   */
+  virtual void DoRun (void);
+
+};
+
+NhlfePoolTestCase::NhlfePoolTestCase () :
+  TestCase ("Verify the NHLFE pool")
+{
+}
+
+NhlfePoolTestCase::~NhlfePoolTestCase ()
+{
+}
+
+void
+NhlfePoolTestCase::DoRun (void)
+{
+  Ptr<NhlfePool> pool = Create<NhlfePool> ();
+  uint32_t id1 = pool->Intern (Nhlfe (Swap (100), 1, Ipv4Address ("10.0.0.2")));
+  uint32_t id2 = pool->Intern (Nhlfe (Swap (100), 1, Ipv4Address ("10.0.0.2")));
+  uint32_t id3 = pool->Intern (Nhlfe (Push (1, 2, 3), 1, Ipv4Address ("10.0.0.2")));
+
+  NS_TEST_ASSERT_MSG_EQ (id1, id2, "Equal NHLFEs should get the same id");
+  NS_TEST_ASSERT_MSG_NE (id1, id3, "Different NHLFEs should get different ids");
+  NS_TEST_ASSERT_MSG_EQ (pool->GetN (), 2, "Invalid number of NHLFEs");
+  NS_TEST_ASSERT_MSG_EQ (pool->GetNAdjacencies (), 1, "Adjacency should be kept once");
+  NS_TEST_ASSERT_MSG_EQ (pool->GetLabel (id3, 2), 3, "Invalid label");
+
+  Nhlfe nhlfe = pool->Get (id3);
+  NS_TEST_ASSERT_MSG_EQ (nhlfe.GetNLabels (), 3, "Invalid number of labels");
+  NS_TEST_ASSERT_MSG_EQ (nhlfe.GetInterface (), 1, "Invalid outgoing interface");
+
+  // ids survive growth of the hash table
+  std::vector<uint32_t> ids;
+  for (uint32_t label = 1000; label < 1100; ++label)
+    {
+      ids.push_back (pool->Intern (Nhlfe (Swap (label), 2)));
+    }
+  for (uint32_t label = 1000; label < 1100; ++label)
+    {
+      NS_TEST_ASSERT_MSG_EQ (pool->Intern (Nhlfe (Swap (label), 2)), ids[label - 1000], "Equal NHLFE got a new id");
+    }
+  NS_TEST_ASSERT_MSG_EQ (pool->GetN (), 102, "Invalid number of NHLFEs");
+  NS_TEST_ASSERT_MSG_EQ (pool->Intern (Nhlfe (Swap (100), 1, Ipv4Address ("10.0.0.2"))), id1, "Equal NHLFE got a new id");
+
+  std::vector<double> weights (2, 0.5);
+  Ptr<WeightedPolicy> policy = CreateObject<WeightedPolicy> ();
+  policy->SetWeights (weights);
+
+  Ptr<IncomingLabelMap> ilm = Create<IncomingLabelMap> (100, Nhlfe (Swap (100), 1, Ipv4Address ("10.0.0.2")), policy);
+  ilm->AddNhlfe (Nhlfe (Swap (200), 2));
+  ilm->Intern (pool);
+  NS_TEST_ASSERT_MSG_EQ (ilm->GetNhlfePool (), pool, "NHLFEs are not interned");
+  NS_TEST_ASSERT_MSG_EQ (pool->GetN (), 103, "Only the new NHLFE should be added");
+
+  // weighted state grows once the NHLFEs are ranked
+  uint32_t before = ilm->GetMemoryUsage ();
+  ForwardingInformation::Iterator i = ilm->GetIterator ();
+  NS_TEST_ASSERT_MSG_EQ (i.Get ().GetLabel (0), 100, "Invalid NHLFE taken from the pool");
+  NS_TEST_ASSERT_MSG_GT (ilm->GetMemoryUsage (), before, "Memory of the policy state is not counted");
+
+  Simulator::Destroy ();
+}
+
+class FlatLfibTestCase : public TestCase
+{
+public:
+  /**
+   * @brief Constructor.
+   */
+  FlatLfibTestCase ();
+  /**
+   * @brief Destructor.
+   */
+  virtual ~FlatLfibTestCase ();
+  /**
+   * @brief Run unit tests for this class.
+   */
+  virtual void DoRun (void);
+
+};
+
+FlatLfibTestCase::FlatLfibTestCase () :
+  TestCase ("Verify the flat label forwarding table")
+{
+}
+
+FlatLfibTestCase::~FlatLfibTestCase ()
+{
+}
+
+void
+FlatLfibTestCase::DoRun (void)
+{
+  const uint32_t links[][2] = { { 0, 1 }, { 0, 1 } };
+  MplsNetworkConfigurator network;
+  NodeContainer nodes = CreateNetwork (network, 2, links, 2);
+  Ptr<MplsNode> node = DynamicCast<MplsNode> (nodes.Get (0));
+  Ptr<NhlfeSelectionPolicy> policy = CreateObject<RoundRobinPolicy> ();
+
+  Ptr<IncomingLabelMap> ilm = Create<IncomingLabelMap> (100, Nhlfe (Swap (200), 1), policy);
+  ilm->AddNhlfe (Nhlfe (Swap (300), 2));
+  node->GetIlmTable ()->push_back (ilm);
+  node->GetIlmTable ()->push_back (Create<IncomingLabelMap> (101, Nhlfe (Pop (), 1), policy));
+  Ptr<IncomingLabelMap> replicating = Create<IncomingLabelMap> (102, Nhlfe (Swap (202), 1), policy);
+  replicating->AddNhlfe (Nhlfe (Swap (302), 2));
+  replicating->SetReplication (true);
+  node->GetIlmTable ()->push_back (replicating);
+
+  const Ptr<FlatLfib> &flat = node->GetFlatLfib ();
+  NS_TEST_ASSERT_MSG_EQ (node->FlattenIlmTable (), 2, "Replicating ILM should stay in the ILM table");
+  NS_TEST_ASSERT_MSG_EQ (node->GetIlmTable ()->size (), 1, "Moved ILMs are left in the ILM table");
+  NS_TEST_ASSERT_MSG_EQ (flat->GetNEntries (), 2, "Invalid number of entries");
+
+  FlatLfib::Handle handle = flat->Lookup (100, 1);
+  NS_TEST_ASSERT_MSG_EQ (handle.IsValid (), true, "Entry is not found");
+  NS_TEST_ASSERT_MSG_EQ (flat->GetIlm (handle)->GetNNhlfe (), 2, "NHLFEs are lost");
+  NS_TEST_ASSERT_MSG_EQ (flat->GetIlm (handle)->GetPolicy (), policy, "Policy should be shared");
+  NS_TEST_ASSERT_MSG_EQ (flat->GetNext (0).GetLabel (), 100, "Invalid first entry");
+  NS_TEST_ASSERT_MSG_EQ (flat->GetNext (101).GetLabel (), 101, "Invalid next entry");
+  NS_TEST_ASSERT_MSG_EQ (flat->GetNext (102).IsValid (), false, "Entry beyond the last one");
+
+  // NHLFEs of dead interfaces are skipped as in the ILM table
+  InterfaceLiveness liveness;
+  liveness.SetAlive (1, false);
+  ForwardingInformation::Iterator i = flat->GetIterator (handle, liveness);
+  NS_TEST_ASSERT_MSG_EQ (i.HasNext (), true, "Alive NHLFE is not selectable");
+  NS_TEST_ASSERT_MSG_EQ (i.Get ().GetInterface (), 2, "NHLFE of the dead interface is selectable");
+  NS_TEST_ASSERT_MSG_EQ (i.HasNext (), false, "NHLFE of the dead interface is selectable");
+  i = flat->GetIterator (flat->Lookup (101, 1), liveness);
+  NS_TEST_ASSERT_MSG_EQ (i.HasNext (), false, "NHLFE of the dead interface is selectable");
+
+  // flat entries are saved as ILMs
+  MplsLfibSnapshot snapshot;
+  std::stringstream ss;
+  snapshot.Save (nodes, ss);
+  NS_TEST_ASSERT_MSG_EQ (snapshot.GetNEntries (), 3, "Flat entries are not saved");
+  NS_TEST_ASSERT_MSG_EQ (snapshot.Restore (nodes, ss), true, "Snapshot is not restored");
+  NS_TEST_ASSERT_MSG_EQ (flat->GetNEntries (), 0, "Flat table is not cleared");
+  NS_TEST_ASSERT_MSG_EQ (node->GetIlmTable ()->size (), 3, "Flat entries are not restored");
+  NS_TEST_ASSERT_MSG_NE (node->LookupIlm (100, 1), 0, "Restored ILM is not indexed");
+  NS_TEST_ASSERT_MSG_EQ (node->LookupIlm (100, 1)->GetNNhlfe (), 2, "NHLFEs are lost");
+
+  Simulator::Destroy ();
+}
+
+class NextHopGroupTestCase : public TestCase
+{
+public:
+  /**
+   * @brief Constructor.
+   */
+  NextHopGroupTestCase ();
+  /**
+   * @brief Destructor.
+   */
+  virtual ~NextHopGroupTestCase ();
+  /**
+   * @brief Run unit tests for this class.
+   */
+  virtual void DoRun (void);
+
+};
+
+NextHopGroupTestCase::NextHopGroupTestCase () :
+  TestCase ("Verify NHLFEs shared by a next-hop group")
+{
+}
+
+NextHopGroupTestCase::~NextHopGroupTestCase ()
+{
+}
+
+void
+NextHopGroupTestCase::DoRun (void)
+{
+  Ptr<NextHopGroup> group = Create<NextHopGroup> ();
+  group->AddNhlfe (Nhlfe (Swap (200), 1, Ipv4Address ("10.0.0.2")));
+  group->AddNhlfe (Nhlfe (Swap (300), 2, Ipv4Address ("10.0.1.2")));
+
+  Ptr<NhlfeSelectionPolicy> policy = CreateObject<RoundRobinPolicy> ();
+  Ptr<IncomingLabelMap> ilm = Create<IncomingLabelMap> (-1, 100, group, policy);
+  Ptr<FecToNhlfe> ftn = Create<FecToNhlfe> (Fec::Build (Ipv4Destination ("10.1.0.1")), group, policy);
+
+  // one change of the group is seen by every entry
+  group->SetNhlfe (0, Nhlfe (Swap (400), 1, Ipv4Address ("10.0.0.2")));
+  NS_TEST_ASSERT_MSG_EQ (ilm->GetNhlfe (0).GetLabel (0), 400, "ILM does not see the group change");
+  NS_TEST_ASSERT_MSG_EQ (ftn->GetNhlfe (0).GetLabel (0), 400, "FTN does not see the group change");
+
+  InterfaceLiveness liveness;
+  liveness.SetAlive (1, false);
+  ForwardingInformation::Iterator i = ilm->GetIterator (liveness);
+  NS_TEST_ASSERT_MSG_EQ (i.HasNext (), true, "Alive NHLFE is not selectable");
+  NS_TEST_ASSERT_MSG_EQ (i.Get ().GetInterface (), 2, "NHLFE of the dead interface is selectable");
+  NS_TEST_ASSERT_MSG_EQ (i.HasNext (), false, "NHLFE of the dead interface is selectable");
+
+  NS_TEST_ASSERT_MSG_EQ (group->RemoveNextHop (2, Ipv4Address ("10.0.1.2")), 1, "Next-hop is not removed");
+  NS_TEST_ASSERT_MSG_EQ (ilm->GetNNhlfe (), 1, "ILM does not see the removal");
+  NS_TEST_ASSERT_MSG_EQ (ftn->GetNNhlfe (), 1, "FTN does not see the removal");
+
+  i = ilm->GetIterator (liveness);
+  NS_TEST_ASSERT_MSG_EQ (i.HasNext (), false, "NHLFE of the dead interface is selectable");
+
+  Simulator::Destroy ();
+}
+
+class FastRerouteTestCase : public TestCase
+{
+public:
+  /**
+   * @brief Constructor.
+   */
+  FastRerouteTestCase ();
+  /**
+   * @brief Destructor.
+   */
+  virtual ~FastRerouteTestCase ();
+  /**
+   * @brief Run unit tests for this class.
+   */
+  virtual void DoRun (void);
+
+};
+
+FastRerouteTestCase::FastRerouteTestCase () :
+  TestCase ("Verify forwarding to the fast reroute backup")
+{
+}
+
+FastRerouteTestCase::~FastRerouteTestCase ()
+{
+}
+
+void
+FastRerouteTestCase::DoRun (void)
+{
+  // two parallel links between node 0 and node 1, packets enter node 0 from node 2
+  const uint32_t links[][2] = { { 0, 1 }, { 0, 1 }, { 0, 2 } };
+  MplsNetworkConfigurator network;
+  NodeContainer nodes = CreateNetwork (network, 3, links, 3);
+  Ptr<MplsNode> node = DynamicCast<MplsNode> (nodes.Get (0));
+  Ptr<Interface> primary = GetMplsInterface (node, 1);
+  Ptr<Interface> backup = GetMplsInterface (node, 2);
+
+  node->GetIlmTable ()->push_back (Create<IncomingLabelMap> (100,
+    Nhlfe (Swap (200), primary->GetIfIndex (), Ipv4Address ("10.0.0.2")), CreateObject<RoundRobinPolicy> ()));
+  node->GetFastReroute ()->AddBypass (primary->GetIfIndex (), Ipv4Address ("10.0.0.2"),
+    Nhlfe (Swap (900), backup->GetIfIndex (), Ipv4Address ("10.0.1.2")));
+
+  TxRecorder recorder (node);
+  const uint32_t label = 100;
+
+  ReceiveLabeled (node, 3, &label, 1);
+  NS_TEST_ASSERT_MSG_EQ (recorder.m_interfaces.size (), 1, "Packet is not forwarded");
+  NS_TEST_ASSERT_MSG_EQ (recorder.m_interfaces[0], int32_t (primary->GetIfIndex ()), "Backup is used before the failure");
+  NS_TEST_ASSERT_MSG_EQ (recorder.m_labels[0], 200, "Invalid outgoing label");
+
+  // the next-hop of the failed link is not resolvable anymore
+  primary->SetDown ();
+  primary->RemoveAddress (Ipv4Address ("10.0.0.2"));
+  recorder.Clear ();
+
+  ReceiveLabeled (node, 3, &label, 1);
+  NS_TEST_ASSERT_MSG_EQ (recorder.m_interfaces.size (), 1, "Packet is not rerouted");
+  NS_TEST_ASSERT_MSG_EQ (recorder.m_interfaces[0], int32_t (backup->GetIfIndex ()), "Packet is not sent to the bypass");
+  NS_TEST_ASSERT_MSG_EQ (recorder.m_labels[0], 900, "Bypass label is not pushed");
+  NS_TEST_ASSERT_MSG_EQ (recorder.m_sizes[0], 2, "Primary operation is not performed");
+  NS_TEST_ASSERT_MSG_EQ (node->GetFastReroute ()->GetNEvents (), 1, "Failure is not recorded");
+
+  Simulator::Destroy ();
+}
+
+class FastRerouteLivenessTestCase : public TestCase
+{
+public:
+  /**
+   * @brief Constructor.
+   */
+  FastRerouteLivenessTestCase ();
+  /**
+   * @brief Destructor.
+   */
+  virtual ~FastRerouteLivenessTestCase ();
+  /**
+   * @brief Run unit tests for this class.
+   */
+  virtual void DoRun (void);
+
+};
+
+FastRerouteLivenessTestCase::FastRerouteLivenessTestCase () :
+  TestCase ("Verify NHLFEs of a failed link are not used without a backup")
+{
+}
+
+FastRerouteLivenessTestCase::~FastRerouteLivenessTestCase ()
+{
+}
+
+void
+FastRerouteLivenessTestCase::DoRun (void)
+{
+  const uint32_t links[][2] = { { 0, 1 }, { 0, 1 }, { 0, 2 } };
+  MplsNetworkConfigurator network;
+  NodeContainer nodes = CreateNetwork (network, 3, links, 3);
+  Ptr<MplsNode> node = DynamicCast<MplsNode> (nodes.Get (0));
+  Ptr<Interface> primary = GetMplsInterface (node, 1);
+  Ptr<Interface> backup = GetMplsInterface (node, 2);
+  const Ptr<FastReroute> &frr = node->GetFastReroute ();
+  const Ptr<InterfaceLiveness> &liveness = node->GetInterfaceLiveness ();
+
+  node->GetIlmTable ()->push_back (Create<IncomingLabelMap> (100,
+    Nhlfe (Swap (200), primary->GetIfIndex (), Ipv4Address ("10.0.0.2")), CreateObject<RoundRobinPolicy> ()));
+
+  TxRecorder recorder (node);
+  const uint32_t label = 100;
+
+  primary->SetDown ();
+  NS_TEST_ASSERT_MSG_EQ (liveness->IsAlive (primary->GetIfIndex ()), false, "Unprotected failed interface is alive");
+  ReceiveLabeled (node, 3, &label, 1);
+  NS_TEST_ASSERT_MSG_EQ (recorder.m_interfaces.size (), 0, "Packet is sent to the failed link");
+  NS_TEST_ASSERT_MSG_EQ (recorder.m_nDrops, 1, "Packet is not dropped");
+
+  // protection added after the failure is used at once
+  frr->AddBypass (primary->GetIfIndex (), Address (), Nhlfe (Swap (900), backup->GetIfIndex (), Ipv4Address ("10.0.1.2")));
+  NS_TEST_ASSERT_MSG_EQ (liveness->IsAlive (primary->GetIfIndex ()), true, "Protected failed interface is not alive");
+  recorder.Clear ();
+  ReceiveLabeled (node, 3, &label, 1);
+  NS_TEST_ASSERT_MSG_EQ (recorder.m_interfaces.size (), 1, "Packet is not rerouted");
+  NS_TEST_ASSERT_MSG_EQ (recorder.m_interfaces[0], int32_t (backup->GetIfIndex ()), "Packet is not sent to the bypass");
+
+  // the backup fails as well
+  backup->SetDown ();
+  recorder.Clear ();
+  ReceiveLabeled (node, 3, &label, 1);
+  NS_TEST_ASSERT_MSG_EQ (recorder.m_interfaces.size (), 0, "Packet is sent although the backup failed");
+  NS_TEST_ASSERT_MSG_EQ (recorder.m_nDrops, 1, "Packet is not dropped");
+
+  frr->RemoveBackups (primary->GetIfIndex ());
+  NS_TEST_ASSERT_MSG_EQ (liveness->IsAlive (primary->GetIfIndex ()), false, "Unprotected failed interface is alive");
+
+  primary->SetUp ();
+  NS_TEST_ASSERT_MSG_EQ (liveness->IsAlive (primary->GetIfIndex ()), true, "Restored interface is not alive");
+  recorder.Clear ();
+  ReceiveLabeled (node, 3, &label, 1);
+  NS_TEST_ASSERT_MSG_EQ (recorder.m_interfaces.size (), 1, "Packet is not forwarded");
+  NS_TEST_ASSERT_MSG_EQ (recorder.m_interfaces[0], int32_t (primary->GetIfIndex ()), "Packet is not sent to the restored link");
+
+  Simulator::Destroy ();
+}
+
+class WeightedLivenessTestCase : public TestCase
+{
+public:
+  /**
+   * @brief Constructor.
+   */
+  WeightedLivenessTestCase ();
+  /**
+   * @brief Destructor.
+   */
+  virtual ~WeightedLivenessTestCase ();
+  /**
+   * @brief Run unit tests for this class.
+   */
+  virtual void DoRun (void);
+
+};
+
+WeightedLivenessTestCase::WeightedLivenessTestCase () :
+  TestCase ("Verify weighted split over the NHLFEs of alive interfaces")
+{
+}
+
+WeightedLivenessTestCase::~WeightedLivenessTestCase ()
+{
+}
+
+void
+WeightedLivenessTestCase::DoRun (void)
+{
+  const uint32_t links[][2] = { { 0, 1 }, { 0, 1 }, { 0, 1 }, { 0, 2 } };
+  MplsNetworkConfigurator network;
+  NodeContainer nodes = CreateNetwork (network, 3, links, 4);
+  Ptr<MplsNode> node = DynamicCast<MplsNode> (nodes.Get (0));
+
+  std::vector<double> weights;
+  weights.push_back (0.5);
+  weights.push_back (0.3);
+  weights.push_back (0.2);
+  Ptr<WeightedPolicy> policy = CreateObject<WeightedPolicy> ();
+  policy->SetWeights (weights);
+
+  Ptr<IncomingLabelMap> ilm = Create<IncomingLabelMap> (100,
+    Nhlfe (Swap (201), GetMplsInterface (node, 1)->GetIfIndex (), Ipv4Address ("10.0.0.2")), policy);
+  ilm->AddNhlfe (Nhlfe (Swap (202), GetMplsInterface (node, 2)->GetIfIndex (), Ipv4Address ("10.0.1.2")));
+  ilm->AddNhlfe (Nhlfe (Swap (203), GetMplsInterface (node, 3)->GetIfIndex (), Ipv4Address ("10.0.2.2")));
+  node->GetIlmTable ()->push_back (ilm);
+
+  // the survivors keep their own weights, 0.5 and 0.2 of the 0.7 left
+  GetMplsInterface (node, 2)->SetDown ();
+
+  TxRecorder recorder (node);
+  const uint32_t label = 100;
+  for (uint32_t i = 0; i < 1000; ++i)
+    {
+      ReceiveLabeled (node, 4, &label, 1);
+    }
+
+  uint32_t counts[3] = { 0, 0, 0 };
+  for (std::vector<uint32_t>::const_iterator i = recorder.m_labels.begin (); i != recorder.m_labels.end (); ++i)
+    {
+      ++counts[*i - 201];
+    }
+  NS_TEST_ASSERT_MSG_EQ (recorder.m_labels.size (), 1000, "Packets are dropped");
+  NS_TEST_ASSERT_MSG_EQ (counts[1], 0, "NHLFE of the dead interface is selected");
+  NS_TEST_ASSERT_MSG_EQ_TOL (counts[0], 714, 5, "Invalid share of the first NHLFE");
+  NS_TEST_ASSERT_MSG_EQ_TOL (counts[2], 286, 5, "Invalid share of the last NHLFE");
+
+  Simulator::Destroy ();
+}
+
+class TiLfaTestCase : public TestCase
+{
+public:
+  /**
+   * @brief Constructor.
+   */
+  TiLfaTestCase ();
+  /**
+   * @brief Destructor.
+   */
+  virtual ~TiLfaTestCase ();
+  /**
+   * @brief Run unit tests for this class.
+   */
+  virtual void DoRun (void);
+
+};
+
+TiLfaTestCase::TiLfaTestCase () :
+  TestCase ("Verify TI-LFA repair paths")
+{
+}
+
+TiLfaTestCase::~TiLfaTestCase ()
+{
+}
+
+void
+TiLfaTestCase::DoRun (void)
+{
+  // ring 0 - 1 - 2 - 3 - 4 - 0, device 1 of node 0 is on the link to 1, device 2 on the link to 4
+  const uint32_t links[][2] = { { 0, 1 }, { 1, 2 }, { 2, 3 }, { 3, 4 }, { 4, 0 } };
+  MplsNetworkConfigurator network;
+  NodeContainer nodes = CreateNetwork (network, 5, links, 5);
+  Ptr<Node> node = nodes.Get (0);
+  Ptr<Interface> primary = GetMplsInterface (node, 1);
+  Ptr<Interface> repair = GetMplsInterface (node, 2);
+
+  MplsGlobalLabelHelper labels;
+  labels.PopulateLabelTables (network);
+
+  MplsTiLfaHelper tilfa;
+  uint32_t nDetours = tilfa.InstallBackups (network, labels);
+  NS_TEST_ASSERT_MSG_GT (nDetours, 0, "No detour is installed");
+  NS_TEST_ASSERT_MSG_EQ (tilfa.GetNProtected (), nDetours, "Every protected pair should get a detour");
+  NS_TEST_ASSERT_MSG_EQ (tilfa.GetNUnprotected (), 0, "Every adjacency of a ring has a repair path");
+  NS_TEST_ASSERT_MSG_GT (tilfa.GetMaxStackDepth (), 0, "Repair paths of a ring need segments");
+  NS_TEST_ASSERT_MSG_EQ (DynamicCast<MplsNode> (node)->GetFastReroute ()->HasBackups (primary->GetIfIndex ()), true,
+                         "Adjacency is not protected");
+
+  // LSP from 0 to 2 crosses the protected link, its repair path goes around the ring
+  Label label (0);
+  NS_TEST_ASSERT_MSG_EQ (labels.GetLabel (node, nodes.Get (2), label), true, "No LSP from 0 to 2");
+  const uint32_t in = label;
+
+  TxRecorder recorder (node);
+  ReceiveLabeled (node, 2, &in, 1);
+  NS_TEST_ASSERT_MSG_EQ (recorder.m_interfaces.size (), 1, "Packet is not forwarded");
+  NS_TEST_ASSERT_MSG_EQ (recorder.m_interfaces[0], int32_t (primary->GetIfIndex ()), "Detour is used before the failure");
+
+  primary->SetDown ();
+  recorder.Clear ();
+  ReceiveLabeled (node, 2, &in, 1);
+  NS_TEST_ASSERT_MSG_EQ (recorder.m_interfaces.size (), 1, "Packet is not repaired");
+  NS_TEST_ASSERT_MSG_EQ (recorder.m_interfaces[0], int32_t (repair->GetIfIndex ()), "Packet does not take the repair path");
+
+  tilfa.RemoveBackups ();
+  NS_TEST_ASSERT_MSG_EQ (DynamicCast<MplsNode> (node)->GetFastReroute ()->HasBackups (primary->GetIfIndex ()), false,
+                         "Backups are not removed");
+
+  Simulator::Destroy ();
+}
+
+class SegmentRoutingTestCase : public TestCase
+{
+public:
+  /**
+   * @brief Constructor.
+   */
+  SegmentRoutingTestCase ();
+  /**
+   * @brief Destructor.
+   */
+  virtual ~SegmentRoutingTestCase ();
+  /**
+   * @brief Run unit tests for this class.
+   */
+  virtual void DoRun (void);
+
+};
+
+SegmentRoutingTestCase::SegmentRoutingTestCase () :
+  TestCase ("Verify segment routing with a deep segment list")
+{
+}
+
+SegmentRoutingTestCase::~SegmentRoutingTestCase ()
+{
+}
+
+void
+SegmentRoutingTestCase::DoRun (void)
+{
+  const uint32_t links[][2] = { { 0, 1 } };
+  MplsNetworkConfigurator network;
+  NodeContainer nodes = CreateNetwork (network, 2, links, 1);
+  Ptr<MplsNode> ingress = DynamicCast<MplsNode> (nodes.Get (0));
+
+  MplsSegmentRoutingHelper sr;
+  sr.Install (network);
+
+  uint32_t label = sr.GetNodeLabel (nodes.Get (1));
+  NS_TEST_ASSERT_MSG_EQ (label >= 16000 && label < 24000, true, "Node label is out of the SRGB");
+  NS_TEST_ASSERT_MSG_NE (FindIlm (ingress, label), 0, "Node segment is not installed");
+  NS_TEST_ASSERT_MSG_NE (FindIlm (ingress, sr.GetAdjacencyLabel (GetMplsInterface (ingress, 1))), 0,
+                         "Adjacency segment is not installed");
+
+  // the segment list bounces between the nodes, its stack is deeper than 255 labels
+  MplsSegmentRoutingHelper::SegmentList segments;
+  for (uint32_t i = 0; i < 300; ++i)
+    {
+      segments.push_back (MplsSegmentRoutingHelper::Segment (nodes.Get ((i + 1) % 2)));
+    }
+
+  sr.AddFtn (ingress, Ipv4Destination ("10.9.0.1"), segments);
+  NS_TEST_ASSERT_MSG_EQ (ingress->GetFtnTable ()->size (), 1, "FTN is not installed");
+  uint32_t nLabels = ingress->GetFtnTable ()->front ()->GetNhlfe (0).GetNLabels ();
+  NS_TEST_ASSERT_MSG_GT (nLabels, 255, "Segment list is not encoded");
+
+  // label stacks of any depth are saved
+  MplsLfibSnapshot snapshot;
+  std::stringstream ss;
+  snapshot.Save (nodes, ss);
+  NS_TEST_ASSERT_MSG_EQ (snapshot.Restore (nodes, ss), true, "Snapshot is not restored");
+  NS_TEST_ASSERT_MSG_EQ (ingress->GetFtnTable ()->size (), 1, "FTN is not restored");
+  NS_TEST_ASSERT_MSG_EQ (ingress->GetFtnTable ()->front ()->GetNhlfe (0).GetNLabels (), nLabels, "Labels are lost");
+
+  Simulator::Destroy ();
+}
+
+class BindingSidTestCase : public TestCase
+{
+public:
+  /**
+   * @brief Constructor.
+   */
+  BindingSidTestCase ();
+  /**
+   * @brief Destructor.
+   */
+  virtual ~BindingSidTestCase ();
+  /**
+   * @brief Run unit tests for this class.
+   */
+  virtual void DoRun (void);
+
+};
+
+BindingSidTestCase::BindingSidTestCase () :
+  TestCase ("Verify expansion of binding SIDs")
+{
+}
+
+BindingSidTestCase::~BindingSidTestCase ()
+{
+}
+
+void
+BindingSidTestCase::DoRun (void)
+{
+  // chain 0 - 1 - 2
+  const uint32_t links[][2] = { { 0, 1 }, { 1, 2 } };
+  MplsNetworkConfigurator network;
+  NodeContainer nodes = CreateNetwork (network, 3, links, 2);
+  Ptr<MplsNode> node = DynamicCast<MplsNode> (nodes.Get (0));
+
+  MplsSegmentRoutingHelper sr;
+  sr.Install (network);
+
+  MplsSegmentRoutingHelper::SegmentList segments;
+  segments.push_back (MplsSegmentRoutingHelper::Segment (nodes.Get (2)));
+  const uint32_t binding = sr.AddBindingSid (node, segments);
+  NS_TEST_ASSERT_MSG_NE (FindIlm (node, binding), 0, "Binding SID is not installed");
+
+  // the binding label is replaced by the segment list, which is resolved by the same node
+  TxRecorder recorder (node);
+  const uint32_t stack[] = { binding, 777 };
+  ReceiveLabeled (node, 1, stack, 2);
+  NS_TEST_ASSERT_MSG_EQ (recorder.m_interfaces.size (), 1, "Packet is not forwarded");
+  NS_TEST_ASSERT_MSG_EQ (recorder.m_interfaces[0], int32_t (GetMplsInterface (node, 1)->GetIfIndex ()),
+                         "Invalid outgoing interface");
+  NS_TEST_ASSERT_MSG_EQ (recorder.m_labels[0], uint32_t (sr.GetNodeLabel (nodes.Get (2))), "Segment list is not pushed");
+  NS_TEST_ASSERT_MSG_EQ (recorder.m_sizes[0], 2, "Binding label is not popped");
+
+  // a binding SID referring to itself is dropped
+  node->GetIlmTable ()->push_back (Create<IncomingLabelMap> (5000, Nhlfe (Push (5000)),
+    CreateObject<RoundRobinPolicy> ()));
+  recorder.Clear ();
+  const uint32_t loop = 5000;
+  ReceiveLabeled (node, 1, &loop, 1);
+  NS_TEST_ASSERT_MSG_EQ (recorder.m_interfaces.size (), 0, "Looping packet is forwarded");
+  NS_TEST_ASSERT_MSG_EQ (recorder.m_nDrops, 1, "Looping packet is not dropped");
+
+  Simulator::Destroy ();
+}
+
+class NhlfeRewriteTestCase : public TestCase
+{
+public:
+  /**
+   * @brief Constructor.
+   */
+  NhlfeRewriteTestCase ();
+  /**
+   * @brief Destructor.
+   */
+  virtual ~NhlfeRewriteTestCase ();
+  /**
+   * @brief Run unit tests for this class.
+   */
+  virtual void DoRun (void);
+
+};
+
+NhlfeRewriteTestCase::NhlfeRewriteTestCase () :
+  TestCase ("Verify NHLFE operations compiled into label stack rewrites")
+{
+}
+
+NhlfeRewriteTestCase::~NhlfeRewriteTestCase ()
+{
+}
+
+void
+NhlfeRewriteTestCase::DoRun (void)
+{
+  Nhlfe pop = Nhlfe (Pop (), 1);
+  NS_TEST_ASSERT_MSG_EQ (pop.GetNPop (), 1, "Pop should pop one entry");
+  NS_TEST_ASSERT_MSG_EQ (pop.GetNShims (), 0, "Pop should push nothing");
+
+  Nhlfe php = Nhlfe (Swap (Label (Label::IMPLICIT_NULL)), 1);
+  NS_TEST_ASSERT_MSG_EQ (php.GetNPop (), 1, "Penultimate hop popping should pop one entry");
+  NS_TEST_ASSERT_MSG_EQ (php.GetNShims (), 0, "Implicit null is pushed");
+
+  Nhlfe swap = Nhlfe (Swap (18, 20), 1);
+  NS_TEST_ASSERT_MSG_EQ (swap.GetNPop (), 1, "Swap should pop one entry");
+  NS_TEST_ASSERT_MSG_EQ (swap.GetNShims (), 2, "Swap should push every label");
+
+  LabelStack stack;
+  stack.Push (shim::Get (5));
+  stack.Push (shim::Get (17));
+  stack.Rewrite (swap.GetNPop (), swap.GetShims (), swap.GetNShims ());
+  NS_TEST_ASSERT_MSG_EQ (stack.GetSize (), 3, "Invalid stack size after swap");
+  NS_TEST_ASSERT_MSG_EQ (shim::GetLabel (stack.Peek ()), 20, "The last label should be on top");
+
+  stack.Rewrite (pop.GetNPop (), pop.GetShims (), pop.GetNShims ());
+  NS_TEST_ASSERT_MSG_EQ (shim::GetLabel (stack.Peek ()), 18, "Invalid top label after pop");
+
+  // the operation is shared by copies of the NHLFE
+  std::vector<uint32_t> labels (10);
+  for (uint32_t i = 0; i < labels.size (); ++i)
+    {
+      labels[i] = 100 + i;
+    }
+  Nhlfe deep = Nhlfe (Push (&labels[0], labels.size ()));
+  Nhlfe copy = deep;
+  NS_TEST_ASSERT_MSG_EQ (copy.GetNShims (), 10, "Labels are lost by the copy");
+  NS_TEST_ASSERT_MSG_EQ (copy.GetLabel (9), 109, "Labels are lost by the copy");
+
+  // a binding SID pushing implicit null only leaves nothing to resolve
+  const uint32_t links[][2] = { { 0, 1 } };
+  MplsNetworkConfigurator network;
+  NodeContainer nodes = CreateNetwork (network, 2, links, 1);
+  Ptr<MplsNode> node = DynamicCast<MplsNode> (nodes.Get (0));
+  Nhlfe empty = Nhlfe (Push (Label (Label::IMPLICIT_NULL)));
+  NS_TEST_ASSERT_MSG_EQ (empty.GetNShims (), 0, "Implicit null is pushed");
+  node->GetIlmTable ()->push_back (Create<IncomingLabelMap> (5000, empty, CreateObject<RoundRobinPolicy> ()));
+
+  TxRecorder recorder (node);
+  const uint32_t label = 5000;
+  ReceiveLabeled (node, 1, &label, 1);
+  NS_TEST_ASSERT_MSG_EQ (recorder.m_interfaces.size (), 0, "Packet without labels is forwarded");
+  NS_TEST_ASSERT_MSG_EQ (recorder.m_nDrops, 1, "Packet without labels is not dropped");
+
+  Simulator::Destroy ();
+}
+
+class PhpIpForwardTestCase : public TestCase
+{
+public:
+  /**
+   * @brief Constructor.
+   */
+  PhpIpForwardTestCase ();
+  /**
+   * @brief Destructor.
+   */
+  virtual ~PhpIpForwardTestCase ();
+  /**
+   * @brief Run unit tests for this class.
+   */
+  virtual void DoRun (void);
+
+private:
+  void Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol, const Address &from,
+                const Address &to, NetDevice::PacketType packetType);
+  Ptr<Packet> CreateIpv4Packet (uint32_t size) const;
+
+  std::vector<Ipv4Header> m_received;
+};
+
+PhpIpForwardTestCase::PhpIpForwardTestCase () :
+  TestCase ("Verify ipv4 forwarding to the next-hop of a penultimate hop popping NHLFE")
+{
+}
+
+PhpIpForwardTestCase::~PhpIpForwardTestCase ()
+{
+}
+
+void
+PhpIpForwardTestCase::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                               const Address &from, const Address &to, NetDevice::PacketType packetType)
+{
+  Ipv4Header header;
+  packet->PeekHeader (header);
+  m_received.push_back (header);
+}
+
+Ptr<Packet>
+PhpIpForwardTestCase::CreateIpv4Packet (uint32_t size) const
+{
+  Ptr<Packet> packet = Create<Packet> (size);
+  Ipv4Header header;
+  header.SetSource (Ipv4Address ("10.0.1.2"));
+  header.SetDestination (Ipv4Address ("10.0.0.2"));
+  header.SetProtocol (UdpL4Protocol::PROT_NUMBER);
+  header.SetPayloadSize (size);
+  header.SetTtl (64);
+  packet->AddHeader (header);
+  return packet;
+}
+
+void
+PhpIpForwardTestCase::DoRun (void)
+{
+  // packets enter node 0 from node 2, node 1 is the egress
+  const uint32_t links[][2] = { { 0, 1 }, { 0, 2 } };
+  MplsNetworkConfigurator network;
+  NodeContainer nodes = CreateNetwork (network, 3, links, 2);
+  Ptr<MplsNode> node = DynamicCast<MplsNode> (nodes.Get (0));
+  Ptr<Interface> outInterface = GetMplsInterface (node, 1);
+
+  node->GetIlmTable ()->push_back (Create<IncomingLabelMap> (100, Nhlfe (Swap (Label (Label::IMPLICIT_NULL)),
+    outInterface->GetIfIndex (), Ipv4Address ("10.0.0.2")), CreateObject<RoundRobinPolicy> ()));
+  nodes.Get (1)->RegisterProtocolHandler (MakeCallback (&PhpIpForwardTestCase::Receive, this),
+                                          Ipv4L3Protocol::PROT_NUMBER, nodes.Get (1)->GetDevice (1));
+
+  // the label is popped and the packet is sent to the next-hop directly
+  const uint32_t label = 100;
+  ReceiveLabeled (node, 2, &label, 1, CreateIpv4Packet (100));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_received.size (), 1, "Packet is not delivered to the next-hop");
+  NS_TEST_ASSERT_MSG_EQ (m_received[0].GetDestination (), Ipv4Address ("10.0.0.2"), "Invalid ipv4 header");
+  NS_TEST_ASSERT_MSG_EQ (uint32_t (m_received[0].GetTtl ()), 63, "TTL of the label is not copied");
+
+  // a packet exceeding the MTU is fragmented by ipv4 on the adjacency route
+  node->GetDevice (1)->SetMtu (600);
+  m_received.clear ();
+  ReceiveLabeled (node, 2, &label, 1, CreateIpv4Packet (1000));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_GT (m_received.size (), 1, "Packet is not fragmented");
+  NS_TEST_ASSERT_MSG_EQ (m_received[0].GetSource (), Ipv4Address ("10.0.1.2"), "Source of the packet is changed");
+
+  // the adjacency route follows the new address of the interface
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  int32_t ipv4if = ipv4->GetInterfaceForDevice (node->GetDevice (1));
+  ipv4->RemoveAddress (ipv4if, 0);
+  ipv4->AddAddress (ipv4if, Ipv4InterfaceAddress (Ipv4Address ("10.0.0.3"), Ipv4Mask ("255.255.255.0")));
+  m_received.clear ();
+  ReceiveLabeled (node, 2, &label, 1, CreateIpv4Packet (1000));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_GT (m_received.size (), 1, "Packet is not fragmented after renumbering");
+
+  Simulator::Destroy ();
+}
+
+class RouteCacheTestCase : public TestCase
+{
+public:
+  /**
+   * @brief Constructor.
+   */
+  RouteCacheTestCase ();
+  /**
+   * @brief Destructor.
+   */
+  virtual ~RouteCacheTestCase ();
+  /**
+   * @brief Run unit tests for this class.
+   */
+  virtual void DoRun (void);
+
+};
+
+RouteCacheTestCase::RouteCacheTestCase () :
+  TestCase ("Verify the route cache of the mpls routing hook")
+{
+}
+
+RouteCacheTestCase::~RouteCacheTestCase ()
+{
+}
+
+void
+RouteCacheTestCase::DoRun (void)
+{
+  const uint32_t links[][2] = { { 0, 1 }, { 0, 2 } };
+  MplsNetworkConfigurator network;
+  NodeContainer nodes = CreateNetwork (network, 3, links, 2);
+  Ptr<MplsNode> node = DynamicCast<MplsNode> (nodes.Get (0));
+  Ptr<Ipv4Routing> routing = DynamicCast<Ipv4Protocol> (node->GetObject<Ipv4> ())->GetMplsRouting ();
+
+  // the last label is popped without a next-hop, ipv4 routing forwards the packet
+  node->GetIlmTable ()->push_back (Create<IncomingLabelMap> (100, Nhlfe (Pop ()), CreateObject<RoundRobinPolicy> ()));
+
+  Ipv4Header header;
+  header.SetSource (Ipv4Address ("10.0.1.2"));
+  header.SetDestination (Ipv4Address ("10.0.0.2"));
+  header.SetProtocol (UdpL4Protocol::PROT_NUMBER);
+  header.SetPayloadSize (100);
+  header.SetTtl (64);
+  const uint32_t label = 100;
+
+  Ptr<Packet> packet = Create<Packet> (100);
+  packet->AddHeader (header);
+  ReceiveLabeled (node, 2, &label, 1, packet);
+  NS_TEST_ASSERT_MSG_EQ (routing->GetRouteCacheHits () + routing->GetRouteCacheMisses (), 0,
+                         "Route cache should be disabled by default");
+
+  routing->SetAttribute ("RouteCacheSize", UintegerValue (16));
+  for (uint32_t i = 0; i < 2; ++i)
+    {
+      packet = Create<Packet> (100);
+      packet->AddHeader (header);
+      ReceiveLabeled (node, 2, &label, 1, packet);
+    }
+  NS_TEST_ASSERT_MSG_EQ (routing->GetRouteCacheMisses (), 1, "Route of the popped packet is not looked up in the cache");
+  NS_TEST_ASSERT_MSG_EQ (routing->GetRouteCacheHits (), 1, "Route of the popped packet is not cached");
+
+  routing->FlushRouteCache ();
+  packet = Create<Packet> (100);
+  packet->AddHeader (header);
+  ReceiveLabeled (node, 2, &label, 1, packet);
+  NS_TEST_ASSERT_MSG_EQ (routing->GetRouteCacheMisses (), 2, "Route cache is not flushed");
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+class ReplicationTestCase : public TestCase
+{
+public:
+  /**
+   * @brief Constructor.
+   */
+  ReplicationTestCase ();
+  /**
+   * @brief Destructor.
+   */
+  virtual ~ReplicationTestCase ();
+  /**
+   * @brief Run unit tests for this class.
+   */
+  virtual void DoRun (void);
+
+};
+
+ReplicationTestCase::ReplicationTestCase () :
+  TestCase ("Verify replication of point-to-multipoint LSPs")
+{
+}
+
+ReplicationTestCase::~ReplicationTestCase ()
+{
+}
+
+void
+ReplicationTestCase::DoRun (void)
+{
+  // node 0 is the branch point of a tree towards nodes 1 and 2, packets enter from node 3
+  const uint32_t links[][2] = { { 0, 1 }, { 0, 2 }, { 0, 3 } };
+  MplsNetworkConfigurator network;
+  NodeContainer nodes = CreateNetwork (network, 4, links, 3);
+  Ptr<MplsNode> node = DynamicCast<MplsNode> (nodes.Get (0));
+  int32_t if1 = GetMplsInterface (node, 1)->GetIfIndex ();
+  int32_t if2 = GetMplsInterface (node, 2)->GetIfIndex ();
+
+  Ptr<IncomingLabelMap> ilm = Create<IncomingLabelMap> (100, Nhlfe (Swap (201), if1, Ipv4Address ("10.0.0.2")),
+    CreateObject<RoundRobinPolicy> ());
+  ilm->AddNhlfe (Nhlfe (Swap (202), if2, Ipv4Address ("10.0.1.2")));
+  ilm->SetReplication (true);
+  node->GetIlmTable ()->push_back (ilm);
+
+  TxRecorder recorder (node);
+  const uint32_t label = 100;
+  ReceiveLabeled (node, 3, &label, 1);
+  NS_TEST_ASSERT_MSG_EQ (recorder.m_interfaces.size (), 2, "Packet is not replicated to every branch");
+  NS_TEST_ASSERT_MSG_EQ (recorder.m_interfaces[0] != recorder.m_interfaces[1], true, "Branches share an interface");
+  for (uint32_t i = 0; i < 2; ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (recorder.m_labels[i], recorder.m_interfaces[i] == if1 ? 201u : 202u,
+                             "Branch label is not swapped");
+    }
+
+  // a branch over a failed link is dropped, the others are still sent
+  GetMplsInterface (node, 1)->SetDown ();
+  recorder.Clear ();
+  ReceiveLabeled (node, 3, &label, 1);
+  NS_TEST_ASSERT_MSG_EQ (recorder.m_interfaces.size (), 1, "Branch of the failed link is sent");
+  NS_TEST_ASSERT_MSG_EQ (recorder.m_interfaces[0], if2, "Branch of the alive link is not sent");
+
+  // a protected branch follows its bypass
+  node->GetFastReroute ()->AddBypass (if1, Address (), Nhlfe (Swap (900), if2, Ipv4Address ("10.0.1.2")));
+  recorder.Clear ();
+  ReceiveLabeled (node, 3, &label, 1);
+  NS_TEST_ASSERT_MSG_EQ (recorder.m_interfaces.size (), 2, "Protected branch is not sent");
+  uint32_t nBypass = 0;
+  for (uint32_t i = 0; i < recorder.m_interfaces.size (); ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (recorder.m_interfaces[i], if2, "Branch is sent to the failed link");
+      nBypass += recorder.m_labels[i] == 900 && recorder.m_sizes[i] == 2;
+    }
+  NS_TEST_ASSERT_MSG_EQ (nBypass, 1, "Protected branch does not take the bypass");
+
+  Simulator::Destroy ();
+}
+
 static class MplsTestSuite : public TestSuite
 {
 public:
@@ -72,6 +2099,31 @@ public:
     TestSuite ("mpls", UNIT)
   {
     AddTestCase (new NhlfeTestCase ());
+    AddTestCase (new GlobalLabelTestCase ());
+    AddTestCase (new GlobalLabelRepairTestCase ());
+    AddTestCase (new TunnelTestCase ());
+    AddTestCase (new CspfTestCase ());
+    AddTestCase (new CspfBatchTestCase ());
+    AddTestCase (new TopologyTestCase ());
+    AddTestCase (new NetworkUpdateTestCase ());
+    AddTestCase (new InstallerTestCase ());
+    AddTestCase (new LfibSnapshotTestCase ());
+    AddTestCase (new ConfigLoaderTestCase ());
+    AddTestCase (new BulkInsertionTestCase ());
+    AddTestCase (new SharedPolicyTestCase ());
+    AddTestCase (new NhlfePoolTestCase ());
+    AddTestCase (new FlatLfibTestCase ());
+    AddTestCase (new NextHopGroupTestCase ());
+    AddTestCase (new FastRerouteTestCase ());
+    AddTestCase (new FastRerouteLivenessTestCase ());
+    AddTestCase (new WeightedLivenessTestCase ());
+    AddTestCase (new TiLfaTestCase ());
+    AddTestCase (new SegmentRoutingTestCase ());
+    AddTestCase (new BindingSidTestCase ());
+    AddTestCase (new NhlfeRewriteTestCase ());
+    AddTestCase (new PhpIpForwardTestCase ());
+    AddTestCase (new RouteCacheTestCase ());
+    AddTestCase (new ReplicationTestCase ());
   }
 } g_mplsTestSuite;
 